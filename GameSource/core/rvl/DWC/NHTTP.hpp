@@ -13,4 +13,4 @@ s32 NHTTPDestroyResponse(void *response);
 // SSL/HTTPS support functions
 s32 NHTTPSetRootCADefault();
 s32 NHTTPSetClientCertDefault();
-s32 NHTTPSetVerifyOption(u32 option);
\ No newline at end of file
+s32 NHTTPSetVerifyOption(u32 option);
@@ -13,6 +13,7 @@ extern u32 coreClock;  // 800000fc
 inline u32 GetTimerClock() { return busClock / 4; }
 inline u32 TicksToMilliseconds(u64 ticks) { return ticks / (GetTimerClock() / 1000); }
 inline u32 TicksToSeconds(u64 ticks) { return ticks / GetTimerClock(); }
+inline u32 TicksToMicroseconds(u64 ticks) { return (ticks * 8) / (GetTimerClock() / 125000); }
 inline u32 TicksToNanoseconds(u64 ticks) { return ticks * (1000000000 / GetTimerClock()); }
 inline u32 NanosecondsToTicks(u32 nanoSeconds) { return nanoSeconds / (1000000000 / GetTimerClock()); }
 
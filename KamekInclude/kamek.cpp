@@ -1,4 +1,7 @@
 #include <kamek.hpp>
+#ifdef HOOK_PROFILING
+#include <core/rvl/OS/OS.hpp>
+#endif
 
 DoFuncsHook *SectionLoadHook::sHooks = nullptr;
 DoFuncsHook *RaceLoadHook::raceLoadHooks = nullptr;
@@ -10,11 +13,25 @@ void DoFuncsHook::Init(void *f, Invoker inv, DoFuncsHook **prev) {
     this->invoker = inv;
     this->next = *prev;
     *prev = this;
+#ifdef HOOK_PROFILING
+    this->profile.calls = 0;
+    this->profile.maxTicks = 0;
+    this->profile.totalTicks = 0;
+#endif
 }
 
 void DoFuncsHook::Exec(DoFuncsHook *first, void *a1, void *a2, void *a3) {
     for (DoFuncsHook *p = first; p; p = p->next) {
+#ifdef HOOK_PROFILING
+        const u32 start = OS::GetTick();
         p->invoker(p->funcPtr, a1, a2, a3);
+        const u32 ticks = OS::GetTick() - start;
+        ++p->profile.calls;
+        p->profile.totalTicks += ticks;
+        if (ticks > p->profile.maxTicks) p->profile.maxTicks = ticks;
+#else
+        p->invoker(p->funcPtr, a1, a2, a3);
+#endif
     }
 }
 
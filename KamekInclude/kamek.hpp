@@ -270,6 +270,18 @@ protected:
     void Init(void *f, Invoker inv, DoFuncsHook **prev);
 
     static void Exec(DoFuncsHook *first, void *a1 = nullptr, void *a2 = nullptr, void *a3 = nullptr);
+
+#ifdef HOOK_PROFILING
+public:
+    struct Profile {
+        u32 calls;
+        u32 maxTicks;
+        u64 totalTicks;
+    };
+    const void *GetFunc() const { return funcPtr; }
+    DoFuncsHook *GetNext() const { return next; }
+    Profile profile;
+#endif
 };
 
 class RaceLoadHook : public DoFuncsHook {
@@ -279,6 +291,9 @@ public:
     template <typename F>
     RaceLoadHook(F f) : DoFuncsHook(f, &raceLoadHooks) {}
     static void Exec(void *a1 = nullptr, void *a2 = nullptr, void *a3 = nullptr) { DoFuncsHook::Exec(raceLoadHooks, a1, a2, a3); }
+#ifdef HOOK_PROFILING
+    static DoFuncsHook *GetFirst() { return raceLoadHooks; }
+#endif
 };
 
 class FrameLoadHook : public DoFuncsHook {
@@ -288,6 +303,9 @@ public:
     template <typename F>
     FrameLoadHook(F f) : DoFuncsHook(f, &FrameLoadHooks) {}
     static void Exec(void *a1 = nullptr, void *a2 = nullptr, void *a3 = nullptr) { DoFuncsHook::Exec(FrameLoadHooks, a1, a2, a3); }
+#ifdef HOOK_PROFILING
+    static DoFuncsHook *GetFirst() { return FrameLoadHooks; }
+#endif
 };
 
 class RaceFrameHook : public DoFuncsHook {
@@ -297,6 +315,9 @@ public:
     template <typename F>
     RaceFrameHook(F f) : DoFuncsHook(f, &raceFrameHooks) {}
     static void Exec(void *a1 = nullptr, void *a2 = nullptr, void *a3 = nullptr) { DoFuncsHook::Exec(raceFrameHooks, a1, a2, a3); }
+#ifdef HOOK_PROFILING
+    static DoFuncsHook *GetFirst() { return raceFrameHooks; }
+#endif
 };
 
 class SectionLoadHook : public DoFuncsHook {
@@ -306,6 +327,9 @@ public:
     template <typename F>
     SectionLoadHook(F f) : DoFuncsHook(f, &sHooks) {}
     static void Exec(void *a1 = nullptr, void *a2 = nullptr, void *a3 = nullptr) { DoFuncsHook::Exec(sHooks, a1, a2, a3); }
+#ifdef HOOK_PROFILING
+    static DoFuncsHook *GetFirst() { return sHooks; }
+#endif
 };
 
 // REL has NOT loaded yet, so do NOT do anything with REL addr, it will not work
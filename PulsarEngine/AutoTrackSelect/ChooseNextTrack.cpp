@@ -180,12 +180,15 @@ void ChooseNextTrack::UpdateRH1() {
         if (aid == sub.localAid) continue;
         for (int i = 0; i < 2; ++i) {
             RKNet::PacketHolder<Network::PulRH1> *holder = controller->splitToSendRACEPackets[i][aid]->GetPacketHolder<Network::PulRH1>();
-            Network::PulRH1 *sendPacket = holder->packet;
-            sendPacket->chooseNextStatus = this->status;
+            Network::PulRH1 sendPacket;
+            u32 packetSize;
+            Network::ReadSendPulRH1(*holder, sendPacket, packetSize);
+            sendPacket.chooseNextStatus = this->status;
             const CupsConfig *cupsConfig = CupsConfig::sInstance;
-            sendPacket->nextTrack = cupsConfig->GetWinning();
-            sendPacket->variantIdx = cupsConfig->GetCurVariantIdx();
-            sendPacket->hasTrack = true;
+            sendPacket.nextTrack = cupsConfig->GetWinning();
+            sendPacket.variantIdx = cupsConfig->GetCurVariantIdx();
+            sendPacket.hasTrack = true;
+            Network::WriteSendPulRH1(*holder, sendPacket, packetSize);
         }
     }
 }
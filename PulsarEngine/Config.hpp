@@ -88,6 +88,21 @@ struct PulBMG {
     BMGHeader header;
 };
 
+struct FileNameEntry {
+    u32 key;  // (variantIdx << 12) | trackIdx, same keys as the text FILE block
+    u32 nameOffset;  // into the string pool that follows the entries
+};
+
+// Optional section right after the BMG; without it the text FILE block is parsed instead.
+struct FileNamesHolder {
+    static const u32 magic = 'FNAM';
+    static const u32 curVersion = 1;
+    SectionHeader header;  // size covers the entries and the pool
+    u32 entryCount;
+    u32 poolSize;
+    FileNameEntry entries[1];
+};
+
 struct ConfigFile {
     static u32 readBytes;
     void Destroy() {
@@ -73,8 +73,8 @@ bool LoadRawBRRES(void *holder, RawBRRES &cache, const char *path) {
     return true;
 }
 
-bool LoadRawBRRESIntoHeap(void *holder, EGG::Heap *heap, const char *path, u32 fileSize) {
-    if (holder == nullptr || heap == nullptr || path == nullptr || fileSize == 0) return false;
+bool LoadRawBRRESIntoHeap(void *holder, EGG::Heap *heap, const char *path) {
+    if (holder == nullptr || heap == nullptr || path == nullptr) return false;
     u32 loadedSize = 0;
     void *file = LoadFileToMainRAM(path, heap, EGG::DvdRipper::ALLOC_FROM_HEAD, &loadedSize);
     if (file == nullptr || loadedSize == 0) return false;
@@ -120,7 +120,7 @@ bool TryLoadCustomMenuBRRES(void *holder, CharacterId character) {
 
 bool TryLoadLooseMiiCBRRES(void *holder, CharacterId character) {
     const u8 idx = MiiCIndex(character);
-    if (idx >= MII_C_COUNT) return false;
+    if (idx >= MII_C_COUNT || !LooseMiiCDriverExists(character)) return false;
     char path[0x60];
     if (!BuildDriverPath(character, TABLE_DEFAULT, path, sizeof(path))) return false;
     return LoadRawBRRES(holder, looseMiiCBRRES[idx], path);
@@ -130,16 +130,15 @@ bool TryLoadCustomMenuBRRESIntoHeap(void *holder, CharacterId character, EGG::He
     fileExists = false;
     const CharacterId menuCharacter = MenuBRRESCharacter(character);
     const u8 table = ResolveMenuTable(menuCharacter);
-    if (table == TABLE_DEFAULT || table >= TABLE_COUNT || !HasSkin(menuCharacter, table)) return false;
+    if (table == TABLE_DEFAULT || table >= TABLE_COUNT) return false;
     char path[0x60];
     if (!BuildDriverPath(menuCharacter, table, path, sizeof(path))) return false;
-    u32 fileSize = 0;
-    if (!DiscFileSize(path, fileSize)) {
+    if (!HasSkin(menuCharacter, table)) {
         rawBRRES[table][menuCharacter].failed = true;
         return false;
     }
     fileExists = true;
-    return LoadRawBRRESIntoHeap(holder, heap, path, fileSize);
+    return LoadRawBRRESIntoHeap(holder, heap, path);
 }
 
 bool TryLoadLooseMiiCBRRESIntoHeap(void *holder, CharacterId character, EGG::Heap *heap, bool &fileExists) {
@@ -148,13 +147,12 @@ bool TryLoadLooseMiiCBRRESIntoHeap(void *holder, CharacterId character, EGG::Hea
     if (idx >= MII_C_COUNT) return false;
     char path[0x60];
     if (!BuildDriverPath(character, TABLE_DEFAULT, path, sizeof(path))) return false;
-    u32 fileSize = 0;
-    if (!DiscFileSize(path, fileSize)) {
+    if (!LooseMiiCDriverExists(character)) {
         looseMiiCBRRES[idx].failed = true;
         return false;
     }
     fileExists = true;
-    return LoadRawBRRESIntoHeap(holder, heap, path, fileSize);
+    return LoadRawBRRESIntoHeap(holder, heap, path);
 }
 
 // Menu driver BRRES loads prefer selected loose skins, then loose Mii C, then vanilla.
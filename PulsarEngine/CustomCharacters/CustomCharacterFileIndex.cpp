@@ -0,0 +1,319 @@
+#include <CustomCharacters/CustomCharacters.hpp>
+#include <IO/LooseArchiveOverrides.hpp>
+#include <core/rvl/OS/OSBootInfo.hpp>
+
+namespace Pulsar {
+namespace CustomCharacters {
+
+// Existence of loose skins, Mii C models, voice stems and silent markers, filled by a single walk over
+// /Scene/Model/Driver and /sound instead of one FST path lookup per character, table and file variant.
+// Driver files only reachable through a whole-file override, or through the channel's SD folders, are probed
+// once on first use since the FST cannot list them.
+
+struct DiscFSTEntry {
+    u32 typeName;
+    u32 offset;
+    u32 size;
+};
+
+static bool FSTEntryIsDir(const DiscFSTEntry &entry) {
+    return (entry.typeName & 0xff000000) != 0;
+}
+
+static u32 FSTNameOffset(const DiscFSTEntry &entry) {
+    return entry.typeName & 0x00ffffff;
+}
+
+typedef u64 LooseVoiceStems[LOOSE_VOICE_SUFFIX_COUNT];  // one LOOSE_VOICE_STEM_* bit per name variant
+
+struct CharacterFileIndex {
+    bool built;
+    u8 miiCFound;
+    u8 miiCChecked;
+    u64 skinFound[CHARACTER_COUNT];  // bit per table, indexed by StateCharacter
+    u64 skinChecked[CHARACTER_COUNT];
+    u64 silentFound[CHARACTER_COUNT];
+    u16 voiceSlots[CHARACTER_COUNT][TABLE_COUNT];  // 1-based into voiceStems, 0 when the table has no loose voices
+    u32 voiceSlotCount;
+    LooseVoiceStems *voiceStems;
+    EGG::Heap *voiceStemsHeap;
+};
+
+static CharacterFileIndex fileIndex;
+
+static u64 TableBit(u8 table) {
+    return static_cast<u64>(1) << table;
+}
+
+static char ToLowerAscii(char c) {
+    if (c >= 'A' && c <= 'Z') return static_cast<char>(c - 'A' + 'a');
+    return c;
+}
+
+// DVD path lookups ignore case, so the index does too.
+static bool EqualsIgnoreCase(const char *str, const char *expected, u32 length) {
+    for (u32 i = 0; i < length; ++i) {
+        if (ToLowerAscii(str[i]) != ToLowerAscii(expected[i])) return false;
+    }
+    return true;
+}
+
+static bool EqualsIgnoreCase(const char *str, const char *expected) {
+    const u32 length = strlen(expected);
+    return strlen(str) == length && EqualsIgnoreCase(str, expected, length);
+}
+
+static bool ConsumeIgnoreCase(const char *&cursor, const char *expected) {
+    const u32 length = strlen(expected);
+    if (strlen(cursor) < length || !EqualsIgnoreCase(cursor, expected, length)) return false;
+    cursor += length;
+    return true;
+}
+
+// Parses "<vanilla postfix>-<table>" as written by GeneratedCustomPostfix and leaves cursor right after it.
+static bool ParseCustomPostfix(const char *&cursor, CharacterId &character, u8 &table) {
+    const char *dash = strchr(cursor, '-');
+    if (dash == nullptr || dash == cursor) return false;
+    const u32 baseLength = static_cast<u32>(dash - cursor);
+
+    character = CHARACTER_NONE;
+    for (u32 i = 0; i < CHARACTER_COUNT; ++i) {
+        const CharacterId candidate = static_cast<CharacterId>(i);
+        if (StateCharacter(candidate) != candidate) continue;
+        const char *base = GetDefaultCharacterPostfix(candidate);
+        if (base == nullptr || strlen(base) != baseLength || !EqualsIgnoreCase(cursor, base, baseLength)) continue;
+        character = candidate;
+        break;
+    }
+    if (!IsCharacter(character)) return false;
+
+    const char *digits = dash + 1;
+    if (*digits < '1' || *digits > '9') return false;  // "%u" never writes leading zeros
+    u32 value = 0;
+    while (*digits >= '0' && *digits <= '9') {
+        value = value * 10 + static_cast<u32>(*digits - '0');
+        if (value > CUSTOM_TABLE_LIMIT) return false;
+        ++digits;
+    }
+    table = static_cast<u8>(value);
+    cursor = digits;
+    return true;
+}
+
+static bool FindFSTDir(const char *path, const DiscFSTEntry *&fst, const char *&stringTable, u32 &first, u32 &end) {
+    fst = static_cast<const DiscFSTEntry *>(OS::BootInfo::mInstance.FSTLocation);
+    if (fst == nullptr) return false;
+    const u32 entryCount = fst[0].size;
+    const s32 entryNum = DVD::ConvertPathToEntryNum(path);
+    if (entryNum < 0 || static_cast<u32>(entryNum) >= entryCount || !FSTEntryIsDir(fst[entryNum])) return false;
+    first = static_cast<u32>(entryNum) + 1;
+    end = fst[entryNum].size;
+    if (end > entryCount) end = entryCount;
+    stringTable = reinterpret_cast<const char *>(fst) + entryCount * sizeof(DiscFSTEntry);
+    return true;
+}
+
+static void IndexDriverFile(const char *name, u32 size) {
+    if (size == 0) return;
+    const char *cursor = name;
+    CharacterId character = CHARACTER_NONE;
+    u8 table = TABLE_DEFAULT;
+    if (ParseCustomPostfix(cursor, character, table) && EqualsIgnoreCase(cursor, ".brres")) {
+        fileIndex.skinFound[character] |= TableBit(table);
+        return;
+    }
+
+    for (u32 i = 0; i < CHARACTER_COUNT; ++i) {
+        const CharacterId miiC = static_cast<CharacterId>(i);
+        const u8 idx = MiiCIndex(miiC);
+        if (idx >= MII_C_COUNT) continue;
+        const char *miiCName = DriverBRRESName(miiC, TABLE_DEFAULT);
+        cursor = name;
+        if (miiCName != nullptr && ConsumeIgnoreCase(cursor, miiCName) && EqualsIgnoreCase(cursor, ".brres")) {
+            fileIndex.miiCFound |= 1 << idx;
+            return;
+        }
+    }
+}
+
+static u64 LooseVoiceNameBits(const char *name) {
+    u64 bits = 0;
+    for (u32 i = 0; i < LOOSE_VOICE_CHARACTER_COUNT; ++i) {
+        if (EqualsIgnoreCase(name, voiceCharacterNames[i].name)) bits |= static_cast<u64>(1) << (LOOSE_VOICE_STEM_VOICE_NAME + i);
+        const char *postfixName = VoicePostfixNameForCharacter(voiceCharacterNames[i].character);
+        if (postfixName != nullptr && EqualsIgnoreCase(name, postfixName)) {
+            bits |= static_cast<u64>(1) << (LOOSE_VOICE_STEM_POSTFIX_NAME + i);
+        }
+    }
+    return bits;
+}
+
+// Sound files are "<postfix>.silent" markers and "GRP_VO_<POSTFIX>_<SUFFIX>.<brwsd|brbnk>[.<voice name>]" stems.
+// The first pass only assigns stem slots so the second one can fill an exactly sized allocation.
+static void IndexSoundFile(const char *name, u32 size, bool fillStems) {
+    const char *cursor = name;
+    CharacterId character = CHARACTER_NONE;
+    u8 table = TABLE_DEFAULT;
+    if (!ConsumeIgnoreCase(cursor, "GRP_VO_")) {
+        if (!fillStems && ParseCustomPostfix(cursor, character, table) && EqualsIgnoreCase(cursor, ".silent")) {
+            fileIndex.silentFound[character] |= TableBit(table);
+        }
+        return;
+    }
+    if (size == 0 || !ParseCustomPostfix(cursor, character, table) || *cursor != '_') return;
+    ++cursor;
+
+    const char *suffixEnd = strchr(cursor, '.');
+    if (suffixEnd == nullptr) return;
+    const u32 suffixLength = static_cast<u32>(suffixEnd - cursor);
+    u32 suffixIndex = 0;
+    for (; suffixIndex < LOOSE_VOICE_SUFFIX_COUNT; ++suffixIndex) {
+        const char *suffix = looseVoiceGroupSuffixes[suffixIndex];
+        if (strlen(suffix) == suffixLength && EqualsIgnoreCase(cursor, suffix, suffixLength)) break;
+    }
+    if (suffixIndex == LOOSE_VOICE_SUFFIX_COUNT) return;
+
+    cursor = suffixEnd + 1;
+    if (!ConsumeIgnoreCase(cursor, "brwsd") && !ConsumeIgnoreCase(cursor, "brbnk")) return;
+    u64 stemBits = 0;
+    if (*cursor == '\0')
+        stemBits = static_cast<u64>(1) << LOOSE_VOICE_STEM_DIRECT;
+    else if (*cursor == '.')
+        stemBits = LooseVoiceNameBits(cursor + 1);
+    if (stemBits == 0) return;
+
+    u16 &slot = fileIndex.voiceSlots[character][table];
+    if (!fillStems) {
+        if (slot == 0) slot = static_cast<u16>(++fileIndex.voiceSlotCount);
+        return;
+    }
+    if (slot == 0 || slot > fileIndex.voiceSlotCount) return;
+    fileIndex.voiceStems[slot - 1][suffixIndex] |= stemBits;
+}
+
+static void IndexSoundDir(const DiscFSTEntry *fst, const char *stringTable, u32 first, u32 end, bool fillStems) {
+    for (u32 i = first; i < end;) {
+        const DiscFSTEntry &entry = fst[i];
+        if (FSTEntryIsDir(entry)) {
+            i = entry.size > i ? entry.size : i + 1;
+            continue;
+        }
+        IndexSoundFile(stringTable + FSTNameOffset(entry), entry.size, fillStems);
+        ++i;
+    }
+}
+
+static void BuildCharacterFileIndex() {
+    if (System::sInstance == nullptr) return;
+    fileIndex.built = true;
+
+    const DiscFSTEntry *fst = nullptr;
+    const char *stringTable = nullptr;
+    u32 first = 0;
+    u32 end = 0;
+    // The channel reads driver files from SD (see DiscFileSize), so the FST only speaks for disc builds.
+    if (!IsNewChannel() && FindFSTDir("/Scene/Model/Driver", fst, stringTable, first, end)) {
+        for (u32 i = first; i < end;) {
+            const DiscFSTEntry &entry = fst[i];
+            if (FSTEntryIsDir(entry)) {
+                i = entry.size > i ? entry.size : i + 1;
+                continue;
+            }
+            IndexDriverFile(stringTable + FSTNameOffset(entry), entry.size);
+            ++i;
+        }
+        for (u32 i = 0; i < CHARACTER_COUNT; ++i) fileIndex.skinChecked[i] = fileIndex.skinFound[i];
+        fileIndex.miiCChecked = fileIndex.miiCFound;
+    }
+
+    if (!FindFSTDir("/sound", fst, stringTable, first, end)) return;
+    IndexSoundDir(fst, stringTable, first, end, false);
+    if (fileIndex.voiceSlotCount == 0) return;
+
+    EGG::Heap *heap = System::sInstance->heap;
+    const u32 stemsSize = fileIndex.voiceSlotCount * sizeof(LooseVoiceStems);
+    fileIndex.voiceStems = static_cast<LooseVoiceStems *>(EGG::Heap::alloc(stemsSize, 0x4, heap));
+    if (fileIndex.voiceStems == nullptr) {
+        memset(fileIndex.voiceSlots, 0, sizeof(fileIndex.voiceSlots));
+        fileIndex.voiceSlotCount = 0;
+        return;
+    }
+    fileIndex.voiceStemsHeap = heap;
+    memset(fileIndex.voiceStems, 0, stemsSize);
+    IndexSoundDir(fst, stringTable, first, end, true);
+}
+
+static void EnsureCharacterFileIndex() {
+    if (!fileIndex.built) BuildCharacterFileIndex();
+}
+
+void InvalidateCharacterFileIndex() {
+    if (fileIndex.voiceStems != nullptr) EGG::Heap::free(fileIndex.voiceStems, fileIndex.voiceStemsHeap);
+    memset(&fileIndex, 0, sizeof(fileIndex));
+}
+
+static bool ProbeUnindexedDriverFile(const char *path) {
+    if (!IsNewChannel()) {
+        // On disc the FST pass already saw every real file; only a whole-file override can still supply one.
+        char resolvedPath[IOOverrides::OVERRIDE_MAX_PATH];
+        bool redirected = false;
+        IOOverrides::ResolveWholeFileOverride(path, resolvedPath, sizeof(resolvedPath), &redirected);
+        if (!redirected) return false;
+    }
+    u32 fileSize = 0;
+    return DiscFileSize(path, fileSize);
+}
+
+bool LooseDriverSkinExists(CharacterId character, u8 table) {
+    if (!IsCharacter(character) || table == TABLE_DEFAULT || table > CUSTOM_TABLE_LIMIT) return false;
+    const char *postfix = GeneratedCustomPostfix(character, table);
+    if (postfix == nullptr) return false;
+    EnsureCharacterFileIndex();
+    const CharacterId stateCharacter = StateCharacter(character);
+    const u64 bit = TableBit(table);
+    if ((fileIndex.skinFound[stateCharacter] & bit) != 0) return true;
+    if ((fileIndex.skinChecked[stateCharacter] & bit) != 0) return false;
+
+    fileIndex.skinChecked[stateCharacter] |= bit;
+    char path[0x60];
+    const int written = snprintf(path, sizeof(path), "/Scene/Model/Driver/%s.brres", postfix);
+    if (written <= 0 || static_cast<u32>(written) >= sizeof(path) || !ProbeUnindexedDriverFile(path)) return false;
+    fileIndex.skinFound[stateCharacter] |= bit;
+    return true;
+}
+
+bool LooseMiiCDriverExists(CharacterId character) {
+    const u8 idx = MiiCIndex(character);
+    if (idx >= MII_C_COUNT) return false;
+    EnsureCharacterFileIndex();
+    const u8 bit = static_cast<u8>(1 << idx);
+    if ((fileIndex.miiCFound & bit) != 0) return true;
+    if ((fileIndex.miiCChecked & bit) != 0) return false;
+
+    fileIndex.miiCChecked |= bit;
+    char path[0x60];
+    if (!BuildDriverPath(character, TABLE_DEFAULT, path, sizeof(path)) || !ProbeUnindexedDriverFile(path)) return false;
+    fileIndex.miiCFound |= bit;
+    return true;
+}
+
+bool SilentVoiceMarkerExists(CharacterId character, u8 table) {
+    if (!IsCharacter(character) || table == TABLE_DEFAULT || table > CUSTOM_TABLE_LIMIT) return false;
+    if (GeneratedCustomPostfix(character, table) == nullptr) return false;
+    EnsureCharacterFileIndex();
+    const CharacterId stateCharacter = StateCharacter(character);
+    return (fileIndex.silentFound[stateCharacter] & TableBit(table)) != 0;
+}
+
+bool LooseVoiceStemExists(CharacterId character, u8 table, u32 suffixIndex, u32 stem) {
+    if (!IsCharacter(character) || table == TABLE_DEFAULT || table > CUSTOM_TABLE_LIMIT) return false;
+    if (suffixIndex >= LOOSE_VOICE_SUFFIX_COUNT || stem >= LOOSE_VOICE_STEM_COUNT) return false;
+    if (GeneratedCustomPostfix(character, table) == nullptr) return false;
+    EnsureCharacterFileIndex();
+    const u16 slot = fileIndex.voiceSlots[StateCharacter(character)][table];
+    if (slot == 0 || fileIndex.voiceStems == nullptr) return false;
+    return (fileIndex.voiceStems[slot - 1][suffixIndex] & (static_cast<u64>(1) << stem)) != 0;
+}
+
+}  // namespace CustomCharacters
+}  // namespace Pulsar
@@ -1,5 +1,4 @@
 #include <CustomCharacters/CustomCharacters.hpp>
-#include <core/rvl/OS/OSBootInfo.hpp>
 
 namespace Pulsar {
 namespace CustomCharacters {
@@ -58,61 +57,6 @@ static s32 PickRandomSoundSafe(Audio::RandomSoundPicker *picker) {
 }
 kmBranch(0x80867194, PickRandomSoundSafe);
 
-struct DiscFSTEntry {
-    u32 typeName;
-    u32 offset;
-    u32 size;
-};
-
-static bool FSTEntryIsDir(const DiscFSTEntry &entry) {
-    return (entry.typeName & 0xff000000) != 0;
-}
-
-static u32 FSTNameOffset(const DiscFSTEntry &entry) {
-    return entry.typeName & 0x00ffffff;
-}
-
-static char ToUpperAscii(char c) {
-    if (c >= 'a' && c <= 'z') return static_cast<char>(c - 'a' + 'A');
-    return c;
-}
-
-// Loose voice files use upper-case character postfixes in GRP_VO filenames.
-void CopyUpperPostfix(char *dest, u32 destSize, const char *postfix) {
-    if (dest == nullptr || destSize == 0) return;
-    u32 i = 0;
-    if (postfix != nullptr) {
-        for (; i + 1 < destSize && postfix[i] != '\0'; ++i) {
-            dest[i] = ToUpperAscii(postfix[i]);
-        }
-    }
-    dest[i] = '\0';
-}
-
-bool BuildLooseVoicePath(const char *postfix, const char *suffix, const char *extension, const char *voiceName, char *path,
-                         u32 pathSize) {
-    char upperPostfix[32];
-    CopyUpperPostfix(upperPostfix, sizeof(upperPostfix), postfix);
-    if (upperPostfix[0] == '\0' || suffix == nullptr || extension == nullptr) return false;
-    const int written = voiceName == nullptr ? snprintf(path, pathSize, "/sound/GRP_VO_%s_%s.%s", upperPostfix, suffix, extension)
-                                             : snprintf(path, pathSize, "/sound/GRP_VO_%s_%s.%s.%s", upperPostfix, suffix,
-                                                        extension, voiceName);
-    return written > 0 && static_cast<u32>(written) < pathSize;
-}
-
-bool LooseVoiceFileExists(const char *postfix, const char *suffix, const char *extension, const char *voiceName) {
-    char path[0x80];
-    if (!BuildLooseVoicePath(postfix, suffix, extension, voiceName, path, sizeof(path))) return false;
-    const s32 entryNum = DVD::ConvertPathToEntryNum(path);
-    if (entryNum < 0) return false;
-
-    DVD::FileInfo info;
-    if (!DVD::FastOpen(entryNum, &info)) return false;
-    const bool exists = info.length != 0;
-    DVD::Close(&info);
-    return exists;
-}
-
 const char *const looseVoiceGroupSuffixes[] = {
     "PC",
     "NPC",
@@ -148,7 +92,15 @@ const char *LooseVoiceSuffixForGroupOffset(u32 offset) {
 
 const u32 SILENT_VOICE_GROUP = 0xffffffff;
 
-bool LooseVoiceStemExistsForCharacter(const char *postfix, const char *suffix, CharacterId character);
+static_assert(ARRAY_COUNT(looseVoiceGroupSuffixes) == LOOSE_VOICE_SUFFIX_COUNT, "Loose voice suffix masks are out of sync");
+
+u32 LooseVoiceSuffixIndex(const char *suffix) {
+    if (suffix == nullptr) return LOOSE_VOICE_SUFFIX_COUNT;
+    for (u32 i = 0; i < ARRAY_COUNT(looseVoiceGroupSuffixes); ++i) {
+        if (strcmp(suffix, looseVoiceGroupSuffixes[i]) == 0) return i;
+    }
+    return LOOSE_VOICE_SUFFIX_COUNT;
+}
 
 const VoiceGroupBase voiceGroupBases[] = {
     {MARIO, BRSAR_GROUP_MARIO},
@@ -216,17 +168,13 @@ const char *VoicePostfixNameForCharacter(CharacterId character) {
     return postfix != nullptr ? postfix : VoiceNameForCharacter(character);
 }
 
-bool LooseVoiceStemExists(const char *postfix, const char *suffix, const char *voiceName) {
-    return LooseVoiceFileExists(postfix, suffix, "brwsd", voiceName) || LooseVoiceFileExists(postfix, suffix, "brbnk", voiceName);
-}
+static_assert(ARRAY_COUNT(voiceCharacterNames) == LOOSE_VOICE_CHARACTER_COUNT, "Loose voice name stems are out of sync");
 
-// A .silent marker suppresses voice groups only when no loose voices exist.
-bool SilentVoiceMarkerExists(CharacterId character, u8 table, const char *postfix) {
-    if (table == TABLE_DEFAULT || table >= TABLE_COUNT || !IsCharacter(character)) return false;
-    if (postfix == nullptr) return false;
-    char path[0x60];
-    const int written = snprintf(path, sizeof(path), "/sound/%s.silent", postfix);
-    return written > 0 && static_cast<u32>(written) < sizeof(path) && DVD::ConvertPathToEntryNum(path) >= 0;
+u32 VoiceCharacterIndex(CharacterId character) {
+    for (u32 i = 0; i < ARRAY_COUNT(voiceCharacterNames); ++i) {
+        if (voiceCharacterNames[i].character == character) return i;
+    }
+    return LOOSE_VOICE_CHARACTER_COUNT;
 }
 
 static void ApplyLooseVoiceMasks(LooseVoiceInfo &info, u32 directMask, const u32 *characterMasks) {
@@ -248,48 +196,44 @@ static void ApplyLooseVoiceMasks(LooseVoiceInfo &info, u32 directMask, const u32
     }
 }
 
-static void ScanLooseVoiceInfoFromPaths(const char *postfix, LooseVoiceInfo &info) {
-    if (postfix == nullptr) return;
+// Stems named after a vanilla voice use either its voice name or its character postfix.
+bool LooseVoiceStemExistsForCharacter(CharacterId character, u8 table, u32 suffixIndex, CharacterId voiceCharacter) {
+    const u32 voiceIndex = VoiceCharacterIndex(voiceCharacter);
+    if (voiceIndex >= LOOSE_VOICE_CHARACTER_COUNT) return LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_DIRECT);
+    return LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_VOICE_NAME + voiceIndex) ||
+           LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_POSTFIX_NAME + voiceIndex);
+}
 
+static void ScanLooseVoiceInfo(CharacterId character, u8 table, LooseVoiceInfo &info) {
     u32 directMask = 0;
     u32 characterMasks[ARRAY_COUNT(voiceCharacterNames)];
     for (u32 i = 0; i < ARRAY_COUNT(characterMasks); ++i) characterMasks[i] = 0;
 
     for (u32 suffixIndex = 0; suffixIndex < ARRAY_COUNT(looseVoiceGroupSuffixes); ++suffixIndex) {
-        const char *suffix = looseVoiceGroupSuffixes[suffixIndex];
         const u32 suffixBit = 1 << suffixIndex;
         for (u32 characterIndex = 0; characterIndex < ARRAY_COUNT(voiceCharacterNames); ++characterIndex) {
-            const CharacterId character = voiceCharacterNames[characterIndex].character;
-            if (LooseVoiceStemExistsForCharacter(postfix, suffix, character)) {
+            const CharacterId voiceCharacter = voiceCharacterNames[characterIndex].character;
+            if (LooseVoiceStemExistsForCharacter(character, table, suffixIndex, voiceCharacter)) {
                 characterMasks[characterIndex] |= suffixBit;
             }
         }
 
-        if (LooseVoiceStemExists(postfix, suffix)) directMask |= suffixBit;
+        if (LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_DIRECT)) directMask |= suffixBit;
     }
 
     ApplyLooseVoiceMasks(info, directMask, characterMasks);
 }
 
-bool LooseVoiceStemExistsForCharacter(const char *postfix, const char *suffix, CharacterId character) {
-    const char *voiceName = VoiceNameForCharacter(character);
-    if (LooseVoiceStemExists(postfix, suffix, voiceName)) return true;
-
-    const char *postfixName = VoicePostfixNameForCharacter(character);
-    if (postfixName == nullptr || (voiceName != nullptr && strcmp(postfixName, voiceName) == 0)) return false;
-    return LooseVoiceStemExists(postfix, suffix, postfixName);
-}
-
-const char *ExistingLooseVoiceNameForCharacter(const char *postfix, const char *suffix, CharacterId character) {
-    const char *voiceName = VoiceNameForCharacter(character);
-    if (LooseVoiceStemExists(postfix, suffix, voiceName)) return voiceName;
-
-    const char *postfixName = VoicePostfixNameForCharacter(character);
-    if (postfixName != nullptr && (voiceName == nullptr || strcmp(postfixName, voiceName) != 0) &&
-        LooseVoiceStemExists(postfix, suffix, postfixName)) {
-        return postfixName;
+const char *ExistingLooseVoiceNameForCharacter(CharacterId character, u8 table, u32 suffixIndex, CharacterId voiceCharacter) {
+    const char *voiceName = VoiceNameForCharacter(voiceCharacter);
+    const u32 voiceIndex = VoiceCharacterIndex(voiceCharacter);
+    if (voiceIndex < LOOSE_VOICE_CHARACTER_COUNT) {
+        if (LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_VOICE_NAME + voiceIndex)) return voiceName;
+        if (LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_POSTFIX_NAME + voiceIndex)) {
+            return VoicePostfixNameForCharacter(voiceCharacter);
+        }
     }
-    if (LooseVoiceStemExists(postfix, suffix)) return nullptr;
+    if (LooseVoiceStemExists(character, table, suffixIndex, LOOSE_VOICE_STEM_DIRECT)) return nullptr;
     return voiceName;
 }
 
@@ -306,11 +250,10 @@ const LooseVoiceInfo &GetLooseVoiceInfo(CharacterId character, u8 table) {
     info.voiceCharacter = CHARACTER_NONE;
     info.suffixMask = 0;
 
-    const char *postfix = GeneratedCustomPostfix(character, table);
-    if (postfix == nullptr) return info;
-    const bool silent = SilentVoiceMarkerExists(character, table, postfix);
+    if (GeneratedCustomPostfix(character, table) == nullptr) return info;
+    const bool silent = SilentVoiceMarkerExists(character, table);
 
-    ScanLooseVoiceInfoFromPaths(postfix, info);
+    ScanLooseVoiceInfo(character, table, info);
     if (!info.hasFiles && silent) info.silent = true;
     return info;
 }
@@ -566,7 +509,7 @@ const char *GetLooseVoicePostfixForGroup(u32 groupId, const char *&groupSuffix,
         if (!LooseVoiceInfoHasSuffix(GetLooseVoiceInfo(character, table), groupSuffix)) continue;
         const char *postfix = GeneratedCustomPostfix(character, table);
         if (postfix != nullptr) {
-            voiceName = ExistingLooseVoiceNameForCharacter(postfix, groupSuffix, groupCharacter);
+            voiceName = ExistingLooseVoiceNameForCharacter(character, table, LooseVoiceSuffixIndex(groupSuffix), groupCharacter);
             return postfix;
         }
     }
@@ -9,7 +9,6 @@ u8 offlineCpuCharacterTables[ONLINE_PLAYER_COUNT];
 const char *defaultNames[CHARACTER_COUNT];
 bool cachedDefaultNames;
 char customPostfixes[CHARACTER_COUNT][TABLE_COUNT][16];
-u8 customSkinExists[CHARACTER_COUNT][TABLE_COUNT];
 CharacterId hoveredCharacters[LOCAL_PLAYER_COUNT] = {MARIO, MARIO, MARIO, MARIO};
 RawBRRES rawBRRES[TABLE_COUNT][CHARACTER_COUNT];
 RawBRRES looseMiiCBRRES[MII_C_COUNT];
@@ -113,25 +112,6 @@ const char *GeneratedCustomPostfix(CharacterId character, u8 table) {
     return postfix;
 }
 
-// Driver BRRES existence is cached because menu hooks query it repeatedly.
-bool CustomDriverFileExists(CharacterId character, u8 table) {
-    if (!IsCharacter(character) || table == TABLE_DEFAULT || table > CUSTOM_TABLE_LIMIT) return false;
-    u8 &cached = customSkinExists[character][table];
-    if (cached != 0) return cached == 2;
-    const char *postfix = GeneratedCustomPostfix(character, table);
-    bool exists = false;
-    if (postfix != nullptr) {
-        char path[0x60];
-        const int written = snprintf(path, sizeof(path), "/Scene/Model/Driver/%s.brres", postfix);
-        if (written > 0 && static_cast<u32>(written) < sizeof(path)) {
-            u32 fileSize = 0;
-            exists = DiscFileSize(path, fileSize);
-        }
-    }
-    cached = exists ? 2 : 1;
-    return exists;
-}
-
 // Peach/Daisy/Rosalina menu BRRES files use biker ids for their standing models.
 CharacterId MenuBRRESCharacter(CharacterId character) {
     switch (character) {
@@ -147,7 +127,7 @@ CharacterId MenuBRRESCharacter(CharacterId character) {
 }
 
 bool HasSkin(CharacterId character, u8 table) {
-    return table == TABLE_DEFAULT || CustomDriverFileExists(character, table);
+    return table == TABLE_DEFAULT || LooseDriverSkinExists(character, table);
 }
 
 u8 NormalizeTable(CharacterId character, u8 table) {
@@ -358,7 +338,7 @@ void CompactOfflineCpuSkinTable(u8 targetPlayerId, u8 sourcePlayerId) {
 }
 
 void ClearCustomCharacterFileCaches() {
-    memset(customSkinExists, 0, sizeof(customSkinExists));
+    InvalidateCharacterFileIndex();
     memset(looseVoiceInfo, 0, sizeof(looseVoiceInfo));
 }
 
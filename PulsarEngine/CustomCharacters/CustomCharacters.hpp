@@ -54,7 +54,16 @@ enum {
     MENU_DRIVER_MODEL_COUNT = 0x18,
     LOCAL_PLAYER_COUNT = 4,
     ONLINE_PLAYER_COUNT = 12,
-    MII_C_COUNT = 6
+    MII_C_COUNT = 6,
+
+    LOOSE_VOICE_SUFFIX_COUNT = 13,
+    LOOSE_VOICE_CHARACTER_COUNT = 24,
+    // Loose voice stem variants: GRP_VO_<POSTFIX>_<SUFFIX>.<ext>, then .<ext>.<voice name> and .<ext>.<postfix name>
+    // for each voiceCharacterNames entry.
+    LOOSE_VOICE_STEM_DIRECT = 0,
+    LOOSE_VOICE_STEM_VOICE_NAME = 1,
+    LOOSE_VOICE_STEM_POSTFIX_NAME = LOOSE_VOICE_STEM_VOICE_NAME + LOOSE_VOICE_CHARACTER_COUNT,
+    LOOSE_VOICE_STEM_COUNT = LOOSE_VOICE_STEM_POSTFIX_NAME + LOOSE_VOICE_CHARACTER_COUNT
 };
 
 extern "C" const char *characterNames[];
@@ -112,7 +121,6 @@ extern u8 offlineCpuCharacterTables[ONLINE_PLAYER_COUNT];
 extern const char *defaultNames[CHARACTER_COUNT];
 extern bool cachedDefaultNames;
 extern char customPostfixes[CHARACTER_COUNT][TABLE_COUNT][16];
-extern u8 customSkinExists[CHARACTER_COUNT][TABLE_COUNT];
 extern CharacterId hoveredCharacters[LOCAL_PLAYER_COUNT];
 extern RawBRRES rawBRRES[TABLE_COUNT][CHARACTER_COUNT];
 extern RawBRRES looseMiiCBRRES[MII_C_COUNT];
@@ -202,6 +210,7 @@ u8 ResolveMenuTable(CharacterId character);
 u32 AlignUp(u32 value, u32 alignment);
 bool BuildDriverPath(CharacterId character, u8 table, char *path, u32 pathSize);
 bool DiscFileSize(const char *path, u32 &size);
+u8 MiiCIndex(CharacterId character);
 void *LoadFileToMainRAM(const char *path, EGG::Heap *heap, EGG::DvdRipper::EAllocDirection allocDirection, u32 *outSize);
 
 // Loose voices and menu model reloads.
@@ -216,7 +225,14 @@ SectionId CurrentSectionId();
 bool IsVotingSection(SectionId section);
 bool IsCharacterSelectActive();
 bool CycleSkin(CharacterId character, int step);
-bool LooseVoiceStemExists(const char *postfix, const char *suffix, const char *voiceName = nullptr);
+const char *VoicePostfixNameForCharacter(CharacterId character);
+
+// Loose character file index, built from one FST pass on first use.
+void InvalidateCharacterFileIndex();
+bool LooseDriverSkinExists(CharacterId character, u8 table);
+bool LooseMiiCDriverExists(CharacterId character);
+bool SilentVoiceMarkerExists(CharacterId character, u8 table);
+bool LooseVoiceStemExists(CharacterId character, u8 table, u32 suffixIndex, u32 stem);
 bool FindLooseSoundEffectPath(u32 fileId, const char *extension, char *path, u32 pathSize, u32 *outFileSize = nullptr);
 
 }  // namespace CustomCharacters
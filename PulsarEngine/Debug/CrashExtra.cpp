@@ -2,6 +2,7 @@
 #include <include/c_string.h>
 
 #include <Debug/CrashExtra.hpp>
+#include <Debug/FrameRecorder.hpp>
 #include <PulsarSystem.hpp>
 #include <IO/LooseArchiveOverrides.hpp>
 #include <SlotExpansion/CupsConfig.hpp>
@@ -145,6 +146,21 @@ void PopulateLastTrackSzs(CrashExtra &extra) {
     CopyTrackSzs(extra.lastTrackSzs, sizeof(extra.lastTrackSzs), fallback);
 }
 
+void PopulateFrameTimes(CrashExtra &extra) {
+    FrameTimeSummary summary;
+    GetFrameTimeSummary(summary);
+    extra.frameCount = summary.frameCount;
+    for (int i = 0; i < FRAME_PERCENTILE_COUNT; ++i) {
+        extra.frameCpuUs[i] = summary.cpuUs[i];
+        extra.frameWaitUs[i] = summary.waitUs[i];
+        extra.frameTotalUs[i] = summary.totalUs[i];
+    }
+    extra.frameMaxTotalUs = summary.maxTotalUs;
+    extra.lagCorrections = summary.lagCorrections;
+    extra.lagFramesCorrected = summary.lagFramesCorrected;
+    CopyRecentFrameTimes(extra.recentFrameCpuUs, extra.recentFrameTotalUs, EXCEPTION_RECENT_FRAME_COUNT);
+}
+
 }  // namespace
 
 void PopulateCrashExtra(ExceptionFile &exception) {
@@ -179,6 +195,7 @@ void PopulateCrashExtra(ExceptionFile &exception) {
         extra.myStuffState = EXCEPTION_MYSTUFF_DISABLED;
 
     PopulateLastTrackSzs(extra);
+    PopulateFrameTimes(extra);
 }
 
 }  // namespace Debug
@@ -36,18 +36,21 @@ struct StackFrame {
 };
 
 enum {
-    EXCEPTION_FILE_VERSION = 3,
+    EXCEPTION_FILE_VERSION = 4,
     EXCEPTION_FLAG_LOOSE_ARCHIVE_OVERRIDES_ENABLED = 1 << 0,
     EXCEPTION_FLAG_CUSTOM_CHARACTER_ENABLED = 1 << 1,
     EXCEPTION_MAX_TRACK_SZS_LENGTH = 64,
     EXCEPTION_MYSTUFF_DISABLED = 0,
     EXCEPTION_MYSTUFF_ENABLED = 1,
-    EXCEPTION_MYSTUFF_MUSIC_ONLY = 2
+    EXCEPTION_MYSTUFF_MUSIC_ONLY = 2,
+    EXCEPTION_RECENT_FRAME_COUNT = 32
 };
 
 struct CrashExtra {
-    CrashExtra() : version(EXCEPTION_FILE_VERSION), sectionId(-1), pageId(-1), context(0), context2(0), flags(0), looseOverrideFileCount(0), myStuffState(EXCEPTION_MYSTUFF_DISABLED) {
+    CrashExtra() : version(EXCEPTION_FILE_VERSION), sectionId(-1), pageId(-1), context(0), context2(0), flags(0), looseOverrideFileCount(0), myStuffState(EXCEPTION_MYSTUFF_DISABLED), frameCount(0), frameMaxTotalUs(0), lagCorrections(0), lagFramesCorrected(0) {
         lastTrackSzs[0] = '\0';
+        for (int i = 0; i < 3; ++i) frameCpuUs[i] = frameWaitUs[i] = frameTotalUs[i] = 0;
+        for (int i = 0; i < EXCEPTION_RECENT_FRAME_COUNT; ++i) recentFrameCpuUs[i] = recentFrameTotalUs[i] = 0;
     }
 
     u32 version;
@@ -59,6 +62,16 @@ struct CrashExtra {
     u32 looseOverrideFileCount;
     u32 myStuffState;
     char lastTrackSzs[EXCEPTION_MAX_TRACK_SZS_LENGTH];
+    // v4, frame recorder state of the current or last race, all times in microseconds
+    u32 frameCount;
+    u32 frameCpuUs[3];  // p50, p95, p99
+    u32 frameWaitUs[3];
+    u32 frameTotalUs[3];
+    u32 frameMaxTotalUs;
+    u32 lagCorrections;
+    u32 lagFramesCorrected;
+    u16 recentFrameCpuUs[EXCEPTION_RECENT_FRAME_COUNT];  // oldest first
+    u16 recentFrameTotalUs[EXCEPTION_RECENT_FRAME_COUNT];
 };
 
 struct ExceptionFile {
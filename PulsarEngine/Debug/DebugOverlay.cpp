@@ -0,0 +1,109 @@
+#include <MarioKartWii/UI/Ctrl/CtrlRace/CtrlRaceBase.hpp>
+#include <MarioKartWii/UI/Layout/ControlLoader.hpp>
+#include <MarioKartWii/UI/Text/Text.hpp>
+#include <MarioKartWii/Race/RaceInfo/RaceInfo.hpp>
+#include <UI/CtrlRaceBase/CustomCtrlRaceBase.hpp>
+#include <UI/UI.hpp>
+#include <Debug/DebugOverlay.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <include/c_wchar.h>
+
+namespace Pulsar {
+namespace Debug {
+
+DebugOverlaySection *DebugOverlaySection::sSections = nullptr;
+
+u32 DebugOverlaySection::Format(wchar_t *dest, u32 capacity, DebugOverlayScope scope) {
+    if (capacity == 0) return 0;
+    dest[0] = L'\0';
+    u32 length = 0;
+    for (const DebugOverlaySection *section = sSections; section != nullptr; section = section->next) {
+        if ((section->scopes & scope) == 0 || capacity - length <= 1) continue;
+        const u32 written = section->writer(dest + length, capacity - length);
+        length += written < capacity - length ? written : capacity - length - 1;
+        dest[length] = L'\0';
+    }
+    return length;
+}
+
+#ifdef DEBUG_OVERLAY
+static const u16 kDebugOverlayRefreshFrames = 30;
+static const u32 kDebugOverlayLength = 512;
+
+// Race HUD side, refreshed twice a second
+class CtrlRaceDebugOverlay : public CtrlRaceBase {
+public:
+    static u32 Count() { return 1; }
+    static void Create(Page &page, u32 index, u32 count);
+    void Load();
+    void OnUpdate() override;
+
+private:
+    void UpdateMessage();
+
+    u16 framesUntilRefresh;
+};
+
+static UI::CustomCtrlBuilder sDebugOverlayBuilder(CtrlRaceDebugOverlay::Count, CtrlRaceDebugOverlay::Create);
+
+void CtrlRaceDebugOverlay::Create(Page &page, u32 index, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        CtrlRaceDebugOverlay *control = new (CtrlRaceDebugOverlay);
+        page.AddControl(index + i, *control, 0);
+        control->Load();
+    }
+}
+
+void CtrlRaceDebugOverlay::Load() {
+    this->hudSlotId = 0;
+    ControlLoader loader(this);
+    loader.Load(UI::raceFolder, "CTInfo", "CTInfo", nullptr);
+    this->framesUntilRefresh = 0;
+}
+
+void CtrlRaceDebugOverlay::OnUpdate() {
+    this->UpdatePausePosition();
+    if (this->framesUntilRefresh > 0) {
+        --this->framesUntilRefresh;
+        return;
+    }
+    this->framesUntilRefresh = kDebugOverlayRefreshFrames;
+    this->UpdateMessage();
+}
+
+void CtrlRaceDebugOverlay::UpdateMessage() {
+    wchar_t message[kDebugOverlayLength];
+    DebugOverlaySection::Format(message, kDebugOverlayLength, DEBUG_OVERLAY_RACE);
+    Text::Info info;
+    info.strings[0] = message;
+    this->SetMessage(UI::BMG_TEXT, &info);
+}
+
+// Menu side: menu sections are only logged when their text changed since the last check
+static wchar_t sLastMenuMessage[kDebugOverlayLength];
+static u16 sMenuFramesUntilRefresh = 0;
+
+static void ReportMenuDebugOverlay() {
+    if (Raceinfo::sInstance != nullptr) return;
+    if (sMenuFramesUntilRefresh > 0) {
+        --sMenuFramesUntilRefresh;
+        return;
+    }
+    sMenuFramesUntilRefresh = kDebugOverlayRefreshFrames;
+
+    wchar_t message[kDebugOverlayLength];
+    if (DebugOverlaySection::Format(message, kDebugOverlayLength, DEBUG_OVERLAY_MENU) == 0) return;
+    if (wcscmp(message, sLastMenuMessage) == 0) return;
+    wcscpy(sLastMenuMessage, message);
+
+    char report[kDebugOverlayLength];
+    const int length = wcstombs(report, message, sizeof(report) - 1);
+    if (length <= 0) return;
+    report[length] = '\0';
+    OS::Report("[Pulsar] %s", report);
+}
+static FrameLoadHook sMenuDebugOverlayHook(ReportMenuDebugOverlay);
+#endif
+
+}  // namespace Debug
+}  // namespace Pulsar
@@ -0,0 +1,42 @@
+#ifndef _PUL_DEBUG_OVERLAY_
+#define _PUL_DEBUG_OVERLAY_
+
+#include <kamek.hpp>
+
+// One debug text overlay for every FRAME_TIME_DEBUG, NET_TELEMETRY_DEBUG and HTTP_CACHE_DEBUG section.
+// In races the sections share a single CTInfo control on the HUD; in menus the ones that ask for it are written to
+// OSReport whenever their text changes, so they reach the log without a layout on every page.
+#if defined(FRAME_TIME_DEBUG) || defined(NET_TELEMETRY_DEBUG) || defined(HTTP_CACHE_DEBUG)
+#define DEBUG_OVERLAY
+#endif
+
+namespace Pulsar {
+namespace Debug {
+
+enum DebugOverlayScope {
+    DEBUG_OVERLAY_RACE = 1 << 0,
+    DEBUG_OVERLAY_MENU = 1 << 1
+};
+
+// Appends the section's lines to dest and returns how many characters were written, without the terminator
+typedef u32 (*DebugOverlayWriter)(wchar_t *dest, u32 capacity);
+
+class DebugOverlaySection {
+public:
+    DebugOverlaySection(DebugOverlayWriter writer, u32 scopes) : writer(writer), scopes(scopes), next(sSections) {
+        sSections = this;
+    }
+    // Concatenates every section registered for scope; returns the length written
+    static u32 Format(wchar_t *dest, u32 capacity, DebugOverlayScope scope);
+
+private:
+    DebugOverlayWriter writer;
+    u32 scopes;
+    DebugOverlaySection *next;
+    static DebugOverlaySection *sSections;
+};
+
+}  // namespace Debug
+}  // namespace Pulsar
+
+#endif
@@ -0,0 +1,191 @@
+#include <kamek.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <MarioKartWii/Scene/RaceScene.hpp>
+#include <Debug/FrameRecorder.hpp>
+#include <Debug/Histogram.hpp>
+#include <include/c_string.h>
+#ifdef FRAME_TIME_DEBUG
+#include <include/c_stdio.h>
+#include <PulsarSystem.hpp>
+#include <IO/IO.hpp>
+#include <SlotExpansion/CupsConfig.hpp>
+#endif
+
+namespace Pulsar {
+namespace Debug {
+
+const u32 FRAME_RECORDER_RING_SIZE = 256;  // power of two, the write position is free running
+const u32 FRAME_BUCKET_US = 250;
+const u32 FRAME_BUCKET_COUNT = 160;  // 40ms of range, anything slower lands in the last bucket
+const u32 FRAME_MAX_GAP_US = 1000000;  // a longer gap means the scene was not running, not a slow frame
+
+enum FrameSeries {
+    FRAME_SERIES_CPU,
+    FRAME_SERIES_WAIT,
+    FRAME_SERIES_TOTAL,
+    FRAME_SERIES_COUNT
+};
+
+struct FrameSample {
+    u32 cpuTicks;
+    u32 totalTicks;
+    u16 lagFrames;
+    u16 padding;
+};
+
+struct FrameRecorder {
+    FrameSample ring[FRAME_RECORDER_RING_SIZE];
+    u32 histograms[FRAME_SERIES_COUNT][FRAME_BUCKET_COUNT];
+    u32 maxUs[FRAME_SERIES_COUNT];
+    u32 writePos;
+    u32 frameCount;
+    u32 lagCorrections;
+    u32 lagFramesCorrected;
+    u32 pendingLagFrames;  // corrections land between two calcs, they are attributed to the next frame
+    u32 lastCalcStart;
+    u32 lastCalcTicks;
+    bool hasLastCalc;
+    bool finished;
+};
+
+static FrameRecorder sRecorder;
+
+static void AddToHistogram(FrameSeries series, u32 us) {
+    ++sRecorder.histograms[series][GetHistogramBucket(us, FRAME_BUCKET_US, FRAME_BUCKET_COUNT)];
+    if (us > sRecorder.maxUs[series]) sRecorder.maxUs[series] = us;
+}
+
+static void RecordFrame(u32 calcStart, u32 cpuTicks) {
+    FrameRecorder &rec = sRecorder;
+    const bool hadLastCalc = rec.hasLastCalc;
+    const u32 totalTicks = calcStart - rec.lastCalcStart;
+    const u32 lastCpuTicks = rec.lastCalcTicks;
+    rec.lastCalcStart = calcStart;
+    rec.lastCalcTicks = cpuTicks;
+    rec.hasLastCalc = true;
+    if (!hadLastCalc) return;
+
+    // The sample closes the previous frame: its calc time plus whatever ran until this calc started
+    const u32 totalUs = OS::TicksToMicroseconds(totalTicks);
+    if (totalUs > FRAME_MAX_GAP_US) return;
+
+    FrameSample &sample = rec.ring[rec.writePos & (FRAME_RECORDER_RING_SIZE - 1)];
+    sample.cpuTicks = lastCpuTicks;
+    sample.totalTicks = totalTicks;
+    sample.lagFrames = rec.pendingLagFrames > 0xFFFF ? 0xFFFF : static_cast<u16>(rec.pendingLagFrames);
+    sample.padding = 0;
+    rec.pendingLagFrames = 0;
+    ++rec.writePos;
+    ++rec.frameCount;
+
+    const u32 cpuUs = OS::TicksToMicroseconds(lastCpuTicks);
+    AddToHistogram(FRAME_SERIES_CPU, cpuUs);
+    AddToHistogram(FRAME_SERIES_WAIT, totalUs > cpuUs ? totalUs - cpuUs : 0);
+    AddToHistogram(FRAME_SERIES_TOTAL, totalUs);
+}
+
+static u32 GetPercentileUs(FrameSeries series, u32 percentile) {
+    const FrameRecorder &rec = sRecorder;
+    return GetHistogramPercentile(rec.histograms[series], FRAME_BUCKET_COUNT, FRAME_BUCKET_US, rec.frameCount,
+                                  rec.maxUs[series], percentile);
+}
+
+void RecordLagCorrection(u32 frames) {
+    ++sRecorder.lagCorrections;
+    sRecorder.lagFramesCorrected += frames;
+    sRecorder.pendingLagFrames += frames;
+}
+
+void GetFrameTimeSummary(FrameTimeSummary &summary) {
+    static const u32 percentiles[FRAME_PERCENTILE_COUNT] = {50, 95, 99};
+    const FrameRecorder &rec = sRecorder;
+    summary.frameCount = rec.frameCount;
+    for (int i = 0; i < FRAME_PERCENTILE_COUNT; ++i) {
+        summary.cpuUs[i] = GetPercentileUs(FRAME_SERIES_CPU, percentiles[i]);
+        summary.waitUs[i] = GetPercentileUs(FRAME_SERIES_WAIT, percentiles[i]);
+        summary.totalUs[i] = GetPercentileUs(FRAME_SERIES_TOTAL, percentiles[i]);
+    }
+    summary.maxTotalUs = rec.maxUs[FRAME_SERIES_TOTAL];
+    summary.lagCorrections = rec.lagCorrections;
+    summary.lagFramesCorrected = rec.lagFramesCorrected;
+}
+
+static u16 ClampUs(u32 ticks) {
+    const u32 us = OS::TicksToMicroseconds(ticks);
+    return us > 0xFFFF ? 0xFFFF : static_cast<u16>(us);
+}
+
+u32 CopyRecentFrameTimes(u16 *cpuUs, u16 *totalUs, u32 count) {
+    const FrameRecorder &rec = sRecorder;
+    u32 available = rec.writePos < FRAME_RECORDER_RING_SIZE ? rec.writePos : FRAME_RECORDER_RING_SIZE;
+    if (count > available) count = available;
+    const u32 first = rec.writePos - count;
+    for (u32 i = 0; i < count; ++i) {
+        const FrameSample &sample = rec.ring[(first + i) & (FRAME_RECORDER_RING_SIZE - 1)];
+        if (cpuUs != nullptr) cpuUs[i] = ClampUs(sample.cpuTicks);
+        if (totalUs != nullptr) totalUs[i] = ClampUs(sample.totalTicks);
+    }
+    return count;
+}
+
+#ifdef FRAME_TIME_DEBUG
+static void AppendFrameTimesFile(const FrameTimeSummary &summary) {
+    IO *io = IO::sInstance;
+    const System *system = System::sInstance;
+    if (io == nullptr || system == nullptr) return;
+
+    s32 trackId = -1;
+    if (CupsConfig::sInstance != nullptr) trackId = static_cast<s32>(CupsConfig::sInstance->GetWinning());
+
+    alignas(0x20) char line[0x100];
+    const int length = snprintf(line, sizeof(line),
+                                "track %d frames %u cpu %u/%u/%u wait %u/%u/%u total %u/%u/%u max %u lag %u (%u frames)\n",
+                                trackId, summary.frameCount,
+                                summary.cpuUs[FRAME_PERCENTILE_50], summary.cpuUs[FRAME_PERCENTILE_95], summary.cpuUs[FRAME_PERCENTILE_99],
+                                summary.waitUs[FRAME_PERCENTILE_50], summary.waitUs[FRAME_PERCENTILE_95], summary.waitUs[FRAME_PERCENTILE_99],
+                                summary.totalUs[FRAME_PERCENTILE_50], summary.totalUs[FRAME_PERCENTILE_95], summary.totalUs[FRAME_PERCENTILE_99],
+                                summary.maxTotalUs, summary.lagCorrections, summary.lagFramesCorrected);
+    if (length <= 0) return;
+    OS::Report("[FrameTimes] %s", line);
+
+    char path[IOS::ipcMaxPath];
+    snprintf(path, IOS::ipcMaxPath, "%s/FrameTimes.txt", system->GetModFolder());
+    if (!io->OpenFile(path, FILE_MODE_WRITE) && !io->CreateAndOpen(path, FILE_MODE_WRITE)) return;
+    const s32 size = io->GetFileSize();
+    if (size > 0) io->Seek(static_cast<u32>(size));
+    io->Write(static_cast<u32>(length) < sizeof(line) ? static_cast<u32>(length) : sizeof(line) - 1, line);
+    io->Close();
+}
+#endif
+
+static void FinishRace() {
+    if (sRecorder.finished || sRecorder.frameCount == 0) return;
+    sRecorder.finished = true;
+#ifdef FRAME_TIME_DEBUG
+    FrameTimeSummary summary;
+    GetFrameTimeSummary(summary);
+    AppendFrameTimesFile(summary);
+#endif
+}
+
+static void ResetFrameRecorder() {
+    FinishRace();
+    memset(&sRecorder, 0, sizeof(FrameRecorder));
+}
+static RaceLoadHook ResetFrameRecorderHook(ResetFrameRecorder);
+
+static void RecordedRaceSceneCalc(RaceScene *scene) {
+    const u32 start = OS::GetTick();
+    scene->RaceScene::OnCalc();
+    RecordFrame(start, OS::GetTick() - start);
+}
+kmWritePointer(0x808b4250, RecordedRaceSceneCalc);  // RaceScene vtable 0x30
+
+static void FinishRaceOnExit(RaceScene *scene) {
+    scene->RaceScene::OnExit();
+    FinishRace();
+}
+kmWritePointer(0x808b4254, FinishRaceOnExit);  // RaceScene vtable 0x34
+
+}  // namespace Debug
+}  // namespace Pulsar
@@ -0,0 +1,36 @@
+#ifndef _PUL_FRAME_RECORDER_
+#define _PUL_FRAME_RECORDER_
+
+#include <kamek.hpp>
+
+// Flight recorder for race frame times: keeps the last FRAME_RECORDER_RING_SIZE frames and per race histograms.
+// Define FRAME_TIME_DEBUG to get the on-screen percentile overlay and a per race summary line in <modFolder>/FrameTimes.txt
+namespace Pulsar {
+namespace Debug {
+
+enum FramePercentile {
+    FRAME_PERCENTILE_50,
+    FRAME_PERCENTILE_95,
+    FRAME_PERCENTILE_99,
+    FRAME_PERCENTILE_COUNT
+};
+
+struct FrameTimeSummary {
+    u32 frameCount;
+    u32 cpuUs[FRAME_PERCENTILE_COUNT];    // RaceScene calc
+    u32 waitUs[FRAME_PERCENTILE_COUNT];   // rest of the frame: draw, GPU sync and retrace wait
+    u32 totalUs[FRAME_PERCENTILE_COUNT];  // calc start to calc start
+    u32 maxTotalUs;
+    u32 lagCorrections;
+    u32 lagFramesCorrected;
+};
+
+void RecordLagCorrection(u32 frames);
+void GetFrameTimeSummary(FrameTimeSummary &summary);
+// Oldest first, in microseconds clamped to 0xFFFF; returns how many entries were written
+u32 CopyRecentFrameTimes(u16 *cpuUs, u16 *totalUs, u32 count);
+
+}  // namespace Debug
+}  // namespace Pulsar
+
+#endif
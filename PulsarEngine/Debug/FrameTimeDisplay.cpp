@@ -0,0 +1,34 @@
+#include <Debug/DebugOverlay.hpp>
+#include <Debug/FrameRecorder.hpp>
+#include <include/c_wchar.h>
+
+#ifdef FRAME_TIME_DEBUG
+namespace Pulsar {
+namespace Debug {
+
+// Running percentiles of the frame recorder, on the race debug overlay
+static u32 WriteFrameTimes(wchar_t *dest, u32 capacity) {
+    FrameTimeSummary summary;
+    GetFrameTimeSummary(summary);
+
+    // Values are shown in tenths of a millisecond
+    const int length = ::swprintf(dest, capacity,
+               L"CPU %u.%u/%u.%u/%u.%u\nWait %u.%u/%u.%u/%u.%u\nFrame %u.%u/%u.%u/%u.%u max %u.%u\nLag %u (%u frames)\n",
+               summary.cpuUs[FRAME_PERCENTILE_50] / 1000, summary.cpuUs[FRAME_PERCENTILE_50] / 100 % 10,
+               summary.cpuUs[FRAME_PERCENTILE_95] / 1000, summary.cpuUs[FRAME_PERCENTILE_95] / 100 % 10,
+               summary.cpuUs[FRAME_PERCENTILE_99] / 1000, summary.cpuUs[FRAME_PERCENTILE_99] / 100 % 10,
+               summary.waitUs[FRAME_PERCENTILE_50] / 1000, summary.waitUs[FRAME_PERCENTILE_50] / 100 % 10,
+               summary.waitUs[FRAME_PERCENTILE_95] / 1000, summary.waitUs[FRAME_PERCENTILE_95] / 100 % 10,
+               summary.waitUs[FRAME_PERCENTILE_99] / 1000, summary.waitUs[FRAME_PERCENTILE_99] / 100 % 10,
+               summary.totalUs[FRAME_PERCENTILE_50] / 1000, summary.totalUs[FRAME_PERCENTILE_50] / 100 % 10,
+               summary.totalUs[FRAME_PERCENTILE_95] / 1000, summary.totalUs[FRAME_PERCENTILE_95] / 100 % 10,
+               summary.totalUs[FRAME_PERCENTILE_99] / 1000, summary.totalUs[FRAME_PERCENTILE_99] / 100 % 10,
+               summary.maxTotalUs / 1000, summary.maxTotalUs / 100 % 10,
+               summary.lagCorrections, summary.lagFramesCorrected);
+    return length > 0 ? static_cast<u32>(length) : 0;
+}
+static DebugOverlaySection sFrameTimesSection(WriteFrameTimes, DEBUG_OVERLAY_RACE);
+
+}  // namespace Debug
+}  // namespace Pulsar
+#endif
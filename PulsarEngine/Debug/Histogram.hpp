@@ -0,0 +1,36 @@
+#ifndef _PUL_HISTOGRAM_
+#define _PUL_HISTOGRAM_
+
+#include <kamek.hpp>
+
+// Fixed width histograms shared by the frame recorder and the network telemetry; the last bucket is open ended.
+namespace Pulsar {
+namespace Debug {
+
+inline u32 GetHistogramBucket(u32 value, u32 bucketWidth, u32 bucketCount) {
+    const u32 bucket = value / bucketWidth;
+    return bucket < bucketCount ? bucket : bucketCount - 1;
+}
+
+// Upper edge of the bucket the percentile falls in, never above the largest value recorded. total is the sum of all buckets.
+template <typename Count>
+u32 GetHistogramPercentile(const Count *buckets, u32 bucketCount, u32 bucketWidth, u32 total, u32 maxValue,
+                           u32 percentile) {
+    if (total == 0) return 0;
+    const u32 target = (total * percentile + 99) / 100;
+    u32 cumulated = 0;
+    for (u32 bucket = 0; bucket < bucketCount; ++bucket) {
+        cumulated += buckets[bucket];
+        if (cumulated >= target) {
+            if (bucket == bucketCount - 1) return maxValue;
+            const u32 upper = (bucket + 1) * bucketWidth;
+            return upper < maxValue ? upper : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+}  // namespace Debug
+}  // namespace Pulsar
+
+#endif
@@ -0,0 +1,68 @@
+#include <kamek.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <PulsarSystem.hpp>
+#include <IO/IO.hpp>
+#include <MarioKartWii/UI/Section/SectionMgr.hpp>
+#include <include/c_stdio.h>
+
+// Build with HOOK_PROFILING to time every FrameLoadHook, RaceFrameHook, RaceLoadHook and SectionLoadHook call.
+// The table gathered since the previous section change is appended to <modFolder>/HookProfile.txt, then cleared.
+#ifdef HOOK_PROFILING
+namespace Pulsar {
+namespace Debug {
+
+const u32 HOOK_PROFILE_BUFFER_SIZE = 0x2000;
+
+alignas(0x20) static char sHookProfileBuffer[HOOK_PROFILE_BUFFER_SIZE];
+static s32 sProfiledSectionId = -1;
+
+static u32 AppendHookList(u32 offset, const char *kind, DoFuncsHook *first) {
+    for (DoFuncsHook *hook = first; hook != nullptr; hook = hook->GetNext()) {
+        DoFuncsHook::Profile &profile = hook->profile;
+        if (profile.calls != 0 && offset < HOOK_PROFILE_BUFFER_SIZE) {
+            const u32 totalUs = OS::TicksToMicroseconds(profile.totalTicks);
+            const int written = snprintf(&sHookProfileBuffer[offset], HOOK_PROFILE_BUFFER_SIZE - offset,
+                                         "%-8s %08x calls %6u total %8uus avg %6uus max %6uus\n",
+                                         kind, reinterpret_cast<u32>(hook->GetFunc()), profile.calls,
+                                         totalUs, totalUs / profile.calls, OS::TicksToMicroseconds(profile.maxTicks));
+            if (written > 0) offset += static_cast<u32>(written);
+            if (offset > HOOK_PROFILE_BUFFER_SIZE - 1) offset = HOOK_PROFILE_BUFFER_SIZE - 1;
+        }
+        profile.calls = 0;
+        profile.maxTicks = 0;
+        profile.totalTicks = 0;
+    }
+    return offset;
+}
+
+static void WriteHookProfile() {
+    const s32 sectionId = sProfiledSectionId;
+    const SectionMgr *sectionMgr = SectionMgr::sInstance;
+    sProfiledSectionId = (sectionMgr != nullptr && sectionMgr->curSection != nullptr) ? static_cast<s32>(sectionMgr->curSection->sectionId) : -1;
+
+    int header = snprintf(sHookProfileBuffer, HOOK_PROFILE_BUFFER_SIZE, "section 0x%x\n", sectionId);
+    u32 offset = header > 0 ? static_cast<u32>(header) : 0;
+    const u32 headerEnd = offset;
+    offset = AppendHookList(offset, "frame", FrameLoadHook::GetFirst());
+    offset = AppendHookList(offset, "race", RaceFrameHook::GetFirst());
+    offset = AppendHookList(offset, "raceload", RaceLoadHook::GetFirst());
+    offset = AppendHookList(offset, "section", SectionLoadHook::GetFirst());
+    if (sectionId < 0 || offset == headerEnd) return;
+    OS::Report("%s", sHookProfileBuffer);
+
+    IO *io = IO::sInstance;
+    const System *system = System::sInstance;
+    if (io == nullptr || system == nullptr) return;
+    char path[IOS::ipcMaxPath];
+    snprintf(path, IOS::ipcMaxPath, "%s/HookProfile.txt", system->GetModFolder());
+    if (!io->OpenFile(path, FILE_MODE_WRITE) && !io->CreateAndOpen(path, FILE_MODE_WRITE)) return;
+    const s32 size = io->GetFileSize();
+    if (size > 0) io->Seek(static_cast<u32>(size));
+    io->Write(offset, sHookProfileBuffer);
+    io->Close();
+}
+static SectionLoadHook WriteHookProfileHook(WriteHookProfile);
+
+}  // namespace Debug
+}  // namespace Pulsar
+#endif
@@ -1,7 +1,7 @@
 #include <kamek.hpp>
 #include <PulsarSystem.hpp>
 #include <IO/IO.hpp>
-#include <IO/SDIO.hpp>
+#include <core/egg/Thread.hpp>
 #include <core/rvl/OS/OS.hpp>
 #include <include/c_stdarg.h>
 #include <include/c_stdio.h>
@@ -12,69 +12,124 @@ namespace Pulsar {
 namespace Debug {
 
 const char *OS_REPORT_LOG_PATH = "/RetroRewind6/OSReport.txt";
-const u32 LOG_BUFFER_SIZE = 0x4000;
-const u32 LOG_FLUSH_CHUNK_SIZE = 0x400;
-
+const u32 LOG_BUFFER_SIZE = 0x10000;  // power of two, positions are free-running and masked on access
+const u32 LOG_WRITE_BLOCK_SIZE = 0x1000;
+const u32 LOG_IDLE_FLUSH_FRAMES = 60;  // partial blocks still reach the file about once a second
+// Lowest priority in use, the writer only runs when nothing else wants the CPU
+const int LOG_WRITER_PRIORITY = 30;
+const u32 LOG_WRITER_STACK_SIZE = 0x2000;
+
+// OSReport runs on several threads, but with interrupts off a reservation is atomic on the single Broadway core,
+// so the ring only ever sees one producer and one consumer (the writer thread).
 char sLogBuffer[LOG_BUFFER_SIZE];
-u32 sLogWritePos = 0;
-u32 sLogReadPos = 0;
-bool sWritingOSReportLog = false;
+volatile u32 sLogWritePos = 0;
+volatile u32 sLogReadPos = 0;
+volatile u32 sDroppedBytes = 0;
+volatile u32 sDroppedMessages = 0;
+u32 sWrittenBytes = 0;
+u32 sReportedDroppedBytes = 0;
+
+alignas(0x20) char sLogBlock[LOG_WRITE_BLOCK_SIZE];
+EGG::TaskThread *sLogWriter = nullptr;
+IO *sLogIo = nullptr;
+bool sLogFileOpen = false;
+volatile bool sLogFlushPending = false;
+u32 sFramesSinceFlush = 0;
 
 u32 PendingLogBytes() {
-    if (sLogWritePos >= sLogReadPos) return sLogWritePos - sLogReadPos;
-    return LOG_BUFFER_SIZE - sLogReadPos + sLogWritePos;
+    return sLogWritePos - sLogReadPos;
 }
 
 void QueueOSReportLog(const char *text, u32 length) {
     if (text == nullptr || length == 0) return;
 
-    for (u32 i = 0; i < length; ++i) {
-        const u32 next = (sLogWritePos + 1) % LOG_BUFFER_SIZE;
-        if (next == sLogReadPos) sLogReadPos = (sLogReadPos + 1) % LOG_BUFFER_SIZE;
-        sLogBuffer[sLogWritePos] = text[i];
-        sLogWritePos = next;
+    const s32 isr = OS::DisableInterrupts();
+    const u32 writePos = sLogWritePos;
+    if (length > LOG_BUFFER_SIZE - (writePos - sLogReadPos)) {
+        // Never overwrite unread bytes, drop the whole line instead so the file never holds half messages.
+        sDroppedBytes += length;
+        ++sDroppedMessages;
+        OS::RestoreInterrupts(isr);
+        return;
     }
+    const u32 offset = writePos & (LOG_BUFFER_SIZE - 1);
+    u32 firstPart = LOG_BUFFER_SIZE - offset;
+    if (firstPart > length) firstPart = length;
+    memcpy(&sLogBuffer[offset], text, firstPart);
+    if (firstPart < length) memcpy(&sLogBuffer[0], text + firstPart, length - firstPart);
+    sLogWritePos = writePos + length;
+    OS::RestoreInterrupts(isr);
 }
 
-void FlushOSReportLog() {
-    if (System::sInstance == nullptr || sWritingOSReportLog || PendingLogBytes() == 0) return;
-
-    sWritingOSReportLog = true;
-
-    SDIO sd(IOType_SD, nullptr, nullptr);
-    IO *logIo = &sd;
-    if (IO::sInstance != nullptr && IO::sInstance->type == IOType_DOLPHIN) {
-        logIo = IO::sInstance;
+static bool OpenOSReportLog() {
+    if (sLogFileOpen) return true;
+    if (sLogIo == nullptr) {
+        const IO *io = IO::sInstance;
+        const IOType type = (io != nullptr && io->type == IOType_DOLPHIN) ? IOType_DOLPHIN : IOType_SD;
+        sLogIo = IO::Create(type, System::sInstance->heap, nullptr);
+        if (sLogIo == nullptr) return false;
     }
-
-    if (!logIo->OpenFile(OS_REPORT_LOG_PATH, IOS::MODE_WRITE)) {
-        logIo->CreateFolder("/RetroRewind6");
-        if (!logIo->CreateAndOpen(OS_REPORT_LOG_PATH, IOS::MODE_WRITE)) {
-            sWritingOSReportLog = false;
-            return;
-        }
+    if (!sLogIo->OpenFile(OS_REPORT_LOG_PATH, FILE_MODE_WRITE)) {
+        sLogIo->CreateFolder("/RetroRewind6");
+        if (!sLogIo->CreateAndOpen(OS_REPORT_LOG_PATH, FILE_MODE_WRITE)) return false;
     }
+    const s32 size = sLogIo->GetFileSize();
+    if (size > 0) sLogIo->Seek(static_cast<u32>(size));
+    sLogFileOpen = true;
+    return true;
+}
 
-    const s32 size = logIo->GetFileSize();
-    if (size > 0) logIo->Seek(static_cast<u32>(size));
-
-    u32 remaining = PendingLogBytes();
-    if (remaining > LOG_FLUSH_CHUNK_SIZE) remaining = LOG_FLUSH_CHUNK_SIZE;
-
-    while (remaining != 0) {
-        u32 chunk = LOG_BUFFER_SIZE - sLogReadPos;
-        if (chunk > remaining) chunk = remaining;
+static bool WriteLogBlock(const void *data, u32 length) {
+    const s32 wrote = sLogIo->Write(length, data);
+    if (wrote != static_cast<s32>(length)) {
+        // Reopen on the next flush; the handle may have been invalidated (SD pulled, NAND error).
+        sLogIo->Close();
+        sLogFileOpen = false;
+        return false;
+    }
+    sWrittenBytes += length;
+    return true;
+}
 
-        const s32 wrote = logIo->Write(chunk, &sLogBuffer[sLogReadPos]);
-        if (wrote <= 0) break;
+static void DrainOSReportLog(void *) {
+    if (OpenOSReportLog()) {
+        const u32 droppedBytes = sDroppedBytes;
+        if (droppedBytes != sReportedDroppedBytes) {
+            const int length = snprintf(sLogBlock, sizeof(sLogBlock), "[Pulsar] OSReport log dropped %u bytes (%u messages) so far\n",
+                                        droppedBytes, sDroppedMessages);
+            if (length > 0 && WriteLogBlock(sLogBlock, static_cast<u32>(length))) sReportedDroppedBytes = droppedBytes;
+        }
 
-        sLogReadPos = (sLogReadPos + static_cast<u32>(wrote)) % LOG_BUFFER_SIZE;
-        remaining -= static_cast<u32>(wrote);
+        u32 pending = PendingLogBytes();
+        while (sLogFileOpen && pending != 0) {
+            u32 length = pending > LOG_WRITE_BLOCK_SIZE ? LOG_WRITE_BLOCK_SIZE : pending;
+            const u32 offset = sLogReadPos & (LOG_BUFFER_SIZE - 1);
+            u32 firstPart = LOG_BUFFER_SIZE - offset;
+            if (firstPart > length) firstPart = length;
+            memcpy(sLogBlock, &sLogBuffer[offset], firstPart);
+            if (firstPart < length) memcpy(sLogBlock + firstPart, &sLogBuffer[0], length - firstPart);
+            if (!WriteLogBlock(sLogBlock, length)) break;
+            sLogReadPos += length;
+            pending = PendingLogBytes();
+        }
     }
+    sLogFlushPending = false;
+}
 
-    logIo->Close();
-
-    sWritingOSReportLog = false;
+void FlushOSReportLog() {
+    if (System::sInstance == nullptr || sLogFlushPending) return;
+    ++sFramesSinceFlush;
+    const u32 pending = PendingLogBytes();
+    if (pending == 0 && sDroppedBytes == sReportedDroppedBytes) return;
+    if (pending < LOG_WRITE_BLOCK_SIZE && sFramesSinceFlush < LOG_IDLE_FLUSH_FRAMES) return;
+
+    if (sLogWriter == nullptr) {
+        sLogWriter = EGG::TaskThread::Create(1, LOG_WRITER_PRIORITY, LOG_WRITER_STACK_SIZE, System::sInstance->heap);
+        if (sLogWriter == nullptr) return;
+    }
+    sLogFlushPending = true;
+    sFramesSinceFlush = 0;
+    if (!sLogWriter->Request(DrainOSReportLog, nullptr, 0)) sLogFlushPending = false;
 }
 
 int OSReportLogHook(const char *format, ...) {
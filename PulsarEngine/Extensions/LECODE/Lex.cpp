@@ -24,6 +24,8 @@ const KMPHeader *LexMgr::LoadLEXAndKMP(u32, const char *kmpString) {
     Pulsar::System *system = Pulsar::System::sInstance;
     Pulsar::Race::ResetConditionalObjectsTrackState();
     Pulsar::Race::ResetConditionalRouteGroupsState();
+    Pulsar::Race::ResetObjectResourceVariantsState();
+    Pulsar::Race::IndexObjectResourceVariants();
 
     LexMgr &self = system->lecodeMgr.lexMgr;
     self.Reset();
@@ -13,6 +13,7 @@
 #include <MarioKartWii/Kart/KartBody.hpp>
 #include <MarioKartWii/Kart/KartPhysics.hpp>
 #include <MarioKartWii/RKNet/RKNetController.hpp>
+#include <core/rvl/OS/OS.hpp>
 #include <PulsarSystem.hpp>
 #include <Gamemodes/ItemRain/ItemRain.hpp>
 #include <runtimeWrite.hpp>
@@ -26,6 +27,10 @@ static const float MIN_FORWARD_OFFSET = 4500.0f;
 static const u32 BOBOMB_DURATION_EXTRA = 20;
 static const u32 LIGHTNING_MIN_FRAME = 1800;
 static const float OFFSET_SCALE = 10.0f;
+static const u32 MAX_SPAWNS_PER_FRAME = 3;
+static const u32 SPAWN_QUEUE_CAPACITY = 24;
+static const u32 MAX_SPAWN_DELAY = 12;  // requests older than two generation intervals are dropped
+static const u32 RAIN_SLOTS_PER_ITEM = 8;
 
 struct ItemWeight {
     u32 threshold;
@@ -55,6 +60,51 @@ struct State {
 };
 static State sState;
 
+// Spawns are rolled on the same frames and in the same order as before, owner included, so the RNG stream is unchanged;
+// only the actual spawn may slip to a later frame when the per-frame budget is spent.
+struct SpawnRequest {
+    u32 frame;
+    float fOff;
+    float rOff;
+    ItemObjId itemId;
+    u8 playerIdx;
+    u8 ownerPlayerId;
+    bool isStorm;
+    bool wasDeferred;
+};
+
+// Rain keeps at most a fixed share of each holder; at that share its oldest object of the type is retired and its
+// slot (with the already loaded entity) is reused instead of growing into the slots players' own items need.
+struct RainSlots {
+    Item::Obj *objs[RAIN_SLOTS_PER_ITEM];
+    u32 spawnFrames[RAIN_SLOTS_PER_ITEM];
+    u8 count;
+    u8 oldest;
+};
+
+struct SpawnScheduler {
+    SpawnRequest queue[SPAWN_QUEUE_CAPACITY];
+    u32 head;
+    u32 count;
+    RainSlots slots[0xF];
+    SpawnStats stats;
+};
+static SpawnScheduler sScheduler;
+
+const SpawnStats &GetSpawnStats() {
+    return sScheduler.stats;
+}
+
+static void ResetSpawnScheduler() {
+    const SpawnStats &stats = sScheduler.stats;
+    if (stats.spawned != 0 || stats.dropped != 0) {
+        OS::Report("[Pulsar] Item rain: %u spawned, %u deferred, %u dropped, %u recycled\n", stats.spawned, stats.deferred, stats.dropped,
+                   stats.recycled);
+    }
+    sScheduler = SpawnScheduler();
+}
+static RaceLoadHook ResetSpawnSchedulerOnRaceLoad(ResetSpawnScheduler);
+
 extern "C" {
 void SpawnItemInternal__Q24Item9ObjHolderFPQ24Item3Obj(Item::ObjHolder *, Item::Obj *);
 void InitProperties__Q24Item3ObjFUiP4Vec3P4Vec3P4Vec3(Item::Obj *, u32, const Vec3 *, const Vec3 *, const Vec3 *);
@@ -112,13 +162,13 @@ static u8 GetRandomPlayerId(s32 fallbackPlayerId) {
     return static_cast<u8>(tm->random.NextLimited(km->playerCount));
 }
 
-static void DoSpawnItem(ItemObjId itemId, s32 playerIdx, float fOff, float rOff, bool isStorm) {
+static Item::Obj *DoSpawnItem(ItemObjId itemId, s32 playerIdx, u8 ownerPlayerId, float fOff, float rOff, bool isStorm) {
     Kart::Manager *km = Kart::Manager::sInstance;
     Item::Manager *im = Item::Manager::sInstance;
-    if (!km || !im || itemId >= 0xF || playerIdx < 0 || playerIdx >= km->playerCount) return;
+    if (!km || !im || itemId >= 0xF || playerIdx < 0 || playerIdx >= km->playerCount) return nullptr;
 
     Kart::Player *player = km->players[playerIdx];
-    if (!player) return;
+    if (!player) return nullptr;
 
     Item::ObjHolder *holder = &im->itemObjHolders[itemId];
     const Kart::PhysicsHolder *physics = player->pointers.kartBody->kartPhysicsHolder;
@@ -131,9 +181,8 @@ static void DoSpawnItem(ItemObjId itemId, s32 playerIdx, float fOff, float rOff,
         pos.z + fOff * mtx.mtx[2][2] + rOff * mtx.mtx[2][0]);
 
     Item::Obj *obj = nullptr;
-    const u8 ownerPlayerId = GetRandomPlayerId(playerIdx);
     holder->Spawn(1u, &obj, ownerPlayerId, spawnPos, false);
-    if (!obj) return;
+    if (!obj) return nullptr;
 
     if (!obj->entity) LoadEntity__Q24Item3ObjFb(obj, false);
 
@@ -156,6 +205,99 @@ static void DoSpawnItem(ItemObjId itemId, s32 playerIdx, float fOff, float rOff,
 
     if (Raceinfo::sInstance->timerMgr)
         *reinterpret_cast<u32 *>(reinterpret_cast<u8 *>(obj) + 0x164) = Raceinfo::sInstance->timerMgr->raceFrameCounter;
+    return obj;
+}
+
+static u32 GetObjSpawnFrame(const Item::Obj *obj) {
+    return *reinterpret_cast<const u32 *>(reinterpret_cast<const u8 *>(obj) + 0x164);
+}
+
+// A slot is still ours if the object is active and has not been respawned by someone else since.
+static bool IsRainSlotLive(const RainSlots &slots, u32 idx) {
+    const Item::Obj *obj = slots.objs[idx];
+    return obj != nullptr && (obj->bitfield74 & 1) == 0 && GetObjSpawnFrame(obj) == slots.spawnFrames[idx];
+}
+
+static void CompactRainSlots(RainSlots &slots) {
+    RainSlots live = RainSlots();
+    for (u32 i = 0; i < slots.count; ++i) {
+        const u32 idx = (slots.oldest + i) % RAIN_SLOTS_PER_ITEM;
+        if (!IsRainSlotLive(slots, idx)) continue;
+        live.objs[live.count] = slots.objs[idx];
+        live.spawnFrames[live.count] = slots.spawnFrames[idx];
+        ++live.count;
+    }
+    slots = live;
+}
+
+static u32 GetRainSlotQuota(ItemObjId itemId) {
+    const Item::Manager *im = Item::Manager::sInstance;
+    u32 quota = im != nullptr ? im->itemObjHolders[itemId].capacity / 2 : 1;
+    if (quota == 0) quota = 1;
+    if (quota > RAIN_SLOTS_PER_ITEM) quota = RAIN_SLOTS_PER_ITEM;
+    return quota;
+}
+
+static void RetireOldestRainObj(RainSlots &slots) {
+    if (slots.count == 0) return;
+    Item::Obj *obj = slots.objs[slots.oldest];
+    obj->DisappearDueToExcess(false);
+    slots.objs[slots.oldest] = nullptr;
+    slots.oldest = static_cast<u8>((slots.oldest + 1) % RAIN_SLOTS_PER_ITEM);
+    --slots.count;
+    ++sScheduler.stats.recycled;
+}
+
+static bool SpawnRequested(const SpawnRequest &request) {
+    RainSlots &slots = sScheduler.slots[request.itemId];
+    CompactRainSlots(slots);
+    if (slots.count >= GetRainSlotQuota(request.itemId)) RetireOldestRainObj(slots);
+
+    Item::Obj *obj = DoSpawnItem(request.itemId, request.playerIdx, request.ownerPlayerId, request.fOff, request.rOff, request.isStorm);
+    if (obj == nullptr) return false;
+
+    const u32 idx = (slots.oldest + slots.count) % RAIN_SLOTS_PER_ITEM;
+    slots.objs[idx] = obj;
+    slots.spawnFrames[idx] = GetObjSpawnFrame(obj);
+    ++slots.count;
+    return true;
+}
+
+static void EnqueueSpawn(const SpawnRequest &request) {
+    SpawnScheduler &scheduler = sScheduler;
+    if (scheduler.count >= SPAWN_QUEUE_CAPACITY) {
+        ++scheduler.stats.dropped;
+        return;
+    }
+    scheduler.queue[(scheduler.head + scheduler.count) % SPAWN_QUEUE_CAPACITY] = request;
+    ++scheduler.count;
+}
+
+static void DrainSpawnQueue(u32 frame) {
+    SpawnScheduler &scheduler = sScheduler;
+    u32 budget = MAX_SPAWNS_PER_FRAME;
+    while (scheduler.count > 0 && budget > 0) {
+        SpawnRequest &request = scheduler.queue[scheduler.head];
+        scheduler.head = (scheduler.head + 1) % SPAWN_QUEUE_CAPACITY;
+        --scheduler.count;
+
+        if (frame - request.frame > MAX_SPAWN_DELAY || !IsLocalPlayer(request.playerIdx)) {
+            ++scheduler.stats.dropped;
+            continue;
+        }
+        --budget;
+        if (SpawnRequested(request))
+            ++scheduler.stats.spawned;
+        else
+            ++scheduler.stats.dropped;
+    }
+
+    for (u32 i = 0; i < scheduler.count; ++i) {
+        SpawnRequest &request = scheduler.queue[(scheduler.head + i) % SPAWN_QUEUE_CAPACITY];
+        if (request.wasDeferred) continue;
+        request.wasDeferred = true;
+        ++scheduler.stats.deferred;
+    }
 }
 
 static bool TryGenerateItemSpawn(RaceTimerMgr *tm, bool isStorm, float *outFOff, float *outROff, ItemObjId *outItemId) {
@@ -231,7 +373,10 @@ static void OnTimerUpdate(u32 oldFrame) {
     if (frame == sState.lastFrame) return;
     sState.lastFrame = frame;
 
-    if (frame % 6 != 0) return;
+    if (frame % 6 != 0) {
+        DrainSpawnQueue(frame);
+        return;
+    }
 
     if (frame == 0x2) {
         if (pid != PAGE_TT_LEADERBOARDS)
@@ -241,7 +386,10 @@ static void OnTimerUpdate(u32 oldFrame) {
     }
 
     Kart::Manager *km = Kart::Manager::sInstance;
-    if (!km) return;
+    if (!km) {
+        DrainSpawnQueue(frame);
+        return;
+    }
     s32 count = km->playerCount;
 
     if (count >= 13) {
@@ -256,13 +404,18 @@ static void OnTimerUpdate(u32 oldFrame) {
         if (!IsLocalPlayer(idx)) continue;
 
         for (u32 s = 0; s < spawnsPerPlayer; s++) {
-            float fOff, rOff;
-            ItemObjId itemId;
-            if (TryGenerateItemSpawn(tm, isStorm, &fOff, &rOff, &itemId)) {
-                DoSpawnItem(itemId, idx, fOff, rOff, isStorm);
+            SpawnRequest request;
+            if (TryGenerateItemSpawn(tm, isStorm, &request.fOff, &request.rOff, &request.itemId)) {
+                request.frame = frame;
+                request.playerIdx = static_cast<u8>(idx);
+                request.ownerPlayerId = GetRandomPlayerId(idx);
+                request.isStorm = isStorm;
+                request.wasDeferred = false;
+                EnqueueSpawn(request);
             }
         }
     }
+    DrainSpawnQueue(frame);
 }
 
 kmRuntimeUse(0x808D1BDC);
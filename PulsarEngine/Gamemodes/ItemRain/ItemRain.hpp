@@ -8,6 +8,15 @@ namespace ItemRain {
 
 bool IsItemRainEnabled();
 
+// Per-race spawn scheduler counters: deferred requests waited for a later frame's budget, dropped ones never spawned.
+struct SpawnStats {
+    u32 spawned;
+    u32 deferred;
+    u32 dropped;
+    u32 recycled;
+};
+const SpawnStats &GetSpawnStats();
+
 }  // namespace ItemRain
 }  // namespace Pulsar
 
@@ -417,10 +417,13 @@ void Mgr::Update() {
                     Stats &stats = self->stats[0];
                     RKNet::PacketHolder<Network::PulRH1> *holder = controller->GetSendPacketHolder<Network::PulRH1>(aid);
 
-                    Network::PulRH1 *dest = holder->packet;
-                    dest->timeInDanger = stats.final.timeInDanger;
-                    dest->almostKOdCounter = stats.final.almostKOdCounter;
-                    dest->finalPercentageSum = stats.final.finalPercentageSum;
+                    Network::PulRH1 dest;
+                    u32 packetSize;
+                    Network::ReadSendPulRH1(*holder, dest, packetSize);
+                    dest.timeInDanger = stats.final.timeInDanger;
+                    dest.almostKOdCounter = stats.final.almostKOdCounter;
+                    dest.finalPercentageSum = stats.final.finalPercentageSum;
+                    Network::WriteSendPulRH1(*holder, dest, packetSize);
                 }
             }
         }
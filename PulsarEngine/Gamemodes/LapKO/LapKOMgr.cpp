@@ -756,8 +756,11 @@ void Mgr::HostDistributeEvents(RKNet::Controller &controller, const RKNet::Contr
         if (aid == sub.localAid) continue;
         if ((sub.availableAids & (1 << aid)) == 0) continue;
         RKNet::PacketHolder<Network::PulRH1> *holder = controller.GetSendPacketHolder<Network::PulRH1>(aid);
-        if (holder->packetSize < Network::PulRH1SizeLapKo) holder->packetSize = Network::PulRH1SizeLapKo;
-        Network::PulRH1 *packet = holder->packet;
+        Network::PulRH1 expanded;
+        u32 packetSize;
+        Network::ReadSendPulRH1(*holder, expanded, packetSize);
+        if (packetSize < Network::PulRH1SizeLapKo) packetSize = Network::PulRH1SizeLapKo;
+        Network::PulRH1 *packet = &expanded;
 
         if (this->hasPendingEvent && this->IsFriendRoomOnline()) {
             packet->pulsarTrackId = static_cast<u16>(packet->trackId);
@@ -784,6 +787,7 @@ void Mgr::HostDistributeEvents(RKNet::Controller &controller, const RKNet::Contr
                 packet->variantIdx = 0;
             }
         }
+        Network::WriteSendPulRH1(*holder, expanded, packetSize);
     }
 
     if (this->pendingTimer > 0) {
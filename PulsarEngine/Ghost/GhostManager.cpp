@@ -14,6 +14,11 @@ Mgr::RKGCallback Mgr::cb = nullptr;
 
 char Mgr::folderPath[IOS::ipcMaxPath] = "";
 
+static const GhostIndexEntry *FindGhostIndexEntry(const GhostIndexFile *index, const char *fileName);
+static bool ReadRKGFooter(IO *io, u32 fileIndex, void *scratch, u32 &outSize, u32 &outCRC32);
+static void StoreGhostIndexData(GhostIndexData &dest, const GhostData &src);
+static void LoadGhostIndexData(GhostData &dest, const GhostIndexData &src);
+
 Mgr *Mgr::CreateInstance() {
     Mgr *self = Mgr::sInstance;
     if (self == nullptr) {
@@ -92,30 +97,218 @@ void Mgr::Init(PulsarId id, u8 variantIdx) {
     }
     u32 counter = this->HasExpert();  // starts at 1 if the expert for this track exists
 
-    for (int i = 0; i < io->GetFileCount(); ++i) {
-        this->rkg.ClearBuffer();
+    // The callback wants every decompressed RKG, so only the plain list can come from the index.
+    const int fileCount = io->GetFileCount();
+    GhostIndexFile *cachedIndex = nullptr;
+    GhostIndexFile *index = nullptr;
+    u32 indexSize = 0;
+    if (this->cb == nullptr && fileCount > 0) {
+        cachedIndex = this->ReadGhostIndex();
+        if (cachedIndex != nullptr && cachedIndex->expertCRC32 != expertCRC32) {
+            delete cachedIndex;
+            cachedIndex = nullptr;
+        }
+        indexSize = sizeof(GhostIndexFile) + sizeof(GhostIndexEntry) * (fileCount - 1);
+        index = io->Alloc<GhostIndexFile>(indexSize);
+        if (index != nullptr) memset(index, 0, indexSize);
+    }
+
+    u32 readCount = 0;
+    for (int i = 0; i < fileCount; ++i) {
         GhostData &curData = this->files[counter];
-        s32 ret = io->ReadFolderFile(&this->rkg, i, sizeof(RKG));
-        if (ret > 0 && this->rkg.CheckValidity() && this->GetRKGcrc32(this->rkg) != expertCRC32) {
-            curData.Init(rkg);
-            if (this->cb != nullptr) {
-                rkg.DecompressTo(*decompressed);
-                this->cb(*decompressed, IS_LOADING_LEADERBOARDS, counter);
+        const GhostIndexEntry *known = FindGhostIndexEntry(cachedIndex, io->GetFileName(i));
+        bool isValid;
+        u32 crc32;
+        u32 fileSize = 0;
+        // A ghost overwritten under the same name changes its size or its CRC32, which is always the last word of an RKG.
+        if (known != nullptr &&
+            (!ReadRKGFooter(io, i, &this->rkg, fileSize, crc32) || fileSize != known->fileSize || crc32 != known->crc32)) {
+            known = nullptr;
+        }
+        if (known != nullptr) {
+            isValid = known->isValid;
+            if (isValid && crc32 != expertCRC32) LoadGhostIndexData(curData, known->ghostData);
+        } else {
+            this->rkg.ClearBuffer();
+            s32 ret = io->ReadFolderFile(&this->rkg, i, sizeof(RKG));
+            ++readCount;
+            fileSize = ret > 0 ? static_cast<u32>(ret) : 0;
+            isValid = ret > 0 && this->rkg.CheckValidity();
+            crc32 = isValid ? this->GetRKGcrc32(this->rkg) : 0;
+            // Invalid files keep their last word too, so they are not read in full again on every open.
+            if (!isValid && fileSize >= 0x20 && fileSize <= sizeof(RKG)) {
+                crc32 = *reinterpret_cast<const u32 *>(reinterpret_cast<const u8 *>(&this->rkg) + fileSize - 4);
             }
-            curData.courseId = static_cast<CourseId>(id);
-            curData.padding = i;
-            if (ttMode <= TTMODE_200 && this->favGhostFileIndex[ttMode] == 0xFF) {
-                if (strcmp(this->leaderboard.GetFavGhost(ttMode), Mgr::GetGhostFileName(i)) == 0) {
-                    this->favGhostFileIndex[ttMode] = i;
+            if (isValid && crc32 != expertCRC32) {
+                curData.Init(rkg);
+                if (this->cb != nullptr) {
+                    rkg.DecompressTo(*decompressed);
+                    this->cb(*decompressed, IS_LOADING_LEADERBOARDS, counter);
                 }
             }
+        }
+        if (index != nullptr) {
+            GhostIndexEntry &entry = index->entries[i];
+            strncpy(entry.fileName, io->GetFileName(i), IOS::ipcMaxPath - 1);
+            entry.fileSize = fileSize;
+            entry.crc32 = crc32;
+            entry.isValid = isValid;
+            if (isValid && crc32 != expertCRC32) StoreGhostIndexData(entry.ghostData, curData);
+        }
+        if (isValid && crc32 != expertCRC32) {
+            curData.courseId = static_cast<CourseId>(id);
+            curData.padding = i;
+            this->ApplyFavGhost(i);
             ++counter;
         }
     }
+
+    // Deleted ghosts only shrink the listing, so a count change also needs a rewrite.
+    const bool indexChanged = cachedIndex == nullptr || readCount > 0 || cachedIndex->fileCount != static_cast<u32>(fileCount);
+    if (index != nullptr && indexChanged) {
+        index->header.magic = GhostIndexFile::magic;
+        index->header.version = GhostIndexFile::version;
+        index->header.size = indexSize;
+        index->fileCount = fileCount;
+        index->expertCRC32 = expertCRC32;
+        char indexPath[IOS::ipcMaxPath];
+        this->GetGhostIndexPath(indexPath);
+        if (io->OpenFile(indexPath, FILE_MODE_WRITE) || io->CreateAndOpen(indexPath, FILE_MODE_WRITE)) {
+            io->Overwrite(indexSize, index);
+            io->Close();
+        }
+    }
+    delete index;
+    delete cachedIndex;
     this->rkgCount = counter;
     delete decompressed;
 }
 
+void Mgr::GetGhostIndexPath(char *dest) const {
+    snprintf(dest, IOS::ipcMaxPath, "%s/%s.gidx", folderPath, System::ttModeFolders[System::sInstance->ttMode]);
+}
+
+GhostIndexFile *Mgr::ReadGhostIndex() const {
+    char indexPath[IOS::ipcMaxPath];
+    this->GetGhostIndexPath(indexPath);
+    IO *io = IO::sInstance;
+    if (!io->OpenFile(indexPath, FILE_MODE_READ)) return nullptr;
+
+    const s32 fileSize = io->GetFileSize();
+    GhostIndexFile *index = nullptr;
+    if (fileSize >= static_cast<s32>(sizeof(GhostIndexFile))) {
+        index = io->Alloc<GhostIndexFile>(fileSize);
+        if (index != nullptr && io->Read(fileSize, index) != fileSize) {
+            delete index;
+            index = nullptr;
+        }
+    }
+    io->Close();
+
+    if (index != nullptr &&
+        (index->header.magic != GhostIndexFile::magic ||
+         index->header.version != GhostIndexFile::version ||
+         index->header.size != static_cast<u32>(fileSize) ||
+         index->fileCount == 0 ||
+         sizeof(GhostIndexFile) + sizeof(GhostIndexEntry) * (index->fileCount - 1) != index->header.size)) {
+        delete index;
+        index = nullptr;
+    }
+    return index;
+}
+
+static const GhostIndexEntry *FindGhostIndexEntry(const GhostIndexFile *index, const char *fileName) {
+    if (index == nullptr) return nullptr;
+    for (u32 i = 0; i < index->fileCount; ++i) {
+        const GhostIndexEntry &entry = index->entries[i];
+        if (strncmp(entry.fileName, fileName, IOS::ipcMaxPath) == 0) return &entry;
+    }
+    return nullptr;
+}
+
+// Reads the last 0x20 bytes of an RKG into scratch (0x20 aligned), enough to check it against its index entry.
+static bool ReadRKGFooter(IO *io, u32 fileIndex, void *scratch, u32 &outSize, u32 &outCRC32) {
+    char path[IOS::ipcMaxPath];
+    io->GetFolderFilePath(path, fileIndex);
+    if (!io->OpenFile(path, FILE_MODE_READ)) return false;
+    const s32 size = io->GetFileSize();
+    bool ok = false;
+    if (size >= 0x20 && size <= static_cast<s32>(sizeof(RKG))) {
+        io->Seek(size - 0x20);
+        ok = io->Read(0x20, scratch) == 0x20;
+    }
+    io->Close();
+    if (!ok) return false;
+    outSize = static_cast<u32>(size);
+    outCRC32 = *reinterpret_cast<const u32 *>(static_cast<const u8 *>(scratch) + 0x1C);
+    return true;
+}
+
+static void StoreGhostIndexTimer(GhostIndexTimer &dest, const Timer &src) {
+    dest.minutes = src.minutes;
+    dest.seconds = src.seconds;
+    dest.isActive = src.isActive;
+    dest.milliseconds = src.milliseconds;
+    dest.reserved[0] = 0;
+    dest.reserved[1] = 0;
+}
+
+static void LoadGhostIndexTimer(Timer &dest, const GhostIndexTimer &src) {
+    dest.minutes = src.minutes;
+    dest.seconds = src.seconds;
+    dest.isActive = src.isActive != 0;
+    dest.milliseconds = src.milliseconds;
+}
+
+static void StoreGhostIndexData(GhostIndexData &dest, const GhostData &src) {
+    memcpy(dest.userData, src.userData, sizeof(dest.userData));
+    dest.lapCount = src.lapCount;
+    dest.isDriftAuto = src.isDriftAuto;
+    memcpy(dest.miiData, &src.miiData, sizeof(dest.miiData));
+    for (int lap = 0; lap < 5; ++lap) StoreGhostIndexTimer(dest.lapTimes[lap], src.lapTimes[lap]);
+    StoreGhostIndexTimer(dest.finishTime, src.finishTime);
+    dest.characterId = static_cast<u8>(src.characterId);
+    dest.kartId = static_cast<u8>(src.kartId);
+    dest.controllerType = static_cast<u8>(src.controllerType);
+    dest.type = static_cast<u8>(src.type);
+    dest.year = src.year;
+    dest.month = src.month;
+    dest.day = src.day;
+    dest.reserved = 0;
+    dest.nationality = src.nationality;
+    dest.inputSize = src.inputSize;
+}
+
+// dest keeps its own vtables; courseId and padding are set by the caller like for a freshly read RKG.
+static void LoadGhostIndexData(GhostData &dest, const GhostIndexData &src) {
+    dest.isValid = true;
+    memcpy(dest.userData, src.userData, sizeof(src.userData));
+    dest.lapCount = src.lapCount;
+    dest.isDriftAuto = src.isDriftAuto != 0;
+    memcpy(&dest.miiData, src.miiData, sizeof(src.miiData));
+    for (int lap = 0; lap < 5; ++lap) LoadGhostIndexTimer(dest.lapTimes[lap], src.lapTimes[lap]);
+    LoadGhostIndexTimer(dest.finishTime, src.finishTime);
+    dest.characterId = static_cast<CharacterId>(src.characterId);
+    dest.kartId = static_cast<KartId>(src.kartId);
+    dest.controllerType = static_cast<ControllerType>(src.controllerType);
+    dest.type = static_cast<GhostType>(src.type);
+    dest.year = src.year;
+    dest.month = src.month;
+    dest.day = src.day;
+    dest.nationality = src.nationality;
+    dest.inputSize = src.inputSize;
+    dest.inputs = nullptr;
+}
+
+void Mgr::ApplyFavGhost(u32 fileIndex) {
+    const TTMode ttMode = System::sInstance->ttMode;
+    if (ttMode <= TTMODE_200 && this->favGhostFileIndex[ttMode] == 0xFF) {
+        if (strcmp(this->leaderboard.GetFavGhost(ttMode), Mgr::GetGhostFileName(fileIndex)) == 0) {
+            this->favGhostFileIndex[ttMode] = fileIndex;
+        }
+    }
+}
+
 void Mgr::Reset() {
     IO::sInstance->CloseFolder();
     this->pulsarId = PULSARID_NONE;
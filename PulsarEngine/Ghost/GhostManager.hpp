@@ -14,6 +14,57 @@ void BeforeEntranceAnimations(Pages::TTSplits *page);
 }  // namespace UI
 namespace Ghosts {
 
+// Timer without its vtable, as stored in a ghost index
+struct GhostIndexTimer {
+    u16 minutes;
+    u8 seconds;
+    u8 isActive;
+    u16 milliseconds;
+    u8 reserved[2];
+};
+
+// The GhostData fields the ghost list needs, written field by field so an index stays valid across builds and regions
+struct GhostIndexData {
+    u16 userData[11];
+    u8 lapCount;
+    u8 isDriftAuto;
+    u8 miiData[sizeof(RFL::StoreData)];
+    GhostIndexTimer lapTimes[5];
+    GhostIndexTimer finishTime;
+    u8 characterId;
+    u8 kartId;
+    u8 controllerType;
+    u8 type;
+    u8 year;
+    u8 month;
+    u8 day;
+    u8 reserved;
+    u32 nationality;
+    u32 inputSize;
+};
+
+struct GhostIndexEntry {
+    IOS::IPCPath fileName;
+    u32 fileSize;
+    u32 crc32;  // last word of the RKG, checked against the file before the entry is reused
+    u8 isValid;
+    u8 reserved[3];
+    GhostIndexData ghostData;
+};
+
+// Per track and TT mode, <trackFolder>/<mode>.gidx; lets the ghost list open without reading every RKG.
+// Entries are matched by file name, size and the RKG's trailing CRC32, which only takes a 0x20 byte read per file; after a
+// ghost is saved only the new RKG is read in full before the index is rewritten.
+struct GhostIndexFile {
+    static const u32 magic = 'GIDX';
+    static const u32 version = 2;
+
+    Pulsar::SectionHeader header;
+    u32 fileCount;
+    s32 expertCRC32;  // entries are only reused while the expert ghost they were filtered against is unchanged
+    GhostIndexEntry entries[1];
+};
+
 // Implements MultiGhost and handles leaderboards/expert
 class Mgr {
 public:
@@ -86,6 +137,9 @@ private:
     bool EnableGhost(const GhostListEntry &entry, bool isMain);
     void DisableGhost(const GhostListEntry &entry);
     void LoadAllGhosts(u32 maxGhosts, bool isGhostRace);
+    void GetGhostIndexPath(char *dest) const;
+    GhostIndexFile *ReadGhostIndex() const;
+    void ApplyFavGhost(u32 fileIndex);
     void CreateGhost(RKSYS::LicenseLdbEntry *entry, u32 position);
     void SetFavGhost(const GhostListEntry &entry, TTMode mode, bool add) { this->leaderboard.SetFavGhost(entry.padding[0], mode, add); }
     static void CreateAndSaveFiles(Mgr *self);
@@ -0,0 +1,222 @@
+#include <kamek.hpp>
+#include <IO/ArchiveCache.hpp>
+#include <include/c_string.h>
+#include <core/RK/RKSystem.hpp>
+#include <core/egg/mem/Heap.hpp>
+#include <core/nw4r/ut/Misc.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <core/rvl/OS/OSCache.hpp>
+#include <core/rvl/OS/OSMutex.hpp>
+
+namespace Pulsar {
+namespace IOOverrides {
+
+namespace {
+const u32 kArchiveCacheMaxEntries = 8;
+const u32 kArchiveCachePathSize = 96;
+// Two or three custom tracks plus Common.szs; past that a 12-player room gains nothing but fragmentation.
+const u32 kArchiveCacheMaxBytes = 0x1400000;
+}  // namespace
+
+struct ArchiveCacheEntry {
+    char path[kArchiveCachePathSize];
+    u32 overrideState;
+    void *data;
+    u32 size;
+    u32 lastUse;
+};
+
+struct ArchiveCacheStats {
+    u32 hits;
+    u32 misses;
+    u32 stores;
+    u32 evictions;
+};
+
+static ArchiveCacheEntry sEntries[kArchiveCacheMaxEntries];
+static ArchiveCacheStats sStats;
+static u32 sCachedBytes = 0;
+static u32 sUseClock = 0;
+
+// Lookups and stores run on the ArchiveMgr task thread, section-change reclaims and flushes on the main thread.
+// Every entry point takes this lock, so an eviction can never free an entry while a load is still copying from it.
+static OS::Mutex sCacheMutex;
+static bool sCacheMutexReady = false;
+
+namespace {
+class ArchiveCacheLock {
+public:
+    ArchiveCacheLock() {
+        if (!sCacheMutexReady) {
+            const int old = OS::DisableInterrupts();
+            if (!sCacheMutexReady) {
+                OS::InitMutex(&sCacheMutex);
+                sCacheMutexReady = true;
+            }
+            OS::RestoreInterrupts(old);
+        }
+        OS::LockMutex(&sCacheMutex);
+    }
+    ~ArchiveCacheLock() { OS::UnlockMutex(&sCacheMutex); }
+};
+}  // namespace
+
+static EGG::Heap *GetArchiveCacheHeap() {
+    return RKSystem::mInstance.EGGRootMEM2;
+}
+
+static const char *SkipLeadingSlash(const char *path) {
+    return (path != nullptr && path[0] == '/') ? path + 1 : path;
+}
+
+bool IsCacheableArchivePath(const char *path) {
+    path = SkipLeadingSlash(path);
+    if (path == nullptr || strlen(path) >= kArchiveCachePathSize) return false;
+    return strncmp(path, "Race/Course/", 12) == 0 || strncmp(path, "Race/Common", 11) == 0;
+}
+
+static void EvictEntry(ArchiveCacheEntry &entry) {
+    if (entry.data == nullptr) return;
+    EGG::Heap::free(entry.data, GetArchiveCacheHeap());
+    sCachedBytes -= nw4r::ut::RoundUp(entry.size, 0x20);
+    entry.data = nullptr;
+    entry.size = 0;
+    entry.path[0] = '\0';
+    ++sStats.evictions;
+}
+
+static ArchiveCacheEntry *FindLeastRecentlyUsed() {
+    ArchiveCacheEntry *oldest = nullptr;
+    for (u32 i = 0; i < kArchiveCacheMaxEntries; ++i) {
+        ArchiveCacheEntry &entry = sEntries[i];
+        if (entry.data == nullptr) continue;
+        if (oldest == nullptr || entry.lastUse < oldest->lastUse) oldest = &entry;
+    }
+    return oldest;
+}
+
+// Scene heaps come out of the same root heap, so whenever something else has eaten into the headroom the cache backs off.
+static void ReclaimHeadroom(u32 extraBytes) {
+    EGG::Heap *heap = GetArchiveCacheHeap();
+    if (heap == nullptr) return;
+    while (heap->getAllocatableSize(0x20) < kCacheHeadroom + extraBytes) {
+        ArchiveCacheEntry *oldest = FindLeastRecentlyUsed();
+        if (oldest == nullptr) return;
+        EvictEntry(*oldest);
+    }
+}
+
+// Lookups and stores only happen while archives load, so the headroom is also checked on every section change; otherwise
+// whatever was cached last would stay pinned until the next course load, even when the coming scene needs the space.
+static void ReclaimHeadroomOnSectionChange() {
+    ArchiveCacheLock lock;
+    ReclaimHeadroom(0);
+}
+static SectionLoadHook reclaimArchiveCacheHook(ReclaimHeadroomOnSectionChange);
+
+static ArchiveCacheEntry *FindEntry(const char *path, u32 overrideState) {
+    for (u32 i = 0; i < kArchiveCacheMaxEntries; ++i) {
+        ArchiveCacheEntry &entry = sEntries[i];
+        if (entry.data != nullptr && entry.overrideState == overrideState && strcmp(entry.path, path) == 0) return &entry;
+    }
+    return nullptr;
+}
+
+static void ReportArchiveCache(const char *result, const char *path) {
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    OS::Report("[Pulsar] ArchiveCache %s %s (hits=%u misses=%u stores=%u evictions=%u bytes=0x%X)\n", result, path,
+               sStats.hits, sStats.misses, sStats.stores, sStats.evictions, sCachedBytes);
+#endif
+}
+
+void *LoadCachedArchive(const char *path, u32 overrideState, EGG::Heap *mountHeap, EGG::Heap *dumpHeap, u32 &outSize,
+                        EGG::Heap *&outHeap) {
+    outSize = 0;
+    outHeap = nullptr;
+    if (!IsCacheableArchivePath(path) || mountHeap == nullptr) return nullptr;
+    path = SkipLeadingSlash(path);
+    ArchiveCacheLock lock;
+    ReclaimHeadroom(0);
+
+    ArchiveCacheEntry *entry = FindEntry(path, overrideState);
+    if (entry == nullptr) {
+        ++sStats.misses;
+        ReportArchiveCache("miss", path);
+        return nullptr;
+    }
+
+    const u32 allocSize = nw4r::ut::RoundUp(entry->size, 0x20);
+    outHeap = mountHeap;
+    void *archive = EGG::Heap::alloc(allocSize, 0x20, mountHeap);
+    if (archive == nullptr && dumpHeap != nullptr && dumpHeap != mountHeap) {
+        outHeap = dumpHeap;
+        archive = EGG::Heap::alloc(allocSize, 0x20, dumpHeap);
+    }
+    if (archive == nullptr) {
+        // The regular load would fail the same allocation; count it as a miss and let it report the error.
+        outHeap = nullptr;
+        ++sStats.misses;
+        ReportArchiveCache("miss (no space)", path);
+        return nullptr;
+    }
+
+    memcpy(archive, entry->data, entry->size);
+    OS::DCStoreRange(archive, entry->size);
+    entry->lastUse = ++sUseClock;
+    outSize = entry->size;
+    ++sStats.hits;
+    ReportArchiveCache("hit", path);
+    return archive;
+}
+
+void StoreCachedArchive(const char *path, u32 overrideState, const void *archive, u32 size) {
+    if (!IsCacheableArchivePath(path) || archive == nullptr || size == 0 || size > kArchiveCacheMaxBytes) return;
+    EGG::Heap *heap = GetArchiveCacheHeap();
+    if (heap == nullptr) return;
+    path = SkipLeadingSlash(path);
+
+    ArchiveCacheLock lock;
+    ArchiveCacheEntry *slot = FindEntry(path, overrideState);
+    if (slot != nullptr) {
+        slot->lastUse = ++sUseClock;
+        return;
+    }
+
+    const u32 allocSize = nw4r::ut::RoundUp(size, 0x20);
+    while (sCachedBytes + allocSize > kArchiveCacheMaxBytes) {
+        ArchiveCacheEntry *oldest = FindLeastRecentlyUsed();
+        if (oldest == nullptr) break;
+        EvictEntry(*oldest);
+    }
+    ReclaimHeadroom(allocSize);
+    if (heap->getAllocatableSize(0x20) < kCacheHeadroom + allocSize) return;
+
+    for (u32 i = 0; i < kArchiveCacheMaxEntries && slot == nullptr; ++i) {
+        if (sEntries[i].data == nullptr) slot = &sEntries[i];
+    }
+    if (slot == nullptr) {
+        slot = FindLeastRecentlyUsed();
+        EvictEntry(*slot);
+    }
+
+    // Tail allocations keep cached archives away from the head, where the root heap hands out scene heaps.
+    void *data = EGG::Heap::alloc(allocSize, -0x20, heap);
+    if (data == nullptr) return;
+    memcpy(data, archive, size);
+
+    strcpy(slot->path, path);
+    slot->overrideState = overrideState;
+    slot->data = data;
+    slot->size = size;
+    slot->lastUse = ++sUseClock;
+    sCachedBytes += allocSize;
+    ++sStats.stores;
+}
+
+void FlushArchiveCache() {
+    ArchiveCacheLock lock;
+    for (u32 i = 0; i < kArchiveCacheMaxEntries; ++i) EvictEntry(sEntries[i]);
+}
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
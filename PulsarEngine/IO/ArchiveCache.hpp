@@ -0,0 +1,33 @@
+#ifndef _PULSAR_ARCHIVE_CACHE_
+#define _PULSAR_ARCHIVE_CACHE_
+
+#include <kamek.hpp>
+
+namespace EGG {
+class Heap;
+}
+
+namespace Pulsar {
+namespace IOOverrides {
+
+// Cross-race LRU cache of decompressed, override-applied course and race common archives.
+// Entries live on spare root MEM2 and are keyed by the requested path plus the loose override state, so a track replayed
+// in a friend room or the next GP race is copied from memory instead of being read and decoded again.
+// The cache always leaves kCacheHeadroom free on MEM2 for scene heaps and gives memory back when it drops below that.
+
+// Root MEM2 that every cache allocating from its tail leaves free: the next scene's heaps are carved from it.
+const u32 kCacheHeadroom = 0x600000;
+
+bool IsCacheableArchivePath(const char *path);
+// Copies a cached archive into a new buffer on mountHeap (or dumpHeap if mountHeap is full).
+// Returns nullptr on a miss; outHeap receives the heap the copy was allocated from.
+void *LoadCachedArchive(const char *path, u32 overrideState, EGG::Heap *mountHeap, EGG::Heap *dumpHeap, u32 &outSize,
+                        EGG::Heap *&outHeap);
+// Snapshots an archive right after decompression, before it is mounted and its resources are relocated.
+void StoreCachedArchive(const char *path, u32 overrideState, const void *archive, u32 size);
+void FlushArchiveCache();
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
+
+#endif  // _PULSAR_ARCHIVE_CACHE_
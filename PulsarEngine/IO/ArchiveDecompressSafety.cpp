@@ -7,11 +7,15 @@
 #include <core/rvl/os/OSCache.hpp>
 #include <core/nw4r/ut/Misc.hpp>
 #include <IO/LooseArchiveOverrides.hpp>
+#include <IO/ArchiveStream.hpp>
+#include <IO/ChunkedArchive.hpp>
 
 namespace Pulsar {
 namespace IOOverrides {
 
 static void ClearCompressedArchive(ArchiveFile *file) {
+    // The stream reader may still be writing into the dump buffer.
+    FinishArchiveStream(file);
     if (file->compressedArchive != nullptr && file->dumpHeap != nullptr) {
         EGG::Heap::free(file->compressedArchive, file->dumpHeap);
     }
@@ -71,7 +75,8 @@ static void SafeDecompress(ArchiveFile *file, const char *path, EGG::Heap *heap,
         return;
     }
 
-    u32 expandSize = EGG::Decomp::getExpandSize(compressedData);
+    const bool isChunked = IsChunkedArchive(compressedData, file->compressedArchiveSize);
+    u32 expandSize = isChunked ? GetChunkedArchiveExpandSize(compressedData) : EGG::Decomp::getExpandSize(compressedData);
     if (expandSize == 0) {
         FailDecompress(file);
         return;
@@ -103,7 +108,27 @@ static void SafeDecompress(ArchiveFile *file, const char *path, EGG::Heap *heap,
         return;
     }
 
-    EGG::Decomp::decodeSZS(compressedData, decompressedBuffer);
+    if (isChunked) {
+        // The reader thread only streams Yaz0, so a chunked container is always fully read by now.
+        if (!BeginChunkedArchive(compressedData, file->compressedArchiveSize, decompressedBuffer, expandSize,
+                                 sourceArchiveHeap) ||
+            !DecodeChunkedArchive(canApplyOverrides ? archiveBaseLower : nullptr)) {
+            OS::Report("[Pulsar] ArchiveFile::Decompress invalid chunked archive: %s\n", path);
+            FinishChunkedArchive(nullptr, true);
+            EGG::Heap::free(decompressedBuffer, sourceArchiveHeap);
+            FailDecompress(file);
+            return;
+        }
+    } else if (IsArchiveStreaming(file)) {
+        if (!DecodeArchiveStream(file, decompressedBuffer, expandSize)) {
+            OS::Report("[Pulsar] ArchiveFile::Decompress streamed read failed: %s\n", path);
+            EGG::Heap::free(decompressedBuffer, sourceArchiveHeap);
+            FailDecompress(file);
+            return;
+        }
+    } else {
+        EGG::Decomp::decodeSZS(compressedData, decompressedBuffer);
+    }
 
     u32 appliedOverrides = 0;
     u32 patchedNodes = 0;
@@ -111,11 +136,15 @@ static void SafeDecompress(ArchiveFile *file, const char *path, EGG::Heap *heap,
     u32 finalSize = expandSize;
 
     u8 *archiveBase = decompressedBuffer;
+    bool overridesApplied = false;
     if (canApplyOverrides) {
         // `ApplyLooseOverrides()` may swap `archiveBase` to a repacked buffer on another heap.
-        ApplyLooseOverrides(archiveBaseLower, archiveBase, finalSize, sourceArchiveHeap, archiveHeap, &appliedOverrides,
-                            &patchedNodes, &missingOverrides, compressedData);
+        // Chunked containers cannot be re-decoded with decodeSZS, so they never take the same-heap repack path.
+        overridesApplied = ApplyLooseOverrides(archiveBaseLower, archiveBase, finalSize, sourceArchiveHeap, archiveHeap,
+                                               &appliedOverrides, &patchedNodes, &missingOverrides,
+                                               isChunked ? nullptr : compressedData);
     }
+    if (isChunked) FinishChunkedArchive(archiveBase, overridesApplied);
     if (archiveBase == decompressedBuffer) {
         archiveHeap = sourceArchiveHeap;
     }
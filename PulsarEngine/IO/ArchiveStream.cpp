@@ -0,0 +1,313 @@
+#include <kamek.hpp>
+#include <PulsarSystem.hpp>
+#include <IO/ArchiveStream.hpp>
+#include <include/c_stdio.h>
+#include <core/egg/Thread.hpp>
+#include <core/egg/mem/Heap.hpp>
+#include <core/nw4r/ut/Misc.hpp>
+#include <core/rvl/dvd/dvd.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <core/rvl/OS/OSCache.hpp>
+#include <core/rvl/OS/OSMessage.hpp>
+
+namespace Pulsar {
+namespace IOOverrides {
+
+namespace {
+const u32 kStreamChunkSize = 0x10000;
+// Anything that fits in a couple of chunks is faster to read in one go than to hand off to the reader thread.
+const u32 kStreamMinFileSize = kStreamChunkSize * 2;
+const u32 kYaz0Magic = 0x59617a30;
+const u32 kYaz0HeaderSize = 0x10;
+// One code byte plus eight 3-byte back-references: the most input a single Yaz0 group can consume.
+const u32 kYaz0MaxGroupSize = 1 + 8 * 3;
+// decodeSZSAsm writes its last 0x132 output bytes without zeroing cache lines ahead, so a back-reference can't overrun.
+const u32 kYaz0AsmTailSize = 0x132;
+// Above the main thread so the reader gets the CPU back as soon as its DVD command completes,
+// below System's task thread so saves are not starved.
+const int kStreamReaderPriority = 8;
+const u32 kStreamReaderStackSize = 0x2000;
+const s32 kMessageNoBlock = 0;
+const s32 kMessageBlock = 1;
+}  // namespace
+
+struct ArchiveStream {
+    ArchiveFile *file;
+    DVD::FileInfo fileInfo;
+    u8 *buffer;
+    u32 fileSize;
+    volatile u32 bytesRead;
+    volatile bool readDone;
+    volatile bool readFailed;
+    bool active;
+    bool joined;
+    OS::MessageQueue progressQueue;
+    OS::Message progressMessages[4];
+    OS::MessageQueue doneQueue;
+    OS::Message doneMessage;
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    char path[64];
+    u32 beginTick;
+    u32 readEndTick;
+    u32 decodeStartTick;
+    u32 decodeEndTick;
+    u32 stallTicks;
+#endif
+};
+
+static ArchiveStream sStream;
+static EGG::TaskThread *sStreamReader = nullptr;
+
+static EGG::TaskThread *GetStreamReader() {
+    if (sStreamReader == nullptr) {
+        System *system = System::sInstance;
+        if (system == nullptr) return nullptr;
+        OS::InitMessageQueue(&sStream.progressQueue, sStream.progressMessages, 4);
+        OS::InitMessageQueue(&sStream.doneQueue, &sStream.doneMessage, 1);
+        sStreamReader = EGG::TaskThread::Create(2, kStreamReaderPriority, kStreamReaderStackSize, system->heap);
+    }
+    return sStreamReader;
+}
+
+static u32 ReadBE32(const u8 *bytes) {
+    return (static_cast<u32>(bytes[0]) << 24) | (static_cast<u32>(bytes[1]) << 16) |
+           (static_cast<u32>(bytes[2]) << 8) | static_cast<u32>(bytes[3]);
+}
+
+static bool ReadStreamChunk(ArchiveStream &stream, u32 offset) {
+    u32 length = stream.fileSize - offset;
+    if (length > kStreamChunkSize) length = kStreamChunkSize;
+    // DVD transfers are 0x20 granular; the buffer is rounded up so the tail read can safely overshoot.
+    const u32 transferLength = nw4r::ut::RoundUp(length, 0x20);
+    OS::DCInvalidateRange(stream.buffer + offset, transferLength);
+    const s32 read = DVD::ReadPrio(&stream.fileInfo, stream.buffer + offset, static_cast<s32>(transferLength),
+                                   static_cast<s32>(offset), 2);
+    return read >= static_cast<s32>(length);
+}
+
+static void ReadArchiveStreamTask(void *) {
+    ArchiveStream &stream = sStream;
+    for (u32 offset = stream.bytesRead; offset < stream.fileSize; offset += kStreamChunkSize) {
+        if (!ReadStreamChunk(stream, offset)) {
+            stream.readFailed = true;
+            break;
+        }
+        const u32 chunkEnd = offset + kStreamChunkSize;
+        stream.bytesRead = chunkEnd < stream.fileSize ? chunkEnd : stream.fileSize;
+        // A full queue already has a wakeup pending, so dropping this one is fine.
+        OS::SendMessage(&stream.progressQueue, nullptr, kMessageNoBlock);
+    }
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    stream.readEndTick = OS::GetTick();
+#endif
+    stream.readDone = true;
+    OS::SendMessage(&stream.progressQueue, nullptr, kMessageNoBlock);
+    OS::SendMessage(&stream.doneQueue, nullptr, kMessageBlock);
+}
+
+static void DrainProgressQueue(ArchiveStream &stream) {
+    OS::Message msg;
+    while (OS::ReceiveMessage(&stream.progressQueue, &msg, kMessageNoBlock)) {
+    }
+}
+
+static bool ClaimArchiveStream() {
+    const int old = OS::DisableInterrupts();
+    const bool claimed = !sStream.active;
+    if (claimed) {
+        sStream.active = true;
+        sStream.file = nullptr;
+    }
+    OS::RestoreInterrupts(old);
+    return claimed;
+}
+
+// The single stream slot is claimed before the first blocking call, so a second caller can't take it over while
+// this one is still opening or reading the head of its file; every path that doesn't hand it to the reader frees it.
+bool BeginArchiveStream(ArchiveFile *file, const char *path, EGG::Heap *dumpHeap, bool allocFromTail) {
+    if (file == nullptr || path == nullptr || dumpHeap == nullptr || !ClaimArchiveStream()) return false;
+    ArchiveStream &stream = sStream;
+    EGG::TaskThread *reader = GetStreamReader();
+    if (reader == nullptr || !DVD::Open(path, &stream.fileInfo)) {
+        stream.active = false;
+        return false;
+    }
+    const u32 fileSize = stream.fileInfo.length;
+    if (fileSize < kStreamMinFileSize) {
+        // Not worth a thread handoff; the regular ripper path handles it.
+        DVD::Close(&stream.fileInfo);
+        stream.active = false;
+        return false;
+    }
+
+    const u32 allocSize = nw4r::ut::RoundUp(fileSize, 0x20);
+    u8 *buffer = static_cast<u8 *>(EGG::Heap::alloc(allocSize, allocFromTail ? -0x20 : 0x20, dumpHeap));
+    if (buffer == nullptr) {
+        DVD::Close(&stream.fileInfo);
+        stream.active = false;
+        return false;
+    }
+
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    snprintf(stream.path, sizeof(stream.path), "%s", path);
+    stream.beginTick = OS::GetTick();
+    stream.stallTicks = 0;
+#endif
+    stream.buffer = buffer;
+    stream.fileSize = fileSize;
+    stream.bytesRead = 0;
+    stream.readDone = false;
+    stream.readFailed = false;
+    stream.joined = false;
+
+    // The first chunk is read inline so the Yaz0 header (and expand size) is available before Decompress runs.
+    if (!ReadStreamChunk(stream, 0)) {
+        EGG::Heap::free(buffer, dumpHeap);
+        DVD::Close(&stream.fileInfo);
+        stream.active = false;
+        return false;
+    }
+    stream.bytesRead = kStreamChunkSize;
+
+    file->compressedArchive = buffer;
+    file->compressedArchiveSize = fileSize;
+    file->dumpHeap = dumpHeap;
+
+    if (ReadBE32(buffer) != kYaz0Magic) {
+        // Only Yaz0 benefits from overlapping; finish the read here so callers see a regular dump.
+        bool read = true;
+        for (u32 offset = kStreamChunkSize; offset < fileSize && read; offset += kStreamChunkSize) {
+            read = ReadStreamChunk(stream, offset);
+        }
+        DVD::Close(&stream.fileInfo);
+        stream.active = false;
+        if (!read) {
+            EGG::Heap::free(buffer, dumpHeap);
+            file->compressedArchive = nullptr;
+            file->compressedArchiveSize = 0;
+            file->dumpHeap = nullptr;
+        }
+        return read;
+    }
+
+    DrainProgressQueue(stream);
+    stream.file = file;
+    if (!reader->Request(ReadArchiveStreamTask, nullptr, 0)) {
+        // No free job slot: read the remainder on this thread, the data is still valid either way.
+        ReadArchiveStreamTask(nullptr);
+        OS::Message msg;
+        OS::ReceiveMessage(&stream.doneQueue, &msg, kMessageBlock);
+        DVD::Close(&stream.fileInfo);
+        stream.active = false;
+        if (stream.readFailed) {
+            EGG::Heap::free(buffer, dumpHeap);
+            file->compressedArchive = nullptr;
+            file->compressedArchiveSize = 0;
+            file->dumpHeap = nullptr;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IsArchiveStreaming(const ArchiveFile *file) {
+    return sStream.active && sStream.file == file;
+}
+
+static bool WaitForStreamBytes(ArchiveStream &stream, u32 needed) {
+    if (needed > stream.fileSize) needed = stream.fileSize;
+    while (stream.bytesRead < needed) {
+        if (stream.readFailed || stream.readDone) return stream.bytesRead >= needed;
+#ifdef ARCHIVE_LOAD_BENCHMARK
+        const u32 stallStart = OS::GetTick();
+#endif
+        OS::Message msg;
+        OS::ReceiveMessage(&stream.progressQueue, &msg, kMessageBlock);
+#ifdef ARCHIVE_LOAD_BENCHMARK
+        stream.stallTicks += OS::GetTick() - stallStart;
+#endif
+    }
+    return true;
+}
+
+// decodeSZSAsm's loop registers between calls of its resumable entry points (Extra/FastSZSAsm.S)
+struct Yaz0AsmState {
+    u8 *dest;  // last byte written
+    const u8 *src;  // last byte read
+    u32 mask;  // code bit of the last op, 0 when a code byte is due
+    u32 code;
+};
+extern "C" void decodeSZSAsmStep(Yaz0AsmState *state, u32 budget);
+extern "C" void decodeSZSAsmFinish(Yaz0AsmState *state, u32 remaining);
+
+// Feeds decodeSZSAsm's loops as chunks arrive. While the read is running, each step only gets the output budget its
+// available input covers whatever it holds: at most 9 input bytes per 8 output bytes, plus one group.
+static bool DecodeYaz0Streaming(ArchiveStream &stream, u8 *dest, u32 expandSize) {
+    Yaz0AsmState state;
+    state.dest = dest - 1;
+    state.src = stream.buffer + kYaz0HeaderSize - 1;
+    state.mask = 0;
+    state.code = 0;
+    const u32 mainSize = expandSize > kYaz0AsmTailSize ? expandSize - kYaz0AsmTailSize : 0;
+    for (;;) {
+        const u32 produced = static_cast<u32>(state.dest + 1 - dest);
+        if (produced >= mainSize) break;
+        const u32 consumed = static_cast<u32>(state.src + 1 - stream.buffer);
+        if (!WaitForStreamBytes(stream, consumed + kYaz0MaxGroupSize + 9)) return false;
+
+        u32 budget = mainSize - produced;
+        const u32 bytesRead = stream.bytesRead;
+        if (bytesRead < stream.fileSize) {
+            const u32 covered = (bytesRead - consumed - kYaz0MaxGroupSize) / 9 * 8;
+            if (covered < budget) budget = covered;
+        }
+        decodeSZSAsmStep(&state, budget);
+    }
+    if (!WaitForStreamBytes(stream, stream.fileSize)) return false;
+    const u32 produced = static_cast<u32>(state.dest + 1 - dest);
+    if (produced < expandSize) decodeSZSAsmFinish(&state, expandSize - produced);
+    return true;
+}
+
+bool DecodeArchiveStream(ArchiveFile *file, u8 *dest, u32 expandSize) {
+    if (!IsArchiveStreaming(file) || dest == nullptr) return false;
+    ArchiveStream &stream = sStream;
+
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    stream.decodeStartTick = OS::GetTick();
+#endif
+    const bool decoded = DecodeYaz0Streaming(stream, dest, expandSize);
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    stream.decodeEndTick = OS::GetTick();
+#endif
+    FinishArchiveStream(file);
+
+#ifdef ARCHIVE_LOAD_BENCHMARK
+    const u32 readTicks = stream.readEndTick - stream.beginTick;
+    const u32 decodeTicks = stream.decodeEndTick - stream.decodeStartTick;
+    const u32 wallTicks = stream.decodeEndTick - stream.beginTick;
+    const u32 serialTicks = readTicks + decodeTicks;
+    OS::Report("[Pulsar] ArchiveStream %s: size=0x%X read=%u decode=%u stall=%u wall=%u overlap=%u ticks\n",
+               stream.path, stream.fileSize, readTicks, decodeTicks, stream.stallTicks, wallTicks,
+               serialTicks > wallTicks ? serialTicks - wallTicks : 0);
+#endif
+    return decoded && !stream.readFailed;
+}
+
+void FinishArchiveStream(ArchiveFile *file) {
+    if (!IsArchiveStreaming(file)) return;
+    ArchiveStream &stream = sStream;
+
+    if (!stream.joined) {
+        OS::Message msg;
+        OS::ReceiveMessage(&stream.doneQueue, &msg, kMessageBlock);
+        stream.joined = true;
+    }
+    DVD::Close(&stream.fileInfo);
+    DrainProgressQueue(stream);
+    stream.active = false;
+    stream.file = nullptr;
+}
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
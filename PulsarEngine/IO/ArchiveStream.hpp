@@ -0,0 +1,29 @@
+#ifndef _PULSAR_ARCHIVE_STREAM_
+#define _PULSAR_ARCHIVE_STREAM_
+
+#include <kamek.hpp>
+#include <MarioKartWii/Archive/ArchiveFile.hpp>
+
+namespace EGG {
+class Heap;
+}
+
+namespace Pulsar {
+namespace IOOverrides {
+
+// Overlapped read + Yaz0 decode for compressed archive loads.
+// BeginArchiveStream reads the first chunk, then keeps reading the rest of the file on a background TaskThread
+// while ArchiveFile::Decompress consumes the bytes already in memory.
+// Build with -DARCHIVE_LOAD_BENCHMARK to report read/decode/overlap ticks for every streamed archive.
+
+bool BeginArchiveStream(ArchiveFile *file, const char *path, EGG::Heap *dumpHeap, bool allocFromTail);
+bool IsArchiveStreaming(const ArchiveFile *file);
+// Decodes the streamed SZS into dest and joins the reader. Returns false if the read or the stream itself failed.
+bool DecodeArchiveStream(ArchiveFile *file, u8 *dest, u32 expandSize);
+// Waits for the reader and closes the file; must run before compressedArchive is freed. No-op if not streaming.
+void FinishArchiveStream(ArchiveFile *file);
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
+
+#endif  // _PULSAR_ARCHIVE_STREAM_
@@ -0,0 +1,254 @@
+#include <kamek.hpp>
+#include <IO/ChunkedArchive.hpp>
+#include <IO/LooseArchiveOverrides.hpp>
+#include <include/c_string.h>
+#include <core/egg/Decomp.hpp>
+#include <core/egg/mem/Heap.hpp>
+#include <core/rvl/arc/arc.hpp>
+#include <core/rvl/OS/OS.hpp>
+
+namespace Pulsar {
+namespace IOOverrides {
+
+namespace {
+const u32 kYaz0Magic = 0x59617a30;
+const u32 kYaz0HeaderSize = 0x10;
+const u32 kU8Magic = 0x55aa382d;
+}  // namespace
+
+struct ChunkedU8Node {
+    u32 typeName;
+    u32 dataOffset;
+    u32 dataSize;
+};
+
+struct ChunkedArchiveState {
+    const u8 *data;
+    const ChunkedArchiveChunk *chunks;
+    const ChunkedArchiveMember *members;
+    u32 chunkCount;
+    u8 *archive;
+    u32 expandSize;
+    const ChunkedU8Node *nodes;
+    u32 nodeCount;
+    u8 *chunkSkipped;
+    u8 *nodeOverridden;
+    EGG::Heap *heap;
+    bool membersValid;
+    bool active;
+};
+
+static ChunkedArchiveState sChunked;
+
+static u32 ReadBE32(const u8 *bytes) {
+    return (static_cast<u32>(bytes[0]) << 24) | (static_cast<u32>(bytes[1]) << 16) |
+           (static_cast<u32>(bytes[2]) << 8) | static_cast<u32>(bytes[3]);
+}
+
+static bool NodeIsDir(const ChunkedU8Node &node) {
+    return (node.typeName >> 24) != 0;
+}
+
+static bool RangeFits(u32 offset, u32 length, u32 size) {
+    return offset <= size && length <= size - offset;
+}
+
+bool IsChunkedArchive(const u8 *data, u32 size) {
+    if (data == nullptr || size < sizeof(ChunkedArchiveHeader)) return false;
+    return reinterpret_cast<const ChunkedArchiveHeader *>(data)->magic == ChunkedArchiveHeader::goodMagic;
+}
+
+u32 GetChunkedArchiveExpandSize(const u8 *data) {
+    return reinterpret_cast<const ChunkedArchiveHeader *>(data)->expandSize;
+}
+
+static bool ValidateChunkTable(const ChunkedArchiveHeader &header, const u8 *data, u32 size) {
+    const ChunkedArchiveChunk *chunks = reinterpret_cast<const ChunkedArchiveChunk *>(data + header.chunkTableOffset);
+    u32 expectedOffset = header.metaSize;
+    for (u32 i = 0; i < header.chunkCount; ++i) {
+        const ChunkedArchiveChunk &chunk = chunks[i];
+        if (chunk.expandOffset != expectedOffset || chunk.expandSize == 0) return false;
+        if (!RangeFits(chunk.expandOffset, chunk.expandSize, header.expandSize)) return false;
+        if (!RangeFits(chunk.dataOffset, chunk.dataSize, size)) return false;
+        if (chunk.dataSize != chunk.expandSize) {
+            const u8 *stream = data + chunk.dataOffset;
+            if (chunk.dataSize < kYaz0HeaderSize || ReadBE32(stream) != kYaz0Magic) return false;
+            if (ReadBE32(stream + 4) != chunk.expandSize) return false;
+        }
+        expectedOffset += chunk.expandSize;
+    }
+    return expectedOffset == header.expandSize;
+}
+
+// The member table is only an optimisation: if it disagrees with the U8 nodes, every chunk is simply decoded.
+static bool ValidateMemberTable(ChunkedArchiveState &state, const ChunkedArchiveHeader &header, u32 size) {
+    const ARC::Header *u8Header = reinterpret_cast<const ARC::Header *>(state.archive);
+    if (u8Header->Magic != kU8Magic || !RangeFits(u8Header->nodeOffset, sizeof(ChunkedU8Node), header.metaSize)) {
+        return false;
+    }
+    state.nodes = reinterpret_cast<const ChunkedU8Node *>(state.archive + u8Header->nodeOffset);
+    state.nodeCount = state.nodes[0].dataSize;
+    if (state.nodeCount == 0 || state.nodeCount > (header.metaSize - u8Header->nodeOffset) / sizeof(ChunkedU8Node)) {
+        return false;
+    }
+    if (!RangeFits(header.memberTableOffset, state.nodeCount * sizeof(ChunkedArchiveMember), size)) return false;
+
+    for (u32 nodeIdx = 1; nodeIdx < state.nodeCount; ++nodeIdx) {
+        const ChunkedU8Node &node = state.nodes[nodeIdx];
+        if (NodeIsDir(node) || node.dataSize == 0) continue;
+        const ChunkedArchiveMember &member = state.members[nodeIdx];
+        const u32 lastChunk = member.firstChunk + member.chunkCount;
+        if (member.chunkCount == 0 || lastChunk > state.chunkCount) return false;
+        const ChunkedArchiveChunk &first = state.chunks[member.firstChunk];
+        const ChunkedArchiveChunk &last = state.chunks[lastChunk - 1];
+        if (first.expandOffset > node.dataOffset) return false;
+        if (last.expandOffset + last.expandSize < node.dataOffset + node.dataSize) return false;
+    }
+    return true;
+}
+
+static void FreeChunkedArchiveScratch(ChunkedArchiveState &state) {
+    if (state.heap != nullptr) {
+        if (state.chunkSkipped != nullptr) EGG::Heap::free(state.chunkSkipped, state.heap);
+        if (state.nodeOverridden != nullptr) EGG::Heap::free(state.nodeOverridden, state.heap);
+    }
+    state = ChunkedArchiveState();
+}
+
+bool BeginChunkedArchive(const u8 *data, u32 size, u8 *dest, u32 expandSize, EGG::Heap *scratchHeap) {
+    FreeChunkedArchiveScratch(sChunked);
+    if (!IsChunkedArchive(data, size) || dest == nullptr || scratchHeap == nullptr) return false;
+
+    const ChunkedArchiveHeader &header = *reinterpret_cast<const ChunkedArchiveHeader *>(data);
+    if (header.version != ChunkedArchiveHeader::curVersion || header.expandSize != expandSize) return false;
+    if (header.metaSize < sizeof(ARC::Header) || header.metaSize > expandSize) return false;
+    if (!RangeFits(header.metaOffset, header.metaSize, size)) return false;
+    if (!RangeFits(header.chunkTableOffset, header.chunkCount * sizeof(ChunkedArchiveChunk), size)) return false;
+    if (!ValidateChunkTable(header, data, size)) return false;
+
+    ChunkedArchiveState &state = sChunked;
+    state.data = data;
+    state.chunks = reinterpret_cast<const ChunkedArchiveChunk *>(data + header.chunkTableOffset);
+    state.members = reinterpret_cast<const ChunkedArchiveMember *>(data + header.memberTableOffset);
+    state.chunkCount = header.chunkCount;
+    state.archive = dest;
+    state.expandSize = expandSize;
+    state.heap = scratchHeap;
+    memcpy(dest, data + header.metaOffset, header.metaSize);
+
+    state.membersValid = ValidateMemberTable(state, header, size);
+    if (state.chunkCount > 0) {
+        state.chunkSkipped = EGG::Heap::alloc<u8>(state.chunkCount, -0x20, scratchHeap);
+        if (state.chunkSkipped == nullptr) {
+            FreeChunkedArchiveScratch(state);
+            return false;
+        }
+        memset(state.chunkSkipped, 0, state.chunkCount);
+    }
+    if (state.membersValid) {
+        state.nodeOverridden = EGG::Heap::alloc<u8>(state.nodeCount, -0x20, scratchHeap);
+        if (state.nodeOverridden == nullptr) state.membersValid = false;
+    }
+    state.active = true;
+    return true;
+}
+
+static void DecodeChunk(const ChunkedArchiveState &state, u32 chunkIdx, u8 *dest) {
+    const ChunkedArchiveChunk &chunk = state.chunks[chunkIdx];
+    const u8 *src = state.data + chunk.dataOffset;
+    if (chunk.dataSize == chunk.expandSize) {
+        memcpy(dest, src, chunk.expandSize);
+    } else {
+        EGG::Decomp::decodeSZS(const_cast<u8 *>(src), dest);
+    }
+}
+
+static void MarkMemberChunksNeeded(ChunkedArchiveState &state, u32 nodeIdx) {
+    const ChunkedArchiveMember &member = state.members[nodeIdx];
+    for (u32 i = 0; i < member.chunkCount; ++i) state.chunkSkipped[member.firstChunk + i] = 0;
+}
+
+bool DecodeChunkedArchive(const char *archiveBaseLower) {
+    ChunkedArchiveState &state = sChunked;
+    if (!state.active) return false;
+
+    u32 overriddenNodes = 0;
+    if (state.membersValid && archiveBaseLower != nullptr && archiveBaseLower[0] != '\0') {
+        memset(state.nodeOverridden, 0, state.nodeCount);
+        overriddenNodes = MarkLooseOverriddenNodes(archiveBaseLower, state.archive, state.expandSize,
+                                                   state.nodeOverridden, state.nodeCount);
+    }
+
+    if (overriddenNodes > 0) {
+        // Start from "skip everything" and keep any chunk that still holds a member the overrides leave alone.
+        memset(state.chunkSkipped, 1, state.chunkCount);
+        for (u32 nodeIdx = 1; nodeIdx < state.nodeCount; ++nodeIdx) {
+            const ChunkedU8Node &node = state.nodes[nodeIdx];
+            if (NodeIsDir(node) || node.dataSize == 0 || state.nodeOverridden[nodeIdx] != 0) continue;
+            MarkMemberChunksNeeded(state, nodeIdx);
+        }
+    }
+
+    u32 skippedChunks = 0;
+    u32 skippedBytes = 0;
+    for (u32 chunkIdx = 0; chunkIdx < state.chunkCount; ++chunkIdx) {
+        const ChunkedArchiveChunk &chunk = state.chunks[chunkIdx];
+        u8 *dest = state.archive + chunk.expandOffset;
+        if (state.chunkSkipped[chunkIdx] != 0) {
+            // Overrides replace these bytes; zero them so a dropped member never exposes stale heap contents.
+            memset(dest, 0, chunk.expandSize);
+            ++skippedChunks;
+            skippedBytes += chunk.expandSize;
+            continue;
+        }
+        DecodeChunk(state, chunkIdx, dest);
+    }
+
+    if (skippedChunks > 0) {
+        OS::Report("[Pulsar] Chunked archive '%s': skipped %u/%u chunk(s), 0x%X bytes for %u overridden member(s)\n",
+                   archiveBaseLower, skippedChunks, state.chunkCount, skippedBytes, overriddenNodes);
+    }
+    return true;
+}
+
+void RestoreChunkedArchiveRange(u8 *archive, u32 offset, u32 size) {
+    ChunkedArchiveState &state = sChunked;
+    if (!state.active || archive != state.archive || size == 0) return;
+    if (!RangeFits(offset, size, state.expandSize)) return;
+
+    const u32 end = offset + size;
+    for (u32 chunkIdx = 0; chunkIdx < state.chunkCount; ++chunkIdx) {
+        if (state.chunkSkipped[chunkIdx] == 0) continue;
+        const ChunkedArchiveChunk &chunk = state.chunks[chunkIdx];
+        const u32 chunkEnd = chunk.expandOffset + chunk.expandSize;
+        if (chunkEnd <= offset || chunk.expandOffset >= end) continue;
+
+        // Other members of a skipped chunk may already be patched, so decode aside and copy back only this range.
+        u8 *decoded = EGG::Heap::alloc<u8>(chunk.expandSize, -0x20, state.heap);
+        if (decoded == nullptr) {
+            OS::Report("[Pulsar] Chunked archive restore failed: no space for 0x%X bytes\n", chunk.expandSize);
+            return;
+        }
+        DecodeChunk(state, chunkIdx, decoded);
+        const u32 copyStart = chunk.expandOffset > offset ? chunk.expandOffset : offset;
+        const u32 copyEnd = chunkEnd < end ? chunkEnd : end;
+        memcpy(archive + copyStart, decoded + (copyStart - chunk.expandOffset), copyEnd - copyStart);
+        EGG::Heap::free(decoded, state.heap);
+    }
+}
+
+void FinishChunkedArchive(u8 *archive, bool overridesApplied) {
+    ChunkedArchiveState &state = sChunked;
+    if (!state.active) return;
+    if (!overridesApplied && archive == state.archive) {
+        // Nothing was patched, so skipped chunks can be decoded straight back into place.
+        for (u32 chunkIdx = 0; chunkIdx < state.chunkCount; ++chunkIdx) {
+            if (state.chunkSkipped[chunkIdx] == 0) continue;
+            DecodeChunk(state, chunkIdx, state.archive + state.chunks[chunkIdx].expandOffset);
+        }
+    }
+    FreeChunkedArchiveScratch(state);
+}
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
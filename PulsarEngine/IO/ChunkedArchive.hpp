@@ -0,0 +1,59 @@
+#ifndef _PULSAR_CHUNKED_ARCHIVE_
+#define _PULSAR_CHUNKED_ARCHIVE_
+
+#include <kamek.hpp>
+
+namespace EGG {
+class Heap;
+}
+
+namespace Pulsar {
+namespace IOOverrides {
+
+// Optional SZS replacement that keeps the U8 metadata uncompressed and splits the payloads into independently
+// Yaz0-compressed chunks, with a per-node table saying which chunks hold each member.
+// Members about to be replaced by loose overrides are never decoded; anything a failed override still needs is
+// decoded on demand. Built by scripts/pack_chunked_szs.py, recognised by magic, so regular SZS files are unaffected.
+
+struct ChunkedArchiveHeader {
+    static const u32 goodMagic = 'PCHK';
+    static const u16 curVersion = 1;
+    u32 magic;
+    u16 version;
+    u16 chunkCount;
+    u32 expandSize;  // size of the decoded U8 archive
+    u32 metaSize;  // bytes [0, metaSize) of the U8 archive, stored raw at metaOffset
+    u32 metaOffset;
+    u32 chunkTableOffset;  // ChunkedArchiveChunk[chunkCount], ordered and contiguous from metaSize to expandSize
+    u32 memberTableOffset;  // ChunkedArchiveMember[nodeCount], indexed like the U8 nodes
+    u32 reserved;
+};  // 0x20
+
+struct ChunkedArchiveChunk {
+    u32 expandOffset;
+    u32 expandSize;
+    u32 dataOffset;
+    u32 dataSize;  // equal to expandSize for stored chunks, otherwise a complete Yaz0 stream
+};
+
+struct ChunkedArchiveMember {
+    u16 firstChunk;
+    u16 chunkCount;  // 0 for directories and empty files
+};
+
+bool IsChunkedArchive(const u8 *data, u32 size);
+u32 GetChunkedArchiveExpandSize(const u8 *data);
+// Copies the metadata into dest and validates the tables; scratchHeap holds per-chunk state until FinishChunkedArchive.
+bool BeginChunkedArchive(const u8 *data, u32 size, u8 *dest, u32 expandSize, EGG::Heap *scratchHeap);
+// Marks the members loose overrides will replace or delete for archiveBaseLower, then decodes every other chunk.
+bool DecodeChunkedArchive(const char *archiveBaseLower);
+// Restores original bytes for part of a skipped chunk, e.g. when reading an override file failed after all.
+// No-op unless archive is the buffer currently being decoded.
+void RestoreChunkedArchiveRange(u8 *archive, u32 offset, u32 size);
+// overridesApplied is false when the archive was left unpatched; every chunk that was skipped is then decoded.
+void FinishChunkedArchive(u8 *archive, bool overridesApplied);
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
+
+#endif  // _PULSAR_CHUNKED_ARCHIVE_
@@ -11,7 +11,13 @@ namespace Pulsar {
 IO *IO::sInstance = nullptr;
 
 IO *IO::CreateInstance(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread) {
-    IO *io;
+    IO *io = IO::Create(type, heap, taskThread);
+    IO::sInstance = io;
+    return io;
+}
+
+IO *IO::Create(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread) {
+    IO *io = nullptr;
 
     switch (type) {
         case IOType_RIIVO:
@@ -25,8 +31,6 @@ IO *IO::CreateInstance(IOType type, EGG::Heap *heap, EGG::TaskThread *const task
             io = new (heap) SDIO(type, heap, taskThread);
             break;
     }
-
-    IO::sInstance = io;
     return io;
 }
 
@@ -49,6 +49,8 @@ public:
 
     static IO *sInstance;
     static IO *CreateInstance(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread);
+    // Standalone backend with its own file handle, sInstance is left untouched
+    static IO *Create(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread);
     template <typename T>
     T *Alloc(u32 size) const { return EGG::Heap::alloc<T>(nw4r::ut::RoundUp(size, 0x20), 0x20, this->heap); }
     virtual s32 GetFileSize() = 0;
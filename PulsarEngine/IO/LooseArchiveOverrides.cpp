@@ -16,6 +16,8 @@
 #include <PulsarSystem.hpp>
 #include <RetroRewindChannel.hpp>
 #include <IO/LooseArchiveOverrides.hpp>
+#include <IO/ArchiveCache.hpp>
+#include <IO/ArchiveStream.hpp>
 #include <IO/SDIO.hpp>
 #include <Settings/Settings.hpp>
 #include <include/c_stdio.h>
@@ -28,11 +30,9 @@
 #include <core/egg/DVD/DvdRipper.hpp>
 #include <core/egg/mem/Heap.hpp>
 #include <core/nw4r/ut/Misc.hpp>
-#include <core/rvl/arc/arc.hpp>
 #include <core/rvl/dvd/dvd.hpp>
 #include <core/rvl/OS/OSBootInfo.hpp>
 #include <core/rvl/os/OS.hpp>
-#include <core/rvl/os/OSCache.hpp>
 
 namespace Pulsar {
 namespace IOOverrides {
@@ -44,31 +44,12 @@ const char kModsRoot[] = "/patches";
 const char kModsRootPrefix[] = "/patches/";
 const u32 kMaxOverridesTotal = 4096;
 const u32 kBRSAROverrideSlotCount = 1024;
-const u32 kOverrideMaxGrowthOnSourceHeap = 0x100000;
 const u32 kInvalidPoolOffset = 0xFFFFFFFFu;
 const s32 kInvalidDVDEntryNum = -1;
-const u16 kInvalidScratchIndex16 = 0xFFFFu;
 const u32 kU8Magic = 0x55aa382d;
 const u32 kYaz0Magic = 0x59617a30;
 const u32 kDefaultOverridePriority = 1000;
 
-enum OverrideEntryFlags {
-    OVERRIDEENTRYFLAG_NONE = 0,
-    OVERRIDEENTRYFLAG_HAS_SUBPATH = (1 << 0),
-    OVERRIDEENTRYFLAG_IS_DELETE = (1 << 1),
-    OVERRIDEENTRYFLAG_SOURCE_YAZ0 = (1 << 2)
-};
-
-struct TaggedOverrideEntry {
-    u32 sourcePathOffset;
-    s32 sourceEntryNum;
-    u32 matchPathOffset;
-    u32 dataOffset;
-    u32 size;
-    u16 tagId;
-    u16 flags;
-};
-
 struct WholeFileOverrideEntry {
     u32 sourcePathOffset;
     s32 sourceEntryNum;
@@ -126,25 +107,6 @@ struct OverrideDatabase {
     u32 brsarCount;
 };
 
-struct LooseOverrideScratch {
-    u16 *nodeOverrideIndex;
-    u32 nodeOverrideCapacity;
-    u32 *entryAppliedBits;
-    u32 entryAppliedCapacity;
-    u16 *basenameHashHeads16;
-    u16 *basenameHashNext16;
-    s32 *basenameHashHeads32;
-    s32 *basenameHashNext32;
-    u32 basenameHashCapacity;
-    bool useWideBasenameIndices;
-    u32 *repackOffsets;
-    u32 *repackSizes;
-    u32 *repackOriginalSizes;
-    u32 *repackOrder;
-    u32 repackCapacity;
-    EGG::Heap *heap;
-};
-
 struct ScanBuildState {
     OverrideDatabase *database;
     TaggedOverrideEntry *taggedEntries;
@@ -161,41 +123,17 @@ struct ScanBuildState {
     u8 *brsarSlotOccupied;
 };
 
-struct U8Node {
-    u32 typeName;
-    u32 dataOffset;
-    u32 dataSize;
-};
-
 struct FSTEntry {
     u32 typeName;
     u32 offset;
     u32 size;
 };
 
-struct PendingStructuralAddCandidate {
-    u16 parentDirIndex;
-    u16 overrideIndex;
-};
-
-struct PendingStructuralAdd {
-    u16 parentDirIndex;
-    u16 overrideIndex;
-    u32 pathOffset;
-    u32 nameOffset;
-};
-
-struct StructuralChildRef {
-    u32 oldNodeIndex;
-    u32 addedFileIndex;
-    const char *name;
-    bool isAddedFile;
-};
-
 static OverrideDatabase sOverrideDatabase = {};
 static OverrideDatabase *sActiveOverrideDatabase = &sOverrideDatabase;
 static u8 sLoggedBRSARLayoutFailure[1024] = {};
 static bool sOverrideIndicesAttempted = false;
+static u32 sOverrideStateGeneration = 0;
 static bool sHasWholeFileOverrides = false;
 static bool sModsRootChecked = false;
 static bool sModsRootPresent = false;
@@ -204,7 +142,16 @@ static bool sOverrideCacheStateInitialized = false;
 static bool sCachedLooseOverridesEnabled = false;
 static char sCachedModFolder[OVERRIDE_MAX_PATH] = "";
 static char sLastUIArchiveBase[32] = "";
-static LooseOverrideScratch sLooseOverrideScratch = {};
+
+#ifdef LOOSE_OVERRIDE_BENCHMARK
+// Running totals reported by ApplyLooseOverrides; per-call numbers come from GetLastLoosePatchStats.
+struct LooseOverrideBench {
+    u32 peakScratchBytes;
+    u32 calls;
+    u32 totalTicks;
+};
+static LooseOverrideBench sLooseOverrideBench = {};
+#endif
 
 static bool AreLooseArchiveOverridesEnabled() {
     if (!Settings::Mgr::IsCreated()) {
@@ -304,10 +251,6 @@ static s32 CompareSourcePathPriorityForFirstWins(const char *lhsPath, const char
     return strcmp(lhsPath, rhsPath);
 }
 
-static u32 MaxU32(u32 lhs, u32 rhs) {
-    return lhs > rhs ? lhs : rhs;
-}
-
 static void SetOverrideResult(u32 *outAppliedOverrides, u32 appliedOverrides, u32 *outPatchedNodes,
                               u32 patchedNodes, u32 *outMissingOverrides, u32 missingOverrides) {
     if (outAppliedOverrides != nullptr) *outAppliedOverrides = appliedOverrides;
@@ -710,14 +653,6 @@ static bool FindArchiveTagRangeById(const OverrideDatabase &database, u16 tagId,
     return end > start;
 }
 
-static bool NodeIsDir(const U8Node &node) {
-    return (node.typeName >> 24) != 0;
-}
-
-static u32 NodeNameOffset(const U8Node &node) {
-    return node.typeName & 0x00FFFFFF;
-}
-
 static bool FSTEntryIsDir(const FSTEntry &entry) {
     return (entry.typeName & 0xFF000000) != 0;
 }
@@ -726,16 +661,6 @@ static u32 FSTNameOffset(const FSTEntry &entry) {
     return entry.typeName & 0x00FFFFFF;
 }
 
-static u32 GetBasenameHashCapacity(u32 nodeCapacity) {
-    u32 capacity = 8;
-    u32 target = (nodeCapacity > 0x7FFFFFFFu) ? 0xFFFFFFFFu : (nodeCapacity * 2);
-    if (target < 8) target = 8;
-    while (capacity < target && capacity < 0x80000000u) {
-        capacity <<= 1;
-    }
-    return capacity;
-}
-
 static void CopyPath(char *dest, u32 destSize, const char *src) {
     snprintf(dest, destSize, "%s", src);
 }
@@ -818,293 +743,6 @@ static void FreeOverrideDatabase(OverrideDatabase &database) {
     database = OverrideDatabase();
 }
 
-static u32 GetEntryAppliedWordCount(u32 entryCapacity) {
-    return (entryCapacity + 31) >> 5;
-}
-
-static void ClearEntryAppliedBits(u32 *entryAppliedBits, u32 entryCapacity) {
-    if (entryAppliedBits == nullptr) return;
-    memset(entryAppliedBits, 0, sizeof(u32) * GetEntryAppliedWordCount(entryCapacity));
-}
-
-static void MarkEntryApplied(u32 *entryAppliedBits, u32 entryIndex) {
-    if (entryAppliedBits == nullptr) return;
-    entryAppliedBits[entryIndex >> 5] |= (1u << (entryIndex & 31));
-}
-
-static bool IsEntryApplied(const u32 *entryAppliedBits, u32 entryIndex) {
-    if (entryAppliedBits == nullptr) return false;
-    return (entryAppliedBits[entryIndex >> 5] & (1u << (entryIndex & 31))) != 0;
-}
-
-static u32 CountAppliedEntries(const u32 *entryAppliedBits, u32 entryCapacity) {
-    u32 appliedCount = 0;
-    for (u32 i = 0; i < entryCapacity; ++i) {
-        if (IsEntryApplied(entryAppliedBits, i)) ++appliedCount;
-    }
-    return appliedCount;
-}
-
-static u32 GetLooseOverrideScratchFootprint(u32 nodeCapacity, u32 entryCapacity, u32 repackCapacity,
-                                            u32 basenameHashCapacity, bool useWideBasenameIndices) {
-    u32 footprint = 0;
-    footprint += Align32(sizeof(u16) * nodeCapacity);
-    footprint += Align32(sizeof(u32) * GetEntryAppliedWordCount(entryCapacity));
-    if (useWideBasenameIndices) {
-        footprint += Align32(sizeof(s32) * nodeCapacity);
-        footprint += Align32(sizeof(s32) * basenameHashCapacity);
-    } else {
-        footprint += Align32(sizeof(u16) * nodeCapacity);
-        footprint += Align32(sizeof(u16) * basenameHashCapacity);
-    }
-    if (repackCapacity > 0) {
-        footprint += Align32(sizeof(u32) * repackCapacity) * 4;
-    }
-    return footprint;
-}
-
-static u32 GetLooseOverrideScratchFootprint(const LooseOverrideScratch &scratch) {
-    return GetLooseOverrideScratchFootprint(scratch.nodeOverrideCapacity, scratch.entryAppliedCapacity,
-                                            scratch.repackCapacity, scratch.basenameHashCapacity,
-                                            scratch.useWideBasenameIndices);
-}
-
-static void FreeLooseOverrideScratch(LooseOverrideScratch &scratch) {
-    if (scratch.heap != nullptr) {
-        if (scratch.nodeOverrideIndex != nullptr) EGG::Heap::free(scratch.nodeOverrideIndex, scratch.heap);
-        if (scratch.entryAppliedBits != nullptr) EGG::Heap::free(scratch.entryAppliedBits, scratch.heap);
-        if (scratch.basenameHashHeads16 != nullptr) EGG::Heap::free(scratch.basenameHashHeads16, scratch.heap);
-        if (scratch.basenameHashNext16 != nullptr) EGG::Heap::free(scratch.basenameHashNext16, scratch.heap);
-        if (scratch.basenameHashHeads32 != nullptr) EGG::Heap::free(scratch.basenameHashHeads32, scratch.heap);
-        if (scratch.basenameHashNext32 != nullptr) EGG::Heap::free(scratch.basenameHashNext32, scratch.heap);
-        if (scratch.repackOffsets != nullptr) EGG::Heap::free(scratch.repackOffsets, scratch.heap);
-        if (scratch.repackSizes != nullptr) EGG::Heap::free(scratch.repackSizes, scratch.heap);
-        if (scratch.repackOriginalSizes != nullptr) EGG::Heap::free(scratch.repackOriginalSizes, scratch.heap);
-        if (scratch.repackOrder != nullptr) EGG::Heap::free(scratch.repackOrder, scratch.heap);
-    }
-    scratch = LooseOverrideScratch();
-}
-
-static EGG::Heap *GetOverridesHeap();
-
-static EGG::Heap *GetLooseOverrideScratchHeap(u32 requiredSize, EGG::Heap *fallbackHeap) {
-    const u32 currentFootprint = GetLooseOverrideScratchFootprint(sLooseOverrideScratch);
-    HeapCandidate candidates[5];
-    candidates[0].heap = RKSystem::mInstance.EGGRootMEM2;
-    candidates[0].reclaimedBytes = 0;
-    candidates[1].heap = sLooseOverrideScratch.heap;
-    // Scratch contents are transient per archive load, so growth can reclaim the old buffers first.
-    candidates[1].reclaimedBytes = currentFootprint;
-    candidates[2].heap = GetOverridesHeap();
-    candidates[2].reclaimedBytes = 0;
-    candidates[3].heap = RKSystem::mInstance.EGGRootMEM1;
-    candidates[3].reclaimedBytes = 0;
-    candidates[4].heap = fallbackHeap;
-    candidates[4].reclaimedBytes = 0;
-    return FindHeapWithSpace(candidates, 5, requiredSize);
-}
-
-static bool EnsureLooseOverrideScratchCapacity(u32 nodeCapacity, u32 entryCapacity, u32 repackCapacity,
-                                               EGG::Heap *fallbackHeap) {
-    if (nodeCapacity == 0 || entryCapacity == 0) return false;
-    const u32 basenameHashCapacity = GetBasenameHashCapacity(nodeCapacity);
-    const bool useWideBasenameIndices = sLooseOverrideScratch.useWideBasenameIndices || (nodeCapacity > 65534);
-    if (sLooseOverrideScratch.nodeOverrideCapacity >= nodeCapacity &&
-        sLooseOverrideScratch.entryAppliedCapacity >= entryCapacity &&
-        sLooseOverrideScratch.basenameHashCapacity >= basenameHashCapacity &&
-        sLooseOverrideScratch.repackCapacity >= repackCapacity &&
-        sLooseOverrideScratch.useWideBasenameIndices == useWideBasenameIndices &&
-        sLooseOverrideScratch.nodeOverrideIndex != nullptr && sLooseOverrideScratch.entryAppliedBits != nullptr &&
-        ((useWideBasenameIndices && sLooseOverrideScratch.basenameHashHeads32 != nullptr &&
-          sLooseOverrideScratch.basenameHashNext32 != nullptr) ||
-         (!useWideBasenameIndices && sLooseOverrideScratch.basenameHashHeads16 != nullptr &&
-          sLooseOverrideScratch.basenameHashNext16 != nullptr)) &&
-        (repackCapacity == 0 ||
-         (sLooseOverrideScratch.repackOffsets != nullptr && sLooseOverrideScratch.repackSizes != nullptr &&
-          sLooseOverrideScratch.repackOriginalSizes != nullptr && sLooseOverrideScratch.repackOrder != nullptr))) {
-        return true;
-    }
-
-    const u32 targetNodeCapacity = MaxU32(sLooseOverrideScratch.nodeOverrideCapacity, nodeCapacity);
-    const u32 targetEntryCapacity = MaxU32(sLooseOverrideScratch.entryAppliedCapacity, entryCapacity);
-    const u32 targetBasenameHashCapacity = MaxU32(sLooseOverrideScratch.basenameHashCapacity, basenameHashCapacity);
-    const u32 targetRepackCapacity = MaxU32(sLooseOverrideScratch.repackCapacity, repackCapacity);
-    const u32 requiredSize = GetLooseOverrideScratchFootprint(targetNodeCapacity, targetEntryCapacity,
-                                                              targetRepackCapacity, targetBasenameHashCapacity,
-                                                              useWideBasenameIndices);
-
-    EGG::Heap *heap = GetLooseOverrideScratchHeap(requiredSize, fallbackHeap);
-    if (heap == nullptr) {
-        return false;
-    }
-
-    FreeLooseOverrideScratch(sLooseOverrideScratch);
-
-    sLooseOverrideScratch.nodeOverrideIndex = EGG::Heap::alloc<u16>(sizeof(u16) * targetNodeCapacity, 0x20, heap);
-    sLooseOverrideScratch.entryAppliedBits =
-        EGG::Heap::alloc<u32>(sizeof(u32) * GetEntryAppliedWordCount(targetEntryCapacity), 0x20, heap);
-    if (useWideBasenameIndices) {
-        sLooseOverrideScratch.basenameHashHeads32 =
-            EGG::Heap::alloc<s32>(sizeof(s32) * targetBasenameHashCapacity, 0x20, heap);
-        sLooseOverrideScratch.basenameHashNext32 =
-            EGG::Heap::alloc<s32>(sizeof(s32) * targetNodeCapacity, 0x20, heap);
-    } else {
-        sLooseOverrideScratch.basenameHashHeads16 =
-            EGG::Heap::alloc<u16>(sizeof(u16) * targetBasenameHashCapacity, 0x20, heap);
-        sLooseOverrideScratch.basenameHashNext16 =
-            EGG::Heap::alloc<u16>(sizeof(u16) * targetNodeCapacity, 0x20, heap);
-    }
-    if (targetRepackCapacity > 0) {
-        sLooseOverrideScratch.repackOffsets = EGG::Heap::alloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
-        sLooseOverrideScratch.repackSizes = EGG::Heap::alloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
-        sLooseOverrideScratch.repackOriginalSizes =
-            EGG::Heap::alloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
-        sLooseOverrideScratch.repackOrder = EGG::Heap::alloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
-    }
-
-    if (sLooseOverrideScratch.nodeOverrideIndex == nullptr || sLooseOverrideScratch.entryAppliedBits == nullptr ||
-        (useWideBasenameIndices &&
-         (sLooseOverrideScratch.basenameHashHeads32 == nullptr || sLooseOverrideScratch.basenameHashNext32 == nullptr)) ||
-        (!useWideBasenameIndices &&
-         (sLooseOverrideScratch.basenameHashHeads16 == nullptr || sLooseOverrideScratch.basenameHashNext16 == nullptr)) ||
-        (targetRepackCapacity > 0 &&
-         (sLooseOverrideScratch.repackOffsets == nullptr || sLooseOverrideScratch.repackSizes == nullptr ||
-          sLooseOverrideScratch.repackOriginalSizes == nullptr || sLooseOverrideScratch.repackOrder == nullptr))) {
-        FreeLooseOverrideScratch(sLooseOverrideScratch);
-        return false;
-    }
-
-    sLooseOverrideScratch.nodeOverrideCapacity = targetNodeCapacity;
-    sLooseOverrideScratch.entryAppliedCapacity = targetEntryCapacity;
-    sLooseOverrideScratch.basenameHashCapacity = targetBasenameHashCapacity;
-    sLooseOverrideScratch.useWideBasenameIndices = useWideBasenameIndices;
-    sLooseOverrideScratch.repackCapacity = targetRepackCapacity;
-    sLooseOverrideScratch.heap = heap;
-    return true;
-}
-
-static void BuildArchiveBasenameLookup16(const U8Node *nodes, u32 nodeCount, char *stringTable, u16 *bucketHeads,
-                                         u32 bucketCount, u16 *nextNode) {
-    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0) {
-        return;
-    }
-
-    memset(bucketHeads, 0xFF, sizeof(u16) * bucketCount);
-    memset(nextNode, 0xFF, sizeof(u16) * nodeCount);
-
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
-        if (IsEmpty(nodeName)) continue;
-
-        const u32 bucket = HashString(nodeName, false) & (bucketCount - 1);
-        nextNode[nodeIdx] = bucketHeads[bucket];
-        bucketHeads[bucket] = static_cast<u16>(nodeIdx);
-    }
-}
-
-static void BuildArchiveBasenameLookup32(const U8Node *nodes, u32 nodeCount, char *stringTable, s32 *bucketHeads,
-                                         u32 bucketCount, s32 *nextNode) {
-    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0) {
-        return;
-    }
-
-    memset(bucketHeads, 0xFF, sizeof(s32) * bucketCount);
-    memset(nextNode, 0xFF, sizeof(s32) * nodeCount);
-
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
-        if (IsEmpty(nodeName)) continue;
-
-        const u32 bucket = HashString(nodeName, false) & (bucketCount - 1);
-        nextNode[nodeIdx] = bucketHeads[bucket];
-        bucketHeads[bucket] = static_cast<s32>(nodeIdx);
-    }
-}
-
-static u32 MatchArchiveBasenameOverride16(const U8Node *nodes, char *stringTable, const u16 *bucketHeads,
-                                          const u16 *nextNode, u32 bucketCount, const char *basename, u16 entryIndex,
-                                          u16 *nodeOverrideIndex) {
-    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0 ||
-        IsEmpty(basename) || nodeOverrideIndex == nullptr) {
-        return 0;
-    }
-
-    const u32 bucket = HashString(basename, false) & (bucketCount - 1);
-    u32 matchCount = 0;
-    for (u16 nodeIdx = bucketHeads[bucket]; nodeIdx != kInvalidScratchIndex16; nodeIdx = nextNode[nodeIdx]) {
-        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
-        if (strcmp(nodeName, basename) != 0) continue;
-
-        // Matching nodes stay fan-out capable: a single basename override still patches every sibling file node.
-        nodeOverrideIndex[nodeIdx] = entryIndex;
-        ++matchCount;
-    }
-    return matchCount;
-}
-
-static u32 MatchArchiveBasenameOverride32(const U8Node *nodes, char *stringTable, const s32 *bucketHeads,
-                                          const s32 *nextNode, u32 bucketCount, const char *basename, u16 entryIndex,
-                                          u16 *nodeOverrideIndex) {
-    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0 ||
-        IsEmpty(basename) || nodeOverrideIndex == nullptr) {
-        return 0;
-    }
-
-    const u32 bucket = HashString(basename, false) & (bucketCount - 1);
-    u32 matchCount = 0;
-    for (s32 nodeIdx = bucketHeads[bucket]; nodeIdx >= 0; nodeIdx = nextNode[nodeIdx]) {
-        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
-        if (strcmp(nodeName, basename) != 0) continue;
-
-        nodeOverrideIndex[nodeIdx] = entryIndex;
-        ++matchCount;
-    }
-    return matchCount;
-}
-
-static void BuildArchiveFileSlotCapacities(const U8Node *nodes, u32 nodeCount, u32 archiveSize, u32 *fileOrder,
-                                           u32 *slotCapacities) {
-    if (nodes == nullptr || fileOrder == nullptr || slotCapacities == nullptr) return;
-
-    memset(slotCapacities, 0, sizeof(u32) * nodeCount);
-    u32 fileCount = 0;
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-        fileOrder[fileCount++] = nodeIdx;
-    }
-
-    // U8 node order is not guaranteed to follow file payload order, so compute
-    // in-place growth limits from a dataOffset-sorted work view.
-    for (u32 i = 1; i < fileCount; ++i) {
-        const u32 keyNode = fileOrder[i];
-        const u32 keyOffset = nodes[keyNode].dataOffset;
-        u32 insertIdx = i;
-        while (insertIdx > 0) {
-            const u32 prevNode = fileOrder[insertIdx - 1];
-            if (nodes[prevNode].dataOffset <= keyOffset) break;
-            fileOrder[insertIdx] = prevNode;
-            --insertIdx;
-        }
-        fileOrder[insertIdx] = keyNode;
-    }
-
-    for (u32 i = 0; i < fileCount; ++i) {
-        const u32 nodeIdx = fileOrder[i];
-        const u32 currentOffset = nodes[nodeIdx].dataOffset;
-        if (currentOffset >= archiveSize) continue;
-
-        u32 slotEnd = archiveSize;
-        if (i + 1 < fileCount) {
-            const u32 nextOffset = nodes[fileOrder[i + 1]].dataOffset;
-            if (nextOffset < currentOffset) continue;
-            slotEnd = (nextOffset < archiveSize) ? nextOffset : archiveSize;
-        }
-        slotCapacities[nodeIdx] = slotEnd - currentOffset;
-    }
-}
-
 static void ResetModsRootCache() {
     sModsRootChecked = false;
     sModsRootPresent = false;
@@ -1116,6 +754,9 @@ static void InvalidateOverrideIndices() {
     sOverrideIndicesAttempted = false;
     sHasWholeFileOverrides = false;
     ResetModsRootCache();
+    // Cached archives were built against the old override set.
+    ++sOverrideStateGeneration;
+    FlushArchiveCache();
 }
 
 static void GetCurrentModFolder(char *outPath, u32 outSize) {
@@ -2088,6 +1729,156 @@ static void ScanModsDir(ScanBuildState &state, u32 maxTaggedCount, u32 maxWholeF
     ScanModsDirDVD(state, maxTaggedCount, maxWholeFileCount, maxBRSARCount);
 }
 
+// Persisted index fingerprint: a listing-only walk of the same source ScanModsDir would use.
+// No file is opened here: SD entries are keyed by name, size and mtime from the listing, DVD entries by FST data.
+enum OverrideIndexSource {
+    OVERRIDEINDEXSOURCE_NONE = 0,
+    OVERRIDEINDEXSOURCE_DVD,
+    OVERRIDEINDEXSOURCE_SD
+};
+
+struct OverrideIndexFingerprint {
+    u32 source;
+    u32 entryCount;
+    u32 totalSize;
+    u32 namesHash;
+};
+
+static void HashAppend(u32 &hash, const void *data, u32 size) {
+    const u8 *bytes = static_cast<const u8 *>(data);
+    for (u32 i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+}
+
+static void AddFingerprintEntry(OverrideIndexFingerprint &fingerprint, const char *relativePath, s32 sourceEntryNum,
+                                u32 size, u32 modifiedTime) {
+    ++fingerprint.entryCount;
+    fingerprint.totalSize += size;
+    // Hash the terminator too so `ab`+`c` and `a`+`bc` listings differ.
+    HashAppend(fingerprint.namesHash, relativePath, static_cast<u32>(strlen(relativePath)) + 1);
+    HashAppend(fingerprint.namesHash, &sourceEntryNum, sizeof(sourceEntryNum));
+    HashAppend(fingerprint.namesHash, &size, sizeof(size));
+    HashAppend(fingerprint.namesHash, &modifiedTime, sizeof(modifiedTime));
+}
+
+static void FingerprintModsDirDVD(OverrideIndexFingerprint &fingerprint) {
+    u32 modsIndex = 0;
+    u32 modsEnd = 0;
+    if (!FindModsDirInFST(modsIndex, modsEnd)) return;
+
+    SetModsRootPath(kModsRoot);
+    sModsRootPresent = true;
+
+    const FSTEntry *fst = static_cast<const FSTEntry *>(OS::BootInfo::mInstance.FSTLocation);
+    const u32 entryCount = fst[0].size;
+    if (modsIndex >= entryCount || modsEnd > entryCount || modsEnd <= modsIndex) return;
+    const char *stringTable = reinterpret_cast<const char *>(fst) + (entryCount * sizeof(FSTEntry));
+
+    struct DirStackEntry {
+        u32 endIndex;
+        u32 prevLen;
+    };
+
+    DirStackEntry stack[32];
+    u32 depth = 0;
+    char relPath[OVERRIDE_MAX_PATH];
+    u32 relLen = 0;
+    relPath[0] = '\0';
+
+    // Same traversal rules as ScanModsDirDVD so both see the exact same set of files.
+    for (u32 i = modsIndex + 1; i < modsEnd; ++i) {
+        while (depth > 0 && i >= stack[depth - 1].endIndex) {
+            relLen = stack[depth - 1].prevLen;
+            relPath[relLen] = '\0';
+            --depth;
+        }
+
+        const FSTEntry &entry = fst[i];
+        const char *name = stringTable + FSTNameOffset(entry);
+        if (IsEmpty(name)) continue;
+
+        if (FSTEntryIsDir(entry)) {
+            if (depth >= 32) continue;
+            const u32 prevLen = relLen;
+            if (!AppendPath(relPath, sizeof(relPath), relLen, name)) {
+                relLen = prevLen;
+                relPath[relLen] = '\0';
+                continue;
+            }
+            stack[depth].endIndex = entry.size;
+            stack[depth].prevLen = prevLen;
+            ++depth;
+            continue;
+        }
+
+        char relativePath[OVERRIDE_MAX_PATH];
+        int relWritten = 0;
+        if (relLen > 0) {
+            relWritten = snprintf(relativePath, sizeof(relativePath), "%s/%s", relPath, name);
+        } else {
+            relWritten = snprintf(relativePath, sizeof(relativePath), "%s", name);
+        }
+        if (relWritten <= 0 || static_cast<u32>(relWritten) >= sizeof(relativePath)) continue;
+
+        // The disc image is immutable for a session, FST sizes and entry numbers already pin every file.
+        AddFingerprintEntry(fingerprint, relativePath, static_cast<s32>(i), entry.size, 0);
+    }
+    fingerprint.source = OVERRIDEINDEXSOURCE_DVD;
+}
+
+static void FingerprintModsDirFromSDIO(SDIO &io, OverrideIndexFingerprint &fingerprint) {
+    char modsPath[OVERRIDE_MAX_PATH];
+    if (!GetSDModsRootPath(modsPath, sizeof(modsPath))) return;
+    if (!io.OpenFolderStream(modsPath)) return;
+    SetModsRootPath(modsPath);
+
+    // Size and mtime come from the directory entry itself, so an edit in place that keeps the size still
+    // invalidates the index and no file has to be opened to compute the fingerprint.
+    char fileName[OVERRIDE_MAX_PATH];
+    bool isDirectory = false;
+    u32 fileSize = 0;
+    u32 modifiedTime = 0;
+    while (io.ReadFolderEntry(fileName, sizeof(fileName), isDirectory, fileSize, modifiedTime)) {
+        if (isDirectory || IsEmpty(fileName)) continue;
+
+        ParsedScannedOverride parsed;
+        const bool parsedEntry = ParseScannedOverride(fileName, parsed);
+        char archiveTagLower[OVERRIDE_MAX_NAME];
+        const bool isModdingArchive =
+            TryParseModdingArchiveName(fileName, archiveTagLower, sizeof(archiveTagLower));
+        if (!parsedEntry && !isModdingArchive) continue;
+
+        AddFingerprintEntry(fingerprint, fileName, kInvalidDVDEntryNum, fileSize, modifiedTime);
+    }
+    io.CloseFolderStream();
+    fingerprint.source = OVERRIDEINDEXSOURCE_SD;
+}
+
+static bool ComputeOverrideIndexFingerprint(OverrideIndexFingerprint &fingerprint) {
+    fingerprint.source = OVERRIDEINDEXSOURCE_NONE;
+    fingerprint.entryCount = 0;
+    fingerprint.totalSize = 0;
+    fingerprint.namesHash = 2166136261u;
+    if (!ModsRootExists()) return false;
+
+    IO *io = IO::sInstance;
+    if (io != nullptr && ShouldProbeSDModsPath()) {
+        if (io->type == IOType_SD) {
+            FingerprintModsDirFromSDIO(*static_cast<SDIO *>(io), fingerprint);
+        } else {
+            System *system = System::sInstance;
+            if (system == nullptr) return false;
+            SDIO sdIo(IOType_SD, system->heap, system->taskThread);
+            FingerprintModsDirFromSDIO(sdIo, fingerprint);
+        }
+    } else {
+        FingerprintModsDirDVD(fingerprint);
+    }
+    return fingerprint.source != OVERRIDEINDEXSOURCE_NONE;
+}
+
 static s32 CompareWholeFileEntries(const WholeFileOverrideEntry &lhs, const WholeFileOverrideEntry &rhs) {
     if (lhs.basenameHash < rhs.basenameHash) return -1;
     if (lhs.basenameHash > rhs.basenameHash) return 1;
@@ -2488,33 +2279,209 @@ static void CompactOverrideDatabase(OverrideDatabase &database, u32 taggedCapaci
     if (resizedSize != 0) database.blockSize = resizedSize;
 }
 
-static void EnsureOverrideIndicesBuilt() {
-    if (sOverrideIndicesAttempted) return;
+// On-disk copy of the compacted database block. The block only stores pool offsets and FST entry numbers,
+// so it can be written verbatim and mapped back with InitializeOverrideDatabaseViews.
+// Bump the version whenever any of the serialized entry structs change layout.
+const u32 kOverrideIndexMagic = 0x50494458;  // PIDX
+const u32 kOverrideIndexVersion = 1;
+const char kOverrideIndexFileName[] = "Patches.idx";
+
+struct OverrideIndexHeader {
+    u32 magic;
+    u32 version;
+    u32 source;
+    u32 fingerprintEntryCount;
+    u32 fingerprintTotalSize;
+    u32 fingerprintNamesHash;
+    u32 taggedCapacity;
+    u32 wholeFileCapacity;
+    u32 brsarCapacity;
+    u32 taggedCount;
+    u32 wholeFileCount;
+    u32 brsarCount;
+    u32 tagCount;
+    u32 stringPoolUsed;
+    u32 blockSize;
+    u32 blockHash;
+};
+static_assert(sizeof(OverrideIndexHeader) == 0x40, "OverrideIndexHeader size");
 
-    if (!ModsRootExists()) {
-        FreeOverrideDatabase(sOverrideDatabase);
-        sHasWholeFileOverrides = false;
-        sOverrideIndicesAttempted = true;
-        return;
-    }
+static bool GetOverrideIndexPath(char *outPath, u32 outSize) {
+    if (!HasBuffer(outPath, outSize)) return false;
 
-    sOverrideIndicesAttempted = true;
+    const System *system = System::sInstance;
+    if (system == nullptr) return false;
 
-    // Count first, then allocate tightly and fill the persistent index.
+    const char *modFolder = system->GetModFolder();
+    // Stored next to the `Patches` folder rather than inside it so the scan never sees it as an override.
+    if (IsEmpty(modFolder)) return false;
 
-    u8 brsarSlotOccupied[kBRSAROverrideSlotCount];
-    memset(brsarSlotOccupied, 0, sizeof(brsarSlotOccupied));
-    ScanBuildState countState = {nullptr, nullptr, 0, false, nullptr, 0, false, nullptr, 0, false, 0, 0,
-                                 brsarSlotOccupied};
-    ScanModsDir(countState, kMaxOverridesTotal, kMaxOverridesTotal, kMaxOverridesTotal);
+    const int written = snprintf(outPath, outSize, "%s/%s", modFolder, kOverrideIndexFileName);
+    if (written <= 0 || static_cast<u32>(written) >= outSize) return false;
+    return true;
+}
 
-    if (countState.taggedCount >= kMaxOverridesTotal) {
-        countState.taggedTruncated = true;
+static u32 HashOverrideIndexBlock(const void *block, u32 size) {
+    u32 hash = 2166136261u;
+    HashAppend(hash, block, size);
+    return hash;
+}
+
+static bool LoadOverrideIndexFromIO(IO &io, const char *path, const OverrideIndexFingerprint &fingerprint) {
+    if (!io.OpenFile(path, FILE_MODE_READ)) return false;
+
+    alignas(0x20) OverrideIndexHeader header;
+    if (io.Read(sizeof(header), &header) != sizeof(header) || header.magic != kOverrideIndexMagic ||
+        header.version != kOverrideIndexVersion || header.source != fingerprint.source ||
+        header.fingerprintEntryCount != fingerprint.entryCount ||
+        header.fingerprintTotalSize != fingerprint.totalSize ||
+        header.fingerprintNamesHash != fingerprint.namesHash) {
+        io.Close();
+        return false;
     }
-    if (countState.wholeFileCount >= kMaxOverridesTotal) {
-        countState.wholeFileTruncated = true;
+
+    const u32 blockSize = GetOverrideDatabaseFootprint(header.taggedCapacity, header.wholeFileCapacity,
+                                                       header.brsarCapacity, header.tagCount, header.stringPoolUsed);
+    if (blockSize == 0 || blockSize != header.blockSize || header.taggedCount > header.taggedCapacity ||
+        header.wholeFileCount > header.wholeFileCapacity || header.brsarCount > header.brsarCapacity ||
+        header.tagCount > header.taggedCapacity || header.stringPoolUsed == 0) {
+        io.Close();
+        return false;
     }
-    if (countState.brsarCount >= kMaxOverridesTotal) {
+
+    EGG::Heap *databaseHeap = GetPersistentOverrideHeap(blockSize);
+    void *databaseBlock = databaseHeap != nullptr ? EGG::Heap::alloc(blockSize, 0x20, databaseHeap) : nullptr;
+    if (databaseBlock == nullptr) {
+        io.Close();
+        return false;
+    }
+
+    OverrideDatabase database = {};
+    InitializeOverrideDatabaseViews(database, databaseBlock, blockSize, databaseHeap, header.taggedCapacity,
+                                    header.wholeFileCapacity, header.brsarCapacity, header.tagCount,
+                                    header.stringPoolUsed);
+    const bool readOk = io.Read(blockSize, databaseBlock) == static_cast<s32>(blockSize);
+    io.Close();
+    if (!readOk || HashOverrideIndexBlock(databaseBlock, blockSize) != header.blockHash) {
+        FreeOverrideDatabase(database);
+        return false;
+    }
+
+    database.taggedCount = header.taggedCount;
+    database.wholeFileCount = header.wholeFileCount;
+    database.brsarCount = header.brsarCount;
+    database.tagCount = header.tagCount;
+    database.stringPoolUsed = header.stringPoolUsed;
+
+    FreeOverrideDatabase(sOverrideDatabase);
+    sOverrideDatabase = database;
+    sActiveOverrideDatabase = &sOverrideDatabase;
+    sHasWholeFileOverrides = (database.wholeFileEntries != nullptr && database.wholeFileCount > 0);
+    return true;
+}
+
+static void SaveOverrideIndexToIO(IO &io, const char *path, const OverrideIndexFingerprint &fingerprint,
+                                  const OverrideDatabase &database, u32 taggedCapacity, u32 wholeFileCapacity,
+                                  u32 brsarCapacity) {
+    const u32 blockSize = GetOverrideDatabaseFootprint(taggedCapacity, wholeFileCapacity, brsarCapacity,
+                                                       database.tagCount, database.stringPoolUsed);
+    if (database.block == nullptr || blockSize > database.blockSize) return;
+
+    alignas(0x20) OverrideIndexHeader header;
+    header.magic = kOverrideIndexMagic;
+    header.version = kOverrideIndexVersion;
+    header.source = fingerprint.source;
+    header.fingerprintEntryCount = fingerprint.entryCount;
+    header.fingerprintTotalSize = fingerprint.totalSize;
+    header.fingerprintNamesHash = fingerprint.namesHash;
+    header.taggedCapacity = taggedCapacity;
+    header.wholeFileCapacity = wholeFileCapacity;
+    header.brsarCapacity = brsarCapacity;
+    header.taggedCount = database.taggedCount;
+    header.wholeFileCount = database.wholeFileCount;
+    header.brsarCount = database.brsarCount;
+    header.tagCount = database.tagCount;
+    header.stringPoolUsed = database.stringPoolUsed;
+    header.blockSize = blockSize;
+    header.blockHash = HashOverrideIndexBlock(database.block, blockSize);
+
+    if (!io.OpenFile(path, FILE_MODE_WRITE) && !io.CreateAndOpen(path, FILE_MODE_WRITE)) return;
+    // A torn write leaves a block hash mismatch, so the next boot simply rescans.
+    const bool ok = io.Overwrite(sizeof(header), &header) == sizeof(header) &&
+                    io.Write(blockSize, database.block) == static_cast<s32>(blockSize);
+    io.Close();
+    if (!ok) OS::Report("[Pulsar] Loose override index write failed: %s\n", path);
+}
+
+static bool TryLoadOverrideIndex(const OverrideIndexFingerprint &fingerprint) {
+    char path[OVERRIDE_MAX_PATH];
+    if (!GetOverrideIndexPath(path, sizeof(path))) return false;
+
+    IO *io = IO::sInstance;
+    if (io == nullptr) return false;
+    if (io->type != IOType_DOLPHIN || !IsNewChannel()) return LoadOverrideIndexFromIO(*io, path, fingerprint);
+
+    System *system = System::sInstance;
+    if (system == nullptr) return false;
+    SDIO sdIo(IOType_SD, system->heap, system->taskThread);
+    return LoadOverrideIndexFromIO(sdIo, path, fingerprint);
+}
+
+static void SaveOverrideIndex(const OverrideIndexFingerprint &fingerprint, u32 taggedCapacity,
+                              u32 wholeFileCapacity, u32 brsarCapacity) {
+    char path[OVERRIDE_MAX_PATH];
+    if (!GetOverrideIndexPath(path, sizeof(path))) return;
+
+    IO *io = IO::sInstance;
+    if (io == nullptr) return;
+    if (io->type != IOType_DOLPHIN || !IsNewChannel()) {
+        SaveOverrideIndexToIO(*io, path, fingerprint, sOverrideDatabase, taggedCapacity, wholeFileCapacity,
+                              brsarCapacity);
+        return;
+    }
+
+    System *system = System::sInstance;
+    if (system == nullptr) return;
+    SDIO sdIo(IOType_SD, system->heap, system->taskThread);
+    SaveOverrideIndexToIO(sdIo, path, fingerprint, sOverrideDatabase, taggedCapacity, wholeFileCapacity,
+                          brsarCapacity);
+}
+
+static void EnsureOverrideIndicesBuilt() {
+    if (sOverrideIndicesAttempted) return;
+
+    if (!ModsRootExists()) {
+        FreeOverrideDatabase(sOverrideDatabase);
+        sHasWholeFileOverrides = false;
+        sOverrideIndicesAttempted = true;
+        return;
+    }
+
+    sOverrideIndicesAttempted = true;
+
+    // Warm boots: a matching listing fingerprint means the saved index is still exact, skip the scan entirely.
+    OverrideIndexFingerprint fingerprint;
+    const bool hasFingerprint = ComputeOverrideIndexFingerprint(fingerprint);
+    if (hasFingerprint && TryLoadOverrideIndex(fingerprint)) {
+        OS::Report("[Pulsar] Loose override index loaded (%u files)\n", fingerprint.entryCount);
+        return;
+    }
+
+    // Count first, then allocate tightly and fill the persistent index.
+
+    u8 brsarSlotOccupied[kBRSAROverrideSlotCount];
+    memset(brsarSlotOccupied, 0, sizeof(brsarSlotOccupied));
+    ScanBuildState countState = {nullptr, nullptr, 0, false, nullptr, 0, false, nullptr, 0, false, 0, 0,
+                                 brsarSlotOccupied};
+    ScanModsDir(countState, kMaxOverridesTotal, kMaxOverridesTotal, kMaxOverridesTotal);
+
+    if (countState.taggedCount >= kMaxOverridesTotal) {
+        countState.taggedTruncated = true;
+    }
+    if (countState.wholeFileCount >= kMaxOverridesTotal) {
+        countState.wholeFileTruncated = true;
+    }
+    if (countState.brsarCount >= kMaxOverridesTotal) {
         countState.brsarTruncated = true;
     }
     if (countState.taggedTruncated) {
@@ -2591,6 +2558,10 @@ static void EnsureOverrideIndicesBuilt() {
     sOverrideDatabase = database;
     sActiveOverrideDatabase = &sOverrideDatabase;
     sHasWholeFileOverrides = (database.wholeFileEntries != nullptr && database.wholeFileCount > 0);
+
+    if (hasFingerprint) {
+        SaveOverrideIndex(fingerprint, countState.taggedCount, countState.wholeFileCount, countState.brsarCount);
+    }
 }
 
 static bool ResolveLooseBRSAROverride(u32 fileId, BRSAROverrideSlot *&outEntry, BRSAROverrideLayout &outLayout) {
@@ -2667,676 +2638,6 @@ static BOOL DVDOpenWithLooseOverride(const char *path, DVD::FileInfo *info) {
 }
 kmBranch(0x8015e2bc, DVDOpenWithLooseOverride);
 
-static u32 GetFileDataStart(const ARC::Header *header) {
-    if (header == nullptr) return 0;
-    const u32 metaEnd = header->nodeOffset + header->combinedNodeSize;
-    u32 dataStart = header->fileOffset;
-    if (dataStart < metaEnd) dataStart = metaEnd;
-    return Align32(dataStart);
-}
-
-static bool BuildStructuralAddedFiles(const PendingStructuralAddCandidate *candidates, u32 candidateCount,
-                                      PendingStructuralAdd *&outAddedFiles, u32 &outAddedFileCount,
-                                      char *&outPathPool, u32 &outPathPoolSize, u32 &outAddedNameBytes,
-                                      u32 oldStringTableSize, EGG::Heap *heap) {
-    outAddedFiles = nullptr;
-    outAddedFileCount = 0;
-    outPathPool = nullptr;
-    outPathPoolSize = 0;
-    outAddedNameBytes = 0;
-    if (candidateCount == 0) return true;
-    if (heap == nullptr) return false;
-
-    u32 uniqueCount = 0;
-    u32 pathBytes = 0;
-    u32 nameBytes = 0;
-    char previousPath[OVERRIDE_MAX_PATH];
-    previousPath[0] = '\0';
-    u16 previousParent = kInvalidScratchIndex16;
-    bool hasPrevious = false;
-
-    for (u32 i = 0; i < candidateCount; ++i) {
-        const PendingStructuralAddCandidate &candidate = candidates[i];
-        char matchName[OVERRIDE_MAX_PATH];
-        if (!GetTaggedEntryMatchName(sOverrideDatabase.taggedEntries[candidate.overrideIndex], matchName, sizeof(matchName)) ||
-            IsEmpty(matchName)) {
-            continue;
-        }
-
-        const char *basename = FindBasename(matchName);
-        if (IsEmpty(basename)) continue;
-
-        if (hasPrevious && previousParent == candidate.parentDirIndex && strcmp(previousPath, matchName) == 0) {
-            continue;
-        }
-
-        pathBytes += static_cast<u32>(strlen(matchName)) + 1;
-        nameBytes += static_cast<u32>(strlen(basename)) + 1;
-        CopyPath(previousPath, sizeof(previousPath), matchName);
-        previousParent = candidate.parentDirIndex;
-        hasPrevious = true;
-        ++uniqueCount;
-    }
-
-    if (uniqueCount == 0) return true;
-
-    PendingStructuralAdd *addedFiles = EGG::Heap::alloc<PendingStructuralAdd>(sizeof(PendingStructuralAdd) * uniqueCount,
-                                                                              0x20, heap);
-    char *pathPool = EGG::Heap::alloc<char>(pathBytes, 0x20, heap);
-    if (addedFiles == nullptr || pathPool == nullptr) {
-        if (addedFiles != nullptr) EGG::Heap::free(addedFiles, heap);
-        if (pathPool != nullptr) EGG::Heap::free(pathPool, heap);
-        return false;
-    }
-
-    uniqueCount = 0;
-    pathBytes = 0;
-    nameBytes = 0;
-    previousPath[0] = '\0';
-    previousParent = kInvalidScratchIndex16;
-    hasPrevious = false;
-
-    for (u32 i = 0; i < candidateCount; ++i) {
-        const PendingStructuralAddCandidate &candidate = candidates[i];
-        char matchName[OVERRIDE_MAX_PATH];
-        if (!GetTaggedEntryMatchName(sOverrideDatabase.taggedEntries[candidate.overrideIndex], matchName, sizeof(matchName)) ||
-            IsEmpty(matchName)) {
-            continue;
-        }
-
-        const char *basename = FindBasename(matchName);
-        if (IsEmpty(basename)) continue;
-
-        if (hasPrevious && previousParent == candidate.parentDirIndex && strcmp(previousPath, matchName) == 0) {
-            addedFiles[uniqueCount - 1].overrideIndex = candidate.overrideIndex;
-            continue;
-        }
-
-        const u32 fullLen = static_cast<u32>(strlen(matchName)) + 1;
-        const u32 nameLen = static_cast<u32>(strlen(basename)) + 1;
-        memcpy(pathPool + pathBytes, matchName, fullLen);
-
-        addedFiles[uniqueCount].parentDirIndex = candidate.parentDirIndex;
-        addedFiles[uniqueCount].overrideIndex = candidate.overrideIndex;
-        addedFiles[uniqueCount].pathOffset = pathBytes;
-        addedFiles[uniqueCount].nameOffset = oldStringTableSize + nameBytes;
-
-        pathBytes += fullLen;
-        nameBytes += nameLen;
-        CopyPath(previousPath, sizeof(previousPath), matchName);
-        previousParent = candidate.parentDirIndex;
-        hasPrevious = true;
-        ++uniqueCount;
-    }
-
-    outAddedFiles = addedFiles;
-    outAddedFileCount = uniqueCount;
-    outPathPool = pathPool;
-    outPathPoolSize = pathBytes;
-    outAddedNameBytes = nameBytes;
-    return true;
-}
-
-struct StructuralRebuildContext {
-    const U8Node *oldNodes;
-    u32 oldNodeCount;
-    const char *oldStringTable;
-    const u16 *nodeOverrideIndex;
-    const u8 *nodeDeleteFlags;
-    const PendingStructuralAdd *addedFiles;
-    u32 addedFileCount;
-    const char *addedPathPool;
-    u8 *addedFileEmitted;
-    const u8 *dirKeepFlags;
-    EGG::Heap *tempHeap;
-    u32 childScratchCapacity;
-    u8 *oldArchiveBase;
-    u8 *newBuffer;
-    U8Node *newNodes;
-    char *newStringTable;
-    u32 newStringTableSize;
-    u32 nextStringOffset;
-    u32 writeOffset;
-    u32 nextNodeIndex;
-    u32 patchedNodes;
-    u32 rangeStart;
-    u32 *entryAppliedBits;
-};
-
-static bool AppendStructuralString(StructuralRebuildContext &context, const char *name, u32 &outOffset) {
-    if (name == nullptr) name = "";
-    const u32 nameBytes = strlen(name) + 1;
-    if (context.newStringTable == nullptr || context.nextStringOffset + nameBytes > context.newStringTableSize) {
-        return false;
-    }
-
-    outOffset = context.nextStringOffset;
-    memcpy(context.newStringTable + outOffset, name, nameBytes);
-    context.nextStringOffset += nameBytes;
-    return true;
-}
-
-static void ZeroStructuralFilePadding(u8 *buffer, u32 offset, u32 size) {
-    if (buffer == nullptr) return;
-    const u32 paddedSize = Align32(size);
-    if (paddedSize > size) {
-        memset(buffer + offset + size, 0, paddedSize - size);
-    }
-}
-
-static const char *GetStructuralAddedBasename(u32 addedIndex, const StructuralRebuildContext &context);
-
-static bool EmitStructuralExistingFileNode(u32 oldNodeIdx, StructuralRebuildContext &context) {
-    const U8Node &oldNode = context.oldNodes[oldNodeIdx];
-    const u16 idx = context.nodeOverrideIndex[oldNodeIdx];
-
-    const u32 newNodeIdx = context.nextNodeIndex++;
-    U8Node &newNode = context.newNodes[newNodeIdx];
-    u32 nameOffset = 0;
-    if (!AppendStructuralString(context, context.oldStringTable + NodeNameOffset(oldNode), nameOffset)) {
-        return false;
-    }
-    newNode.typeName = nameOffset;
-
-    const u32 writeOffset = Align32(context.writeOffset);
-    newNode.dataOffset = writeOffset;
-    newNode.dataSize = (idx != kInvalidScratchIndex16) ? sOverrideDatabase.taggedEntries[idx].size : oldNode.dataSize;
-
-    if (idx != kInvalidScratchIndex16) {
-        const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[idx];
-        if (!ReadOverrideFile(entry, context.newBuffer + writeOffset)) {
-            return false;
-        }
-        MarkEntryApplied(context.entryAppliedBits, idx - context.rangeStart);
-        ++context.patchedNodes;
-    } else {
-        memcpy(context.newBuffer + writeOffset, context.oldArchiveBase + oldNode.dataOffset, oldNode.dataSize);
-    }
-
-    const u32 paddedSize = Align32(newNode.dataSize);
-    ZeroStructuralFilePadding(context.newBuffer, writeOffset, newNode.dataSize);
-    context.writeOffset = writeOffset + paddedSize;
-    return true;
-}
-
-static bool EmitStructuralAddedFileNode(u32 addedIndex, StructuralRebuildContext &context) {
-    const PendingStructuralAdd &added = context.addedFiles[addedIndex];
-    const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[added.overrideIndex];
-
-    const u32 newNodeIdx = context.nextNodeIndex++;
-    U8Node &newNode = context.newNodes[newNodeIdx];
-    u32 nameOffset = 0;
-    if (!AppendStructuralString(context, GetStructuralAddedBasename(addedIndex, context), nameOffset)) {
-        return false;
-    }
-    newNode.typeName = nameOffset;
-
-    const u32 writeOffset = Align32(context.writeOffset);
-    newNode.dataOffset = writeOffset;
-    newNode.dataSize = entry.size;
-
-    if (!ReadOverrideFile(entry, context.newBuffer + writeOffset)) {
-        return false;
-    }
-
-    const u32 paddedSize = Align32(newNode.dataSize);
-    ZeroStructuralFilePadding(context.newBuffer, writeOffset, newNode.dataSize);
-    context.writeOffset = writeOffset + paddedSize;
-
-    MarkEntryApplied(context.entryAppliedBits, added.overrideIndex - context.rangeStart);
-    ++context.patchedNodes;
-    return true;
-}
-
-static const char *GetStructuralAddedPath(u32 addedIndex, const StructuralRebuildContext &context) {
-    if (context.addedFiles == nullptr || context.addedPathPool == nullptr ||
-        addedIndex >= context.addedFileCount) {
-        return nullptr;
-    }
-    return context.addedPathPool + context.addedFiles[addedIndex].pathOffset;
-}
-
-static const char *GetStructuralAddedBasename(u32 addedIndex, const StructuralRebuildContext &context) {
-    const char *path = GetStructuralAddedPath(addedIndex, context);
-    if (path == nullptr) return nullptr;
-    return FindBasename(path);
-}
-
-static bool StructuralDirectoryHasDirectAdditions(u32 oldDirIdx, const PendingStructuralAdd *addedFiles,
-                                                  u32 addedFileCount) {
-    for (u32 addedIdx = 0; addedIdx < addedFileCount; ++addedIdx) {
-        if (addedFiles[addedIdx].parentDirIndex == oldDirIdx) return true;
-    }
-    return false;
-}
-
-static bool MarkStructuralKeptDirectories(u32 oldDirIdx, const U8Node *nodes, const u8 *nodeDeleteFlags,
-                                          const PendingStructuralAdd *addedFiles, u32 addedFileCount,
-                                          u8 *dirKeepFlags) {
-    bool hasContent = (oldDirIdx == 0) || StructuralDirectoryHasDirectAdditions(oldDirIdx, addedFiles, addedFileCount);
-
-    u32 childIdx = oldDirIdx + 1;
-    const u32 dirEnd = nodes[oldDirIdx].dataSize;
-    while (childIdx < dirEnd) {
-        const U8Node &child = nodes[childIdx];
-        if (NodeIsDir(child)) {
-            if (MarkStructuralKeptDirectories(childIdx, nodes, nodeDeleteFlags, addedFiles, addedFileCount,
-                                              dirKeepFlags)) {
-                hasContent = true;
-            }
-            childIdx = child.dataSize;
-            continue;
-        }
-
-        if (nodeDeleteFlags[childIdx] == 0) {
-            hasContent = true;
-        }
-        ++childIdx;
-    }
-
-    dirKeepFlags[oldDirIdx] = hasContent ? 1 : 0;
-    return hasContent;
-}
-
-static void MarkDeletedOverridesInSubtree(u32 oldDirIdx, StructuralRebuildContext &context) {
-    const u32 dirEnd = context.oldNodes[oldDirIdx].dataSize;
-    for (u32 nodeIdx = oldDirIdx + 1; nodeIdx < dirEnd; ++nodeIdx) {
-        if (NodeIsDir(context.oldNodes[nodeIdx])) continue;
-        if (context.nodeDeleteFlags[nodeIdx] == 0) continue;
-
-        const u16 deleteIdx = context.nodeOverrideIndex[nodeIdx];
-        if (deleteIdx == kInvalidScratchIndex16) continue;
-
-        MarkEntryApplied(context.entryAppliedBits, deleteIdx - context.rangeStart);
-        ++context.patchedNodes;
-    }
-}
-
-static bool EmitStructuralDirectoryChildren(u32 oldDirIdx, u32 parentNewIdx, StructuralRebuildContext &context);
-
-static bool EmitStructuralDirectoryNode(u32 oldDirIdx, u32 parentNewIdx, StructuralRebuildContext &context) {
-    const u32 newDirIdx = context.nextNodeIndex++;
-    U8Node &newDir = context.newNodes[newDirIdx];
-    u32 nameOffset = 0;
-    if (!AppendStructuralString(context, context.oldStringTable + NodeNameOffset(context.oldNodes[oldDirIdx]),
-                                nameOffset)) {
-        return false;
-    }
-    newDir.typeName = 0x01000000u | nameOffset;
-    newDir.dataOffset = parentNewIdx;
-    newDir.dataSize = newDirIdx + 1;
-
-    if (!EmitStructuralDirectoryChildren(oldDirIdx, newDirIdx, context)) return false;
-
-    newDir.dataSize = context.nextNodeIndex;
-    return true;
-}
-
-static bool EmitStructuralDirectoryChildren(u32 oldDirIdx, u32 parentNewIdx, StructuralRebuildContext &context) {
-    if (context.tempHeap == nullptr || context.childScratchCapacity == 0) return false;
-
-    StructuralChildRef *children = EGG::Heap::alloc<StructuralChildRef>(
-        sizeof(StructuralChildRef) * context.childScratchCapacity, 0x20, context.tempHeap);
-    if (children == nullptr) return false;
-
-    u32 childCount = 0;
-    u32 childIdx = oldDirIdx + 1;
-    const u32 dirEnd = context.oldNodes[oldDirIdx].dataSize;
-    while (childIdx < dirEnd) {
-        const U8Node &child = context.oldNodes[childIdx];
-        const char *childName = context.oldStringTable + NodeNameOffset(child);
-        if (NodeIsDir(child)) {
-            if (context.dirKeepFlags != nullptr && context.dirKeepFlags[childIdx] == 0) {
-                MarkDeletedOverridesInSubtree(childIdx, context);
-                childIdx = child.dataSize;
-                continue;
-            }
-
-            if (childCount >= context.childScratchCapacity) {
-                EGG::Heap::free(children, context.tempHeap);
-                return false;
-            }
-            children[childCount].oldNodeIndex = childIdx;
-            children[childCount].addedFileIndex = 0;
-            children[childCount].name = childName;
-            children[childCount].isAddedFile = false;
-            ++childCount;
-            childIdx = child.dataSize;
-            continue;
-        }
-
-        if (context.nodeDeleteFlags[childIdx] != 0) {
-            const u16 deleteIdx = context.nodeOverrideIndex[childIdx];
-            if (deleteIdx != kInvalidScratchIndex16) {
-                MarkEntryApplied(context.entryAppliedBits, deleteIdx - context.rangeStart);
-                ++context.patchedNodes;
-            }
-        } else {
-            if (childCount >= context.childScratchCapacity) {
-                EGG::Heap::free(children, context.tempHeap);
-                return false;
-            }
-            children[childCount].oldNodeIndex = childIdx;
-            children[childCount].addedFileIndex = 0;
-            children[childCount].name = childName;
-            children[childCount].isAddedFile = false;
-            ++childCount;
-        }
-        ++childIdx;
-    }
-
-    for (u32 addedIdx = 0; addedIdx < context.addedFileCount; ++addedIdx) {
-        if (context.addedFileEmitted != nullptr && context.addedFileEmitted[addedIdx] != 0) continue;
-        if (context.addedFiles[addedIdx].parentDirIndex != oldDirIdx) continue;
-
-        const char *addedName = GetStructuralAddedBasename(addedIdx, context);
-        if (IsEmpty(addedName)) continue;
-        if (childCount >= context.childScratchCapacity) {
-            EGG::Heap::free(children, context.tempHeap);
-            return false;
-        }
-
-        children[childCount].oldNodeIndex = 0;
-        children[childCount].addedFileIndex = addedIdx;
-        children[childCount].name = addedName;
-        children[childCount].isAddedFile = true;
-        ++childCount;
-    }
-
-    bool success = true;
-    for (u32 sortedIdx = 0; sortedIdx < childCount; ++sortedIdx) {
-        const StructuralChildRef childRef = children[sortedIdx];
-        if (childRef.isAddedFile) {
-            if (context.addedFileEmitted != nullptr) context.addedFileEmitted[childRef.addedFileIndex] = 1;
-            if (!EmitStructuralAddedFileNode(childRef.addedFileIndex, context)) {
-                success = false;
-                break;
-            }
-            continue;
-        }
-
-        const U8Node &child = context.oldNodes[childRef.oldNodeIndex];
-        if (NodeIsDir(child)) {
-            if (!EmitStructuralDirectoryNode(childRef.oldNodeIndex, parentNewIdx, context)) {
-                success = false;
-                break;
-            }
-        } else if (!EmitStructuralExistingFileNode(childRef.oldNodeIndex, context)) {
-            success = false;
-            break;
-        }
-    }
-
-    EGG::Heap::free(children, context.tempHeap);
-    return success;
-}
-
-static bool EmitStructuralRootNode(u32 oldRootIdx, StructuralRebuildContext &context) {
-    const u32 newRootIdx = context.nextNodeIndex++;
-    U8Node &newRoot = context.newNodes[newRootIdx];
-    u32 rootNameOffset = 0;
-    if (!AppendStructuralString(context, context.oldStringTable + NodeNameOffset(context.oldNodes[oldRootIdx]),
-                                rootNameOffset)) {
-        return false;
-    }
-    newRoot.typeName = 0x01000000u | rootNameOffset;
-    newRoot.dataOffset = context.oldNodes[oldRootIdx].dataOffset;
-    newRoot.dataSize = newRootIdx + 1;
-
-    if (!EmitStructuralDirectoryChildren(oldRootIdx, newRootIdx, context)) {
-        return false;
-    }
-
-    newRoot.dataSize = context.nextNodeIndex;
-    return true;
-}
-
-static u32 CountStructuralKeptOldNameBytes(u32 oldDirIdx, const U8Node *nodes, const char *stringTable,
-                                           const u8 *nodeDeleteFlags, const u8 *dirKeepFlags) {
-    if (nodes == nullptr || stringTable == nullptr) return 0;
-
-    u32 total = 0;
-    u32 childIdx = oldDirIdx + 1;
-    const u32 dirEnd = nodes[oldDirIdx].dataSize;
-    while (childIdx < dirEnd) {
-        const U8Node &child = nodes[childIdx];
-        if (NodeIsDir(child)) {
-            if (dirKeepFlags == nullptr || dirKeepFlags[childIdx] != 0) {
-                const char *name = stringTable + NodeNameOffset(child);
-                total += strlen(name) + 1;
-                total += CountStructuralKeptOldNameBytes(childIdx, nodes, stringTable, nodeDeleteFlags, dirKeepFlags);
-            }
-            childIdx = child.dataSize;
-            continue;
-        }
-
-        if (nodeDeleteFlags == nullptr || nodeDeleteFlags[childIdx] == 0) {
-            const char *name = stringTable + NodeNameOffset(child);
-            total += strlen(name) + 1;
-        }
-        ++childIdx;
-    }
-    return total;
-}
-
-static void FreeStructuralRebuildTemps(PendingStructuralAdd *addedFiles, char *addedPathPool, u8 *addedFileEmitted,
-                                       u8 *dirKeepFlags, EGG::Heap *heap) {
-    if (addedFiles != nullptr) EGG::Heap::free(addedFiles, heap);
-    if (addedPathPool != nullptr) EGG::Heap::free(addedPathPool, heap);
-    if (addedFileEmitted != nullptr) EGG::Heap::free(addedFileEmitted, heap);
-    if (dirKeepFlags != nullptr) EGG::Heap::free(dirKeepFlags, heap);
-}
-
-static void FreeStructuralMatchTemps(u8 *nodeDeleteFlags, PendingStructuralAddCandidate *structuralAddCandidates,
-                                     EGG::Heap *heap) {
-    if (nodeDeleteFlags != nullptr) EGG::Heap::free(nodeDeleteFlags, heap);
-    if (structuralAddCandidates != nullptr) EGG::Heap::free(structuralAddCandidates, heap);
-}
-
-static bool RebuildArchiveWithStructuralOverrides(const char *archiveBaseLower, u8 *&archiveBase, u32 &archiveSize,
-                                                  EGG::Heap *sourceHeap, EGG::Heap *&archiveHeap, ARC::Header *header,
-                                                  const U8Node *nodes, u32 nodeCount, const u16 *nodeOverrideIndex,
-                                                  const u8 *nodeDeleteFlags,
-                                                  const PendingStructuralAddCandidate *addCandidates,
-                                                  u32 addCandidateCount, u32 rangeStart, u32 taggedCandidates,
-                                                  u32 *entryAppliedBits, u32 missingOverrides, u32 *outAppliedOverrides,
-                                                  u32 *outPatchedNodes, u32 *outMissingOverrides) {
-    PendingStructuralAdd *addedFiles = nullptr;
-    char *addedPathPool = nullptr;
-    u8 *addedFileEmitted = nullptr;
-    u8 *dirKeepFlags = nullptr;
-    u32 addedPathPoolSize = 0;
-    u32 addedNameBytes = 0;
-    bool success = false;
-
-    const u32 estimatedTempBytes =
-        (header != nullptr ? header->combinedNodeSize : 0) +
-        sizeof(StructuralChildRef) * (nodeCount + addCandidateCount) + 0x10000;
-    HeapCandidate tempCandidates[4];
-    tempCandidates[0].heap = RKSystem::mInstance.EGGRootMEM2;
-    tempCandidates[0].reclaimedBytes = 0;
-    tempCandidates[1].heap = RKSystem::mInstance.EGGRootMEM1;
-    tempCandidates[1].reclaimedBytes = 0;
-    tempCandidates[2].heap = GetOverridesHeap();
-    tempCandidates[2].reclaimedBytes = 0;
-    tempCandidates[3].heap = sourceHeap;
-    tempCandidates[3].reclaimedBytes = 0;
-    EGG::Heap *tempHeap = FindHeapWithSpace(tempCandidates, 4, estimatedTempBytes);
-    if (tempHeap == nullptr) tempHeap = tempCandidates[2].heap;
-    if (tempHeap == nullptr) tempHeap = sourceHeap;
-    if (tempHeap == nullptr) {
-        OS::Report("[Pulsar] Structural rebuild early fail '%s': no temp heap\n", archiveBaseLower);
-        return false;
-    }
-
-    const u32 oldNodeBytes = sizeof(U8Node) * nodeCount;
-    if (header == nullptr || header->combinedNodeSize < oldNodeBytes) {
-        OS::Report("[Pulsar] Structural rebuild early fail '%s': bad header nodes=%u combined=0x%X\n",
-                   archiveBaseLower, nodeCount, header != nullptr ? header->combinedNodeSize : 0);
-        return false;
-    }
-    const u32 nodeOffset = header->nodeOffset;
-    const u32 oldCombinedNodeSize = header->combinedNodeSize;
-    const u32 oldStringTableSize = oldCombinedNodeSize - oldNodeBytes;
-    const char *oldStringTable = reinterpret_cast<const char *>(nodes + nodeCount);
-    if (!BuildStructuralAddedFiles(addCandidates, addCandidateCount, addedFiles, addCandidateCount, addedPathPool,
-                                   addedPathPoolSize, addedNameBytes, oldStringTableSize, tempHeap)) {
-        OS::Report("[Pulsar] Structural rebuild early fail '%s': added file list\n", archiveBaseLower);
-        return false;
-    }
-    if (addCandidateCount > 0) {
-        addedFileEmitted = EGG::Heap::alloc<u8>(addCandidateCount, 0x20, tempHeap);
-        if (addedFileEmitted == nullptr) {
-            OS::Report("[Pulsar] Structural rebuild early fail '%s': emitted flags count=%u\n", archiveBaseLower,
-                       addCandidateCount);
-            FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
-            return false;
-        }
-        memset(addedFileEmitted, 0, addCandidateCount);
-    }
-
-    dirKeepFlags = EGG::Heap::alloc<u8>(nodeCount, 0x20, tempHeap);
-    if (dirKeepFlags == nullptr) {
-        OS::Report("[Pulsar] Structural rebuild early fail '%s': dir flags nodes=%u\n", archiveBaseLower, nodeCount);
-        FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
-        return false;
-    }
-    memset(dirKeepFlags, 0, nodeCount);
-    MarkStructuralKeptDirectories(0, nodes, nodeDeleteFlags, addedFiles, addCandidateCount, dirKeepFlags);
-
-    u32 deletedFileCount = 0;
-    u32 deletedDirCount = 0;
-    u32 totalDataSize = 0;
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        if (NodeIsDir(nodes[nodeIdx])) {
-            if (dirKeepFlags[nodeIdx] == 0) ++deletedDirCount;
-            continue;
-        }
-        if (nodeDeleteFlags[nodeIdx] != 0) {
-            ++deletedFileCount;
-            continue;
-        }
-
-        u32 fileSize = nodes[nodeIdx].dataSize;
-        const u16 idx = nodeOverrideIndex[nodeIdx];
-        if (idx != kInvalidScratchIndex16) {
-            fileSize = sOverrideDatabase.taggedEntries[idx].size;
-        }
-        totalDataSize += Align32(fileSize);
-    }
-    for (u32 addedIdx = 0; addedIdx < addCandidateCount; ++addedIdx) {
-        totalDataSize += Align32(sOverrideDatabase.taggedEntries[addedFiles[addedIdx].overrideIndex].size);
-    }
-
-    const char *rootName = oldStringTable + NodeNameOffset(nodes[0]);
-    const u32 newStringTableSize = strlen(rootName) + 1 +
-                                   CountStructuralKeptOldNameBytes(0, nodes, oldStringTable, nodeDeleteFlags, dirKeepFlags) +
-                                   addedNameBytes;
-    const u32 newNodeCount = nodeCount - deletedFileCount - deletedDirCount + addCandidateCount;
-    const u32 newCombinedNodeSize = sizeof(U8Node) * newNodeCount + newStringTableSize;
-    const u32 newDataStart = Align32(nodeOffset + newCombinedNodeSize);
-    const u32 newSize = Align32(newDataStart + totalDataSize);
-
-    HeapCandidate candidates[4];
-    candidates[0].heap = archiveHeap;
-    candidates[0].reclaimedBytes = 0;
-    candidates[1].heap = RKSystem::mInstance.EGGRootMEM2;
-    candidates[1].reclaimedBytes = 0;
-    candidates[2].heap = GetOverridesHeap();
-    candidates[2].reclaimedBytes = 0;
-    candidates[3].heap = RKSystem::mInstance.EGGRootMEM1;
-    candidates[3].reclaimedBytes = 0;
-    EGG::Heap *repackHeap = FindHeapWithSpace(candidates, 4, newSize);
-
-    if (repackHeap == nullptr) {
-        OS::Report("[Pulsar] Structural rebuild fail '%s': no separate heap for old=0x%X new=0x%X\n",
-                   archiveBaseLower, archiveSize, newSize);
-        FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
-        return false;
-    }
-
-    u8 *newBuffer = static_cast<u8 *>(EGG::Heap::alloc(newSize, 0x20, repackHeap));
-    if (newBuffer == nullptr) {
-        OS::Report("[Pulsar] Structural loose override rebuild allocation failed for '%s': old=0x%X new=0x%X\n",
-                   archiveBaseLower, archiveSize, newSize);
-        FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
-        return false;
-    }
-
-    memcpy(newBuffer, archiveBase, nodeOffset);
-
-    ARC::Header *newHeader = reinterpret_cast<ARC::Header *>(newBuffer);
-    newHeader->combinedNodeSize = newCombinedNodeSize;
-    newHeader->fileOffset = newDataStart;
-    if (nodeOffset > 0x10) {
-        memset(newBuffer + 0x10, 0xCC, nodeOffset - 0x10);
-    }
-
-    U8Node *newNodes = reinterpret_cast<U8Node *>(newBuffer + newHeader->nodeOffset);
-    char *newStringTable = reinterpret_cast<char *>(newNodes + newNodeCount);
-    memset(newStringTable, 0, newStringTableSize);
-    const u32 fstEnd = nodeOffset + newCombinedNodeSize;
-    if (newDataStart > fstEnd) {
-        memset(newBuffer + fstEnd, 0, newDataStart - fstEnd);
-    }
-
-    StructuralRebuildContext context;
-    context.oldNodes = nodes;
-    context.oldNodeCount = nodeCount;
-    context.oldStringTable = oldStringTable;
-    context.nodeOverrideIndex = nodeOverrideIndex;
-    context.nodeDeleteFlags = nodeDeleteFlags;
-    context.addedFiles = addedFiles;
-    context.addedFileCount = addCandidateCount;
-    context.addedPathPool = addedPathPool;
-    context.addedFileEmitted = addedFileEmitted;
-    context.dirKeepFlags = dirKeepFlags;
-    context.tempHeap = tempHeap;
-    context.childScratchCapacity = nodeCount + addCandidateCount;
-    context.oldArchiveBase = archiveBase;
-    context.newBuffer = newBuffer;
-    context.newNodes = newNodes;
-    context.newStringTable = newStringTable;
-    context.newStringTableSize = newStringTableSize;
-    context.nextStringOffset = 0;
-    context.writeOffset = newDataStart;
-    context.nextNodeIndex = 0;
-    context.patchedNodes = 0;
-    context.rangeStart = rangeStart;
-    context.entryAppliedBits = entryAppliedBits;
-
-    success = EmitStructuralRootNode(0, context) && context.nextNodeIndex == newNodeCount &&
-              context.nextStringOffset == newStringTableSize;
-    if (!success) {
-        OS::Report("[Pulsar] Structural rebuild detail '%s': emitted=%u/%u strings=%u/%u write=0x%X/0x%X\n",
-                   archiveBaseLower, context.nextNodeIndex, newNodeCount, context.nextStringOffset, newStringTableSize,
-                   context.writeOffset, newSize);
-    }
-    if (success) {
-        const u32 finalSize = Align32(context.writeOffset);
-        if (finalSize < newSize) {
-            memset(newBuffer + finalSize, 0, newSize - finalSize);
-        }
-        OS::DCStoreRange(newBuffer, finalSize);
-
-        EGG::Heap::free(archiveBase, sourceHeap);
-        archiveBase = newBuffer;
-        archiveSize = finalSize;
-        archiveHeap = repackHeap;
-
-        const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
-        SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, context.patchedNodes,
-                          outMissingOverrides, missingOverrides);
-        OS::Report("[Pulsar] Structural loose overrides applied for '%s': applied=%u patched=%u missing=%u\n",
-                   archiveBaseLower, appliedOverrides, context.patchedNodes, missingOverrides);
-    } else {
-        EGG::Heap::free(newBuffer, repackHeap);
-    }
-
-    FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
-    return success;
-}
-
 }  // namespace
 
 bool IsModsPath(const char *path) {
@@ -3380,6 +2681,26 @@ bool HasStructuralLooseOverrides(const char *archiveBaseLower) {
     return false;
 }
 
+u32 MarkLooseOverriddenNodes(const char *archiveBaseLower, u8 *archiveBase, u32 archiveSize, u8 *outNodeFlags,
+                             u32 nodeCount) {
+    RefreshOverrideCacheState();
+    if (!AreLooseArchiveOverridesEnabled() || outNodeFlags == nullptr || IsEmpty(archiveBaseLower)) return 0;
+
+    EnsureOverrideIndicesBuilt();
+    if (sOverrideDatabase.taggedEntries == nullptr || sOverrideDatabase.taggedCount == 0) return 0;
+
+    u16 tagId = 0;
+    u32 rangeStart = 0;
+    u32 rangeEnd = 0;
+    if (!FindArchiveTagId(sOverrideDatabase, archiveBaseLower, tagId) ||
+        !FindArchiveTagRangeById(sOverrideDatabase, tagId, rangeStart, rangeEnd)) {
+        return 0;
+    }
+
+    return MarkPatchedU8Nodes(sOverrideDatabase.taggedEntries, rangeStart, rangeEnd, archiveBase, archiveSize,
+                              outNodeFlags, nodeCount);
+}
+
 bool ShouldApplyLooseOverrides(const char *path, char *archiveBaseLower, u32 archiveBaseLowerSize) {
     if (path == nullptr || !HasBuffer(archiveBaseLower, archiveBaseLowerSize)) return false;
     RefreshOverrideCacheState();
@@ -3406,78 +2727,17 @@ bool ShouldApplyLooseOverrides(const char *path, char *archiveBaseLower, u32 arc
     return true;
 }
 
-static u32 ApplyInPlaceLooseOverrides(u8 *archiveBase, U8Node *nodes, u32 nodeCount, u16 *nodeOverrideIndex,
-                                      u32 *fileSlotCapacities, u32 *entryAppliedBits, u32 rangeStart) {
-    if (archiveBase == nullptr || nodes == nullptr || nodeOverrideIndex == nullptr || fileSlotCapacities == nullptr ||
-        entryAppliedBits == nullptr) {
-        return 0;
-    }
-
-    u32 patchedNodes = 0;
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        const u16 idx = nodeOverrideIndex[nodeIdx];
-        if (idx == kInvalidScratchIndex16) continue;
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-
-        const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[idx];
-        if (entry.size > fileSlotCapacities[nodeIdx]) {
-            continue;
-        }
-
-        void *dest = archiveBase + nodes[nodeIdx].dataOffset;
-        if (!ReadOverrideFile(entry, dest)) {
-            continue;
-        }
-        if (entry.size < nodes[nodeIdx].dataSize) {
-            memset(reinterpret_cast<u8 *>(dest) + entry.size, 0, nodes[nodeIdx].dataSize - entry.size);
-        }
-        nodes[nodeIdx].dataSize = entry.size;
-        OS::DCStoreRange(dest, entry.size);
-        MarkEntryApplied(entryAppliedBits, idx - rangeStart);
-        ++patchedNodes;
-    }
-
-    if (patchedNodes > 0) {
-        OS::DCStoreRange(nodes, nodeCount * sizeof(U8Node));
-    }
-    return patchedNodes;
-}
-
-static u32 CountInPlaceOversizedOverrides(const U8Node *nodes, u32 nodeCount, const u16 *nodeOverrideIndex,
-                                          const u32 *fileSlotCapacities) {
-    if (nodes == nullptr || nodeOverrideIndex == nullptr || fileSlotCapacities == nullptr) return 0;
-
-    u32 oversizedNodes = 0;
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        const u16 idx = nodeOverrideIndex[nodeIdx];
-        if (idx == kInvalidScratchIndex16) continue;
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-        if (sOverrideDatabase.taggedEntries[idx].size > fileSlotCapacities[nodeIdx]) {
-            ++oversizedNodes;
-        }
-    }
-    return oversizedNodes;
-}
-
-bool ApplyLooseOverrides(const char *archiveBaseLower, u8 *&archiveBase, u32 &archiveSize, EGG::Heap *sourceHeap,
-                         EGG::Heap *&archiveHeap, u32 *outAppliedOverrides, u32 *outPatchedNodes,
-                         u32 *outMissingOverrides, const u8 *compressedData) {
+static bool ApplyLooseOverridesToArchive(const char *archiveBaseLower, u8 *&archiveBase, u32 &archiveSize,
+                                         EGG::Heap *sourceHeap, EGG::Heap *&archiveHeap, u32 *outAppliedOverrides,
+                                         u32 *outPatchedNodes, u32 *outMissingOverrides, const u8 *compressedData) {
     SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, 0);
     RefreshOverrideCacheState();
     if (!AreLooseArchiveOverridesEnabled()) return false;
 
-    // Resolve the tag bucket, match entries to U8 nodes, then patch in place or repack.
-    // Applied override count can differ from patched nodes when a basename fans out.
-
+    // Resolve the tag bucket here; matching and patching live in LooseArchivePatch.cpp.
     EnsureOverrideIndicesBuilt();
     if (sOverrideDatabase.taggedEntries == nullptr || sOverrideDatabase.taggedCount == 0) return false;
     if (archiveBase == nullptr || IsEmpty(archiveBaseLower)) return false;
-    if (sourceHeap == nullptr) {
-        return false;
-    }
-    if (archiveHeap == nullptr) {
-        archiveHeap = sourceHeap;
-    }
 
     u16 tagId = 0;
     if (!FindArchiveTagId(sOverrideDatabase, archiveBaseLower, tagId)) {
@@ -3489,514 +2749,48 @@ bool ApplyLooseOverrides(const char *archiveBaseLower, u8 *&archiveBase, u32 &ar
     if (!FindArchiveTagRangeById(sOverrideDatabase, tagId, rangeStart, rangeEnd)) {
         return false;
     }
-    const u32 taggedCandidates = rangeEnd - rangeStart;
-
-    ARC::Handle handle;
-    if (!ARC::InitHandle(archiveBase, &handle)) {
-        return false;
-    }
 
-    ARC::Header *header = reinterpret_cast<ARC::Header *>(archiveBase);
-    U8Node *nodes = reinterpret_cast<U8Node *>(archiveBase + header->nodeOffset);
-    const u32 nodeCount = nodes[0].dataSize;
-    if (nodeCount == 0) {
-        return false;
-    }
-
-    char *stringTable = reinterpret_cast<char *>(nodes + nodeCount);
-    if (!EnsureLooseOverrideScratchCapacity(nodeCount, taggedCandidates, nodeCount, sourceHeap)) {
-        return false;
-    }
-    // These buffers are reused across archive loads and only grow when a larger archive or candidate bucket appears.
-    u16 *nodeOverrideIndex = sLooseOverrideScratch.nodeOverrideIndex;
-    u32 *entryAppliedBits = sLooseOverrideScratch.entryAppliedBits;
-    u16 *basenameHashHeads16 = sLooseOverrideScratch.basenameHashHeads16;
-    u16 *basenameHashNext16 = sLooseOverrideScratch.basenameHashNext16;
-    s32 *basenameHashHeads32 = sLooseOverrideScratch.basenameHashHeads32;
-    s32 *basenameHashNext32 = sLooseOverrideScratch.basenameHashNext32;
-    const bool useWideBasenameIndices = sLooseOverrideScratch.useWideBasenameIndices;
-    const u32 basenameHashCapacity = sLooseOverrideScratch.basenameHashCapacity;
-    u32 *fileNodeOrder = sLooseOverrideScratch.repackOffsets;
-    u32 *fileSlotCapacities = sLooseOverrideScratch.repackSizes;
-    u32 *repackOffsets = sLooseOverrideScratch.repackOffsets;
-    u32 *repackSizes = sLooseOverrideScratch.repackSizes;
-    u32 *repackOriginalSizes = sLooseOverrideScratch.repackOriginalSizes;
-    u32 *repackOrder = sLooseOverrideScratch.repackOrder;
-
-    memset(nodeOverrideIndex, 0xFF, sizeof(u16) * nodeCount);
-    ClearEntryAppliedBits(entryAppliedBits, taggedCandidates);
-    if (useWideBasenameIndices) {
-        BuildArchiveBasenameLookup32(nodes, nodeCount, stringTable, basenameHashHeads32, basenameHashCapacity,
-                                     basenameHashNext32);
-    } else {
-        BuildArchiveBasenameLookup16(nodes, nodeCount, stringTable, basenameHashHeads16, basenameHashCapacity,
-                                     basenameHashNext16);
-    }
-    BuildArchiveFileSlotCapacities(nodes, nodeCount, archiveSize, fileNodeOrder, fileSlotCapacities);
-
-    EGG::Heap *structuralTempHeap = GetOverridesHeap();
-    if (structuralTempHeap == nullptr) structuralTempHeap = sourceHeap;
-    u8 *nodeDeleteFlags = nullptr;
-    PendingStructuralAddCandidate *structuralAddCandidates = nullptr;
-    if (structuralTempHeap != nullptr) {
-        nodeDeleteFlags = EGG::Heap::alloc<u8>(nodeCount, 0x20, structuralTempHeap);
-        structuralAddCandidates = EGG::Heap::alloc<PendingStructuralAddCandidate>(
-            sizeof(PendingStructuralAddCandidate) * taggedCandidates, 0x20, structuralTempHeap);
-    }
-    if (nodeDeleteFlags == nullptr || structuralAddCandidates == nullptr) {
-        FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
-        return false;
-    }
-    memset(nodeDeleteFlags, 0, nodeCount);
-
-    bool anyOverrides = false;
-    bool hasStructuralChanges = false;
-    u32 missingOverrides = 0;
-    u32 structuralAddCandidateCount = 0;
-
-    // Build the node -> override table. Basename-only entries fan out by design.
-    for (u32 i = rangeStart; i < rangeEnd; ++i) {
-        const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[i];
-        char matchName[OVERRIDE_MAX_PATH];
-        if (!GetTaggedEntryMatchName(entry, matchName, sizeof(matchName)) || IsEmpty(matchName)) {
-            continue;
-        }
-        const bool isDelete = (entry.flags & OVERRIDEENTRYFLAG_IS_DELETE) != 0;
-
-        if ((entry.flags & OVERRIDEENTRYFLAG_HAS_SUBPATH) != 0) {
-            s32 entryNum = ARC::ConvertPathToEntrynum(&handle, matchName);
-            if (entryNum < 0) {
-                if (!isDelete) {
-                    const char *slash = FindLastChar(matchName, '/');
-                    u16 parentDirIndex = 0;
-                    bool canAddStructuralFile = true;
-                    if (slash != nullptr) {
-                        char parentPath[OVERRIDE_MAX_PATH];
-                        const u32 parentLen = static_cast<u32>(slash - matchName);
-                        if (parentLen == 0 || parentLen + 1 > sizeof(parentPath)) {
-                            canAddStructuralFile = false;
-                        } else {
-                            memcpy(parentPath, matchName, parentLen);
-                            parentPath[parentLen] = '\0';
-                            const s32 parentEntryNum = ARC::ConvertPathToEntrynum(&handle, parentPath);
-                            if (parentEntryNum < 0 || NodeIsDir(nodes[parentEntryNum]) == 0) {
-                                canAddStructuralFile = false;
-                            } else {
-                                parentDirIndex = static_cast<u16>(parentEntryNum);
-                            }
-                        }
-                    }
-
-                    if (canAddStructuralFile && structuralAddCandidateCount < taggedCandidates) {
-                        structuralAddCandidates[structuralAddCandidateCount].parentDirIndex = parentDirIndex;
-                        structuralAddCandidates[structuralAddCandidateCount].overrideIndex = static_cast<u16>(i);
-                        ++structuralAddCandidateCount;
-                        anyOverrides = true;
-                        hasStructuralChanges = true;
-                        continue;
-                    }
-                }
-
-                // Count it as missing so logs can tell "override exists on disk" from "archive actually contains that node".
-                ++missingOverrides;
-                continue;
-            }
-            if (NodeIsDir(nodes[entryNum])) {
-                // A matching directory path is still unusable because only file payload nodes can be replaced.
-                ++missingOverrides;
-                continue;
-            }
-            nodeOverrideIndex[entryNum] = static_cast<u16>(i);
-            nodeDeleteFlags[entryNum] = isDelete ? 1 : 0;
-            if (isDelete) hasStructuralChanges = true;
-            anyOverrides = true;
-        } else {
-            const u32 matchCount = useWideBasenameIndices
-                                       ? MatchArchiveBasenameOverride32(nodes, stringTable, basenameHashHeads32,
-                                                                        basenameHashNext32, basenameHashCapacity,
-                                                                        matchName, static_cast<u16>(i), nodeOverrideIndex)
-                                       : MatchArchiveBasenameOverride16(nodes, stringTable, basenameHashHeads16,
-                                                                        basenameHashNext16, basenameHashCapacity,
-                                                                        matchName, static_cast<u16>(i), nodeOverrideIndex);
-            if (matchCount == 0) {
-                ++missingOverrides;
-                continue;
-            }
-            if (isDelete) {
-                hasStructuralChanges = true;
-                for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-                    if (nodeOverrideIndex[nodeIdx] == static_cast<u16>(i)) {
-                        nodeDeleteFlags[nodeIdx] = 1;
-                    }
-                }
-            } else {
-                for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-                    if (nodeOverrideIndex[nodeIdx] == static_cast<u16>(i)) {
-                        nodeDeleteFlags[nodeIdx] = 0;
-                    }
-                }
-            }
-            anyOverrides = true;
-        }
-    }
-
-    if (!anyOverrides) {
-        FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
-        if (missingOverrides > 0) {
-            OS::Report("[Pulsar] Loose overrides skipped for '%s': %u tagged file(s) did not match archive contents\n",
-                       archiveBaseLower, missingOverrides);
-        }
-        SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, missingOverrides);
-        return false;
-    }
-
-    if (hasStructuralChanges) {
-        const bool rebuilt = RebuildArchiveWithStructuralOverrides(
-            archiveBaseLower, archiveBase, archiveSize, sourceHeap, archiveHeap, header, nodes, nodeCount, nodeOverrideIndex,
-            nodeDeleteFlags, structuralAddCandidates, structuralAddCandidateCount, rangeStart, taggedCandidates,
-            entryAppliedBits, missingOverrides, outAppliedOverrides, outPatchedNodes, outMissingOverrides);
-        if (!rebuilt) {
-            OS::Report("[Pulsar] Structural loose override rebuild failed for '%s': candidates=%u missing=%u\n",
-                       archiveBaseLower, structuralAddCandidateCount, missingOverrides);
-        }
-        FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
-        return rebuilt;
-    }
-
-    FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
-
-    bool needsRepack = false;
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        const u16 idx = nodeOverrideIndex[nodeIdx];
-        if (idx == kInvalidScratchIndex16) continue;
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-        // In-place growth is safe as long as the replacement stays inside this
-        // node's real byte slot up to the next file payload.
-        if (sOverrideDatabase.taggedEntries[idx].size > fileSlotCapacities[nodeIdx]) {
-            needsRepack = true;
-            break;
-        }
-    }
-
-    u32 patchedNodes = 0;
-    if (!needsRepack) {
-        // Fast path: overwrite payloads in place and zero-fill shrink leftovers.
-
-        patchedNodes = ApplyInPlaceLooseOverrides(archiveBase, nodes, nodeCount, nodeOverrideIndex, fileSlotCapacities,
-                                                  entryAppliedBits, rangeStart);
-
-        const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
-
-        SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes, outMissingOverrides,
-                          missingOverrides);
-        return appliedOverrides > 0;
-    }
-
-    const u32 dataStart = GetFileDataStart(header);
-    // Repack keeps metadata and rewrites the payload region.
-    if (dataStart == 0 || dataStart > archiveSize) {
-        return false;
-    }
-
-    u32 totalDataSize = 0;
-    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-        if (NodeIsDir(nodes[nodeIdx])) continue;
-        const u16 idx = nodeOverrideIndex[nodeIdx];
-        u32 size = nodes[nodeIdx].dataSize;
-        if (idx != kInvalidScratchIndex16) {
-            // Reserve space for replacement sizes up front so the repack layout is fully known before copying.
-            size = sOverrideDatabase.taggedEntries[idx].size;
-        }
-        totalDataSize += Align32(size);
-    }
-
-    const u32 originalArchiveSize = archiveSize;
-    u32 newSize = dataStart + totalDataSize;
-    newSize = Align32(newSize);
-
-    const u32 growth = (newSize > archiveSize) ? (newSize - archiveSize) : 0;
-    EGG::Heap *repackHeap = archiveHeap;
-
-    EGG::Heap *candidates[3];
-    candidates[0] = RKSystem::mInstance.EGGRootMEM2;
-    candidates[1] = RKSystem::mInstance.EGGRootMEM1;
-    candidates[2] = GetOverridesHeap();
-
-    // Prefer a roomier heap; source-heap growth stays capped.
-
-    for (u32 i = 0; i < 3; ++i) {
-        EGG::Heap *candidate = candidates[i];
-        if (candidate == nullptr || candidate == archiveHeap) continue;
-        const u32 available = candidate->getAllocatableSize(0x20);
-        if (available < newSize) continue;
-        repackHeap = candidate;
-        break;
-    }
-
-    const bool allowSourceHeap = (growth <= kOverrideMaxGrowthOnSourceHeap);
-    bool triedSourceHeap = false;
-    u8 *newBuffer = nullptr;
-    bool useSameHeapRepack = false;
-    bool repackPartialFailure = false;
-    u32 repackOrderCount = 0;
-
-    if (repackHeap == archiveHeap && allowSourceHeap && compressedData != nullptr) {
-        // Same-heap repack is only safe when every file moves forward and no
-        // override shrinks after later files have been relocated. In that narrow
-        // case we can free the old archive, decompress the original SZS back into
-        // a new larger buffer on the same heap, and then move files downward from
-        // highest original offset to lowest without clobbering unread data.
-
-        memset(repackOffsets, 0, sizeof(u32) * nodeCount);
-        memset(repackSizes, 0, sizeof(u32) * nodeCount);
-        memset(repackOriginalSizes, 0, sizeof(u32) * nodeCount);
-        memset(repackOrder, 0, sizeof(u32) * nodeCount);
-        u32 plannedOffset = dataStart;
-        bool allOffsetsForward = true;
-        bool hasShrinkOverride = false;
-        for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-            if (NodeIsDir(nodes[nodeIdx])) continue;
-            plannedOffset = Align32(plannedOffset);
-            repackOffsets[nodeIdx] = plannedOffset;
-            const u16 idx = nodeOverrideIndex[nodeIdx];
-            repackOriginalSizes[nodeIdx] = nodes[nodeIdx].dataSize;
-            const u32 plannedSize =
-                (idx != kInvalidScratchIndex16) ? sOverrideDatabase.taggedEntries[idx].size : nodes[nodeIdx].dataSize;
-            repackSizes[nodeIdx] = plannedSize;
-            repackOrder[repackOrderCount++] = nodeIdx;
-            if (plannedOffset < nodes[nodeIdx].dataOffset) {
-                allOffsetsForward = false;
-            }
-            if (idx != kInvalidScratchIndex16 && plannedSize < nodes[nodeIdx].dataSize) {
-                // Same-heap repack cannot safely recover from a failed shrink override after later files move.
-                hasShrinkOverride = true;
-            }
-            plannedOffset += Align32(plannedSize);
-        }
-        useSameHeapRepack = allOffsetsForward && !hasShrinkOverride;
-        if (!useSameHeapRepack) {
-            repackOrderCount = 0;
-        } else {
-            // Same-heap repack must move files from the highest original offset downward.
-            for (u32 i = 1; i < repackOrderCount; ++i) {
-                const u32 keyNode = repackOrder[i];
-                const u32 keyOffset = nodes[keyNode].dataOffset;
-                u32 j = i;
-                while (j > 0) {
-                    const u32 prevNode = repackOrder[j - 1];
-                    if (nodes[prevNode].dataOffset >= keyOffset) break;
-                    repackOrder[j] = prevNode;
-                    --j;
-                }
-                repackOrder[j] = keyNode;
-            }
-        }
-    }
-
-    if (useSameHeapRepack) {
-        // Free first, then recreate from compressed data; the old decompressed buffer has no headroom for growth.
-        EGG::Heap::free(archiveBase, sourceHeap);
-        archiveBase = nullptr;
-        newBuffer = static_cast<u8 *>(EGG::Heap::alloc(newSize, 0x20, repackHeap));
-        triedSourceHeap = true;
-        if (newBuffer != nullptr) {
-            EGG::Decomp::decodeSZS(const_cast<u8 *>(compressedData), newBuffer);
-            if (newSize > originalArchiveSize) {
-                memset(newBuffer + originalArchiveSize, 0, newSize - originalArchiveSize);
-            }
-        }
-    } else if (repackHeap != archiveHeap || allowSourceHeap) {
-        newBuffer = static_cast<u8 *>(EGG::Heap::alloc(newSize, 0x20, repackHeap));
-    }
-    if (newBuffer == nullptr && repackHeap != archiveHeap) {
-        if (allowSourceHeap) {
-            repackHeap = archiveHeap;
-            newBuffer = static_cast<u8 *>(EGG::Heap::alloc(newSize, 0x20, repackHeap));
-            triedSourceHeap = true;
-        }
-    }
-    if (newBuffer == nullptr && repackHeap == archiveHeap && !triedSourceHeap && allowSourceHeap) {
-        newBuffer = static_cast<u8 *>(EGG::Heap::alloc(newSize, 0x20, repackHeap));
-        triedSourceHeap = true;
-    }
-    if (newBuffer == nullptr) {
-        OS::Report("[Pulsar] Loose override repack allocation failed for '%s': old=0x%X new=0x%X growth=0x%X%s\n",
-                   archiveBaseLower, archiveSize, newSize, growth, allowSourceHeap ? "" : " source-heap growth capped");
-        if (archiveBase == nullptr && compressedData != nullptr) {
-            // Same-heap repack may already have released the old archive, so rebuild the original before bailing out.
-            archiveBase = static_cast<u8 *>(EGG::Heap::alloc(originalArchiveSize, 0x20, sourceHeap));
-            if (archiveBase != nullptr) {
-                EGG::Decomp::decodeSZS(const_cast<u8 *>(compressedData), archiveBase);
-                archiveHeap = sourceHeap;
-                archiveSize = originalArchiveSize;
-            }
-        }
-        if (archiveBase != nullptr) {
-            ARC::Header *fallbackHeader = reinterpret_cast<ARC::Header *>(archiveBase);
-            U8Node *fallbackNodes = reinterpret_cast<U8Node *>(archiveBase + fallbackHeader->nodeOffset);
-            const u32 oversizedNodes =
-                CountInPlaceOversizedOverrides(fallbackNodes, nodeCount, nodeOverrideIndex, fileSlotCapacities);
-            if (oversizedNodes > 0) {
-                OS::Report("[Pulsar] Loose override repack fallback rejected for '%s': oversized=%u missing=%u\n",
-                           archiveBaseLower, oversizedNodes, missingOverrides);
-                SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, missingOverrides);
-                return false;
-            }
-            patchedNodes = ApplyInPlaceLooseOverrides(archiveBase, fallbackNodes, nodeCount, nodeOverrideIndex,
-                                                      fileSlotCapacities, entryAppliedBits, rangeStart);
-
-            const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
-
-            if (patchedNodes > 0) {
-                OS::Report("[Pulsar] Loose override repack fallback used for '%s': applied=%u patched=%u oversized=%u missing=%u\n",
-                           archiveBaseLower, appliedOverrides, patchedNodes, oversizedNodes, missingOverrides);
-                SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes,
-                                  outMissingOverrides, missingOverrides);
-                return true;
-            }
-        }
-        SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, missingOverrides);
-        return false;
-    }
-
-    if (!useSameHeapRepack) {
-        // Copy the untouched metadata prefix now; file payloads get rewritten into their new aligned slots below.
-        memcpy(newBuffer, archiveBase, dataStart);
-    }
-    ARC::Header *newHeader = reinterpret_cast<ARC::Header *>(newBuffer);
-    newHeader->fileOffset = dataStart;
-    U8Node *newNodes = reinterpret_cast<U8Node *>(newBuffer + newHeader->nodeOffset);
-
-    u32 writeOffset = dataStart;
-    if (useSameHeapRepack) {
-        for (u32 orderIdx = 0; orderIdx < repackOrderCount; ++orderIdx) {
-            const u32 nodeIdx = repackOrder[orderIdx];
-            const u32 oldOffset = newNodes[nodeIdx].dataOffset;
-            const u32 oldSize = newNodes[nodeIdx].dataSize;
-            const u32 newFileSize = repackSizes[nodeIdx];
-            const u32 newOffset = repackOffsets[nodeIdx];
-
-            if (newOffset != oldOffset) {
-                // Same-heap relocation can overlap source and destination ranges, so `memmove` is required.
-                memmove(newBuffer + newOffset, newBuffer + oldOffset, oldSize);
-            }
-
-            newNodes[nodeIdx].dataOffset = newOffset;
-            newNodes[nodeIdx].dataSize = newFileSize;
-        }
-
-        // Persist moved source data before invalidating cache lines for external reads.
-        OS::DCStoreRange(newBuffer, newSize);
-
-        for (u32 orderIdx = 0; orderIdx < repackOrderCount; ++orderIdx) {
-            const u32 nodeIdx = repackOrder[orderIdx];
-            const u16 idx = nodeOverrideIndex[nodeIdx];
-            if (idx == kInvalidScratchIndex16) continue;
-
-            const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[idx];
-            const u32 oldSize = repackOriginalSizes[nodeIdx];
-            const u32 newOffset = repackOffsets[nodeIdx];
-
-            if (!ReadOverrideFile(entry, newBuffer + newOffset)) {
-                // Keep metadata internally consistent; the partial repack is discarded below.
-                newNodes[nodeIdx].dataSize = oldSize;
-                repackPartialFailure = true;
-                continue;
-            }
-            MarkEntryApplied(entryAppliedBits, idx - rangeStart);
-            ++patchedNodes;
-        }
-
-        writeOffset = dataStart + totalDataSize;
-    } else {
-        for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
-            if (NodeIsDir(nodes[nodeIdx])) continue;
-
-            const u16 idx = nodeOverrideIndex[nodeIdx];
-            const u32 oldOffset = nodes[nodeIdx].dataOffset;
-            const u32 oldSize = nodes[nodeIdx].dataSize;
-            bool useOverride = (idx != kInvalidScratchIndex16);
-            u32 newFileSize = useOverride ? sOverrideDatabase.taggedEntries[idx].size : oldSize;
-
-            writeOffset = Align32(writeOffset);
-            const u32 alignedSize = Align32(newFileSize);
-            if (writeOffset + alignedSize > newSize) {
-                const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[idx];
-                const char *relativePath = GetRelativePath(entry.sourcePathOffset);
-                OS::Report("[Pulsar] Loose override '%s' skipped in '%s': repack buffer too small for 0x%X bytes\n",
-                           relativePath != nullptr ? relativePath : "<missing>", archiveBaseLower, newFileSize);
-                // Recover by copying the original member instead of throwing away the entire repack.
-                useOverride = false;
-                newFileSize = oldSize;
-                repackPartialFailure = true;
-            }
-
-            newNodes[nodeIdx].dataOffset = writeOffset;
-            if (useOverride) {
-                const TaggedOverrideEntry &entry = sOverrideDatabase.taggedEntries[idx];
-                if (!ReadOverrideFile(entry, newBuffer + writeOffset)) {
-                    // Keep the staging buffer parseable; the partial repack is discarded below.
-                    useOverride = false;
-                    newFileSize = oldSize;
-                    repackPartialFailure = true;
-                } else {
-                    MarkEntryApplied(entryAppliedBits, idx - rangeStart);
-                    ++patchedNodes;
-                }
-            }
-
-            if (!useOverride) {
-                memcpy(newBuffer + writeOffset, archiveBase + oldOffset, oldSize);
-            }
-
-            newNodes[nodeIdx].dataSize = newFileSize;
-            const u32 paddedSize = Align32(newFileSize);
-            if (paddedSize > newFileSize) {
-                memset(newBuffer + writeOffset + newFileSize, 0, paddedSize - newFileSize);
-            }
-            writeOffset += paddedSize;
-        }
-    }
-
-    const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
-    if (repackPartialFailure) {
-        OS::Report("[Pulsar] Loose override repack incomplete for '%s': applied=%u patched=%u missing=%u\n",
-                   archiveBaseLower, appliedOverrides, patchedNodes, missingOverrides);
-        if (useSameHeapRepack && compressedData != nullptr) {
-            EGG::Decomp::decodeSZS(const_cast<u8 *>(compressedData), newBuffer);
-            if (newSize > originalArchiveSize) {
-                memset(newBuffer + originalArchiveSize, 0, newSize - originalArchiveSize);
-            }
-            archiveBase = newBuffer;
-            archiveSize = originalArchiveSize;
-            archiveHeap = repackHeap;
-            OS::DCStoreRange(archiveBase, archiveSize);
-        } else {
-            EGG::Heap::free(newBuffer, repackHeap);
-        }
-        SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes, outMissingOverrides,
-                          missingOverrides);
-        return false;
-    }
-
-    u32 finalSize = Align32(writeOffset);
-    // Clamp to the allocated size so bad metadata cannot claim a larger archive than the buffer we own.
-    if (finalSize > newSize) finalSize = newSize;
-    if (!useSameHeapRepack && finalSize < newSize) {
-        memset(newBuffer + finalSize, 0, newSize - finalSize);
-    }
-    OS::DCStoreRange(newBuffer, finalSize);
-
-    if (!useSameHeapRepack) {
-        EGG::Heap::free(archiveBase, sourceHeap);
-    }
-    archiveBase = newBuffer;
-    archiveSize = finalSize;
-    archiveHeap = repackHeap;
+    return PatchU8Archive(archiveBaseLower, sOverrideDatabase.taggedEntries, rangeStart, rangeEnd, archiveBase,
+                          archiveSize, sourceHeap, archiveHeap, outAppliedOverrides, outPatchedNodes,
+                          outMissingOverrides, compressedData);
+}
 
-    SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes, outMissingOverrides,
-                      missingOverrides);
-    return appliedOverrides > 0;
+bool ApplyLooseOverrides(const char *archiveBaseLower, u8 *&archiveBase, u32 &archiveSize, EGG::Heap *sourceHeap,
+                         EGG::Heap *&archiveHeap, u32 *outAppliedOverrides, u32 *outPatchedNodes,
+                         u32 *outMissingOverrides, const u8 *compressedData) {
+#ifndef LOOSE_OVERRIDE_BENCHMARK
+    return ApplyLooseOverridesToArchive(archiveBaseLower, archiveBase, archiveSize, sourceHeap, archiveHeap,
+                                        outAppliedOverrides, outPatchedNodes, outMissingOverrides, compressedData);
+#else
+    LooseOverrideBench &bench = sLooseOverrideBench;
+    ResetLoosePatchStats();
+    const u8 *originalBase = archiveBase;
+    const u32 originalSize = archiveSize;
+    u32 applied = 0;
+    u32 patched = 0;
+    u32 missing = 0;
+
+    const u32 startTick = OS::GetTick();
+    const bool result = ApplyLooseOverridesToArchive(archiveBaseLower, archiveBase, archiveSize, sourceHeap, archiveHeap,
+                                                     &applied, &patched, &missing, compressedData);
+    const u32 ticks = OS::GetTick() - startTick;
+
+    SetOverrideResult(outAppliedOverrides, applied, outPatchedNodes, patched, outMissingOverrides, missing);
+    const LoosePatchStats &stats = GetLastLoosePatchStats();
+    if (stats.nodeCount == 0) return result;  // Rejected before any matching, nothing worth reporting.
+
+    // Scratch is persistent and only grows, so footprint plus this call's temps is the high-water mark of the call.
+    const u32 scratchBytes = GetLoosePatchScratchFootprint() + stats.tempBytes;
+    if (scratchBytes > bench.peakScratchBytes) bench.peakScratchBytes = scratchBytes;
+    ++bench.calls;
+    bench.totalTicks += ticks;
+    OS::Report("[Pulsar] LooseOverrideBench %s: nodes=%u candidates=%u applied=%u patched=%u missing=%u "
+               "size=0x%X->0x%X%s ticks=%u (%uus) scratch=0x%X peak=0x%X calls=%u total=%u ticks\n",
+               archiveBaseLower, stats.nodeCount, stats.candidates, applied, patched, missing, originalSize, archiveSize,
+               archiveBase != originalBase ? " repacked" : "", ticks, OS::TicksToMicroseconds(ticks), scratchBytes,
+               bench.peakScratchBytes, bench.calls, bench.totalTicks);
+    return result;
+#endif
 }
 
 static void ArchiveFileLoadOverride(ArchiveFile *file, const char *path, EGG::Heap *mountHeap, bool isCompressed,
@@ -4046,6 +2840,23 @@ static void ArchiveFileLoadOverride(ArchiveFile *file, const char *path, EGG::He
         dumpHeap = mountHeap;
     }
 
+    // Course and race common archives survive across races in the archive cache; a hit skips the rip and decode entirely.
+    const bool isCacheable = isCompressed != 0 && IsCacheableArchivePath(requestedPath);
+    const u32 overrideState = isCacheable ? GetLooseOverrideState() : 0;
+    bool servedFromCache = false;
+    if (isCacheable && file->status == ARCHIVE_STATUS_NONE) {
+        EGG::Heap *cachedHeap = nullptr;
+        u32 cachedSize = 0;
+        void *cached = LoadCachedArchive(requestedPath, overrideState, mountHeap, dumpHeap, cachedSize, cachedHeap);
+        if (cached != nullptr) {
+            file->rawArchive = cached;
+            file->archiveSize = cachedSize;
+            file->archiveHeap = cachedHeap;
+            file->status = ARCHIVE_STATUS_DECOMPRESSED;
+            servedFromCache = true;
+        }
+    }
+
     if (file->status == ARCHIVE_STATUS_NONE) {
         bool ripped = false;
         EGG::DvdRipper::EAllocDirection ripAlloc = EGG::DvdRipper::ALLOC_FROM_HEAD;
@@ -4060,8 +2871,15 @@ static void ArchiveFileLoadOverride(ArchiveFile *file, const char *path, EGG::He
         // Keep the original request for DVD-backed overrides so DvdFile's hooked entry lookup can return the
         // cached FST index without scanning the large `/patches` directory again.
         const char *ripPath = sourceEntryNum >= 0 ? requestedPath : finalPath;
-        void *rippedData = EGG::DvdRipper::LoadToMainRAM(ripPath, nullptr, dumpHeap, ripAlloc, 0, nullptr,
-                                                         &file->compressedArchiveSize);
+        void *rippedData = nullptr;
+        // Compressed loads overlap the rest of the read with the Yaz0 decode in Decompress.
+        if (isCompressed != 0 &&
+            BeginArchiveStream(file, ripPath, dumpHeap, ripAlloc == EGG::DvdRipper::ALLOC_FROM_TAIL)) {
+            rippedData = file->compressedArchive;
+        } else {
+            rippedData = EGG::DvdRipper::LoadToMainRAM(ripPath, nullptr, dumpHeap, ripAlloc, 0, nullptr,
+                                                       &file->compressedArchiveSize);
+        }
         if (rippedData == nullptr && redirected && requestedPath != nullptr) {
             file->compressedArchiveSize = 0;
             rippedData = EGG::DvdRipper::LoadToMainRAM(requestedPath, nullptr, dumpHeap, ripAlloc, 0, nullptr,
@@ -4080,7 +2898,9 @@ static void ArchiveFileLoadOverride(ArchiveFile *file, const char *path, EGG::He
     }
 
     if (file->status >= ARCHIVE_STATUS_DUMPED) {
-        if (isCompressed == 0) {
+        if (servedFromCache) {
+            // Already decompressed and override-applied; only the mount below is left.
+        } else if (isCompressed == 0) {
             file->rawArchive = file->compressedArchive;
             file->archiveSize = file->compressedArchiveSize;
             file->archiveHeap = file->dumpHeap;
@@ -4094,12 +2914,17 @@ static void ArchiveFileLoadOverride(ArchiveFile *file, const char *path, EGG::He
             } else {
                 file->Decompress(requestedPath, mountHeap, info);
             }
+            FinishArchiveStream(file);
             if (file->compressedArchive != nullptr && file->dumpHeap != nullptr) {
                 EGG::Heap::free(file->compressedArchive, file->dumpHeap);
                 file->compressedArchive = nullptr;
                 file->compressedArchiveSize = 0;
                 file->dumpHeap = nullptr;
             }
+            // Snapshot before mounting: g3d relocates resource offsets in place once the archive is in use.
+            if (isCacheable && file->status == ARCHIVE_STATUS_DECOMPRESSED) {
+                StoreCachedArchive(requestedPath, overrideState, file->rawArchive, file->archiveSize);
+            }
         }
 
         EGG::Archive *mounted = nullptr;
@@ -4112,6 +2937,11 @@ static void ArchiveFileLoadOverride(ArchiveFile *file, const char *path, EGG::He
 }
 kmBranch(0x80518e10, ArchiveFileLoadOverride);
 
+u32 GetLooseOverrideState() {
+    RefreshOverrideCacheState();
+    return (sOverrideStateGeneration << 1) | (AreLooseArchiveOverridesEnabled() ? 1 : 0);
+}
+
 bool AreLooseArchiveOverridesEnabledForDebug() {
     RefreshOverrideCacheState();
     return AreLooseArchiveOverridesEnabled();
@@ -4161,5 +2991,21 @@ u32 GetLooseArchiveOverrideFileCount() {
     return sOverrideDatabase.taggedCount + sOverrideDatabase.wholeFileCount + sOverrideDatabase.brsarCount;
 }
 
+namespace PatchPlatform {
+
+bool GetMatchName(const TaggedOverrideEntry &entry, char *outName, u32 outNameSize) {
+    return GetTaggedEntryMatchName(entry, outName, outNameSize);
+}
+
+bool ReadOverride(const TaggedOverrideEntry &entry, void *dest) {
+    return ReadOverrideFile(entry, dest);
+}
+
+const char *GetSourcePath(const TaggedOverrideEntry &entry) {
+    return GetRelativePath(entry.sourcePathOffset);
+}
+
+}  // namespace PatchPlatform
+
 }  // namespace IOOverrides
 }  // namespace Pulsar
@@ -16,10 +16,7 @@
 #define _PULSAR_LOOSE_ARCHIVE_OVERRIDES_
 
 #include <kamek.hpp>
-
-namespace EGG {
-class Heap;
-}
+#include <IO/LooseArchivePatch.hpp>
 
 #ifdef IO
 #undef IO
@@ -28,9 +25,6 @@ class Heap;
 namespace Pulsar {
 namespace IOOverrides {
 
-enum { OVERRIDE_MAX_PATH = 256,
-       OVERRIDE_MAX_NAME = 64 };
-
 bool IsModsPath(const char *path);
 
 const char *ResolveWholeFileOverride(const char *path, char *resolvedPath, u32 resolvedSize, bool *outRedirected);
@@ -39,6 +33,12 @@ bool ShouldApplyLooseOverrides(const char *path, char *archiveBaseLower, u32 arc
 
 bool HasStructuralLooseOverrides(const char *archiveBaseLower);
 
+// Flags every U8 node whose payload ApplyLooseOverrides would replace or delete, using only the archive's metadata.
+u32 MarkLooseOverriddenNodes(const char *archiveBaseLower, u8 *archiveBase, u32 archiveSize, u8 *outNodeFlags,
+                             u32 nodeCount);
+
+// Build with -DLOOSE_OVERRIDE_BENCHMARK to report ticks and peak scratch memory for every call. The patcher itself is
+// fuzzed and benchmarked natively, see scripts/build_loose_override_host.sh.
 bool ApplyLooseOverrides(const char *archiveBaseLower, u8 *&archiveBase, u32 &archiveSize, EGG::Heap *sourceHeap,
                          EGG::Heap *&archiveHeap, u32 *outAppliedOverrides, u32 *outPatchedNodes,
                          u32 *outMissingOverrides, const u8 *compressedData);
@@ -48,6 +48,8 @@ bool GetLooseBRSAROverrideSizes(u32 fileId, u32 &outFileSize, u32 &outWaveDataSi
 bool ReadLooseBRSAROverrideFile(u32 fileId, void *dest, u32 size);
 bool ReadLooseBRSAROverrideWaveData(u32 fileId, void *dest, u32 size);
 u32 GetLooseArchiveOverrideFileCount();
+// Changes whenever the loose override set is rebuilt or toggled; used to key caches of override-applied data.
+u32 GetLooseOverrideState();
 
 }  // namespace IOOverrides
 }  // namespace Pulsar
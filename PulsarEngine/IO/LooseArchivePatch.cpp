@@ -0,0 +1,1872 @@
+/*
+ * Loose Archive Overrides
+ *
+ * Developed by patchzy as part of the Retro Rewind project.
+ *
+ * Copyright (C) Retro Rewind.
+ * SPDX-License-Identifier: MIT
+ *
+ * This code is licensed under the MIT License.
+ *
+ * Credit is not legally required, but if you use or adapt this system,
+ * please consider crediting patchzy and/or Retro Rewind team.
+ */
+
+#include <IO/LooseArchivePatch.hpp>
+#ifdef LOOSE_OVERRIDE_HOST
+#include <stdio.h>
+#include <string.h>
+#else
+#include <include/c_stdio.h>
+#include <include/c_string.h>
+#endif
+
+namespace Pulsar {
+namespace IOOverrides {
+
+namespace {
+const u32 kOverrideMaxGrowthOnSourceHeap = 0x100000;
+const u16 kInvalidScratchIndex16 = 0xFFFFu;
+const u32 kU8Magic = 0x55aa382d;
+
+struct LooseOverrideScratch {
+    u16 *nodeOverrideIndex;
+    u32 nodeOverrideCapacity;
+    u32 *entryAppliedBits;
+    u32 entryAppliedCapacity;
+    u16 *basenameHashHeads16;
+    u16 *basenameHashNext16;
+    s32 *basenameHashHeads32;
+    s32 *basenameHashNext32;
+    u32 basenameHashCapacity;
+    bool useWideBasenameIndices;
+    u32 *repackOffsets;
+    u32 *repackSizes;
+    u32 *repackOriginalSizes;
+    u32 *repackOrder;
+    u32 repackCapacity;
+    EGG::Heap *heap;
+};
+
+struct PendingStructuralAddCandidate {
+    u16 parentDirIndex;
+    u16 overrideIndex;
+};
+
+struct PendingStructuralAdd {
+    u16 parentDirIndex;
+    u16 overrideIndex;
+    u32 pathOffset;
+    u32 nameOffset;
+};
+
+struct StructuralChildRef {
+    u32 oldNodeIndex;
+    u32 addedFileIndex;
+    const char *name;
+    bool isAddedFile;
+};
+
+struct HeapCandidate {
+    EGG::Heap *heap;
+    u32 reclaimedBytes;
+};
+
+static LooseOverrideScratch sLooseOverrideScratch = {};
+static LoosePatchStats sLastPatchStats = {};
+
+template <typename T>
+static T *HeapAlloc(u32 size, s32 align, EGG::Heap *heap) {
+    return static_cast<T *>(PatchPlatform::Alloc(size, align, heap));
+}
+
+static bool IsEmpty(const char *str) {
+    return str == nullptr || str[0] == '\0';
+}
+
+static const char *FindLastChar(const char *str, char needle) {
+    if (str == nullptr) return nullptr;
+    const char *last = nullptr;
+    const char *cursor = str;
+    while ((cursor = strchr(cursor, needle)) != nullptr) {
+        last = cursor;
+        ++cursor;
+    }
+    return last;
+}
+
+static const char *FindBasename(const char *path) {
+    if (path == nullptr) return nullptr;
+    const char *lastSlash = FindLastChar(path, '/');
+    return lastSlash ? lastSlash + 1 : path;
+}
+
+static void CopyPath(char *dest, u32 destSize, const char *src) {
+    snprintf(dest, destSize, "%s", src);
+}
+
+static u32 MaxU32(u32 lhs, u32 rhs) {
+    return lhs > rhs ? lhs : rhs;
+}
+
+static inline u32 Align32(u32 value) {
+    return (value + 0x1F) & ~0x1Fu;
+}
+
+// FNV-1a, case-sensitive like the member names it buckets
+static u32 HashName(const char *name) {
+    u32 hash = 2166136261u;
+    for (const char *cursor = name; *cursor != '\0'; ++cursor) {
+        hash ^= static_cast<u8>(*cursor);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void SetOverrideResult(u32 *outAppliedOverrides, u32 appliedOverrides, u32 *outPatchedNodes,
+                              u32 patchedNodes, u32 *outMissingOverrides, u32 missingOverrides) {
+    if (outAppliedOverrides != nullptr) *outAppliedOverrides = appliedOverrides;
+    if (outPatchedNodes != nullptr) *outPatchedNodes = patchedNodes;
+    if (outMissingOverrides != nullptr) *outMissingOverrides = missingOverrides;
+}
+
+static EGG::Heap *FindHeapWithSpace(const HeapCandidate *candidates, u32 count, u32 requiredSize) {
+    if (candidates == nullptr) return nullptr;
+
+    for (u32 i = 0; i < count; ++i) {
+        EGG::Heap *heap = candidates[i].heap;
+        if (heap == nullptr) continue;
+
+        bool alreadyChecked = false;
+        for (u32 j = 0; j < i; ++j) {
+            if (candidates[j].heap == heap && candidates[j].reclaimedBytes >= candidates[i].reclaimedBytes) {
+                alreadyChecked = true;
+                break;
+            }
+        }
+        if (alreadyChecked) continue;
+
+        if (PatchPlatform::GetAllocatableSize(heap) + candidates[i].reclaimedBytes >= requiredSize) {
+            return heap;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+// Everything below indexes nodes, names and payloads straight out of the archive, so a truncated or hand-edited SZS
+// has to be rejected here rather than read past the end of its buffer.
+bool IsValidU8Layout(const u8 *archive, u32 archiveSize, u32 metaLimit) {
+    if (archive == nullptr || metaLimit > archiveSize || metaLimit < sizeof(U8Header)) return false;
+    const U8Header *header = reinterpret_cast<const U8Header *>(archive);
+    if (header->magic != kU8Magic) return false;
+
+    const u32 nodeOffset = header->nodeOffset;
+    const u32 metaSize = header->combinedNodeSize;
+    if ((nodeOffset & 3) != 0 || nodeOffset < sizeof(U8Header) || nodeOffset > metaLimit || metaSize > metaLimit - nodeOffset) return false;
+    if (metaSize < sizeof(U8Node)) return false;
+
+    const U8Node *nodes = reinterpret_cast<const U8Node *>(archive + nodeOffset);
+    if (!NodeIsDir(nodes[0])) return false;
+    const u32 nodeCount = nodes[0].dataSize;
+    if (nodeCount == 0 || nodeCount > metaSize / sizeof(U8Node)) return false;
+
+    const char *stringTable = reinterpret_cast<const char *>(nodes + nodeCount);
+    const u32 stringTableSize = metaSize - nodeCount * sizeof(U8Node);
+    if (stringTableSize == 0 || stringTable[stringTableSize - 1] != '\0') return false;
+
+    // Innermost directory whose range holds the current node; walking up through parents keeps this linear.
+    u32 openDir = 0;
+    for (u32 nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        const U8Node &node = nodes[nodeIdx];
+        if (NodeNameOffset(node) >= stringTableSize) return false;
+        while (nodeIdx != 0 && nodeIdx >= nodes[openDir].dataSize) openDir = nodes[openDir].dataOffset;
+        if (NodeIsDir(node)) {
+            // dataOffset is the parent and dataSize the index one past the directory's last child. Ranges have to
+            // nest, or the tree walks would visit a node twice.
+            if (nodeIdx != 0 && (node.dataOffset != openDir || node.dataSize > nodes[openDir].dataSize)) return false;
+            if (node.dataSize <= nodeIdx || node.dataSize > nodeCount) return false;
+            openDir = nodeIdx;
+        } else if (nodeIdx == 0 || node.dataOffset > archiveSize || node.dataSize > archiveSize - node.dataOffset) {
+            return false;
+        } else if (node.dataSize != 0 && node.dataOffset < nodeOffset + metaSize) {
+            // Patching a payload that overlaps the metadata would rewrite the nodes being walked
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IsValidU8Layout(const u8 *archive, u32 archiveSize) {
+    return IsValidU8Layout(archive, archiveSize, archiveSize);
+}
+
+namespace {
+
+static u32 GetBasenameHashCapacity(u32 nodeCapacity) {
+    u32 capacity = 8;
+    u32 target = (nodeCapacity > 0x7FFFFFFFu) ? 0xFFFFFFFFu : (nodeCapacity * 2);
+    if (target < 8) target = 8;
+    while (capacity < target && capacity < 0x80000000u) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static u32 GetEntryAppliedWordCount(u32 entryCapacity) {
+    return (entryCapacity + 31) >> 5;
+}
+
+static void ClearEntryAppliedBits(u32 *entryAppliedBits, u32 entryCapacity) {
+    if (entryAppliedBits == nullptr) return;
+    memset(entryAppliedBits, 0, sizeof(u32) * GetEntryAppliedWordCount(entryCapacity));
+}
+
+static void MarkEntryApplied(u32 *entryAppliedBits, u32 entryIndex) {
+    if (entryAppliedBits == nullptr) return;
+    entryAppliedBits[entryIndex >> 5] |= (1u << (entryIndex & 31));
+}
+
+static bool IsEntryApplied(const u32 *entryAppliedBits, u32 entryIndex) {
+    if (entryAppliedBits == nullptr) return false;
+    return (entryAppliedBits[entryIndex >> 5] & (1u << (entryIndex & 31))) != 0;
+}
+
+static u32 CountAppliedEntries(const u32 *entryAppliedBits, u32 entryCapacity) {
+    u32 appliedCount = 0;
+    for (u32 i = 0; i < entryCapacity; ++i) {
+        if (IsEntryApplied(entryAppliedBits, i)) ++appliedCount;
+    }
+    return appliedCount;
+}
+
+static u32 GetLooseOverrideScratchFootprint(u32 nodeCapacity, u32 entryCapacity, u32 repackCapacity,
+                                            u32 basenameHashCapacity, bool useWideBasenameIndices) {
+    u32 footprint = 0;
+    footprint += Align32(sizeof(u16) * nodeCapacity);
+    footprint += Align32(sizeof(u32) * GetEntryAppliedWordCount(entryCapacity));
+    if (useWideBasenameIndices) {
+        footprint += Align32(sizeof(s32) * nodeCapacity);
+        footprint += Align32(sizeof(s32) * basenameHashCapacity);
+    } else {
+        footprint += Align32(sizeof(u16) * nodeCapacity);
+        footprint += Align32(sizeof(u16) * basenameHashCapacity);
+    }
+    if (repackCapacity > 0) {
+        footprint += Align32(sizeof(u32) * repackCapacity) * 4;
+    }
+    return footprint;
+}
+
+static u32 GetLooseOverrideScratchFootprint(const LooseOverrideScratch &scratch) {
+    return GetLooseOverrideScratchFootprint(scratch.nodeOverrideCapacity, scratch.entryAppliedCapacity,
+                                            scratch.repackCapacity, scratch.basenameHashCapacity,
+                                            scratch.useWideBasenameIndices);
+}
+
+static void FreeLooseOverrideScratch(LooseOverrideScratch &scratch) {
+    if (scratch.heap != nullptr) {
+        if (scratch.nodeOverrideIndex != nullptr) PatchPlatform::Free(scratch.nodeOverrideIndex, scratch.heap);
+        if (scratch.entryAppliedBits != nullptr) PatchPlatform::Free(scratch.entryAppliedBits, scratch.heap);
+        if (scratch.basenameHashHeads16 != nullptr) PatchPlatform::Free(scratch.basenameHashHeads16, scratch.heap);
+        if (scratch.basenameHashNext16 != nullptr) PatchPlatform::Free(scratch.basenameHashNext16, scratch.heap);
+        if (scratch.basenameHashHeads32 != nullptr) PatchPlatform::Free(scratch.basenameHashHeads32, scratch.heap);
+        if (scratch.basenameHashNext32 != nullptr) PatchPlatform::Free(scratch.basenameHashNext32, scratch.heap);
+        if (scratch.repackOffsets != nullptr) PatchPlatform::Free(scratch.repackOffsets, scratch.heap);
+        if (scratch.repackSizes != nullptr) PatchPlatform::Free(scratch.repackSizes, scratch.heap);
+        if (scratch.repackOriginalSizes != nullptr) PatchPlatform::Free(scratch.repackOriginalSizes, scratch.heap);
+        if (scratch.repackOrder != nullptr) PatchPlatform::Free(scratch.repackOrder, scratch.heap);
+    }
+    scratch = LooseOverrideScratch();
+}
+
+
+static EGG::Heap *GetLooseOverrideScratchHeap(u32 requiredSize, EGG::Heap *fallbackHeap) {
+    const u32 currentFootprint = GetLooseOverrideScratchFootprint(sLooseOverrideScratch);
+    HeapCandidate candidates[5];
+    candidates[0].heap = PatchPlatform::GetRootHeapMEM2();
+    candidates[0].reclaimedBytes = 0;
+    candidates[1].heap = sLooseOverrideScratch.heap;
+    // Scratch contents are transient per archive load, so growth can reclaim the old buffers first.
+    candidates[1].reclaimedBytes = currentFootprint;
+    candidates[2].heap = PatchPlatform::GetOverridesHeap();
+    candidates[2].reclaimedBytes = 0;
+    candidates[3].heap = PatchPlatform::GetRootHeapMEM1();
+    candidates[3].reclaimedBytes = 0;
+    candidates[4].heap = fallbackHeap;
+    candidates[4].reclaimedBytes = 0;
+    return FindHeapWithSpace(candidates, 5, requiredSize);
+}
+
+static bool EnsureLooseOverrideScratchCapacity(u32 nodeCapacity, u32 entryCapacity, u32 repackCapacity,
+                                               EGG::Heap *fallbackHeap) {
+    if (nodeCapacity == 0 || entryCapacity == 0) return false;
+    const u32 basenameHashCapacity = GetBasenameHashCapacity(nodeCapacity);
+    const bool useWideBasenameIndices = sLooseOverrideScratch.useWideBasenameIndices || (nodeCapacity > 65534);
+    if (sLooseOverrideScratch.nodeOverrideCapacity >= nodeCapacity &&
+        sLooseOverrideScratch.entryAppliedCapacity >= entryCapacity &&
+        sLooseOverrideScratch.basenameHashCapacity >= basenameHashCapacity &&
+        sLooseOverrideScratch.repackCapacity >= repackCapacity &&
+        sLooseOverrideScratch.useWideBasenameIndices == useWideBasenameIndices &&
+        sLooseOverrideScratch.nodeOverrideIndex != nullptr && sLooseOverrideScratch.entryAppliedBits != nullptr &&
+        ((useWideBasenameIndices && sLooseOverrideScratch.basenameHashHeads32 != nullptr &&
+          sLooseOverrideScratch.basenameHashNext32 != nullptr) ||
+         (!useWideBasenameIndices && sLooseOverrideScratch.basenameHashHeads16 != nullptr &&
+          sLooseOverrideScratch.basenameHashNext16 != nullptr)) &&
+        (repackCapacity == 0 ||
+         (sLooseOverrideScratch.repackOffsets != nullptr && sLooseOverrideScratch.repackSizes != nullptr &&
+          sLooseOverrideScratch.repackOriginalSizes != nullptr && sLooseOverrideScratch.repackOrder != nullptr))) {
+        return true;
+    }
+
+    const u32 targetNodeCapacity = MaxU32(sLooseOverrideScratch.nodeOverrideCapacity, nodeCapacity);
+    const u32 targetEntryCapacity = MaxU32(sLooseOverrideScratch.entryAppliedCapacity, entryCapacity);
+    const u32 targetBasenameHashCapacity = MaxU32(sLooseOverrideScratch.basenameHashCapacity, basenameHashCapacity);
+    const u32 targetRepackCapacity = MaxU32(sLooseOverrideScratch.repackCapacity, repackCapacity);
+    const u32 requiredSize = GetLooseOverrideScratchFootprint(targetNodeCapacity, targetEntryCapacity,
+                                                              targetRepackCapacity, targetBasenameHashCapacity,
+                                                              useWideBasenameIndices);
+
+    EGG::Heap *heap = GetLooseOverrideScratchHeap(requiredSize, fallbackHeap);
+    if (heap == nullptr) {
+        return false;
+    }
+
+    FreeLooseOverrideScratch(sLooseOverrideScratch);
+
+    sLooseOverrideScratch.nodeOverrideIndex = HeapAlloc<u16>(sizeof(u16) * targetNodeCapacity, 0x20, heap);
+    sLooseOverrideScratch.entryAppliedBits =
+        HeapAlloc<u32>(sizeof(u32) * GetEntryAppliedWordCount(targetEntryCapacity), 0x20, heap);
+    if (useWideBasenameIndices) {
+        sLooseOverrideScratch.basenameHashHeads32 =
+            HeapAlloc<s32>(sizeof(s32) * targetBasenameHashCapacity, 0x20, heap);
+        sLooseOverrideScratch.basenameHashNext32 =
+            HeapAlloc<s32>(sizeof(s32) * targetNodeCapacity, 0x20, heap);
+    } else {
+        sLooseOverrideScratch.basenameHashHeads16 =
+            HeapAlloc<u16>(sizeof(u16) * targetBasenameHashCapacity, 0x20, heap);
+        sLooseOverrideScratch.basenameHashNext16 =
+            HeapAlloc<u16>(sizeof(u16) * targetNodeCapacity, 0x20, heap);
+    }
+    if (targetRepackCapacity > 0) {
+        sLooseOverrideScratch.repackOffsets = HeapAlloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
+        sLooseOverrideScratch.repackSizes = HeapAlloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
+        sLooseOverrideScratch.repackOriginalSizes =
+            HeapAlloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
+        sLooseOverrideScratch.repackOrder = HeapAlloc<u32>(sizeof(u32) * targetRepackCapacity, 0x20, heap);
+    }
+
+    if (sLooseOverrideScratch.nodeOverrideIndex == nullptr || sLooseOverrideScratch.entryAppliedBits == nullptr ||
+        (useWideBasenameIndices &&
+         (sLooseOverrideScratch.basenameHashHeads32 == nullptr || sLooseOverrideScratch.basenameHashNext32 == nullptr)) ||
+        (!useWideBasenameIndices &&
+         (sLooseOverrideScratch.basenameHashHeads16 == nullptr || sLooseOverrideScratch.basenameHashNext16 == nullptr)) ||
+        (targetRepackCapacity > 0 &&
+         (sLooseOverrideScratch.repackOffsets == nullptr || sLooseOverrideScratch.repackSizes == nullptr ||
+          sLooseOverrideScratch.repackOriginalSizes == nullptr || sLooseOverrideScratch.repackOrder == nullptr))) {
+        FreeLooseOverrideScratch(sLooseOverrideScratch);
+        return false;
+    }
+
+    sLooseOverrideScratch.nodeOverrideCapacity = targetNodeCapacity;
+    sLooseOverrideScratch.entryAppliedCapacity = targetEntryCapacity;
+    sLooseOverrideScratch.basenameHashCapacity = targetBasenameHashCapacity;
+    sLooseOverrideScratch.useWideBasenameIndices = useWideBasenameIndices;
+    sLooseOverrideScratch.repackCapacity = targetRepackCapacity;
+    sLooseOverrideScratch.heap = heap;
+    return true;
+}
+
+static void BuildArchiveBasenameLookup16(const U8Node *nodes, u32 nodeCount, char *stringTable, u16 *bucketHeads,
+                                         u32 bucketCount, u16 *nextNode) {
+    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0) {
+        return;
+    }
+
+    memset(bucketHeads, 0xFF, sizeof(u16) * bucketCount);
+    memset(nextNode, 0xFF, sizeof(u16) * nodeCount);
+
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
+        if (IsEmpty(nodeName)) continue;
+
+        const u32 bucket = HashName(nodeName) & (bucketCount - 1);
+        nextNode[nodeIdx] = bucketHeads[bucket];
+        bucketHeads[bucket] = static_cast<u16>(nodeIdx);
+    }
+}
+
+static void BuildArchiveBasenameLookup32(const U8Node *nodes, u32 nodeCount, char *stringTable, s32 *bucketHeads,
+                                         u32 bucketCount, s32 *nextNode) {
+    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0) {
+        return;
+    }
+
+    memset(bucketHeads, 0xFF, sizeof(s32) * bucketCount);
+    memset(nextNode, 0xFF, sizeof(s32) * nodeCount);
+
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
+        if (IsEmpty(nodeName)) continue;
+
+        const u32 bucket = HashName(nodeName) & (bucketCount - 1);
+        nextNode[nodeIdx] = bucketHeads[bucket];
+        bucketHeads[bucket] = static_cast<s32>(nodeIdx);
+    }
+}
+
+static u32 MatchArchiveBasenameOverride16(const U8Node *nodes, char *stringTable, const u16 *bucketHeads,
+                                          const u16 *nextNode, u32 bucketCount, const char *basename, u16 entryIndex,
+                                          u16 *nodeOverrideIndex) {
+    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0 ||
+        IsEmpty(basename) || nodeOverrideIndex == nullptr) {
+        return 0;
+    }
+
+    const u32 bucket = HashName(basename) & (bucketCount - 1);
+    u32 matchCount = 0;
+    for (u16 nodeIdx = bucketHeads[bucket]; nodeIdx != kInvalidScratchIndex16; nodeIdx = nextNode[nodeIdx]) {
+        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
+        if (strcmp(nodeName, basename) != 0) continue;
+
+        // Matching nodes stay fan-out capable: a single basename override still patches every sibling file node.
+        nodeOverrideIndex[nodeIdx] = entryIndex;
+        ++matchCount;
+    }
+    return matchCount;
+}
+
+static u32 MatchArchiveBasenameOverride32(const U8Node *nodes, char *stringTable, const s32 *bucketHeads,
+                                          const s32 *nextNode, u32 bucketCount, const char *basename, u16 entryIndex,
+                                          u16 *nodeOverrideIndex) {
+    if (nodes == nullptr || stringTable == nullptr || bucketHeads == nullptr || nextNode == nullptr || bucketCount == 0 ||
+        IsEmpty(basename) || nodeOverrideIndex == nullptr) {
+        return 0;
+    }
+
+    const u32 bucket = HashName(basename) & (bucketCount - 1);
+    u32 matchCount = 0;
+    for (s32 nodeIdx = bucketHeads[bucket]; nodeIdx >= 0; nodeIdx = nextNode[nodeIdx]) {
+        const char *nodeName = stringTable + NodeNameOffset(nodes[nodeIdx]);
+        if (strcmp(nodeName, basename) != 0) continue;
+
+        nodeOverrideIndex[nodeIdx] = entryIndex;
+        ++matchCount;
+    }
+    return matchCount;
+}
+
+static void BuildArchiveFileSlotCapacities(const U8Node *nodes, u32 nodeCount, u32 archiveSize, u32 *fileOrder,
+                                           u32 *slotCapacities) {
+    if (nodes == nullptr || fileOrder == nullptr || slotCapacities == nullptr) return;
+
+    memset(slotCapacities, 0, sizeof(u32) * nodeCount);
+    u32 fileCount = 0;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+        fileOrder[fileCount++] = nodeIdx;
+    }
+
+    // U8 node order is not guaranteed to follow file payload order, so compute
+    // in-place growth limits from a dataOffset-sorted work view.
+    for (u32 i = 1; i < fileCount; ++i) {
+        const u32 keyNode = fileOrder[i];
+        const u32 keyOffset = nodes[keyNode].dataOffset;
+        u32 insertIdx = i;
+        while (insertIdx > 0) {
+            const u32 prevNode = fileOrder[insertIdx - 1];
+            if (nodes[prevNode].dataOffset <= keyOffset) break;
+            fileOrder[insertIdx] = prevNode;
+            --insertIdx;
+        }
+        fileOrder[insertIdx] = keyNode;
+    }
+
+    for (u32 i = 0; i < fileCount; ++i) {
+        const u32 nodeIdx = fileOrder[i];
+        const u32 currentOffset = nodes[nodeIdx].dataOffset;
+        if (currentOffset >= archiveSize) continue;
+
+        u32 slotEnd = archiveSize;
+        if (i + 1 < fileCount) {
+            const u32 nextOffset = nodes[fileOrder[i + 1]].dataOffset;
+            if (nextOffset < currentOffset) continue;
+            slotEnd = (nextOffset < archiveSize) ? nextOffset : archiveSize;
+        }
+        slotCapacities[nodeIdx] = slotEnd - currentOffset;
+    }
+}
+
+static u32 GetFileDataStart(const U8Header *header) {
+    if (header == nullptr) return 0;
+    const u32 metaEnd = header->nodeOffset + header->combinedNodeSize;
+    u32 dataStart = header->fileOffset;
+    if (dataStart < metaEnd) dataStart = metaEnd;
+    return Align32(dataStart);
+}
+
+static bool BuildStructuralAddedFiles(const TaggedOverrideEntry *entries,
+                                      const PendingStructuralAddCandidate *candidates, u32 candidateCount,
+                                      PendingStructuralAdd *&outAddedFiles, u32 &outAddedFileCount,
+                                      char *&outPathPool, u32 &outPathPoolSize, u32 &outAddedNameBytes,
+                                      u32 oldStringTableSize, EGG::Heap *heap) {
+    outAddedFiles = nullptr;
+    outAddedFileCount = 0;
+    outPathPool = nullptr;
+    outPathPoolSize = 0;
+    outAddedNameBytes = 0;
+    if (candidateCount == 0) return true;
+    if (heap == nullptr) return false;
+
+    u32 uniqueCount = 0;
+    u32 pathBytes = 0;
+    u32 nameBytes = 0;
+    char previousPath[OVERRIDE_MAX_PATH];
+    previousPath[0] = '\0';
+    u16 previousParent = kInvalidScratchIndex16;
+    bool hasPrevious = false;
+
+    for (u32 i = 0; i < candidateCount; ++i) {
+        const PendingStructuralAddCandidate &candidate = candidates[i];
+        char matchName[OVERRIDE_MAX_PATH];
+        if (!PatchPlatform::GetMatchName(entries[candidate.overrideIndex], matchName, sizeof(matchName)) ||
+            IsEmpty(matchName)) {
+            continue;
+        }
+
+        const char *basename = FindBasename(matchName);
+        if (IsEmpty(basename)) continue;
+
+        if (hasPrevious && previousParent == candidate.parentDirIndex && strcmp(previousPath, matchName) == 0) {
+            continue;
+        }
+
+        pathBytes += static_cast<u32>(strlen(matchName)) + 1;
+        nameBytes += static_cast<u32>(strlen(basename)) + 1;
+        CopyPath(previousPath, sizeof(previousPath), matchName);
+        previousParent = candidate.parentDirIndex;
+        hasPrevious = true;
+        ++uniqueCount;
+    }
+
+    if (uniqueCount == 0) return true;
+
+    PendingStructuralAdd *addedFiles = HeapAlloc<PendingStructuralAdd>(sizeof(PendingStructuralAdd) * uniqueCount,
+                                                                              0x20, heap);
+    char *pathPool = HeapAlloc<char>(pathBytes, 0x20, heap);
+    if (addedFiles == nullptr || pathPool == nullptr) {
+        if (addedFiles != nullptr) PatchPlatform::Free(addedFiles, heap);
+        if (pathPool != nullptr) PatchPlatform::Free(pathPool, heap);
+        return false;
+    }
+
+    uniqueCount = 0;
+    pathBytes = 0;
+    nameBytes = 0;
+    previousPath[0] = '\0';
+    previousParent = kInvalidScratchIndex16;
+    hasPrevious = false;
+
+    for (u32 i = 0; i < candidateCount; ++i) {
+        const PendingStructuralAddCandidate &candidate = candidates[i];
+        char matchName[OVERRIDE_MAX_PATH];
+        if (!PatchPlatform::GetMatchName(entries[candidate.overrideIndex], matchName, sizeof(matchName)) ||
+            IsEmpty(matchName)) {
+            continue;
+        }
+
+        const char *basename = FindBasename(matchName);
+        if (IsEmpty(basename)) continue;
+
+        if (hasPrevious && previousParent == candidate.parentDirIndex && strcmp(previousPath, matchName) == 0) {
+            addedFiles[uniqueCount - 1].overrideIndex = candidate.overrideIndex;
+            continue;
+        }
+
+        const u32 fullLen = static_cast<u32>(strlen(matchName)) + 1;
+        const u32 nameLen = static_cast<u32>(strlen(basename)) + 1;
+        memcpy(pathPool + pathBytes, matchName, fullLen);
+
+        addedFiles[uniqueCount].parentDirIndex = candidate.parentDirIndex;
+        addedFiles[uniqueCount].overrideIndex = candidate.overrideIndex;
+        addedFiles[uniqueCount].pathOffset = pathBytes;
+        addedFiles[uniqueCount].nameOffset = oldStringTableSize + nameBytes;
+
+        pathBytes += fullLen;
+        nameBytes += nameLen;
+        CopyPath(previousPath, sizeof(previousPath), matchName);
+        previousParent = candidate.parentDirIndex;
+        hasPrevious = true;
+        ++uniqueCount;
+    }
+
+    outAddedFiles = addedFiles;
+    outAddedFileCount = uniqueCount;
+    outPathPool = pathPool;
+    outPathPoolSize = pathBytes;
+    outAddedNameBytes = nameBytes;
+    return true;
+}
+
+struct StructuralRebuildContext {
+    const TaggedOverrideEntry *entries;
+    const U8Node *oldNodes;
+    u32 oldNodeCount;
+    const char *oldStringTable;
+    const u16 *nodeOverrideIndex;
+    const u8 *nodeDeleteFlags;
+    const PendingStructuralAdd *addedFiles;
+    u32 addedFileCount;
+    const char *addedPathPool;
+    u8 *addedFileEmitted;
+    const u8 *dirKeepFlags;
+    EGG::Heap *tempHeap;
+    u32 childScratchCapacity;
+    u8 *oldArchiveBase;
+    u8 *newBuffer;
+    U8Node *newNodes;
+    char *newStringTable;
+    u32 newStringTableSize;
+    u32 nextStringOffset;
+    u32 writeOffset;
+    u32 nextNodeIndex;
+    u32 patchedNodes;
+    u32 rangeStart;
+    u32 *entryAppliedBits;
+};
+
+static bool AppendStructuralString(StructuralRebuildContext &context, const char *name, u32 &outOffset) {
+    if (name == nullptr) name = "";
+    const u32 nameBytes = strlen(name) + 1;
+    if (context.newStringTable == nullptr || context.nextStringOffset + nameBytes > context.newStringTableSize) {
+        return false;
+    }
+
+    outOffset = context.nextStringOffset;
+    memcpy(context.newStringTable + outOffset, name, nameBytes);
+    context.nextStringOffset += nameBytes;
+    return true;
+}
+
+static void ZeroStructuralFilePadding(u8 *buffer, u32 offset, u32 size) {
+    if (buffer == nullptr) return;
+    const u32 paddedSize = Align32(size);
+    if (paddedSize > size) {
+        memset(buffer + offset + size, 0, paddedSize - size);
+    }
+}
+
+static const char *GetStructuralAddedBasename(u32 addedIndex, const StructuralRebuildContext &context);
+
+static bool EmitStructuralExistingFileNode(u32 oldNodeIdx, StructuralRebuildContext &context) {
+    const U8Node &oldNode = context.oldNodes[oldNodeIdx];
+    const u16 idx = context.nodeOverrideIndex[oldNodeIdx];
+
+    const u32 newNodeIdx = context.nextNodeIndex++;
+    U8Node &newNode = context.newNodes[newNodeIdx];
+    u32 nameOffset = 0;
+    if (!AppendStructuralString(context, context.oldStringTable + NodeNameOffset(oldNode), nameOffset)) {
+        return false;
+    }
+    newNode.typeName = nameOffset;
+
+    const u32 writeOffset = Align32(context.writeOffset);
+    newNode.dataOffset = writeOffset;
+    newNode.dataSize = (idx != kInvalidScratchIndex16) ? context.entries[idx].size : oldNode.dataSize;
+
+    if (idx != kInvalidScratchIndex16) {
+        const TaggedOverrideEntry &entry = context.entries[idx];
+        if (!PatchPlatform::ReadOverride(entry, context.newBuffer + writeOffset)) {
+            return false;
+        }
+        MarkEntryApplied(context.entryAppliedBits, idx - context.rangeStart);
+        ++context.patchedNodes;
+    } else {
+        // No-op unless a chunked archive skipped this member for an override that was not applied after all.
+        PatchPlatform::RestoreSkippedRange(context.oldArchiveBase, oldNode.dataOffset, oldNode.dataSize);
+        memcpy(context.newBuffer + writeOffset, context.oldArchiveBase + oldNode.dataOffset, oldNode.dataSize);
+    }
+
+    const u32 paddedSize = Align32(newNode.dataSize);
+    ZeroStructuralFilePadding(context.newBuffer, writeOffset, newNode.dataSize);
+    context.writeOffset = writeOffset + paddedSize;
+    return true;
+}
+
+static bool EmitStructuralAddedFileNode(u32 addedIndex, StructuralRebuildContext &context) {
+    const PendingStructuralAdd &added = context.addedFiles[addedIndex];
+    const TaggedOverrideEntry &entry = context.entries[added.overrideIndex];
+
+    const u32 newNodeIdx = context.nextNodeIndex++;
+    U8Node &newNode = context.newNodes[newNodeIdx];
+    u32 nameOffset = 0;
+    if (!AppendStructuralString(context, GetStructuralAddedBasename(addedIndex, context), nameOffset)) {
+        return false;
+    }
+    newNode.typeName = nameOffset;
+
+    const u32 writeOffset = Align32(context.writeOffset);
+    newNode.dataOffset = writeOffset;
+    newNode.dataSize = entry.size;
+
+    if (!PatchPlatform::ReadOverride(entry, context.newBuffer + writeOffset)) {
+        return false;
+    }
+
+    const u32 paddedSize = Align32(newNode.dataSize);
+    ZeroStructuralFilePadding(context.newBuffer, writeOffset, newNode.dataSize);
+    context.writeOffset = writeOffset + paddedSize;
+
+    MarkEntryApplied(context.entryAppliedBits, added.overrideIndex - context.rangeStart);
+    ++context.patchedNodes;
+    return true;
+}
+
+static const char *GetStructuralAddedPath(u32 addedIndex, const StructuralRebuildContext &context) {
+    if (context.addedFiles == nullptr || context.addedPathPool == nullptr ||
+        addedIndex >= context.addedFileCount) {
+        return nullptr;
+    }
+    return context.addedPathPool + context.addedFiles[addedIndex].pathOffset;
+}
+
+static const char *GetStructuralAddedBasename(u32 addedIndex, const StructuralRebuildContext &context) {
+    const char *path = GetStructuralAddedPath(addedIndex, context);
+    if (path == nullptr) return nullptr;
+    return FindBasename(path);
+}
+
+static bool StructuralDirectoryHasDirectAdditions(u32 oldDirIdx, const PendingStructuralAdd *addedFiles,
+                                                  u32 addedFileCount) {
+    for (u32 addedIdx = 0; addedIdx < addedFileCount; ++addedIdx) {
+        if (addedFiles[addedIdx].parentDirIndex == oldDirIdx) return true;
+    }
+    return false;
+}
+
+static bool MarkStructuralKeptDirectories(u32 oldDirIdx, const U8Node *nodes, const u8 *nodeDeleteFlags,
+                                          const PendingStructuralAdd *addedFiles, u32 addedFileCount,
+                                          u8 *dirKeepFlags) {
+    bool hasContent = (oldDirIdx == 0) || StructuralDirectoryHasDirectAdditions(oldDirIdx, addedFiles, addedFileCount);
+
+    u32 childIdx = oldDirIdx + 1;
+    const u32 dirEnd = nodes[oldDirIdx].dataSize;
+    while (childIdx < dirEnd) {
+        const U8Node &child = nodes[childIdx];
+        if (NodeIsDir(child)) {
+            if (MarkStructuralKeptDirectories(childIdx, nodes, nodeDeleteFlags, addedFiles, addedFileCount,
+                                              dirKeepFlags)) {
+                hasContent = true;
+            }
+            childIdx = child.dataSize;
+            continue;
+        }
+
+        if (nodeDeleteFlags[childIdx] == 0) {
+            hasContent = true;
+        }
+        ++childIdx;
+    }
+
+    dirKeepFlags[oldDirIdx] = hasContent ? 1 : 0;
+    return hasContent;
+}
+
+static void MarkDeletedOverridesInSubtree(u32 oldDirIdx, StructuralRebuildContext &context) {
+    const u32 dirEnd = context.oldNodes[oldDirIdx].dataSize;
+    for (u32 nodeIdx = oldDirIdx + 1; nodeIdx < dirEnd; ++nodeIdx) {
+        if (NodeIsDir(context.oldNodes[nodeIdx])) continue;
+        if (context.nodeDeleteFlags[nodeIdx] == 0) continue;
+
+        const u16 deleteIdx = context.nodeOverrideIndex[nodeIdx];
+        if (deleteIdx == kInvalidScratchIndex16) continue;
+
+        MarkEntryApplied(context.entryAppliedBits, deleteIdx - context.rangeStart);
+        ++context.patchedNodes;
+    }
+}
+
+static bool EmitStructuralDirectoryChildren(u32 oldDirIdx, u32 parentNewIdx, StructuralRebuildContext &context);
+
+static bool EmitStructuralDirectoryNode(u32 oldDirIdx, u32 parentNewIdx, StructuralRebuildContext &context) {
+    const u32 newDirIdx = context.nextNodeIndex++;
+    U8Node &newDir = context.newNodes[newDirIdx];
+    u32 nameOffset = 0;
+    if (!AppendStructuralString(context, context.oldStringTable + NodeNameOffset(context.oldNodes[oldDirIdx]),
+                                nameOffset)) {
+        return false;
+    }
+    newDir.typeName = 0x01000000u | nameOffset;
+    newDir.dataOffset = parentNewIdx;
+    newDir.dataSize = newDirIdx + 1;
+
+    if (!EmitStructuralDirectoryChildren(oldDirIdx, newDirIdx, context)) return false;
+
+    newDir.dataSize = context.nextNodeIndex;
+    return true;
+}
+
+static bool EmitStructuralDirectoryChildren(u32 oldDirIdx, u32 parentNewIdx, StructuralRebuildContext &context) {
+    if (context.tempHeap == nullptr || context.childScratchCapacity == 0) return false;
+
+    StructuralChildRef *children = HeapAlloc<StructuralChildRef>(
+        sizeof(StructuralChildRef) * context.childScratchCapacity, 0x20, context.tempHeap);
+    if (children == nullptr) return false;
+
+    u32 childCount = 0;
+    u32 childIdx = oldDirIdx + 1;
+    const u32 dirEnd = context.oldNodes[oldDirIdx].dataSize;
+    while (childIdx < dirEnd) {
+        const U8Node &child = context.oldNodes[childIdx];
+        const char *childName = context.oldStringTable + NodeNameOffset(child);
+        if (NodeIsDir(child)) {
+            if (context.dirKeepFlags != nullptr && context.dirKeepFlags[childIdx] == 0) {
+                MarkDeletedOverridesInSubtree(childIdx, context);
+                childIdx = child.dataSize;
+                continue;
+            }
+
+            if (childCount >= context.childScratchCapacity) {
+                PatchPlatform::Free(children, context.tempHeap);
+                return false;
+            }
+            children[childCount].oldNodeIndex = childIdx;
+            children[childCount].addedFileIndex = 0;
+            children[childCount].name = childName;
+            children[childCount].isAddedFile = false;
+            ++childCount;
+            childIdx = child.dataSize;
+            continue;
+        }
+
+        if (context.nodeDeleteFlags[childIdx] != 0) {
+            const u16 deleteIdx = context.nodeOverrideIndex[childIdx];
+            if (deleteIdx != kInvalidScratchIndex16) {
+                MarkEntryApplied(context.entryAppliedBits, deleteIdx - context.rangeStart);
+                ++context.patchedNodes;
+            }
+        } else {
+            if (childCount >= context.childScratchCapacity) {
+                PatchPlatform::Free(children, context.tempHeap);
+                return false;
+            }
+            children[childCount].oldNodeIndex = childIdx;
+            children[childCount].addedFileIndex = 0;
+            children[childCount].name = childName;
+            children[childCount].isAddedFile = false;
+            ++childCount;
+        }
+        ++childIdx;
+    }
+
+    for (u32 addedIdx = 0; addedIdx < context.addedFileCount; ++addedIdx) {
+        if (context.addedFileEmitted != nullptr && context.addedFileEmitted[addedIdx] != 0) continue;
+        if (context.addedFiles[addedIdx].parentDirIndex != oldDirIdx) continue;
+
+        const char *addedName = GetStructuralAddedBasename(addedIdx, context);
+        if (IsEmpty(addedName)) continue;
+        if (childCount >= context.childScratchCapacity) {
+            PatchPlatform::Free(children, context.tempHeap);
+            return false;
+        }
+
+        children[childCount].oldNodeIndex = 0;
+        children[childCount].addedFileIndex = addedIdx;
+        children[childCount].name = addedName;
+        children[childCount].isAddedFile = true;
+        ++childCount;
+    }
+
+    bool success = true;
+    for (u32 sortedIdx = 0; sortedIdx < childCount; ++sortedIdx) {
+        const StructuralChildRef childRef = children[sortedIdx];
+        if (childRef.isAddedFile) {
+            if (context.addedFileEmitted != nullptr) context.addedFileEmitted[childRef.addedFileIndex] = 1;
+            if (!EmitStructuralAddedFileNode(childRef.addedFileIndex, context)) {
+                success = false;
+                break;
+            }
+            continue;
+        }
+
+        const U8Node &child = context.oldNodes[childRef.oldNodeIndex];
+        if (NodeIsDir(child)) {
+            if (!EmitStructuralDirectoryNode(childRef.oldNodeIndex, parentNewIdx, context)) {
+                success = false;
+                break;
+            }
+        } else if (!EmitStructuralExistingFileNode(childRef.oldNodeIndex, context)) {
+            success = false;
+            break;
+        }
+    }
+
+    PatchPlatform::Free(children, context.tempHeap);
+    return success;
+}
+
+static bool EmitStructuralRootNode(u32 oldRootIdx, StructuralRebuildContext &context) {
+    const u32 newRootIdx = context.nextNodeIndex++;
+    U8Node &newRoot = context.newNodes[newRootIdx];
+    u32 rootNameOffset = 0;
+    if (!AppendStructuralString(context, context.oldStringTable + NodeNameOffset(context.oldNodes[oldRootIdx]),
+                                rootNameOffset)) {
+        return false;
+    }
+    newRoot.typeName = 0x01000000u | rootNameOffset;
+    newRoot.dataOffset = context.oldNodes[oldRootIdx].dataOffset;
+    newRoot.dataSize = newRootIdx + 1;
+
+    if (!EmitStructuralDirectoryChildren(oldRootIdx, newRootIdx, context)) {
+        return false;
+    }
+
+    newRoot.dataSize = context.nextNodeIndex;
+    return true;
+}
+
+static u32 CountStructuralKeptOldNameBytes(u32 oldDirIdx, const U8Node *nodes, const char *stringTable,
+                                           const u8 *nodeDeleteFlags, const u8 *dirKeepFlags) {
+    if (nodes == nullptr || stringTable == nullptr) return 0;
+
+    u32 total = 0;
+    u32 childIdx = oldDirIdx + 1;
+    const u32 dirEnd = nodes[oldDirIdx].dataSize;
+    while (childIdx < dirEnd) {
+        const U8Node &child = nodes[childIdx];
+        if (NodeIsDir(child)) {
+            if (dirKeepFlags == nullptr || dirKeepFlags[childIdx] != 0) {
+                const char *name = stringTable + NodeNameOffset(child);
+                total += strlen(name) + 1;
+                total += CountStructuralKeptOldNameBytes(childIdx, nodes, stringTable, nodeDeleteFlags, dirKeepFlags);
+            }
+            childIdx = child.dataSize;
+            continue;
+        }
+
+        if (nodeDeleteFlags == nullptr || nodeDeleteFlags[childIdx] == 0) {
+            const char *name = stringTable + NodeNameOffset(child);
+            total += strlen(name) + 1;
+        }
+        ++childIdx;
+    }
+    return total;
+}
+
+static void FreeStructuralRebuildTemps(PendingStructuralAdd *addedFiles, char *addedPathPool, u8 *addedFileEmitted,
+                                       u8 *dirKeepFlags, EGG::Heap *heap) {
+    if (addedFiles != nullptr) PatchPlatform::Free(addedFiles, heap);
+    if (addedPathPool != nullptr) PatchPlatform::Free(addedPathPool, heap);
+    if (addedFileEmitted != nullptr) PatchPlatform::Free(addedFileEmitted, heap);
+    if (dirKeepFlags != nullptr) PatchPlatform::Free(dirKeepFlags, heap);
+}
+
+static void FreeStructuralMatchTemps(u8 *nodeDeleteFlags, PendingStructuralAddCandidate *structuralAddCandidates,
+                                     EGG::Heap *heap) {
+    if (nodeDeleteFlags != nullptr) PatchPlatform::Free(nodeDeleteFlags, heap);
+    if (structuralAddCandidates != nullptr) PatchPlatform::Free(structuralAddCandidates, heap);
+}
+
+static bool RebuildArchiveWithStructuralOverrides(const char *archiveBaseLower, const TaggedOverrideEntry *entries,
+                                                  u8 *&archiveBase, u32 &archiveSize, EGG::Heap *sourceHeap,
+                                                  EGG::Heap *&archiveHeap, U8Header *header,
+                                                  const U8Node *nodes, u32 nodeCount, const u16 *nodeOverrideIndex,
+                                                  const u8 *nodeDeleteFlags,
+                                                  const PendingStructuralAddCandidate *addCandidates,
+                                                  u32 addCandidateCount, u32 rangeStart, u32 taggedCandidates,
+                                                  u32 *entryAppliedBits, u32 missingOverrides, u32 *outAppliedOverrides,
+                                                  u32 *outPatchedNodes, u32 *outMissingOverrides) {
+    PendingStructuralAdd *addedFiles = nullptr;
+    char *addedPathPool = nullptr;
+    u8 *addedFileEmitted = nullptr;
+    u8 *dirKeepFlags = nullptr;
+    u32 addedPathPoolSize = 0;
+    u32 addedNameBytes = 0;
+    bool success = false;
+
+    const u32 estimatedTempBytes =
+        (header != nullptr ? header->combinedNodeSize : 0) +
+        sizeof(StructuralChildRef) * (nodeCount + addCandidateCount) + 0x10000;
+    HeapCandidate tempCandidates[4];
+    tempCandidates[0].heap = PatchPlatform::GetRootHeapMEM2();
+    tempCandidates[0].reclaimedBytes = 0;
+    tempCandidates[1].heap = PatchPlatform::GetRootHeapMEM1();
+    tempCandidates[1].reclaimedBytes = 0;
+    tempCandidates[2].heap = PatchPlatform::GetOverridesHeap();
+    tempCandidates[2].reclaimedBytes = 0;
+    tempCandidates[3].heap = sourceHeap;
+    tempCandidates[3].reclaimedBytes = 0;
+    EGG::Heap *tempHeap = FindHeapWithSpace(tempCandidates, 4, estimatedTempBytes);
+    if (tempHeap == nullptr) tempHeap = tempCandidates[2].heap;
+    if (tempHeap == nullptr) tempHeap = sourceHeap;
+    if (tempHeap == nullptr) {
+        PatchPlatform::Report("[Pulsar] Structural rebuild early fail '%s': no temp heap\n", archiveBaseLower);
+        return false;
+    }
+
+    const u32 oldNodeBytes = sizeof(U8Node) * nodeCount;
+    if (header == nullptr || header->combinedNodeSize < oldNodeBytes) {
+        PatchPlatform::Report("[Pulsar] Structural rebuild early fail '%s': bad header nodes=%u combined=0x%X\n",
+                              archiveBaseLower, nodeCount, header != nullptr ? header->combinedNodeSize : 0);
+        return false;
+    }
+    const u32 nodeOffset = header->nodeOffset;
+    const u32 oldCombinedNodeSize = header->combinedNodeSize;
+    const u32 oldStringTableSize = oldCombinedNodeSize - oldNodeBytes;
+    const char *oldStringTable = reinterpret_cast<const char *>(nodes + nodeCount);
+    if (!BuildStructuralAddedFiles(entries, addCandidates, addCandidateCount, addedFiles, addCandidateCount, addedPathPool,
+                                   addedPathPoolSize, addedNameBytes, oldStringTableSize, tempHeap)) {
+        PatchPlatform::Report("[Pulsar] Structural rebuild early fail '%s': added file list\n", archiveBaseLower);
+        return false;
+    }
+    if (addCandidateCount > 0) {
+        addedFileEmitted = HeapAlloc<u8>(addCandidateCount, 0x20, tempHeap);
+        if (addedFileEmitted == nullptr) {
+            PatchPlatform::Report("[Pulsar] Structural rebuild early fail '%s': emitted flags count=%u\n", archiveBaseLower,
+                                  addCandidateCount);
+            FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
+            return false;
+        }
+        memset(addedFileEmitted, 0, addCandidateCount);
+    }
+
+    dirKeepFlags = HeapAlloc<u8>(nodeCount, 0x20, tempHeap);
+    if (dirKeepFlags == nullptr) {
+        PatchPlatform::Report("[Pulsar] Structural rebuild early fail '%s': dir flags nodes=%u\n", archiveBaseLower, nodeCount);
+        FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
+        return false;
+    }
+    memset(dirKeepFlags, 0, nodeCount);
+    MarkStructuralKeptDirectories(0, nodes, nodeDeleteFlags, addedFiles, addCandidateCount, dirKeepFlags);
+
+    u32 deletedFileCount = 0;
+    u32 deletedDirCount = 0;
+    u32 totalDataSize = 0;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        if (NodeIsDir(nodes[nodeIdx])) {
+            if (dirKeepFlags[nodeIdx] == 0) ++deletedDirCount;
+            continue;
+        }
+        if (nodeDeleteFlags[nodeIdx] != 0) {
+            ++deletedFileCount;
+            continue;
+        }
+
+        u32 fileSize = nodes[nodeIdx].dataSize;
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        if (idx != kInvalidScratchIndex16) {
+            fileSize = entries[idx].size;
+        }
+        totalDataSize += Align32(fileSize);
+    }
+    for (u32 addedIdx = 0; addedIdx < addCandidateCount; ++addedIdx) {
+        totalDataSize += Align32(entries[addedFiles[addedIdx].overrideIndex].size);
+    }
+
+    const char *rootName = oldStringTable + NodeNameOffset(nodes[0]);
+    const u32 newStringTableSize = strlen(rootName) + 1 +
+                                   CountStructuralKeptOldNameBytes(0, nodes, oldStringTable, nodeDeleteFlags, dirKeepFlags) +
+                                   addedNameBytes;
+    const u32 newNodeCount = nodeCount - deletedFileCount - deletedDirCount + addCandidateCount;
+    const u32 newCombinedNodeSize = sizeof(U8Node) * newNodeCount + newStringTableSize;
+    const u32 newDataStart = Align32(nodeOffset + newCombinedNodeSize);
+    const u32 newSize = Align32(newDataStart + totalDataSize);
+
+    HeapCandidate candidates[4];
+    candidates[0].heap = archiveHeap;
+    candidates[0].reclaimedBytes = 0;
+    candidates[1].heap = PatchPlatform::GetRootHeapMEM2();
+    candidates[1].reclaimedBytes = 0;
+    candidates[2].heap = PatchPlatform::GetOverridesHeap();
+    candidates[2].reclaimedBytes = 0;
+    candidates[3].heap = PatchPlatform::GetRootHeapMEM1();
+    candidates[3].reclaimedBytes = 0;
+    EGG::Heap *repackHeap = FindHeapWithSpace(candidates, 4, newSize);
+
+    if (repackHeap == nullptr) {
+        PatchPlatform::Report("[Pulsar] Structural rebuild fail '%s': no separate heap for old=0x%X new=0x%X\n",
+                              archiveBaseLower, archiveSize, newSize);
+        FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
+        return false;
+    }
+
+    u8 *newBuffer = HeapAlloc<u8>(newSize, 0x20, repackHeap);
+    if (newBuffer == nullptr) {
+        PatchPlatform::Report("[Pulsar] Structural loose override rebuild allocation failed for '%s': old=0x%X new=0x%X\n",
+                              archiveBaseLower, archiveSize, newSize);
+        FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
+        return false;
+    }
+
+    memcpy(newBuffer, archiveBase, nodeOffset);
+
+    U8Header *newHeader = reinterpret_cast<U8Header *>(newBuffer);
+    newHeader->combinedNodeSize = newCombinedNodeSize;
+    newHeader->fileOffset = newDataStart;
+    if (nodeOffset > 0x10) {
+        memset(newBuffer + 0x10, 0xCC, nodeOffset - 0x10);
+    }
+
+    U8Node *newNodes = reinterpret_cast<U8Node *>(newBuffer + newHeader->nodeOffset);
+    char *newStringTable = reinterpret_cast<char *>(newNodes + newNodeCount);
+    memset(newStringTable, 0, newStringTableSize);
+    const u32 fstEnd = nodeOffset + newCombinedNodeSize;
+    if (newDataStart > fstEnd) {
+        memset(newBuffer + fstEnd, 0, newDataStart - fstEnd);
+    }
+
+    StructuralRebuildContext context;
+    context.entries = entries;
+    context.oldNodes = nodes;
+    context.oldNodeCount = nodeCount;
+    context.oldStringTable = oldStringTable;
+    context.nodeOverrideIndex = nodeOverrideIndex;
+    context.nodeDeleteFlags = nodeDeleteFlags;
+    context.addedFiles = addedFiles;
+    context.addedFileCount = addCandidateCount;
+    context.addedPathPool = addedPathPool;
+    context.addedFileEmitted = addedFileEmitted;
+    context.dirKeepFlags = dirKeepFlags;
+    context.tempHeap = tempHeap;
+    context.childScratchCapacity = nodeCount + addCandidateCount;
+    context.oldArchiveBase = archiveBase;
+    context.newBuffer = newBuffer;
+    context.newNodes = newNodes;
+    context.newStringTable = newStringTable;
+    context.newStringTableSize = newStringTableSize;
+    context.nextStringOffset = 0;
+    context.writeOffset = newDataStart;
+    context.nextNodeIndex = 0;
+    context.patchedNodes = 0;
+    context.rangeStart = rangeStart;
+    context.entryAppliedBits = entryAppliedBits;
+
+    success = EmitStructuralRootNode(0, context) && context.nextNodeIndex == newNodeCount &&
+              context.nextStringOffset == newStringTableSize;
+    if (!success) {
+        PatchPlatform::Report("[Pulsar] Structural rebuild detail '%s': emitted=%u/%u strings=%u/%u write=0x%X/0x%X\n",
+                              archiveBaseLower, context.nextNodeIndex, newNodeCount, context.nextStringOffset,
+                              newStringTableSize,
+                              context.writeOffset, newSize);
+    }
+    if (success) {
+        const u32 finalSize = Align32(context.writeOffset);
+        if (finalSize < newSize) {
+            memset(newBuffer + finalSize, 0, newSize - finalSize);
+        }
+        PatchPlatform::FlushRange(newBuffer, finalSize);
+
+        PatchPlatform::Free(archiveBase, sourceHeap);
+        archiveBase = newBuffer;
+        archiveSize = finalSize;
+        archiveHeap = repackHeap;
+
+        const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
+        SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, context.patchedNodes,
+                          outMissingOverrides, missingOverrides);
+        PatchPlatform::Report("[Pulsar] Structural loose overrides applied for '%s': applied=%u patched=%u missing=%u\n",
+                              archiveBaseLower, appliedOverrides, context.patchedNodes, missingOverrides);
+    } else {
+        PatchPlatform::Free(newBuffer, repackHeap);
+    }
+
+    FreeStructuralRebuildTemps(addedFiles, addedPathPool, addedFileEmitted, dirKeepFlags, tempHeap);
+    return success;
+}
+
+static u32 ApplyInPlaceLooseOverrides(const TaggedOverrideEntry *entries, u8 *archiveBase, U8Node *nodes, u32 nodeCount,
+                                      u16 *nodeOverrideIndex, u32 *fileSlotCapacities, u32 *entryAppliedBits,
+                                      u32 rangeStart) {
+    if (archiveBase == nullptr || nodes == nullptr || nodeOverrideIndex == nullptr || fileSlotCapacities == nullptr ||
+        entryAppliedBits == nullptr) {
+        return 0;
+    }
+
+    u32 patchedNodes = 0;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        if (idx == kInvalidScratchIndex16) continue;
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+
+        const TaggedOverrideEntry &entry = entries[idx];
+        if (entry.size > fileSlotCapacities[nodeIdx]) {
+            continue;
+        }
+
+        void *dest = archiveBase + nodes[nodeIdx].dataOffset;
+        if (!PatchPlatform::ReadOverride(entry, dest)) {
+            // A chunked archive may have skipped this member expecting it to be replaced; bring the original back.
+            PatchPlatform::RestoreSkippedRange(archiveBase, nodes[nodeIdx].dataOffset, nodes[nodeIdx].dataSize);
+            continue;
+        }
+        if (entry.size < nodes[nodeIdx].dataSize) {
+            memset(reinterpret_cast<u8 *>(dest) + entry.size, 0, nodes[nodeIdx].dataSize - entry.size);
+        }
+        nodes[nodeIdx].dataSize = entry.size;
+        PatchPlatform::FlushRange(dest, entry.size);
+        MarkEntryApplied(entryAppliedBits, idx - rangeStart);
+        ++patchedNodes;
+    }
+
+    if (patchedNodes > 0) {
+        PatchPlatform::FlushRange(nodes, nodeCount * sizeof(U8Node));
+    }
+    return patchedNodes;
+}
+
+// File nodes that matched an override whose entry never got applied
+static u32 CountUnappliedOverrideNodes(const u16 *nodeOverrideIndex, u32 nodeCount, const u32 *entryAppliedBits,
+                                       u32 rangeStart) {
+    u32 unapplied = 0;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        if (idx != kInvalidScratchIndex16 && !IsEntryApplied(entryAppliedBits, idx - rangeStart)) ++unapplied;
+    }
+    return unapplied;
+}
+
+// Oversized overrides can only be applied by a repack; a chunked archive still has those members zeroed
+static void RestoreOversizedOverrideNodes(const TaggedOverrideEntry *entries, u8 *archiveBase, const U8Node *nodes,
+                                          u32 nodeCount, const u16 *nodeOverrideIndex, const u32 *fileSlotCapacities) {
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        if (idx == kInvalidScratchIndex16 || NodeIsDir(nodes[nodeIdx])) continue;
+        if (entries[idx].size <= fileSlotCapacities[nodeIdx]) continue;
+        PatchPlatform::RestoreSkippedRange(archiveBase, nodes[nodeIdx].dataOffset, nodes[nodeIdx].dataSize);
+    }
+}
+
+static u32 CountInPlaceOversizedOverrides(const TaggedOverrideEntry *entries, const U8Node *nodes, u32 nodeCount,
+                                          const u16 *nodeOverrideIndex, const u32 *fileSlotCapacities) {
+    if (nodes == nullptr || nodeOverrideIndex == nullptr || fileSlotCapacities == nullptr) return 0;
+
+    u32 oversizedNodes = 0;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        if (idx == kInvalidScratchIndex16) continue;
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+        if (entries[idx].size > fileSlotCapacities[nodeIdx]) {
+            ++oversizedNodes;
+        }
+    }
+    return oversizedNodes;
+}
+
+}  // namespace
+
+bool PatchU8Archive(const char *archiveBaseLower, const TaggedOverrideEntry *entries, u32 rangeStart, u32 rangeEnd,
+                    u8 *&archiveBase, u32 &archiveSize, EGG::Heap *sourceHeap, EGG::Heap *&archiveHeap,
+                    u32 *outAppliedOverrides, u32 *outPatchedNodes, u32 *outMissingOverrides,
+                    const u8 *compressedData) {
+    SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, 0);
+    ResetLoosePatchStats();
+
+    // Match entries to U8 nodes, then patch in place or repack.
+    // Applied override count can differ from patched nodes when a basename fans out.
+
+    // Node -> entry links are u16 with 0xFFFF as the empty marker.
+    if (entries == nullptr || rangeEnd <= rangeStart || rangeEnd > kInvalidScratchIndex16) return false;
+    if (archiveBase == nullptr || IsEmpty(archiveBaseLower)) return false;
+    if (sourceHeap == nullptr) {
+        return false;
+    }
+    if (archiveHeap == nullptr) {
+        archiveHeap = sourceHeap;
+    }
+    const u32 taggedCandidates = rangeEnd - rangeStart;
+
+    if (!IsValidU8Layout(archiveBase, archiveSize)) {
+        PatchPlatform::Report("[Pulsar] Loose overrides skipped for '%s': malformed U8 archive (size=0x%X)\n",
+                              archiveBaseLower, archiveSize);
+        return false;
+    }
+
+    U8Header *header = reinterpret_cast<U8Header *>(archiveBase);
+    U8Node *nodes = reinterpret_cast<U8Node *>(archiveBase + header->nodeOffset);
+    const u32 nodeCount = nodes[0].dataSize;
+
+    char *stringTable = reinterpret_cast<char *>(nodes + nodeCount);
+    if (!EnsureLooseOverrideScratchCapacity(nodeCount, taggedCandidates, nodeCount, sourceHeap)) {
+        return false;
+    }
+    // These buffers are reused across archive loads and only grow when a larger archive or candidate bucket appears.
+    u16 *nodeOverrideIndex = sLooseOverrideScratch.nodeOverrideIndex;
+    u32 *entryAppliedBits = sLooseOverrideScratch.entryAppliedBits;
+    u16 *basenameHashHeads16 = sLooseOverrideScratch.basenameHashHeads16;
+    u16 *basenameHashNext16 = sLooseOverrideScratch.basenameHashNext16;
+    s32 *basenameHashHeads32 = sLooseOverrideScratch.basenameHashHeads32;
+    s32 *basenameHashNext32 = sLooseOverrideScratch.basenameHashNext32;
+    const bool useWideBasenameIndices = sLooseOverrideScratch.useWideBasenameIndices;
+    const u32 basenameHashCapacity = sLooseOverrideScratch.basenameHashCapacity;
+    u32 *fileNodeOrder = sLooseOverrideScratch.repackOffsets;
+    u32 *fileSlotCapacities = sLooseOverrideScratch.repackSizes;
+    u32 *repackOffsets = sLooseOverrideScratch.repackOffsets;
+    u32 *repackSizes = sLooseOverrideScratch.repackSizes;
+    u32 *repackOriginalSizes = sLooseOverrideScratch.repackOriginalSizes;
+    u32 *repackOrder = sLooseOverrideScratch.repackOrder;
+
+    memset(nodeOverrideIndex, 0xFF, sizeof(u16) * nodeCount);
+    ClearEntryAppliedBits(entryAppliedBits, taggedCandidates);
+    if (useWideBasenameIndices) {
+        BuildArchiveBasenameLookup32(nodes, nodeCount, stringTable, basenameHashHeads32, basenameHashCapacity,
+                                     basenameHashNext32);
+    } else {
+        BuildArchiveBasenameLookup16(nodes, nodeCount, stringTable, basenameHashHeads16, basenameHashCapacity,
+                                     basenameHashNext16);
+    }
+    BuildArchiveFileSlotCapacities(nodes, nodeCount, archiveSize, fileNodeOrder, fileSlotCapacities);
+
+    EGG::Heap *structuralTempHeap = PatchPlatform::GetOverridesHeap();
+    if (structuralTempHeap == nullptr) structuralTempHeap = sourceHeap;
+    u8 *nodeDeleteFlags = nullptr;
+    PendingStructuralAddCandidate *structuralAddCandidates = nullptr;
+    if (structuralTempHeap != nullptr) {
+        nodeDeleteFlags = HeapAlloc<u8>(nodeCount, 0x20, structuralTempHeap);
+        structuralAddCandidates = HeapAlloc<PendingStructuralAddCandidate>(
+            sizeof(PendingStructuralAddCandidate) * taggedCandidates, 0x20, structuralTempHeap);
+    }
+    if (nodeDeleteFlags == nullptr || structuralAddCandidates == nullptr) {
+        FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
+        return false;
+    }
+    memset(nodeDeleteFlags, 0, nodeCount);
+    sLastPatchStats.tempBytes =
+        Align32(nodeCount) + Align32(sizeof(PendingStructuralAddCandidate) * taggedCandidates);
+    sLastPatchStats.nodeCount = nodeCount;
+    sLastPatchStats.candidates = taggedCandidates;
+
+    bool anyOverrides = false;
+    bool hasStructuralChanges = false;
+    u32 missingOverrides = 0;
+    u32 structuralAddCandidateCount = 0;
+
+    // Build the node -> override table. Basename-only entries fan out by design.
+    for (u32 i = rangeStart; i < rangeEnd; ++i) {
+        const TaggedOverrideEntry &entry = entries[i];
+        char matchName[OVERRIDE_MAX_PATH];
+        if (!PatchPlatform::GetMatchName(entry, matchName, sizeof(matchName)) || IsEmpty(matchName)) {
+            continue;
+        }
+        const bool isDelete = (entry.flags & OVERRIDEENTRYFLAG_IS_DELETE) != 0;
+
+        if ((entry.flags & OVERRIDEENTRYFLAG_HAS_SUBPATH) != 0) {
+            s32 entryNum = PatchPlatform::FindU8Entry(archiveBase, matchName);
+            if (entryNum < 0) {
+                if (!isDelete) {
+                    const char *slash = FindLastChar(matchName, '/');
+                    u16 parentDirIndex = 0;
+                    bool canAddStructuralFile = true;
+                    if (slash != nullptr) {
+                        char parentPath[OVERRIDE_MAX_PATH];
+                        const u32 parentLen = static_cast<u32>(slash - matchName);
+                        if (parentLen == 0 || parentLen + 1 > sizeof(parentPath)) {
+                            canAddStructuralFile = false;
+                        } else {
+                            memcpy(parentPath, matchName, parentLen);
+                            parentPath[parentLen] = '\0';
+                            const s32 parentEntryNum = PatchPlatform::FindU8Entry(archiveBase, parentPath);
+                            if (parentEntryNum < 0 || NodeIsDir(nodes[parentEntryNum]) == 0) {
+                                canAddStructuralFile = false;
+                            } else {
+                                parentDirIndex = static_cast<u16>(parentEntryNum);
+                            }
+                        }
+                    }
+
+                    if (canAddStructuralFile && structuralAddCandidateCount < taggedCandidates) {
+                        structuralAddCandidates[structuralAddCandidateCount].parentDirIndex = parentDirIndex;
+                        structuralAddCandidates[structuralAddCandidateCount].overrideIndex = static_cast<u16>(i);
+                        ++structuralAddCandidateCount;
+                        anyOverrides = true;
+                        hasStructuralChanges = true;
+                        continue;
+                    }
+                }
+
+                // Count it as missing so logs can tell "override exists on disk" from "archive actually contains that node".
+                ++missingOverrides;
+                continue;
+            }
+            if (NodeIsDir(nodes[entryNum])) {
+                // A matching directory path is still unusable because only file payload nodes can be replaced.
+                ++missingOverrides;
+                continue;
+            }
+            nodeOverrideIndex[entryNum] = static_cast<u16>(i);
+            nodeDeleteFlags[entryNum] = isDelete ? 1 : 0;
+            if (isDelete) hasStructuralChanges = true;
+            anyOverrides = true;
+        } else {
+            const u32 matchCount = useWideBasenameIndices
+                                       ? MatchArchiveBasenameOverride32(nodes, stringTable, basenameHashHeads32,
+                                                                        basenameHashNext32, basenameHashCapacity,
+                                                                        matchName, static_cast<u16>(i), nodeOverrideIndex)
+                                       : MatchArchiveBasenameOverride16(nodes, stringTable, basenameHashHeads16,
+                                                                        basenameHashNext16, basenameHashCapacity,
+                                                                        matchName, static_cast<u16>(i), nodeOverrideIndex);
+            if (matchCount == 0) {
+                ++missingOverrides;
+                continue;
+            }
+            if (isDelete) {
+                hasStructuralChanges = true;
+                for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+                    if (nodeOverrideIndex[nodeIdx] == static_cast<u16>(i)) {
+                        nodeDeleteFlags[nodeIdx] = 1;
+                    }
+                }
+            } else {
+                for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+                    if (nodeOverrideIndex[nodeIdx] == static_cast<u16>(i)) {
+                        nodeDeleteFlags[nodeIdx] = 0;
+                    }
+                }
+            }
+            anyOverrides = true;
+        }
+    }
+
+    if (!anyOverrides) {
+        FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
+        if (missingOverrides > 0) {
+            PatchPlatform::Report("[Pulsar] Loose overrides skipped for '%s': %u tagged file(s) did not match archive contents\n",
+                                  archiveBaseLower, missingOverrides);
+        }
+        SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, missingOverrides);
+        return false;
+    }
+
+    if (hasStructuralChanges) {
+        const bool rebuilt = RebuildArchiveWithStructuralOverrides(
+            archiveBaseLower, entries, archiveBase, archiveSize, sourceHeap, archiveHeap, header, nodes, nodeCount,
+            nodeOverrideIndex, nodeDeleteFlags, structuralAddCandidates, structuralAddCandidateCount, rangeStart, taggedCandidates,
+            entryAppliedBits, missingOverrides, outAppliedOverrides, outPatchedNodes, outMissingOverrides);
+        if (!rebuilt) {
+            PatchPlatform::Report("[Pulsar] Structural loose override rebuild failed for '%s': candidates=%u missing=%u\n",
+                                  archiveBaseLower, structuralAddCandidateCount, missingOverrides);
+        }
+        FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
+        return rebuilt;
+    }
+
+    FreeStructuralMatchTemps(nodeDeleteFlags, structuralAddCandidates, structuralTempHeap);
+
+    bool needsRepack = false;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        if (idx == kInvalidScratchIndex16) continue;
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+        // In-place growth is safe as long as the replacement stays inside this
+        // node's real byte slot up to the next file payload.
+        if (entries[idx].size > fileSlotCapacities[nodeIdx]) {
+            needsRepack = true;
+            break;
+        }
+    }
+
+    u32 patchedNodes = 0;
+    if (!needsRepack) {
+        // Fast path: overwrite payloads in place and zero-fill shrink leftovers.
+
+        patchedNodes = ApplyInPlaceLooseOverrides(entries, archiveBase, nodes, nodeCount, nodeOverrideIndex,
+                                                  fileSlotCapacities, entryAppliedBits, rangeStart);
+
+        const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
+
+        SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes, outMissingOverrides,
+                          missingOverrides);
+        return appliedOverrides > 0;
+    }
+
+    const u32 dataStart = GetFileDataStart(header);
+    // Repack keeps metadata and rewrites the payload region.
+    if (dataStart == 0 || dataStart > archiveSize) {
+        return false;
+    }
+
+    u32 totalDataSize = 0;
+    for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+        if (NodeIsDir(nodes[nodeIdx])) continue;
+        const u16 idx = nodeOverrideIndex[nodeIdx];
+        u32 size = nodes[nodeIdx].dataSize;
+        if (idx != kInvalidScratchIndex16) {
+            // Reserve space for replacement sizes up front so the repack layout is fully known before copying.
+            size = entries[idx].size;
+        }
+        totalDataSize += Align32(size);
+    }
+
+    const u32 originalArchiveSize = archiveSize;
+    u32 newSize = dataStart + totalDataSize;
+    newSize = Align32(newSize);
+
+    const u32 growth = (newSize > archiveSize) ? (newSize - archiveSize) : 0;
+    EGG::Heap *repackHeap = archiveHeap;
+
+    EGG::Heap *candidates[3];
+    candidates[0] = PatchPlatform::GetRootHeapMEM2();
+    candidates[1] = PatchPlatform::GetRootHeapMEM1();
+    candidates[2] = PatchPlatform::GetOverridesHeap();
+
+    // Prefer a roomier heap; source-heap growth stays capped.
+
+    for (u32 i = 0; i < 3; ++i) {
+        EGG::Heap *candidate = candidates[i];
+        if (candidate == nullptr || candidate == archiveHeap) continue;
+        const u32 available = PatchPlatform::GetAllocatableSize(candidate);
+        if (available < newSize) continue;
+        repackHeap = candidate;
+        break;
+    }
+
+    const bool allowSourceHeap = (growth <= kOverrideMaxGrowthOnSourceHeap);
+    bool triedSourceHeap = false;
+    u8 *newBuffer = nullptr;
+    bool useSameHeapRepack = false;
+    bool repackPartialFailure = false;
+    bool repackAborted = false;
+    u32 repackOrderCount = 0;
+
+    if (repackHeap == archiveHeap && allowSourceHeap && compressedData != nullptr) {
+        // Same-heap repack is only safe when every file moves forward and no
+        // override shrinks after later files have been relocated. In that narrow
+        // case we can free the old archive, decompress the original SZS back into
+        // a new larger buffer on the same heap, and then move files downward from
+        // highest original offset to lowest without clobbering unread data.
+
+        memset(repackOffsets, 0, sizeof(u32) * nodeCount);
+        memset(repackSizes, 0, sizeof(u32) * nodeCount);
+        memset(repackOriginalSizes, 0, sizeof(u32) * nodeCount);
+        memset(repackOrder, 0, sizeof(u32) * nodeCount);
+        u32 plannedOffset = dataStart;
+        bool allOffsetsForward = true;
+        bool hasShrinkOverride = false;
+        for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+            if (NodeIsDir(nodes[nodeIdx])) continue;
+            plannedOffset = Align32(plannedOffset);
+            repackOffsets[nodeIdx] = plannedOffset;
+            const u16 idx = nodeOverrideIndex[nodeIdx];
+            repackOriginalSizes[nodeIdx] = nodes[nodeIdx].dataSize;
+            const u32 plannedSize =
+                (idx != kInvalidScratchIndex16) ? entries[idx].size : nodes[nodeIdx].dataSize;
+            repackSizes[nodeIdx] = plannedSize;
+            repackOrder[repackOrderCount++] = nodeIdx;
+            if (plannedOffset < nodes[nodeIdx].dataOffset) {
+                allOffsetsForward = false;
+            }
+            if (idx != kInvalidScratchIndex16 && plannedSize < nodes[nodeIdx].dataSize) {
+                // Same-heap repack cannot safely recover from a failed shrink override after later files move.
+                hasShrinkOverride = true;
+            }
+            plannedOffset += Align32(plannedSize);
+        }
+        useSameHeapRepack = allOffsetsForward && !hasShrinkOverride;
+        if (!useSameHeapRepack) {
+            repackOrderCount = 0;
+        } else {
+            // Same-heap repack must move files from the highest original offset downward.
+            for (u32 i = 1; i < repackOrderCount; ++i) {
+                const u32 keyNode = repackOrder[i];
+                const u32 keyOffset = nodes[keyNode].dataOffset;
+                u32 j = i;
+                while (j > 0) {
+                    const u32 prevNode = repackOrder[j - 1];
+                    if (nodes[prevNode].dataOffset >= keyOffset) break;
+                    repackOrder[j] = prevNode;
+                    --j;
+                }
+                repackOrder[j] = keyNode;
+            }
+        }
+    }
+
+    if (useSameHeapRepack) {
+        // Free first, then recreate from compressed data; the old decompressed buffer has no headroom for growth.
+        PatchPlatform::Free(archiveBase, sourceHeap);
+        archiveBase = nullptr;
+        newBuffer = HeapAlloc<u8>(newSize, 0x20, repackHeap);
+        triedSourceHeap = true;
+        if (newBuffer != nullptr) {
+            PatchPlatform::DecodeSourceArchive(compressedData, newBuffer);
+            if (newSize > originalArchiveSize) {
+                memset(newBuffer + originalArchiveSize, 0, newSize - originalArchiveSize);
+            }
+        }
+    } else if (repackHeap != archiveHeap || allowSourceHeap) {
+        newBuffer = HeapAlloc<u8>(newSize, 0x20, repackHeap);
+    }
+    if (newBuffer == nullptr && repackHeap != archiveHeap) {
+        if (allowSourceHeap) {
+            repackHeap = archiveHeap;
+            newBuffer = HeapAlloc<u8>(newSize, 0x20, repackHeap);
+            triedSourceHeap = true;
+        }
+    }
+    if (newBuffer == nullptr && repackHeap == archiveHeap && !triedSourceHeap && allowSourceHeap) {
+        newBuffer = HeapAlloc<u8>(newSize, 0x20, repackHeap);
+        triedSourceHeap = true;
+    }
+    if (newBuffer == nullptr) {
+        PatchPlatform::Report("[Pulsar] Loose override repack allocation failed for '%s': old=0x%X new=0x%X growth=0x%X%s\n",
+                              archiveBaseLower, archiveSize, newSize, growth,
+                              allowSourceHeap ? "" : " source-heap growth capped");
+        if (archiveBase == nullptr && compressedData != nullptr) {
+            // Same-heap repack may already have released the old archive, so rebuild the original before bailing out.
+            archiveBase = HeapAlloc<u8>(originalArchiveSize, 0x20, sourceHeap);
+            if (archiveBase != nullptr) {
+                PatchPlatform::DecodeSourceArchive(compressedData, archiveBase);
+                archiveHeap = sourceHeap;
+                archiveSize = originalArchiveSize;
+            }
+        }
+        if (archiveBase != nullptr) {
+            U8Header *fallbackHeader = reinterpret_cast<U8Header *>(archiveBase);
+            U8Node *fallbackNodes = reinterpret_cast<U8Node *>(archiveBase + fallbackHeader->nodeOffset);
+            // The same-heap repack plan shares its scratch with the slot table, so measure the slots again.
+            BuildArchiveFileSlotCapacities(fallbackNodes, nodeCount, archiveSize, fileNodeOrder, fileSlotCapacities);
+            const u32 oversizedNodes =
+                CountInPlaceOversizedOverrides(entries, fallbackNodes, nodeCount, nodeOverrideIndex, fileSlotCapacities);
+            if (oversizedNodes > 0) {
+                PatchPlatform::Report("[Pulsar] Loose override repack fallback rejected for '%s': oversized=%u missing=%u\n",
+                                      archiveBaseLower, oversizedNodes, missingOverrides);
+                SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, missingOverrides);
+                return false;
+            }
+            patchedNodes = ApplyInPlaceLooseOverrides(entries, archiveBase, fallbackNodes, nodeCount, nodeOverrideIndex,
+                                                      fileSlotCapacities, entryAppliedBits, rangeStart);
+
+            const u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
+
+            if (patchedNodes > 0) {
+                PatchPlatform::Report("[Pulsar] Loose override repack fallback used for '%s': applied=%u patched=%u oversized=%u missing=%u\n",
+                                      archiveBaseLower, appliedOverrides, patchedNodes, oversizedNodes,
+                                      missingOverrides);
+                SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes,
+                                  outMissingOverrides, missingOverrides);
+                return true;
+            }
+        }
+        SetOverrideResult(outAppliedOverrides, 0, outPatchedNodes, 0, outMissingOverrides, missingOverrides);
+        return false;
+    }
+
+    if (!useSameHeapRepack) {
+        // Copy the untouched metadata prefix now; file payloads get rewritten into their new aligned slots below.
+        memcpy(newBuffer, archiveBase, dataStart);
+    }
+    U8Header *newHeader = reinterpret_cast<U8Header *>(newBuffer);
+    newHeader->fileOffset = dataStart;
+    U8Node *newNodes = reinterpret_cast<U8Node *>(newBuffer + newHeader->nodeOffset);
+
+    u32 writeOffset = dataStart;
+    if (useSameHeapRepack) {
+        for (u32 orderIdx = 0; orderIdx < repackOrderCount; ++orderIdx) {
+            const u32 nodeIdx = repackOrder[orderIdx];
+            const u32 oldOffset = newNodes[nodeIdx].dataOffset;
+            const u32 oldSize = newNodes[nodeIdx].dataSize;
+            const u32 newFileSize = repackSizes[nodeIdx];
+            const u32 newOffset = repackOffsets[nodeIdx];
+
+            if (newOffset != oldOffset) {
+                // Same-heap relocation can overlap source and destination ranges, so `memmove` is required.
+                memmove(newBuffer + newOffset, newBuffer + oldOffset, oldSize);
+            }
+
+            newNodes[nodeIdx].dataOffset = newOffset;
+            newNodes[nodeIdx].dataSize = newFileSize;
+        }
+
+        // Persist moved source data before invalidating cache lines for external reads.
+        PatchPlatform::FlushRange(newBuffer, newSize);
+
+        for (u32 orderIdx = 0; orderIdx < repackOrderCount; ++orderIdx) {
+            const u32 nodeIdx = repackOrder[orderIdx];
+            const u16 idx = nodeOverrideIndex[nodeIdx];
+            if (idx == kInvalidScratchIndex16) continue;
+
+            const TaggedOverrideEntry &entry = entries[idx];
+            const u32 oldSize = repackOriginalSizes[nodeIdx];
+            const u32 newOffset = repackOffsets[nodeIdx];
+
+            if (!PatchPlatform::ReadOverride(entry, newBuffer + newOffset)) {
+                // Keep metadata internally consistent; the buffer is decoded again below.
+                newNodes[nodeIdx].dataSize = oldSize;
+                repackPartialFailure = true;
+                continue;
+            }
+            MarkEntryApplied(entryAppliedBits, idx - rangeStart);
+            ++patchedNodes;
+        }
+
+        writeOffset = dataStart + totalDataSize;
+    } else {
+        for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+            if (NodeIsDir(nodes[nodeIdx])) continue;
+
+            const u16 idx = nodeOverrideIndex[nodeIdx];
+            const u32 oldOffset = nodes[nodeIdx].dataOffset;
+            const u32 oldSize = nodes[nodeIdx].dataSize;
+            bool useOverride = (idx != kInvalidScratchIndex16);
+            u32 newFileSize = useOverride ? entries[idx].size : oldSize;
+
+            writeOffset = Align32(writeOffset);
+            if (useOverride && writeOffset + Align32(newFileSize) > newSize) {
+                const TaggedOverrideEntry &entry = entries[idx];
+                const char *relativePath = PatchPlatform::GetSourcePath(entry);
+                PatchPlatform::Report("[Pulsar] Loose override '%s' skipped in '%s': repack buffer too small for 0x%X bytes\n",
+                                      relativePath != nullptr ? relativePath : "<missing>", archiveBaseLower,
+                                      newFileSize);
+                // Recover by copying the original member instead of throwing away the entire repack.
+                useOverride = false;
+                newFileSize = oldSize;
+                repackPartialFailure = true;
+            }
+
+            newNodes[nodeIdx].dataOffset = writeOffset;
+            if (useOverride) {
+                const TaggedOverrideEntry &entry = entries[idx];
+                if (!PatchPlatform::ReadOverride(entry, newBuffer + writeOffset)) {
+                    useOverride = false;
+                    newFileSize = oldSize;
+                    repackPartialFailure = true;
+                } else {
+                    MarkEntryApplied(entryAppliedBits, idx - rangeStart);
+                    ++patchedNodes;
+                }
+            }
+
+            if (!useOverride) {
+                if (writeOffset + Align32(oldSize) > newSize) {
+                    // The layout was planned for a smaller override, so the original no longer fits.
+                    repackAborted = true;
+                    break;
+                }
+                // DecodeChunkedArchive left a member it expected to be replaced zeroed.
+                if (idx != kInvalidScratchIndex16) PatchPlatform::RestoreSkippedRange(archiveBase, oldOffset, oldSize);
+                memcpy(newBuffer + writeOffset, archiveBase + oldOffset, oldSize);
+            }
+
+            newNodes[nodeIdx].dataSize = newFileSize;
+            const u32 paddedSize = Align32(newFileSize);
+            if (paddedSize > newFileSize) {
+                memset(newBuffer + writeOffset + newFileSize, 0, paddedSize - newFileSize);
+            }
+            writeOffset += paddedSize;
+        }
+    }
+
+    u32 appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
+    if (repackAborted || (useSameHeapRepack && repackPartialFailure)) {
+        // Fall back to the overrides that fit in place, like a failed repack allocation does.
+        if (useSameHeapRepack) {
+            // The failed member's original bytes were overwritten, so start over from the SZS.
+            PatchPlatform::DecodeSourceArchive(compressedData, newBuffer);
+            if (newSize > originalArchiveSize) {
+                memset(newBuffer + originalArchiveSize, 0, newSize - originalArchiveSize);
+            }
+            archiveBase = newBuffer;
+            archiveSize = originalArchiveSize;
+            archiveHeap = repackHeap;
+        } else {
+            PatchPlatform::Free(newBuffer, repackHeap);
+        }
+        U8Node *fallbackNodes = reinterpret_cast<U8Node *>(archiveBase + reinterpret_cast<U8Header *>(archiveBase)->nodeOffset);
+        BuildArchiveFileSlotCapacities(fallbackNodes, nodeCount, archiveSize, fileNodeOrder, fileSlotCapacities);
+        RestoreOversizedOverrideNodes(entries, archiveBase, fallbackNodes, nodeCount, nodeOverrideIndex, fileSlotCapacities);
+        ClearEntryAppliedBits(entryAppliedBits, taggedCandidates);
+        patchedNodes = ApplyInPlaceLooseOverrides(entries, archiveBase, fallbackNodes, nodeCount, nodeOverrideIndex,
+                                                  fileSlotCapacities, entryAppliedBits, rangeStart);
+        appliedOverrides = CountAppliedEntries(entryAppliedBits, taggedCandidates);
+        PatchPlatform::FlushRange(archiveBase, archiveSize);
+        PatchPlatform::Report("[Pulsar] Loose override repack discarded for '%s': kept=%u in place, dropped=%u missing=%u\n",
+                              archiveBaseLower, appliedOverrides,
+                              CountUnappliedOverrideNodes(nodeOverrideIndex, nodeCount, entryAppliedBits, rangeStart),
+                              missingOverrides);
+        SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes, outMissingOverrides,
+                          missingOverrides);
+        return appliedOverrides > 0;
+    }
+    if (repackPartialFailure) {
+        // Every member that lost its override was copied back from the original, so the repack stays usable.
+        PatchPlatform::Report("[Pulsar] Loose override repack incomplete for '%s': applied=%u dropped=%u missing=%u\n",
+                              archiveBaseLower, appliedOverrides,
+                              CountUnappliedOverrideNodes(nodeOverrideIndex, nodeCount, entryAppliedBits, rangeStart),
+                              missingOverrides);
+    }
+
+    u32 finalSize = Align32(writeOffset);
+    // Clamp to the allocated size so bad metadata cannot claim a larger archive than the buffer we own.
+    if (finalSize > newSize) finalSize = newSize;
+    if (!useSameHeapRepack && finalSize < newSize) {
+        memset(newBuffer + finalSize, 0, newSize - finalSize);
+    }
+    PatchPlatform::FlushRange(newBuffer, finalSize);
+
+    if (!useSameHeapRepack) {
+        PatchPlatform::Free(archiveBase, sourceHeap);
+    }
+    archiveBase = newBuffer;
+    archiveSize = finalSize;
+    archiveHeap = repackHeap;
+
+    SetOverrideResult(outAppliedOverrides, appliedOverrides, outPatchedNodes, patchedNodes, outMissingOverrides,
+                      missingOverrides);
+    return appliedOverrides > 0;
+}
+
+u32 MarkPatchedU8Nodes(const TaggedOverrideEntry *entries, u32 rangeStart, u32 rangeEnd, const u8 *archiveBase,
+                       u32 archiveSize, u8 *outNodeFlags, u32 nodeCount) {
+    if (entries == nullptr || outNodeFlags == nullptr || rangeEnd <= rangeStart) return 0;
+
+    // Only the header, nodes and names are present yet; payload ranges are checked but never read.
+    if (!IsValidU8Layout(archiveBase, archiveSize)) return 0;
+    const U8Header *header = reinterpret_cast<const U8Header *>(archiveBase);
+    const U8Node *nodes = reinterpret_cast<const U8Node *>(archiveBase + header->nodeOffset);
+    if (nodes[0].dataSize != nodeCount) return 0;
+    const char *stringTable = reinterpret_cast<const char *>(nodes + nodeCount);
+
+    // Same matching rules as PatchU8Archive: subpaths resolve through the U8 tree, basenames fan out.
+    u32 marked = 0;
+    for (u32 i = rangeStart; i < rangeEnd; ++i) {
+        const TaggedOverrideEntry &entry = entries[i];
+        char matchName[OVERRIDE_MAX_PATH];
+        if (!PatchPlatform::GetMatchName(entry, matchName, sizeof(matchName)) || IsEmpty(matchName)) continue;
+
+        if ((entry.flags & OVERRIDEENTRYFLAG_HAS_SUBPATH) != 0) {
+            const s32 entryNum = PatchPlatform::FindU8Entry(archiveBase, matchName);
+            if (entryNum <= 0 || static_cast<u32>(entryNum) >= nodeCount || NodeIsDir(nodes[entryNum])) continue;
+            if (outNodeFlags[entryNum] == 0) ++marked;
+            outNodeFlags[entryNum] = 1;
+            continue;
+        }
+        for (u32 nodeIdx = 1; nodeIdx < nodeCount; ++nodeIdx) {
+            if (NodeIsDir(nodes[nodeIdx]) || outNodeFlags[nodeIdx] != 0) continue;
+            if (strcmp(stringTable + NodeNameOffset(nodes[nodeIdx]), matchName) != 0) continue;
+            outNodeFlags[nodeIdx] = 1;
+            ++marked;
+        }
+    }
+    return marked;
+}
+
+const LoosePatchStats &GetLastLoosePatchStats() {
+    return sLastPatchStats;
+}
+
+void ResetLoosePatchStats() {
+    sLastPatchStats = LoosePatchStats();
+}
+
+u32 GetLoosePatchScratchFootprint() {
+    return GetLooseOverrideScratchFootprint(sLooseOverrideScratch);
+}
+
+void FreeLoosePatchScratch() {
+    FreeLooseOverrideScratch(sLooseOverrideScratch);
+}
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
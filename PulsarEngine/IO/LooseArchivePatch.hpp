@@ -0,0 +1,133 @@
+/*
+ * Loose Archive Overrides
+ *
+ * Developed by patchzy as part of the Retro Rewind project.
+ *
+ * Copyright (C) Retro Rewind.
+ * SPDX-License-Identifier: MIT
+ *
+ * This code is licensed under the MIT License.
+ *
+ * Credit is not legally required, but if you use or adapt this system,
+ * please consider crediting patchzy and/or Retro Rewind team.
+ */
+
+#ifndef _PULSAR_LOOSE_ARCHIVE_PATCH_
+#define _PULSAR_LOOSE_ARCHIVE_PATCH_
+
+#include <types.hpp>
+
+// U8 archive patcher behind ApplyLooseOverrides. It only reaches the game through the PatchPlatform functions below,
+// so LooseArchivePatch.cpp also builds natively with -DLOOSE_OVERRIDE_HOST, see scripts/build_loose_override_host.sh.
+
+namespace EGG {
+class Heap;
+}
+
+namespace Pulsar {
+namespace IOOverrides {
+
+enum { OVERRIDE_MAX_PATH = 256,
+       OVERRIDE_MAX_NAME = 64 };
+
+enum OverrideEntryFlags {
+    OVERRIDEENTRYFLAG_NONE = 0,
+    OVERRIDEENTRYFLAG_HAS_SUBPATH = (1 << 0),
+    OVERRIDEENTRYFLAG_IS_DELETE = (1 << 1),
+    OVERRIDEENTRYFLAG_SOURCE_YAZ0 = (1 << 2)
+};
+
+struct TaggedOverrideEntry {
+    u32 sourcePathOffset;
+    s32 sourceEntryNum;
+    u32 matchPathOffset;
+    u32 dataOffset;
+    u32 size;
+    u16 tagId;
+    u16 flags;
+};
+
+// Same layout as ARC::Header, in the byte order of the CPU running the patcher
+struct U8Header {
+    u32 magic;
+    u32 nodeOffset;
+    u32 combinedNodeSize;
+    u32 fileOffset;
+    u32 reserved[4];
+};
+
+struct U8Node {
+    u32 typeName;
+    u32 dataOffset;
+    u32 dataSize;
+};
+
+inline bool NodeIsDir(const U8Node &node) {
+    return (node.typeName >> 24) != 0;
+}
+
+inline u32 NodeNameOffset(const U8Node &node) {
+    return node.typeName & 0x00FFFFFF;
+}
+
+// Numbers from the last PatchU8Archive call; nodeCount stays 0 when the archive was rejected before matching.
+struct LoosePatchStats {
+    u32 nodeCount;
+    u32 candidates;
+    u32 tempBytes;
+};
+
+// Header, nodes and names must fit in the first metaLimit bytes; payloads only have to fit in archiveSize.
+bool IsValidU8Layout(const u8 *archive, u32 archiveSize, u32 metaLimit);
+bool IsValidU8Layout(const u8 *archive, u32 archiveSize);
+
+// Matches entries[rangeStart, rangeEnd), one archive tag's bucket, against the U8 nodes, then patches payloads in
+// place, repacks the payload region, or rebuilds the node tree when files are added or deleted. archiveBase,
+// archiveSize and archiveHeap are updated when the archive moves. compressedData is the source SZS, needed to
+// repack on the archive's own heap; pass nullptr when it is gone.
+bool PatchU8Archive(const char *archiveBaseLower, const TaggedOverrideEntry *entries, u32 rangeStart, u32 rangeEnd,
+                    u8 *&archiveBase, u32 &archiveSize, EGG::Heap *sourceHeap, EGG::Heap *&archiveHeap,
+                    u32 *outAppliedOverrides, u32 *outPatchedNodes, u32 *outMissingOverrides,
+                    const u8 *compressedData);
+
+// Flags every node PatchU8Archive would replace or delete, reading only the header, nodes and names.
+u32 MarkPatchedU8Nodes(const TaggedOverrideEntry *entries, u32 rangeStart, u32 rangeEnd, const u8 *archiveBase,
+                       u32 archiveSize, u8 *outNodeFlags, u32 nodeCount);
+
+const LoosePatchStats &GetLastLoosePatchStats();
+void ResetLoosePatchStats();
+// Node, entry and repack tables are kept across calls and only grow
+u32 GetLoosePatchScratchFootprint();
+void FreeLoosePatchScratch();
+
+// Implemented by LooseOverridePlatform.cpp and LooseArchiveOverrides.cpp in the game, and by
+// scripts/loose_override_host natively.
+namespace PatchPlatform {
+
+EGG::Heap *GetRootHeapMEM1();
+EGG::Heap *GetRootHeapMEM2();
+EGG::Heap *GetOverridesHeap();
+void *Alloc(u32 size, s32 align, EGG::Heap *heap);
+void Free(void *block, EGG::Heap *heap);
+u32 GetAllocatableSize(EGG::Heap *heap);
+
+void Report(const char *format, ...);
+void FlushRange(void *data, u32 size);
+// Decodes the archive's SZS again, for the repacks that had to give up its decoded copy first
+void DecodeSourceArchive(const u8 *compressedData, u8 *dest);
+// Path lookup through the U8 tree with ARC's rules, -1 when nothing matches
+s32 FindU8Entry(const u8 *archiveBase, const char *path);
+// Brings back the payload of a member that a chunked decode skipped, no-op otherwise
+void RestoreSkippedRange(u8 *archiveBase, u32 offset, u32 size);
+
+bool GetMatchName(const TaggedOverrideEntry &entry, char *outName, u32 outNameSize);
+bool ReadOverride(const TaggedOverrideEntry &entry, void *dest);
+// For logs only, may return nullptr
+const char *GetSourcePath(const TaggedOverrideEntry &entry);
+
+}  // namespace PatchPlatform
+
+}  // namespace IOOverrides
+}  // namespace Pulsar
+
+#endif  // _PULSAR_LOOSE_ARCHIVE_PATCH_
@@ -0,0 +1,89 @@
+/*
+ * Loose Archive Overrides
+ *
+ * Developed by patchzy as part of the Retro Rewind project.
+ *
+ * Copyright (C) Retro Rewind.
+ * SPDX-License-Identifier: MIT
+ *
+ * This code is licensed under the MIT License.
+ *
+ * Credit is not legally required, but if you use or adapt this system,
+ * please consider crediting patchzy and/or Retro Rewind team.
+ */
+
+#include <kamek.hpp>
+#include <PulsarSystem.hpp>
+#include <IO/LooseArchivePatch.hpp>
+#include <IO/ChunkedArchive.hpp>
+#include <include/c_stdarg.h>
+#include <include/c_stdio.h>
+#include <core/egg/Decomp.hpp>
+#include <core/egg/mem/Heap.hpp>
+#include <core/RK/RKSystem.hpp>
+#include <core/rvl/arc/arc.hpp>
+#include <core/rvl/os/OS.hpp>
+#include <core/rvl/os/OSCache.hpp>
+
+// Game side of the heap and I/O shim LooseArchivePatch.cpp is built against; the override entry accessors live in
+// LooseArchiveOverrides.cpp next to the database they read.
+
+namespace Pulsar {
+namespace IOOverrides {
+namespace PatchPlatform {
+
+EGG::Heap *GetRootHeapMEM1() {
+    return RKSystem::mInstance.EGGRootMEM1;
+}
+
+EGG::Heap *GetRootHeapMEM2() {
+    return RKSystem::mInstance.EGGRootMEM2;
+}
+
+EGG::Heap *GetOverridesHeap() {
+    System *system = System::sInstance;
+    if (system == nullptr) return nullptr;
+    return static_cast<EGG::Heap *>(system->heap);
+}
+
+void *Alloc(u32 size, s32 align, EGG::Heap *heap) {
+    return EGG::Heap::alloc(size, align, heap);
+}
+
+void Free(void *block, EGG::Heap *heap) {
+    EGG::Heap::free(block, heap);
+}
+
+u32 GetAllocatableSize(EGG::Heap *heap) {
+    return heap->getAllocatableSize(0x20);
+}
+
+void Report(const char *format, ...) {
+    char buffer[0x200];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    OS::Report("%s", buffer);
+}
+
+void FlushRange(void *data, u32 size) {
+    OS::DCStoreRange(data, size);
+}
+
+void DecodeSourceArchive(const u8 *compressedData, u8 *dest) {
+    EGG::Decomp::decodeSZS(const_cast<u8 *>(compressedData), dest);
+}
+
+s32 FindU8Entry(const u8 *archiveBase, const char *path) {
+    ARC::Handle handle;
+    if (!ARC::InitHandle(const_cast<u8 *>(archiveBase), &handle)) return -1;
+    return ARC::ConvertPathToEntrynum(&handle, path);
+}
+
+void RestoreSkippedRange(u8 *archiveBase, u32 offset, u32 size) {
+    RestoreChunkedArchiveRange(archiveBase, offset, size);
+}
+
+}  // namespace PatchPlatform
+}  // namespace IOOverrides
+}  // namespace Pulsar
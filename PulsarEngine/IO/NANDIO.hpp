@@ -20,7 +20,7 @@ class NANDIO : public IOSIO {
     bool CreateFolder(const char *path) override;
     void ReadFolder(const char *path) override;
 
-    friend IO *IO::CreateInstance(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread);
+    friend IO *IO::Create(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread);
 };
 
 }  // namespace Pulsar
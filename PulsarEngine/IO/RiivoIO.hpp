@@ -114,7 +114,7 @@ class RiivoIO : public IOSIO {
     s32 GetDevice_fd() const;
     RiivoMode GetRiivoMode(u32 mode) const;
 
-    friend IO *IO::CreateInstance(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread);
+    friend IO *IO::Create(IOType type, EGG::Heap *heap, EGG::TaskThread *const taskThread);
 };
 
 struct RiivoStats {
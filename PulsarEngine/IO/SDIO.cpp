@@ -91,6 +91,13 @@ bool SDIO::OpenFolderStream(const char *path) {
 }
 
 bool SDIO::ReadFolderEntry(char *outFilename, u32 outFilenameSize, bool &outIsDirectory) {
+    u32 size;
+    u32 modifiedTime;
+    return this->ReadFolderEntry(outFilename, outFilenameSize, outIsDirectory, size, modifiedTime);
+}
+
+bool SDIO::ReadFolderEntry(char *outFilename, u32 outFilenameSize, bool &outIsDirectory, u32 &outSize,
+                           u32 &outModifiedTime) {
     if (!isFolderOpen || outFilename == nullptr || outFilenameSize == 0) return false;
 
     char filename[SD_MAX_FILENAME_LENGTH];
@@ -104,6 +111,8 @@ bool SDIO::ReadFolderEntry(char *outFilename, u32 outFilenameSize, bool &outIsDi
         if (written <= 0 || static_cast<u32>(written) >= outFilenameSize) continue;
 
         outIsDirectory = (entryStat.st_mode & S_IFMT) == S_IFDIR;
+        outSize = static_cast<u32>(entryStat.st_size);
+        outModifiedTime = static_cast<u32>(entryStat.st_mtime);
         return true;
     }
 }
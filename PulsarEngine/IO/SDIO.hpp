@@ -20,10 +20,15 @@ struct dir_struct {
     u8 _unused[836];
 };
 
+// newlib layout: 64-bit off_t and timespec seconds, st_mtime is st_mtim.tv_sec.
 struct stat {
     u8 _unused[8];
     u32 st_mode;
-    u8 _unused2[76];
+    u8 _unused2[12];
+    s64 st_size;
+    u8 _unused3[16];
+    s64 st_mtime;
+    u8 _unused4[32];
 };
 
 // Should be in sync with the assertions in runtime-ext
@@ -36,6 +41,8 @@ public:
     SDIO(IOType type, EGG::Heap *heap, EGG::TaskThread *taskThread)
         : IO(type, heap, taskThread), isFolderOpen(false) {
         offset_assert(stat, st_mode, 8);
+        offset_assert(stat, st_size, 0x18);
+        offset_assert(stat, st_mtime, 0x30);
         offset_assert(file_struct, filesize, 0);
         fileNames = nullptr;
     }
@@ -50,6 +57,9 @@ public:
     void CloseFolder() override;
     bool OpenFolderStream(const char *path);
     bool ReadFolderEntry(char *outFilename, u32 outFilenameSize, bool &outIsDirectory);
+    // Same as above, also returning the entry's size and modification time without opening it.
+    bool ReadFolderEntry(char *outFilename, u32 outFilenameSize, bool &outIsDirectory, u32 &outSize,
+                         u32 &outModifiedTime);
     void CloseFolderStream();
 
     s32 GetFileSize() override;
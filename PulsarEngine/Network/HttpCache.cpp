@@ -0,0 +1,260 @@
+#include <kamek.hpp>
+#include <Network/HttpCache.hpp>
+#include <PulsarSystem.hpp>
+#include <IO/IO.hpp>
+#include <IO/ArchiveCache.hpp>
+#include <core/RK/RKSystem.hpp>
+#include <core/egg/mem/Heap.hpp>
+#include <core/nw4r/ut/Misc.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <include/c_stdio.h>
+#include <include/c_string.h>
+
+namespace Pulsar {
+namespace Network {
+
+namespace {
+const u32 kHttpCacheMaxEntries = 8;
+const u32 kHttpCacheUrlSize = 128;
+// A few leaderboard pages plus the badge list; bodies past that are simply downloaded every time.
+const u32 kHttpCacheMaxBytes = 0x60000;
+#ifdef HTTP_CACHE_PERSIST
+const u32 kHttpCacheMagic = 'HTTC';
+const u16 kHttpCacheVersion = 2;
+// Writes happen on the main thread, so only bodies that are quick to write are kept across boots.
+const u32 kHttpCachePersistMaxBody = 0x4000;
+#endif
+}  // namespace
+
+struct HttpCacheEntry {
+    char url[kHttpCacheUrlSize];
+    char *data;
+    u32 size;
+    u32 fetchedSec;
+    u32 maxAgeSec;
+    u32 lastUse;
+};
+
+static HttpCacheEntry sEntries[kHttpCacheMaxEntries];
+static HttpCacheStats sStats;
+static u32 sCachedBytes = 0;
+static u32 sUseClock = 0;
+
+static EGG::Heap *GetHttpCacheHeap() {
+    return RKSystem::mInstance.EGGRootMEM2;
+}
+
+static u32 GetNowSec() {
+    return OS::TicksToSeconds(OS::GetTime());
+}
+
+static void CopyField(char *dest, const char *src, u32 destSize) {
+    if (src == nullptr) src = "";
+    strncpy(dest, src, destSize - 1);
+    dest[destSize - 1] = '\0';
+}
+
+static void ReleaseEntry(HttpCacheEntry &entry) {
+    if (entry.data == nullptr) return;
+    EGG::Heap::free(entry.data, GetHttpCacheHeap());
+    sCachedBytes -= nw4r::ut::RoundUp(entry.size, 0x20);
+    entry.data = nullptr;
+    entry.size = 0;
+    entry.url[0] = '\0';
+}
+
+static void EvictEntry(HttpCacheEntry &entry) {
+    if (entry.data == nullptr) return;
+    ReleaseEntry(entry);
+    ++sStats.evictions;
+}
+
+static HttpCacheEntry *FindLeastRecentlyUsed() {
+    HttpCacheEntry *oldest = nullptr;
+    for (u32 i = 0; i < kHttpCacheMaxEntries; ++i) {
+        HttpCacheEntry &entry = sEntries[i];
+        if (entry.data == nullptr) continue;
+        if (oldest == nullptr || entry.lastUse < oldest->lastUse) oldest = &entry;
+    }
+    return oldest;
+}
+
+// body may be null when the caller fills the data itself
+static HttpCacheEntry *AllocEntry(const char *url, const char *body, u32 size);
+
+#ifdef HTTP_CACHE_PERSIST
+struct PersistedHeader {
+    u32 magic;
+    u16 version;
+    u16 count;
+    u8 padding[24];
+};
+
+struct PersistedEntry {
+    char url[kHttpCacheUrlSize];
+    u32 fetchedSec;
+    u32 maxAgeSec;
+    u32 size;  // body follows, padded to 0x20
+    u8 padding[20];
+};
+
+static char sPersistPath[IOS::ipcMaxPath];
+static bool sPersistLoaded = false;
+
+static bool IsPersistable(const HttpCacheEntry &entry) {
+    return entry.data != nullptr && entry.size <= kHttpCachePersistMaxBody;
+}
+
+static const char *GetPersistPath() {
+    if (sPersistPath[0] == '\0') {
+        const System *sys = System::sInstance;
+        if (sys == nullptr) return nullptr;
+        snprintf(sPersistPath, IOS::ipcMaxPath, "%s/RRHttpCache.pul", sys->GetModFolder());
+    }
+    return sPersistPath;
+}
+
+static void LoadPersisted() {
+    if (sPersistLoaded) return;
+    IO *io = IO::sInstance;
+    const char *path = GetPersistPath();
+    if (io == nullptr || path == nullptr) return;
+    sPersistLoaded = true;
+    if (!io->OpenFile(path, FILE_MODE_READ)) return;
+
+    PersistedHeader header __attribute__((aligned(32)));
+    if (io->Read(sizeof(header), &header) != sizeof(header) || header.magic != kHttpCacheMagic ||
+        header.version != kHttpCacheVersion) {
+        io->Close();
+        return;
+    }
+
+    for (u16 i = 0; i < header.count && i < kHttpCacheMaxEntries; ++i) {
+        PersistedEntry persisted __attribute__((aligned(32)));
+        if (io->Read(sizeof(persisted), &persisted) != sizeof(persisted)) break;
+        if (persisted.size == 0 || persisted.size > kHttpCachePersistMaxBody) break;
+
+        persisted.url[kHttpCacheUrlSize - 1] = '\0';
+        HttpCacheEntry *entry = AllocEntry(persisted.url, nullptr, persisted.size);
+        if (entry == nullptr) break;
+        const u32 paddedSize = nw4r::ut::RoundUp(persisted.size, 0x20);
+        if (io->Read(paddedSize, entry->data) != static_cast<s32>(paddedSize)) {
+            ReleaseEntry(*entry);
+            break;
+        }
+        entry->fetchedSec = persisted.fetchedSec;
+        entry->maxAgeSec = persisted.maxAgeSec;
+    }
+    io->Close();
+}
+
+static void SavePersisted() {
+    IO *io = IO::sInstance;
+    const char *path = GetPersistPath();
+    if (io == nullptr || path == nullptr) return;
+    if (!io->OpenFile(path, FILE_MODE_WRITE) && !io->CreateAndOpen(path, FILE_MODE_WRITE)) return;
+
+    PersistedHeader header __attribute__((aligned(32)));
+    memset(&header, 0, sizeof(header));
+    header.magic = kHttpCacheMagic;
+    header.version = kHttpCacheVersion;
+    for (u32 i = 0; i < kHttpCacheMaxEntries; ++i) {
+        if (IsPersistable(sEntries[i])) ++header.count;
+    }
+    io->Overwrite(sizeof(header), &header);
+
+    for (u32 i = 0; i < kHttpCacheMaxEntries; ++i) {
+        const HttpCacheEntry &entry = sEntries[i];
+        if (!IsPersistable(entry)) continue;
+        PersistedEntry persisted __attribute__((aligned(32)));
+        memset(&persisted, 0, sizeof(persisted));
+        memcpy(persisted.url, entry.url, kHttpCacheUrlSize);
+        persisted.fetchedSec = entry.fetchedSec;
+        persisted.maxAgeSec = entry.maxAgeSec;
+        persisted.size = entry.size;
+        io->Write(sizeof(persisted), &persisted);
+
+        io->Write(nw4r::ut::RoundUp(entry.size, 0x20), entry.data);
+    }
+    io->Close();
+}
+#endif
+
+static HttpCacheEntry *FindEntry(const char *url) {
+#ifdef HTTP_CACHE_PERSIST
+    LoadPersisted();
+#endif
+    for (u32 i = 0; i < kHttpCacheMaxEntries; ++i) {
+        HttpCacheEntry &entry = sEntries[i];
+        if (entry.data != nullptr && strcmp(entry.url, url) == 0) return &entry;
+    }
+    return nullptr;
+}
+
+static HttpCacheEntry *AllocEntry(const char *url, const char *body, u32 size) {
+    EGG::Heap *heap = GetHttpCacheHeap();
+    const u32 allocSize = nw4r::ut::RoundUp(size, 0x20);
+    if (heap == nullptr || size == 0 || allocSize > kHttpCacheMaxBytes || strlen(url) >= kHttpCacheUrlSize) return nullptr;
+
+    while (sCachedBytes + allocSize > kHttpCacheMaxBytes) {
+        HttpCacheEntry *oldest = FindLeastRecentlyUsed();
+        if (oldest == nullptr) break;
+        EvictEntry(*oldest);
+    }
+    if (heap->getAllocatableSize(0x20) < IOOverrides::kCacheHeadroom + allocSize) return nullptr;
+
+    HttpCacheEntry *slot = nullptr;
+    for (u32 i = 0; i < kHttpCacheMaxEntries && slot == nullptr; ++i) {
+        if (sEntries[i].data == nullptr) slot = &sEntries[i];
+    }
+    if (slot == nullptr) {
+        slot = FindLeastRecentlyUsed();
+        EvictEntry(*slot);
+    }
+
+    // Tail allocations keep cached bodies away from the head, where the root heap hands out scene heaps.
+    char *data = reinterpret_cast<char *>(EGG::Heap::alloc(allocSize, -0x20, heap));
+    if (data == nullptr) return nullptr;
+    // Bodies are stored padded to 0x20 so the persisted copy can be read and written in place
+    memset(data + size, 0, allocSize - size);
+    if (body != nullptr) memcpy(data, body, size);
+
+    CopyField(slot->url, url, kHttpCacheUrlSize);
+    slot->data = data;
+    slot->size = size;
+    slot->lastUse = ++sUseClock;
+    sCachedBytes += allocSize;
+    return slot;
+}
+
+bool GetFreshHttpCacheBody(const char *url, const char *&body, u32 &size) {
+    HttpCacheEntry *entry = FindEntry(url);
+    if (entry == nullptr || GetNowSec() - entry->fetchedSec >= entry->maxAgeSec) return false;
+    entry->lastUse = ++sUseClock;
+    body = entry->data;
+    size = entry->size;
+    ++sStats.freshHits;
+    return true;
+}
+
+void StoreHttpCacheEntry(const char *url, const char *body, u32 size, u32 maxAgeSec) {
+    ++sStats.downloads;
+    HttpCacheEntry *entry = FindEntry(url);
+    if (entry != nullptr) ReleaseEntry(*entry);
+    if (maxAgeSec == 0) return;
+
+    entry = AllocEntry(url, body, size);
+    if (entry == nullptr) return;
+    entry->fetchedSec = GetNowSec();
+    entry->maxAgeSec = maxAgeSec;
+#ifdef HTTP_CACHE_PERSIST
+    if (IsPersistable(*entry)) SavePersisted();
+#endif
+}
+
+const HttpCacheStats &GetHttpCacheStats() {
+    return sStats;
+}
+
+}  // namespace Network
+}  // namespace Pulsar
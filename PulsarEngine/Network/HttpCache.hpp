@@ -0,0 +1,27 @@
+#ifndef _PUL_HTTP_CACHE_
+#define _PUL_HTTP_CACHE_
+
+#include <types.hpp>
+
+namespace Pulsar {
+namespace Network {
+
+// Response cache behind the HTTP scheduler, keyed by URL. Bodies live on root MEM2 and are served without touching the
+// network while younger than the max-age the caller asked for; once stale they are downloaded again in full.
+// The scheduler only stores 200 responses. With HTTP_CACHE_PERSIST, small entries are also kept in the mod folder.
+// Only used from the main thread.
+
+struct HttpCacheStats {
+    u32 freshHits;  // served without a request
+    u32 downloads;  // full body fetched and stored
+    u32 evictions;
+};
+
+bool GetFreshHttpCacheBody(const char *url, const char *&body, u32 &size);
+void StoreHttpCacheEntry(const char *url, const char *body, u32 size, u32 maxAgeSec);
+const HttpCacheStats &GetHttpCacheStats();
+
+}  // namespace Network
+}  // namespace Pulsar
+
+#endif
@@ -0,0 +1,38 @@
+#include <Debug/DebugOverlay.hpp>
+#include <Network/HttpCache.hpp>
+#include <Network/NHTTPHelper.hpp>
+#include <include/c_wchar.h>
+
+#ifdef HTTP_CACHE_DEBUG
+namespace Pulsar {
+namespace Network {
+
+// HTTP cache hit rate and the average request times of every priority; most requests happen in menus, so this
+// section is also logged there
+static u32 WriteHttpCache(wchar_t *dest, u32 capacity) {
+    const HttpCacheStats &cache = GetHttpCacheStats();
+    const u32 lookups = cache.freshHits + cache.downloads;
+    int written = ::swprintf(dest, capacity, L"cache %u%% fresh%u dl%u ev%u\n",
+                             lookups == 0 ? 0 : cache.freshHits * 100 / lookups, cache.freshHits, cache.downloads,
+                             cache.evictions);
+    u32 length = written > 0 ? static_cast<u32>(written) : 0;
+    for (u32 priority = 0; priority < HTTP_PRIORITY_COUNT; ++priority) {
+        const HttpLatencyStats &stats = GetHttpLatencyStats(static_cast<HttpPriority>(priority));
+        const u32 finished = stats.completed + stats.failed + stats.cancelled;
+        const u32 remaining = capacity - length;
+        if (remaining <= 1) break;
+        // Average queue wait and service time in milliseconds
+        written = ::swprintf(dest + length, remaining, L"p%u: %u/%u/%u w%u s%u\n", priority, stats.completed,
+                             stats.failed, stats.cancelled, finished == 0 ? 0 : static_cast<u32>(stats.totalWaitMs / finished),
+                             finished == 0 ? 0 : static_cast<u32>(stats.totalServiceMs / finished));
+        if (written <= 0) break;
+        length += static_cast<u32>(written);
+    }
+    return length;
+}
+static Debug::DebugOverlaySection sHttpCacheSection(WriteHttpCache,
+                                                    Debug::DEBUG_OVERLAY_RACE | Debug::DEBUG_OVERLAY_MENU);
+
+}  // namespace Network
+}  // namespace Pulsar
+#endif
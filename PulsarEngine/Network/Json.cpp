@@ -4,52 +4,388 @@ namespace Pulsar {
 namespace Network {
 namespace Json {
 
-const char *SkipWhitespace(const char *p) {
-    while (p != nullptr && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
-    return p;
-}
-
 const char *SkipWhitespace(const char *p, const char *end) {
     if (p == nullptr || end == nullptr) return p;
     while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
     return p;
 }
 
-template <typename T>
-static const char *ParseUnsigned(const char *p, T &out) {
-    out = 0;
-    p = SkipWhitespace(p);
-    if (p == nullptr || *p == '-' || *p < '0' || *p > '9') return nullptr;
-    while (*p >= '0' && *p <= '9') {
-        out = out * 10 + static_cast<T>(*p - '0');
+static bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static s32 HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// p is past the backslash of an escape the tokenizer already validated
+static u32 DecodeEscape(const char *&p) {
+    const char esc = *p++;
+    switch (esc) {
+        case 'b':
+            return '\b';
+        case 'f':
+            return '\f';
+        case 'n':
+            return '\n';
+        case 'r':
+            return '\r';
+        case 't':
+            return '\t';
+        case 'u': {
+            u32 unit = 0;
+            for (int i = 0; i < 4; ++i) unit = (unit << 4) | static_cast<u32>(HexValue(*p++));
+            return unit;
+        }
+        default:  // '"', '\\' and '/'
+            return static_cast<u8>(esc);
+    }
+}
+
+// Next UTF-16 code unit of a string token; malformed or 4-byte UTF-8 sequences come out as '?'
+static u32 DecodeUnit(const char *&p, const char *end) {
+    const u8 c = static_cast<u8>(*p++);
+    if (c == '\\') return DecodeEscape(p);
+    if (c < 0x80) return c;
+
+    u32 trailing;
+    u32 unit;
+    if ((c & 0xe0) == 0xc0) {
+        trailing = 1;
+        unit = c & 0x1f;
+    } else if ((c & 0xf0) == 0xe0) {
+        trailing = 2;
+        unit = c & 0x0f;
+    } else {
+        return '?';
+    }
+    for (u32 i = 0; i < trailing; ++i) {
+        if (p >= end || (static_cast<u8>(*p) & 0xc0) != 0x80) return '?';
+        unit = (unit << 6) | (static_cast<u8>(*p++) & 0x3f);
+    }
+    return unit;
+}
+
+static bool AccumulateDigit(u64 &value, u32 digit, u64 limit) {
+    if (value > (limit - digit) / 10) return false;
+    value = value * 10 + digit;
+    return true;
+}
+
+// Digits past the first kept ones are dropped and must all be zero
+static bool AccumulateDigits(const char *p, const char *end, s32 &index, s32 kept, u64 limit, u64 &value) {
+    for (; p < end; ++p, ++index) {
+        const u32 digit = static_cast<u32>(*p - '0');
+        if (index >= kept) {
+            if (digit != 0) return false;
+        } else if (!AccumulateDigit(value, digit, limit)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Magnitude of a validated number token without its sign. Integral values written with a fraction or an exponent,
+// 1234.0 or 1.5e3, are accepted; anything with a non-zero fractional part is not.
+static bool ParseIntegralMagnitude(const char *p, const char *end, u64 limit, u64 &out) {
+    const char *intStart = p;
+    while (p < end && IsDigit(*p)) ++p;
+    const char *intEnd = p;
+    const char *fracStart = p;
+    const char *fracEnd = p;
+    if (p < end && *p == '.') {
+        fracStart = ++p;
+        while (p < end && IsDigit(*p)) ++p;
+        fracEnd = p;
+    }
+    s32 exponent = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
         ++p;
+        const bool negativeExponent = p < end && *p == '-';
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        for (; p < end && IsDigit(*p); ++p) {
+            if (exponent < 1000) exponent = exponent * 10 + (*p - '0');
+        }
+        if (negativeExponent) exponent = -exponent;
     }
-    return p;
+
+    // All digits read as one integer, then shifted by the exponent minus the fraction length
+    const s32 shift = exponent - static_cast<s32>(fracEnd - fracStart);
+    const s32 digitCount = static_cast<s32>((intEnd - intStart) + (fracEnd - fracStart));
+    const s32 kept = shift < 0 ? digitCount + shift : digitCount;
+    u64 value = 0;
+    s32 index = 0;
+    if (!AccumulateDigits(intStart, intEnd, index, kept, limit, value)) return false;
+    if (!AccumulateDigits(fracStart, fracEnd, index, kept, limit, value)) return false;
+    for (s32 i = 0; i < shift && value != 0; ++i) {
+        if (!AccumulateDigit(value, 0, limit)) return false;
+    }
+    out = value;
+    return true;
 }
 
-const char *ParseU32(const char *p, u32 &out) {
-    return ParseUnsigned(p, out);
+// Validates a string token; p is past the opening quote and ends past the closing one
+static ParseResult ScanString(const char *&p, const char *end, StringRef &out) {
+    out.data = p;
+    out.hasEscapes = false;
+    while (p < end) {
+        const u8 c = static_cast<u8>(*p);
+        if (c == '"') {
+            out.length = static_cast<u32>(p - out.data);
+            ++p;
+            return PARSE_OK;
+        }
+        if (c < 0x20) return PARSE_ERROR_SYNTAX;
+        ++p;
+        if (c != '\\') continue;
+
+        out.hasEscapes = true;
+        if (p >= end) return PARSE_ERROR_TRUNCATED;
+        const char esc = *p++;
+        if (esc == 'u') {
+            for (int i = 0; i < 4; ++i, ++p) {
+                if (p >= end) return PARSE_ERROR_TRUNCATED;
+                if (HexValue(*p) < 0) return PARSE_ERROR_SYNTAX;
+            }
+        } else if (esc != '"' && esc != '\\' && esc != '/' && esc != 'b' && esc != 'f' && esc != 'n' && esc != 'r' &&
+                   esc != 't') {
+            return PARSE_ERROR_SYNTAX;
+        }
+    }
+    return PARSE_ERROR_TRUNCATED;
 }
 
-const char *ParseU64(const char *p, u64 &out) {
-    return ParseUnsigned(p, out);
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static ParseResult ScanNumber(const char *&p, const char *end, NumberRef &out) {
+    out.data = p;
+    out.isInteger = true;
+    out.isNegative = false;
+    if (*p == '-') {
+        out.isNegative = true;
+        ++p;
+    }
+    if (p >= end) return PARSE_ERROR_TRUNCATED;
+    if (*p == '0') {
+        ++p;
+    } else if (IsDigit(*p)) {
+        while (p < end && IsDigit(*p)) ++p;
+    } else {
+        return PARSE_ERROR_SYNTAX;
+    }
+
+    if (p < end && *p == '.') {
+        out.isInteger = false;
+        ++p;
+        if (p >= end) return PARSE_ERROR_TRUNCATED;
+        if (!IsDigit(*p)) return PARSE_ERROR_SYNTAX;
+        while (p < end && IsDigit(*p)) ++p;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        out.isInteger = false;
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        if (p >= end) return PARSE_ERROR_TRUNCATED;
+        if (!IsDigit(*p)) return PARSE_ERROR_SYNTAX;
+        while (p < end && IsDigit(*p)) ++p;
+    }
+    out.length = static_cast<u32>(p - out.data);
+    return PARSE_OK;
 }
 
-bool ParseU32(const char *&p, const char *end, u32 &value) {
-    if (p == nullptr || end == nullptr) return false;
-    p = SkipWhitespace(p, end);
-    if (p >= end || *p < '0' || *p > '9') return false;
+static ParseResult ScanLiteral(const char *&p, const char *end, const char *literal) {
+    for (; *literal != '\0'; ++literal, ++p) {
+        if (p >= end) return PARSE_ERROR_TRUNCATED;
+        if (*p != *literal) return PARSE_ERROR_SYNTAX;
+    }
+    return PARSE_OK;
+}
 
-    value = 0;
-    while (p < end && *p >= '0' && *p <= '9') {
-        const u32 digit = static_cast<u32>(*p - '0');
-        if (value > (0xffffffffu - digit) / 10) return false;
-        value = value * 10 + digit;
+enum TokenizerState {
+    STATE_VALUE,
+    STATE_ARRAY_FIRST,  // after '[': a value or ']'
+    STATE_OBJECT_FIRST,  // after '{': a key or '}'
+    STATE_KEY,
+    STATE_AFTER_VALUE,  // ',' or the end of the open container
+    STATE_DONE
+};
+
+bool StringRef::Equals(const char *literal) const {
+    if (literal == nullptr) return false;
+    const char *p = this->data;
+    const char *end = this->data + this->length;
+    while (p < end) {
+        if (*literal == '\0') return false;
+        if (DecodeUnit(p, end) != static_cast<u8>(*literal++)) return false;
+    }
+    return *literal == '\0';
+}
+
+u32 StringRef::CopyAscii(char *out, u32 outSize) const {
+    if (out == nullptr || outSize == 0) return 0;
+    const char *p = this->data;
+    const char *end = this->data + this->length;
+    u32 o = 0;
+    while (p < end && o + 1 < outSize) {
+        const u32 unit = DecodeUnit(p, end);
+        out[o++] = unit < 0x80 ? static_cast<char>(unit) : '?';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+u32 StringRef::CopyWide(wchar_t *out, u32 outSize) const {
+    if (out == nullptr || outSize == 0) return 0;
+    const char *p = this->data;
+    const char *end = this->data + this->length;
+    u32 o = 0;
+    while (p < end && o + 1 < outSize) out[o++] = static_cast<wchar_t>(DecodeUnit(p, end));
+    out[o] = L'\0';
+    return o;
+}
+
+bool NumberRef::ToU32(u32 &out) const {
+    if (this->isNegative) return false;
+    u64 value;
+    if (!ParseIntegralMagnitude(this->data, this->data + this->length, 0xffffffffu, value)) return false;
+    out = static_cast<u32>(value);
+    return true;
+}
+
+bool NumberRef::ToU64(u64 &out) const {
+    if (this->isNegative) return false;
+    return ParseIntegralMagnitude(this->data, this->data + this->length, 0xffffffffffffffffull, out);
+}
+
+bool NumberRef::ToS32(s32 &out) const {
+    const char *digits = this->isNegative ? this->data + 1 : this->data;
+    const u64 limit = this->isNegative ? 0x80000000u : 0x7fffffffu;
+    u64 magnitude;
+    if (!ParseIntegralMagnitude(digits, this->data + this->length, limit, magnitude)) return false;
+    out = static_cast<s32>(this->isNegative ? -static_cast<s64>(magnitude) : static_cast<s64>(magnitude));
+    return true;
+}
+
+bool NumberRef::ToFloat(float &out) const {
+    const char *p = this->isNegative ? this->data + 1 : this->data;
+    const char *end = this->data + this->length;
+    double value = 0.0;
+    for (; p < end && IsDigit(*p); ++p) value = value * 10.0 + static_cast<double>(*p - '0');
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && IsDigit(*p); ++p) {
+            value += static_cast<double>(*p - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
         ++p;
+        const bool negativeExponent = p < end && *p == '-';
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        u32 exponent = 0;
+        for (; p < end && IsDigit(*p); ++p) {
+            if (exponent < 100) exponent = exponent * 10 + static_cast<u32>(*p - '0');
+        }
+        for (u32 i = 0; i < exponent && value != 0.0; ++i) {
+            value = negativeExponent ? value * 0.1 : value * 10.0;
+            if (value > 3.4e38) return false;
+        }
     }
+    if (value > 3.4e38) return false;
+    out = static_cast<float>(this->isNegative ? -value : value);
     return true;
 }
 
+ParseResult Parse(const char *data, u32 length, Handler &handler, u32 maxDepth) {
+    if (data == nullptr) return PARSE_ERROR_TRUNCATED;
+    if (maxDepth > kMaxDepthLimit) maxDepth = kMaxDepthLimit;
+
+    const char *p = data;
+    const char *end = data + length;
+    u32 depth = 0;
+    u32 arrayBits = 0;  // bit n is set when the container opened at depth n is an array
+    TokenizerState state = STATE_VALUE;
+
+    for (;;) {
+        p = SkipWhitespace(p, end);
+        if (p >= end) return state == STATE_DONE ? PARSE_OK : PARSE_ERROR_TRUNCATED;
+        const char c = *p;
+
+        if (state == STATE_DONE) return PARSE_ERROR_SYNTAX;
+
+        if (state == STATE_AFTER_VALUE || (state == STATE_ARRAY_FIRST && c == ']') ||
+            (state == STATE_OBJECT_FIRST && c == '}')) {
+            const bool inArray = (arrayBits >> (depth - 1)) & 1;
+            if (c == ',' && state == STATE_AFTER_VALUE) {
+                ++p;
+                state = inArray ? STATE_VALUE : STATE_KEY;
+                continue;
+            }
+            if (c != (inArray ? ']' : '}')) return PARSE_ERROR_SYNTAX;
+            ++p;
+            --depth;
+            if (!(inArray ? handler.OnArrayEnd(depth) : handler.OnObjectEnd(depth))) return PARSE_STOPPED;
+            state = depth == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+            continue;
+        }
+
+        if (state == STATE_OBJECT_FIRST || state == STATE_KEY) {
+            if (c != '"') return PARSE_ERROR_SYNTAX;
+            ++p;
+            StringRef key;
+            const ParseResult result = ScanString(p, end, key);
+            if (result != PARSE_OK) return result;
+            p = SkipWhitespace(p, end);
+            if (p >= end) return PARSE_ERROR_TRUNCATED;
+            if (*p != ':') return PARSE_ERROR_SYNTAX;
+            ++p;
+            if (!handler.OnKey(key, depth)) return PARSE_STOPPED;
+            state = STATE_VALUE;
+            continue;
+        }
+
+        // STATE_VALUE or the first value of an array
+        bool keepGoing;
+        if (c == '{' || c == '[') {
+            if (depth >= maxDepth) return PARSE_ERROR_DEPTH;
+            ++p;
+            const bool isArray = c == '[';
+            keepGoing = isArray ? handler.OnArrayBegin(depth) : handler.OnObjectBegin(depth);
+            if (isArray) arrayBits |= 1u << depth;
+            else arrayBits &= ~(1u << depth);
+            ++depth;
+            if (!keepGoing) return PARSE_STOPPED;
+            state = isArray ? STATE_ARRAY_FIRST : STATE_OBJECT_FIRST;
+            continue;
+        }
+
+        ParseResult result;
+        if (c == '"') {
+            ++p;
+            StringRef value;
+            result = ScanString(p, end, value);
+            keepGoing = result == PARSE_OK && handler.OnString(value, depth);
+        } else if (c == '-' || IsDigit(c)) {
+            NumberRef value;
+            result = ScanNumber(p, end, value);
+            keepGoing = result == PARSE_OK && handler.OnNumber(value, depth);
+        } else if (c == 't' || c == 'f') {
+            result = ScanLiteral(p, end, c == 't' ? "true" : "false");
+            keepGoing = result == PARSE_OK && handler.OnBool(c == 't', depth);
+        } else if (c == 'n') {
+            result = ScanLiteral(p, end, "null");
+            keepGoing = result == PARSE_OK && handler.OnNull(depth);
+        } else {
+            return PARSE_ERROR_SYNTAX;
+        }
+        if (result != PARSE_OK) return result;
+        if (!keepGoing) return PARSE_STOPPED;
+        state = depth == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+    }
+}
+
 }  // namespace Json
 }  // namespace Network
 }  // namespace Pulsar
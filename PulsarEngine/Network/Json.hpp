@@ -7,12 +7,69 @@ namespace Pulsar {
 namespace Network {
 namespace Json {
 
-const char *SkipWhitespace(const char *p);
 const char *SkipWhitespace(const char *p, const char *end);
 
-const char *ParseU32(const char *p, u32 &out);
-const char *ParseU64(const char *p, u64 &out);
-bool ParseU32(const char *&p, const char *end, u32 &out);
+// Single-pass SAX tokenizer shared by every HTTP response parser. It reads a buffer that need not be null-terminated,
+// never reads past its length, never allocates and keeps no copies: strings and numbers are handed out as spans of
+// the buffer and only decoded when the handler asks for it.
+
+const u32 kDefaultMaxDepth = 16;
+const u32 kMaxDepthLimit = 32;  // open containers are tracked in one u32
+
+enum ParseResult {
+    PARSE_OK,
+    PARSE_STOPPED,  // a handler callback returned false
+    PARSE_ERROR_SYNTAX,
+    PARSE_ERROR_DEPTH,
+    PARSE_ERROR_TRUNCATED  // the buffer ended inside a value
+};
+
+// String token without its quotes; escapes are resolved by the copy and compare functions
+struct StringRef {
+    bool Equals(const char *literal) const;
+    // Both return the number of characters written, out is always terminated. Non-ASCII characters become '?' in
+    // CopyAscii; CopyWide decodes UTF-8 and \u escapes to UTF-16 code units.
+    u32 CopyAscii(char *out, u32 outSize) const;
+    u32 CopyWide(wchar_t *out, u32 outSize) const;
+
+    const char *data;
+    u32 length;
+    bool hasEscapes;
+};
+
+// Number token exactly as it appears in the buffer, already validated against the JSON grammar
+struct NumberRef {
+    // The integer conversions take any integral value, 1234.0 and 1.5e3 included, and fail on a non-zero fractional
+    // part, on out of range values and, for unsigned types, on negatives
+    bool ToU32(u32 &out) const;
+    bool ToU64(u64 &out) const;
+    bool ToS32(s32 &out) const;
+    bool ToFloat(float &out) const;
+
+    const char *data;
+    u32 length;
+    bool isInteger;  // no fraction and no exponent
+    bool isNegative;
+};
+
+// depth is the number of containers open around the token: a top-level value is at depth 0, the keys and values of a
+// top-level object at depth 1. Begin and End of one container report the same depth. Returning false stops the parse.
+class Handler {
+public:
+    virtual bool OnObjectBegin(u32 /*depth*/) { return true; }
+    virtual bool OnObjectEnd(u32 /*depth*/) { return true; }
+    virtual bool OnArrayBegin(u32 /*depth*/) { return true; }
+    virtual bool OnArrayEnd(u32 /*depth*/) { return true; }
+    virtual bool OnKey(const StringRef & /*key*/, u32 /*depth*/) { return true; }
+    virtual bool OnString(const StringRef & /*value*/, u32 /*depth*/) { return true; }
+    virtual bool OnNumber(const NumberRef & /*value*/, u32 /*depth*/) { return true; }
+    virtual bool OnBool(bool /*value*/, u32 /*depth*/) { return true; }
+    virtual bool OnNull(u32 /*depth*/) { return true; }
+};
+
+// Parses exactly one JSON value spanning the whole buffer, surrounding whitespace aside. maxDepth is capped at
+// kMaxDepthLimit.
+ParseResult Parse(const char *data, u32 length, Handler &handler, u32 maxDepth = kDefaultMaxDepth);
 
 }  // namespace Json
 }  // namespace Network
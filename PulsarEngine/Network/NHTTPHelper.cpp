@@ -1,14 +1,16 @@
 #include <PulsarSystem.hpp>
 #include <Network/NHTTPHelper.hpp>
+#include <Network/HttpCache.hpp>
 #include <core/RK/RKSystem.hpp>
 #include <core/egg/mem/Heap.hpp>
 #include <core/rvl/DWC/NHTTP.hpp>
+#include <core/rvl/NHTTP/NHTTP.hpp>
+#include <include/c_stdio.h>
+#include <include/c_string.h>
 
 namespace Pulsar {
 namespace Network {
 
-static u32 s_activeRequestCount = 0;
-
 void *NHTTPAlloc(u32 size, s32 align) {
     EGG::Heap *heap = RKSystem::mInstance.EGGSystem;
     if (heap == nullptr) return nullptr;
@@ -24,30 +26,355 @@ void NHTTPFree(void *ptr) {
 kmBranch(0x800ed69c, NHTTPAlloc);
 kmBranch(0x800ed6b4, NHTTPFree);
 
-bool PrepareNHTTPRequest() {
-    if (s_activeRequestCount != 0) return true;
+// Each buffer class is allocated by the first request that needs it. NHTTP keeps writing into a buffer until its
+// callback runs, so a class can only be released once none of its buffers is out; the large one is, as soon as
+// nothing in flight or queued needs it, so it only stays around while a leaderboard is loading
+struct HttpBufferClass {
+    u32 size;
+    u32 count;
+    bool releaseWhenIdle;
+};
+static const HttpBufferClass kHttpBufferClasses[] = {
+    {0x4000, 2, false},
+    {0x20000, 1, true},
+};
+static const u32 kHttpBufferClassCount = sizeof(kHttpBufferClasses) / sizeof(kHttpBufferClasses[0]);
+static const u32 kHttpBufferCount = 3;
+static const u32 kHttpRequestSlots = 8;  // ids keep the slot in their low 3 bits
+static const u32 kHttpSlotBits = 3;
+static const u32 kHttpDefaultConcurrency = 2;
+static const u8 kHttpNoBuffer = 0xFF;
+
+enum HttpSlotState {
+    HTTP_SLOT_FREE,
+    HTTP_SLOT_QUEUED,
+    HTTP_SLOT_SENDING,
+    HTTP_SLOT_DONE  // NHTTP answered, waiting for the pump
+};
+
+struct HttpRequestSlot {
+    HttpRequestId id;
+    u8 state;
+    u8 priority;
+    u8 bufferIdx;
+    bool cancelled;
+    u32 bufferSize;
+    u32 cacheMaxAgeSec;
+    HttpResponseCallback callback;
+    void *userdata;
+    s32 result;
+    void *response;
+    u64 queuedTime;
+    u64 sentTime;
+    u64 doneTime;
+    char url[256];
+};
+
+static HttpRequestSlot s_slots[kHttpRequestSlots];
+static u8 *s_classBlocks[kHttpBufferClassCount];
+static bool s_bufferInUse[kHttpBufferCount];
+static u32 s_nextSequence = 1;
+static u32 s_inFlightCount = 0;
+static u32 s_concurrencyLimit = kHttpDefaultConcurrency;
+static HttpLatencyStats s_stats[HTTP_PRIORITY_COUNT];
+
+static u8 GetBufferClassFor(u32 size) {
+    for (u8 i = 0; i < kHttpBufferClassCount; ++i) {
+        if (kHttpBufferClasses[i].size >= size) return i;
+    }
+    return kHttpBufferClassCount;
+}
+
+// Buffers are numbered smallest class first, so the first free fit is also the tightest. A larger class that is not
+// allocated yet is only borrowed by the requests that actually need it
+static u8 FindFreeBuffer(u32 size) {
+    const u8 neededClass = GetBufferClassFor(size);
+    u8 buffer = 0;
+    for (u8 i = 0; i < kHttpBufferClassCount; ++i) {
+        const bool usable = i == neededClass || (i > neededClass && s_classBlocks[i] != nullptr);
+        for (u32 j = 0; j < kHttpBufferClasses[i].count; ++j, ++buffer) {
+            if (usable && !s_bufferInUse[buffer]) return buffer;
+        }
+    }
+    return kHttpNoBuffer;
+}
+
+// Class the buffer belongs to; bufferIdx becomes its index within that class
+static u8 GetBufferClass(u32 &bufferIdx) {
+    u8 bufferClass = 0;
+    while (bufferIdx >= kHttpBufferClasses[bufferClass].count) bufferIdx -= kHttpBufferClasses[bufferClass++].count;
+    return bufferClass;
+}
+
+static u8 *GetBuffer(u8 bufferIdx, u32 &size) {
+    u32 classIdx = bufferIdx;
+    const u8 bufferClass = GetBufferClass(classIdx);
+    const HttpBufferClass &info = kHttpBufferClasses[bufferClass];
+    if (s_classBlocks[bufferClass] == nullptr) {
+        s_classBlocks[bufferClass] = reinterpret_cast<u8 *>(NHTTPAlloc(info.size * info.count, 0x20));
+        if (s_classBlocks[bufferClass] == nullptr) return nullptr;
+    }
+    size = info.size;
+    return s_classBlocks[bufferClass] + classIdx * info.size;
+}
+
+static void ReleaseIdleBufferClasses() {
+    for (u8 i = 0; i < kHttpBufferClassCount; ++i) {
+        if (!kHttpBufferClasses[i].releaseWhenIdle || s_classBlocks[i] == nullptr) continue;
+        bool needed = false;
+        for (u8 buffer = 0; buffer < kHttpBufferCount && !needed; ++buffer) {
+            u32 classIdx = buffer;
+            needed = s_bufferInUse[buffer] && GetBufferClass(classIdx) == i;
+        }
+        for (u32 slot = 0; slot < kHttpRequestSlots && !needed; ++slot) {
+            needed = s_slots[slot].state == HTTP_SLOT_QUEUED && GetBufferClassFor(s_slots[slot].bufferSize) == i;
+        }
+        if (needed) continue;
+        NHTTPFree(s_classBlocks[i]);
+        s_classBlocks[i] = nullptr;
+    }
+}
+
+static HttpRequestSlot *FindSlot(HttpRequestId id) {
+    if (id == 0) return nullptr;
+    HttpRequestSlot &slot = s_slots[id & (kHttpRequestSlots - 1)];
+    return slot.state != HTTP_SLOT_FREE && slot.id == id ? &slot : nullptr;
+}
+
+static void CopyRequestUrl(const char *url, char *dest, u32 destSize) {
+#ifdef HTTP_STANDIN_HOST
+    // Keeps the path and query, swaps scheme and host for the plain HTTP stand-in server
+    const char *path = strstr(url, "://");
+    path = path != nullptr ? strchr(path + 3, '/') : nullptr;
+    snprintf(dest, destSize, "http://%s%s", HTTP_STANDIN_HOST, path != nullptr ? path : "/");
+#else
+    strncpy(dest, url, destSize - 1);
+    dest[destSize - 1] = '\0';
+#endif
+}
+
+static void ConfigureHttpsForRequest(void *request) {
+    typedef s32 (*Fn)(void *, ...);
+    (reinterpret_cast<Fn>(&NHTTPSetRootCADefault))(request);
+    (reinterpret_cast<Fn>(&NHTTPSetVerifyOption))(request, 1);
+}
+
+// Runs on the NHTTP thread, the response is handed to the caller by the next frame's pump
+static void OnHttpResponse(s32 result, void *response, void *userdata) {
+    HttpRequestSlot *slot = reinterpret_cast<HttpRequestSlot *>(userdata);
+    slot->doneTime = OS::GetTime();
+    slot->result = result;
+    slot->response = response;
+    slot->state = HTTP_SLOT_DONE;
+}
+
+static void RecordLatency(const HttpRequestSlot &slot, s32 result) {
+    const u32 waitMs = OS::TicksToMilliseconds(slot.sentTime - slot.queuedTime);
+    const u32 serviceMs = OS::TicksToMilliseconds(slot.doneTime - slot.sentTime);
+    HttpLatencyStats &stats = s_stats[slot.priority];
+    if (slot.cancelled) ++stats.cancelled;
+    else if (result != NHTTP::NHTTP_ERROR_NONE) ++stats.failed;
+    else ++stats.completed;
+    stats.lastWaitMs = waitMs;
+    stats.lastServiceMs = serviceMs;
+    if (waitMs > stats.maxWaitMs) stats.maxWaitMs = waitMs;
+    if (serviceMs > stats.maxServiceMs) stats.maxServiceMs = serviceMs;
+    stats.totalWaitMs += waitMs;
+    stats.totalServiceMs += serviceMs;
 
-    const s32 startupRet = NHTTPStartup(reinterpret_cast<void *>(&NHTTPAlloc),
-                                        reinterpret_cast<void *>(&NHTTPFree),
-                                        0x11);
-    if (startupRet < 0) return false;
+#ifdef HTTP_SCHEDULER_DEBUG
+    OS::Report("[Pulsar] HTTP %08x prio %u result %d wait %ums service %ums%s\n", slot.id, slot.priority, result, waitMs,
+               serviceMs, slot.cancelled ? " cancelled" : "");
+#endif
+}
+
+// body stays null if the response has none the caller can use; only 200 responses are cached, error pages are not
+static void ReadResponseBody(const HttpRequestSlot &slot, void *response, const char *&body, u32 &bodyLen) {
+    NHTTP::Res *res = reinterpret_cast<NHTTP::Res *>(response);
+    char *raw = nullptr;
+    const int rawLen = NHTTP::GetBodyAll(res, &raw);
+    if (raw == nullptr || rawLen <= 0) return;
+    body = raw;
+    bodyLen = static_cast<u32>(rawLen);
+    if (slot.cacheMaxAgeSec != 0 && NHTTP::GetResultCode(res) == 200) {
+        StoreHttpCacheEntry(slot.url, body, bodyLen, slot.cacheMaxAgeSec);
+    }
+}
+
+static void FinishRequest(HttpRequestSlot &slot) {
+    void *response = slot.response;
+    if (!slot.cancelled) {
+        const char *body = nullptr;
+        u32 bodyLen = 0;
+        if (slot.result == NHTTP::NHTTP_ERROR_NONE && response != nullptr) ReadResponseBody(slot, response, body, bodyLen);
+        slot.callback(slot.result, body, bodyLen, slot.userdata);
+    }
+    if (response != nullptr) NHTTPDestroyResponse(response);
+
+    const int old = OS::DisableInterrupts();
+    RecordLatency(slot, slot.result);
+    s_bufferInUse[slot.bufferIdx] = false;
+    slot.state = HTTP_SLOT_FREE;
+    if (s_inFlightCount != 0) --s_inFlightCount;
+    OS::RestoreInterrupts(old);
+}
+
+// Fresh cached responses are delivered right away, whatever the queue and concurrency limit look like
+static void ServeFromCache(HttpRequestSlot &slot) {
+    const char *body = nullptr;
+    u32 bodyLen = 0;
+    if (slot.cacheMaxAgeSec == 0 || !GetFreshHttpCacheBody(slot.url, body, bodyLen)) return;
+    slot.sentTime = OS::GetTime();
+    slot.doneTime = slot.sentTime;
+    slot.state = HTTP_SLOT_SENDING;  // out of the queue while the callback runs
+    slot.callback(NHTTP::NHTTP_ERROR_NONE, body, bodyLen, slot.userdata);
+
+    const int old = OS::DisableInterrupts();
+    RecordLatency(slot, NHTTP::NHTTP_ERROR_NONE);
+    slot.state = HTTP_SLOT_FREE;
+    OS::RestoreInterrupts(old);
+}
+
+static void FailRequest(HttpRequestSlot &slot) {
+    const int old = OS::DisableInterrupts();
+    const bool cancelled = slot.cancelled;
+    if (cancelled) ++s_stats[slot.priority].cancelled;
+    else ++s_stats[slot.priority].failed;
+    if (slot.bufferIdx != kHttpNoBuffer) s_bufferInUse[slot.bufferIdx] = false;
+    slot.state = HTTP_SLOT_FREE;
+    OS::RestoreInterrupts(old);
+    if (!cancelled) slot.callback(HTTP_RESULT_START_FAILED, nullptr, 0, slot.userdata);
+}
+
+static HttpRequestSlot *PickNextRequest() {
+    HttpRequestSlot *best = nullptr;
+    for (u32 i = 0; i < kHttpRequestSlots; ++i) {
+        HttpRequestSlot &slot = s_slots[i];
+        if (slot.state != HTTP_SLOT_QUEUED) continue;
+        if (best == nullptr || slot.priority < best->priority ||
+            (slot.priority == best->priority && slot.queuedTime < best->queuedTime)) {
+            best = &slot;
+        }
+    }
+    return best;
+}
+
+// The next request in line keeps its place while its buffer class is busy, nothing behind it overtakes it
+static void PumpHttpRequests() {
+    for (u32 i = 0; i < kHttpRequestSlots; ++i) {
+        HttpRequestSlot &slot = s_slots[i];
+        if (slot.state == HTTP_SLOT_DONE) FinishRequest(slot);
+        else if (slot.state == HTTP_SLOT_QUEUED && !slot.cancelled) ServeFromCache(slot);
+    }
+    ReleaseIdleBufferClasses();
+
+    while (s_inFlightCount < s_concurrencyLimit) {
+        HttpRequestSlot *slot = PickNextRequest();
+        if (slot == nullptr) return;
+
+        int old = OS::DisableInterrupts();
+        const u8 bufferIdx = FindFreeBuffer(slot->bufferSize);
+        if (bufferIdx == kHttpNoBuffer) {
+            OS::RestoreInterrupts(old);
+            return;
+        }
+        const bool needsStartup = s_inFlightCount == 0;
+        s_bufferInUse[bufferIdx] = true;
+        slot->bufferIdx = bufferIdx;
+        slot->state = HTTP_SLOT_SENDING;
+        ++s_inFlightCount;
+        OS::RestoreInterrupts(old);
+
+        if (needsStartup && NHTTPStartup(reinterpret_cast<void *>(&NHTTPAlloc), reinterpret_cast<void *>(&NHTTPFree), 0x11) < 0) {
+            --s_inFlightCount;
+            FailRequest(*slot);
+            continue;
+        }
+
+        u32 bufferSize = 0;
+        u8 *buffer = GetBuffer(bufferIdx, bufferSize);
+        if (buffer == nullptr) {
+            old = OS::DisableInterrupts();
+            --s_inFlightCount;
+            OS::RestoreInterrupts(old);
+            FailRequest(*slot);
+            continue;
+        }
+        memset(buffer, 0, bufferSize);
+        void *request = NHTTPCreateRequest(slot->url, 0, buffer, bufferSize, reinterpret_cast<void *>(&OnHttpResponse),
+                                           slot);
+        if (request != nullptr && strncmp(slot->url, "https://", 8) == 0) ConfigureHttpsForRequest(request);
+        slot->sentTime = OS::GetTime();
+        if (request == nullptr || NHTTPSendRequestAsync(request) < 0) {
+            old = OS::DisableInterrupts();
+            --s_inFlightCount;
+            OS::RestoreInterrupts(old);
+            FailRequest(*slot);
+        }
+    }
+}
+static FrameLoadHook HttpSchedulerHook(PumpHttpRequests);
+
+HttpRequestId QueueHttpRequest(const HttpRequestParams &params) {
+    if (params.url == nullptr || params.callback == nullptr || params.priority >= HTTP_PRIORITY_COUNT) return 0;
+    if (params.bufferSize > kHttpBufferClasses[kHttpBufferClassCount - 1].size) return 0;
+
+    const int old = OS::DisableInterrupts();
+    HttpRequestSlot *slot = nullptr;
+    u32 slotIdx = 0;
+    for (; slotIdx < kHttpRequestSlots; ++slotIdx) {
+        if (s_slots[slotIdx].state == HTTP_SLOT_FREE) {
+            slot = &s_slots[slotIdx];
+            slot->state = HTTP_SLOT_QUEUED;
+            break;
+        }
+    }
+    OS::RestoreInterrupts(old);
+    if (slot == nullptr) return 0;
+
+    slot->id = (s_nextSequence++ << kHttpSlotBits) | slotIdx;
+    slot->priority = static_cast<u8>(params.priority);
+    slot->bufferIdx = kHttpNoBuffer;
+    slot->cancelled = false;
+    slot->bufferSize = params.bufferSize;
+    slot->cacheMaxAgeSec = params.cacheMaxAgeSec;
+    slot->response = nullptr;
+    slot->callback = params.callback;
+    slot->userdata = params.userdata;
+    slot->queuedTime = OS::GetTime();
+    slot->sentTime = slot->queuedTime;
+    CopyRequestUrl(params.url, slot->url, sizeof(slot->url));
+    return slot->id;
+}
 
-    return true;
+void CancelHttpRequest(HttpRequestId id) {
+    const int old = OS::DisableInterrupts();
+    HttpRequestSlot *slot = FindSlot(id);
+    if (slot != nullptr) {
+        if (slot->state == HTTP_SLOT_QUEUED) {
+            ++s_stats[slot->priority].cancelled;
+            slot->state = HTTP_SLOT_FREE;
+        } else {
+            slot->cancelled = true;
+        }
+    }
+    OS::RestoreInterrupts(old);
 }
 
-bool PreparePersistentNHTTPRequest(bool &started) {
-    if (started) return true;
-    if (!PrepareNHTTPRequest()) return false;
-    started = true;
-    return true;
+bool IsHttpRequestPending(HttpRequestId id) {
+    const int old = OS::DisableInterrupts();
+    const HttpRequestSlot *slot = FindSlot(id);
+    const bool pending = slot != nullptr && !slot->cancelled;
+    OS::RestoreInterrupts(old);
+    return pending;
 }
 
-void MarkNHTTPRequestActive() {
-    ++s_activeRequestCount;
+void SetHttpConcurrencyLimit(u32 limit) {
+    s_concurrencyLimit = limit == 0 ? 1 : limit;
 }
 
-void FinishNHTTPRequest() {
-    if (s_activeRequestCount != 0) --s_activeRequestCount;
+const HttpLatencyStats &GetHttpLatencyStats(HttpPriority priority) {
+    return s_stats[priority < HTTP_PRIORITY_COUNT ? priority : HTTP_PRIORITY_BACKGROUND];
 }
 
 }  // namespace Network
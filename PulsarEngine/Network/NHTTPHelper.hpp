@@ -8,10 +8,51 @@ namespace Network {
 
 void *NHTTPAlloc(u32 size, s32 align);
 void NHTTPFree(void *ptr);
-bool PrepareNHTTPRequest();
-bool PreparePersistentNHTTPRequest(bool &started);
-void MarkNHTTPRequestActive();
-void FinishNHTTPRequest();
+
+// Every HTTP request goes through one queue, pumped once per frame. Queued requests start by priority, then age,
+// as long as fewer than the concurrency limit are in flight and a pooled response buffer of the right size is free.
+// Build with HTTP_STANDIN_HOST="host:port" to send every request to a local stand-in server instead (scripts/http_standin_server.py).
+enum HttpPriority {
+    HTTP_PRIORITY_INTERACTIVE,  // a page is waiting on the result
+    HTTP_PRIORITY_NORMAL,
+    HTTP_PRIORITY_BACKGROUND,
+    HTTP_PRIORITY_COUNT
+};
+
+static const s32 HTTP_RESULT_START_FAILED = -1;  // NHTTP refused the request, no response exists
+
+// Called from the frame pump on the main thread. body is only valid during the call and is not null terminated; it is null on failure
+typedef void (*HttpResponseCallback)(s32 result, const char *body, u32 bodyLen, void *userdata);
+
+struct HttpRequestParams {
+    const char *url;  // copied
+    HttpPriority priority;
+    u32 bufferSize;  // largest response expected, picks the pooled buffer class
+    u32 cacheMaxAgeSec;  // 0: never cached, otherwise how long a response stays fresh unless the server says otherwise
+    HttpResponseCallback callback;
+    void *userdata;
+};
+
+typedef u32 HttpRequestId;  // 0 is never a valid id, ids of finished requests are never reused
+
+HttpRequestId QueueHttpRequest(const HttpRequestParams &params);  // 0 if the queue is full or no buffer class fits
+void CancelHttpRequest(HttpRequestId id);  // drops it if queued, suppresses its callback if in flight
+bool IsHttpRequestPending(HttpRequestId id);
+void SetHttpConcurrencyLimit(u32 limit);
+
+struct HttpLatencyStats {
+    u32 completed;
+    u32 failed;
+    u32 cancelled;
+    u32 lastWaitMs;  // queued to sent
+    u32 lastServiceMs;  // sent to callback
+    u32 maxWaitMs;
+    u32 maxServiceMs;
+    u64 totalWaitMs;
+    u64 totalServiceMs;
+};
+
+const HttpLatencyStats &GetHttpLatencyStats(HttpPriority priority);
 
 }  // namespace Network
 }  // namespace Pulsar
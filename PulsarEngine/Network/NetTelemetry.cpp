@@ -0,0 +1,161 @@
+#include <kamek.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <MarioKartWii/Driver/DriverManager.hpp>
+#include <MarioKartWii/Race/RaceInfo/RaceInfo.hpp>
+#include <MarioKartWii/RKNet/RKNetController.hpp>
+#include <MarioKartWii/RKNet/RH1.hpp>
+#include <Network/PacketExpansion.hpp>
+#include <Network/GPReport.hpp>
+#include <Network/NetTelemetry.hpp>
+#include <Debug/Histogram.hpp>
+#include <include/c_stdio.h>
+#include <include/c_string.h>
+
+namespace Pulsar {
+namespace Network {
+
+const u32 NET_INTERVAL_BUCKET_US = 4000;
+const u32 NET_INTERVAL_BUCKET_COUNT = 64;  // 256ms of range, slower arrivals land in the last bucket
+const u32 NET_HISTOGRAM_DECAY_TOTAL = 0x2000;  // counts are halved past this so the histogram follows the last few hundred packets
+const u32 NET_GAP_THRESHOLD_US = 100000;
+const u32 NET_FRAME_US = 16683;
+
+struct AidLink {
+    u16 intervalHistogram[NET_INTERVAL_BUCKET_COUNT];
+    u64 lastSeenReceiveTime;
+    u32 histogramTotal;
+    u32 packets;
+    u32 gaps;
+    u32 maxIntervalUs;
+    u32 lastIntervalUs;
+    u32 jitterUs;
+    s32 timerAgeFrames8;  // smoothed RH1 timer age, in eighths of a frame
+    bool hasTimerAge;
+};
+
+struct NetTelemetry {
+    AidLink links[12];
+    bool reported;
+};
+
+static NetTelemetry sTelemetry;
+
+static void AddInterval(AidLink &link, u32 intervalUs) {
+    const u32 bucket = Debug::GetHistogramBucket(intervalUs, NET_INTERVAL_BUCKET_US, NET_INTERVAL_BUCKET_COUNT);
+    if (link.histogramTotal >= NET_HISTOGRAM_DECAY_TOTAL) {
+        link.histogramTotal = 0;
+        for (u32 i = 0; i < NET_INTERVAL_BUCKET_COUNT; ++i) {
+            link.intervalHistogram[i] >>= 1;
+            link.histogramTotal += link.intervalHistogram[i];
+        }
+    }
+    ++link.intervalHistogram[bucket];
+    ++link.histogramTotal;
+
+    if (intervalUs > NET_GAP_THRESHOLD_US) ++link.gaps;
+    if (intervalUs > link.maxIntervalUs) link.maxIntervalUs = intervalUs;
+    if (link.packets > 1) {
+        // RFC 3550 style estimator: J += (|D| - J) / 16
+        const u32 delta = intervalUs > link.lastIntervalUs ? intervalUs - link.lastIntervalUs : link.lastIntervalUs - intervalUs;
+        link.jitterUs = static_cast<u32>(static_cast<s32>(link.jitterUs) + (static_cast<s32>(delta) - static_cast<s32>(link.jitterUs)) / 16);
+    }
+    link.lastIntervalUs = intervalUs;
+}
+
+static void AddTimerAge(AidLink &link, u32 localTimer, u32 remoteTimer) {
+    if (localTimer == 0 || remoteTimer == 0) return;
+    const s32 ageFrames8 = static_cast<s32>(localTimer - remoteTimer) * 8;
+    if (!link.hasTimerAge) {
+        link.timerAgeFrames8 = ageFrames8;
+        link.hasTimerAge = true;
+    } else {
+        link.timerAgeFrames8 += (ageFrames8 - link.timerAgeFrames8) / 8;
+    }
+}
+
+static u32 GetIntervalPercentileUs(const AidLink &link, u32 percentile) {
+    return Debug::GetHistogramPercentile(link.intervalHistogram, NET_INTERVAL_BUCKET_COUNT, NET_INTERVAL_BUCKET_US,
+                                         link.histogramTotal, link.maxIntervalUs, percentile);
+}
+
+bool GetAidLinkStats(u8 aid, AidLinkStats &stats) {
+    if (aid >= 12) return false;
+    const AidLink &link = sTelemetry.links[aid];
+    if (link.packets == 0) return false;
+    stats.packets = link.packets;
+    stats.gaps = link.gaps;
+    stats.intervalP50Us = GetIntervalPercentileUs(link, 50);
+    stats.intervalP95Us = GetIntervalPercentileUs(link, 95);
+    stats.maxIntervalUs = link.maxIntervalUs;
+    stats.jitterUs = link.jitterUs;
+    stats.timerLagUs = 0;
+    if (link.hasTimerAge && link.timerAgeFrames8 > 0) stats.timerLagUs = static_cast<u32>(link.timerAgeFrames8) * NET_FRAME_US / 8;
+    return true;
+}
+
+// One report per race: the host aid, then pk,gp,p50,p95,mx,jt,lag for every remote aid
+static void ReportLinkStats() {
+    const RKNet::Controller *controller = RKNet::Controller::sInstance;
+    const RKNet::ControllerSub &sub = controller->subs[controller->currentSub];
+    char buffer[768];
+    int length = snprintf(buffer, sizeof(buffer), "ho=%u", sub.hostAid);
+    bool hasLinks = false;
+    for (u8 aid = 0; aid < 12; ++aid) {
+        if (aid == sub.localAid) continue;
+        AidLinkStats stats;
+        if (!GetAidLinkStats(aid, stats)) continue;
+        if (length < 0 || static_cast<u32>(length) >= sizeof(buffer)) break;
+        const int written = snprintf(buffer + length,
+                                     sizeof(buffer) - length,
+                                     "|%u:%u,%u,%u,%u,%u,%u,%u",
+                                     aid,
+                                     stats.packets,
+                                     stats.gaps,
+                                     stats.intervalP50Us,
+                                     stats.intervalP95Us,
+                                     stats.maxIntervalUs,
+                                     stats.jitterUs,
+                                     stats.timerLagUs);
+        if (written <= 0 || static_cast<u32>(length + written) >= sizeof(buffer)) break;
+        length += written;
+        hasLinks = true;
+    }
+    if (hasLinks) Report("wl:mkw_net_link", buffer);
+}
+
+static void UpdateNetTelemetry() {
+    if (!DriverMgr::isOnlineRace) return;
+    const CustomRKNetController *controller = reinterpret_cast<const CustomRKNetController *>(RKNet::Controller::sInstance);
+    const Raceinfo *raceinfo = Raceinfo::sInstance;
+    if (controller == nullptr || raceinfo == nullptr) return;
+
+    const RKNet::ControllerSub &sub = controller->subs[controller->currentSub];
+    const RKNet::RH1Handler *rh1 = RKNet::RH1Handler::sInstance;
+    const u32 localTimer = raceinfo->timerMgr != nullptr ? raceinfo->timerMgr->raceFrameCounter : 0;
+    for (u8 aid = 0; aid < 12; ++aid) {
+        if (aid == sub.localAid || (sub.availableAids & (1 << aid)) == 0) continue;
+        AidLink &link = sTelemetry.links[aid];
+        const u64 receiveTime = controller->lastRACERecivedTimes[aid];
+        if (receiveTime == 0 || receiveTime == link.lastSeenReceiveTime) continue;
+        const bool hadPrevious = link.lastSeenReceiveTime != 0;
+        link.lastSeenReceiveTime = receiveTime;
+        ++link.packets;
+        // Only the latest arrival per frame is visible, so this samples the interval rather than tracing every packet
+        if (hadPrevious) AddInterval(link, OS::TicksToMicroseconds(controller->RACEReceivedTimesTaken[aid]));
+        if (rh1 != nullptr) AddTimerAge(link, localTimer, rh1->rh1Data[aid].timer);
+    }
+
+    if (!sTelemetry.reported && raceinfo->stage == RACESTAGE_FINISHED) {
+        sTelemetry.reported = true;
+        ReportLinkStats();
+    }
+}
+static RaceFrameHook UpdateNetTelemetryHook(UpdateNetTelemetry);
+
+static void ResetNetTelemetry() {
+    memset(&sTelemetry, 0, sizeof(NetTelemetry));
+}
+static RaceLoadHook ResetNetTelemetryHook(ResetNetTelemetry);
+
+}  // namespace Network
+}  // namespace Pulsar
@@ -0,0 +1,26 @@
+#ifndef _PUL_NET_TELEMETRY_
+#define _PUL_NET_TELEMETRY_
+
+#include <kamek.hpp>
+
+// Per aid link statistics gathered from the RACE receive timestamps CustomRKNetController already keeps.
+// Summarised to the server at race end; define NET_TELEMETRY_DEBUG for the in-race overlay.
+namespace Pulsar {
+namespace Network {
+
+struct AidLinkStats {
+    u32 packets;
+    u32 gaps;  // inter-arrival times above NET_GAP_THRESHOLD_US
+    u32 intervalP50Us;
+    u32 intervalP95Us;
+    u32 maxIntervalUs;
+    u32 jitterUs;  // smoothed variation between consecutive inter-arrival times
+    u32 timerLagUs;  // smoothed age of the peer's RH1 timer: one way delay plus the race start skew between consoles
+};
+
+bool GetAidLinkStats(u8 aid, AidLinkStats &stats);
+
+}  // namespace Network
+}  // namespace Pulsar
+
+#endif
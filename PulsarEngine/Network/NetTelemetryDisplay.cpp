@@ -0,0 +1,33 @@
+#include <MarioKartWii/RKNet/RKNetController.hpp>
+#include <Debug/DebugOverlay.hpp>
+#include <Network/NetTelemetry.hpp>
+#include <include/c_wchar.h>
+
+#ifdef NET_TELEMETRY_DEBUG
+namespace Pulsar {
+namespace Network {
+
+// Link statistics of every remote aid, on the race debug overlay while in a room
+static u32 WriteNetTelemetry(wchar_t *dest, u32 capacity) {
+    const RKNet::Controller *controller = RKNet::Controller::sInstance;
+    if (controller == nullptr || controller->roomType == RKNet::ROOMTYPE_NONE) return 0;
+    u32 length = 0;
+    for (u8 aid = 0; aid < 12; ++aid) {
+        AidLinkStats stats;
+        if (!GetAidLinkStats(aid, stats)) continue;
+        const u32 remaining = capacity - length;
+        if (remaining <= 1) break;
+        // Times in milliseconds: median/p95 inter-arrival, jitter, gaps and RH1 timer lag
+        const int written = ::swprintf(dest + length, remaining, L"%u: %u/%u j%u g%u lag%u\n", aid,
+                                       stats.intervalP50Us / 1000, stats.intervalP95Us / 1000, stats.jitterUs / 1000,
+                                       stats.gaps, stats.timerLagUs / 1000);
+        if (written <= 0) break;
+        length += static_cast<u32>(written);
+    }
+    return length;
+}
+static Debug::DebugOverlaySection sNetTelemetrySection(WriteNetTelemetry, Debug::DEBUG_OVERLAY_RACE);
+
+}  // namespace Network
+}  // namespace Pulsar
+#endif
@@ -6,8 +6,6 @@
 namespace Pulsar {
 namespace Network {
 
-static const u32 MAX_TRACK_BLOCKING = 12;  // Maximum number of blocked tracks synced via packets
-
 static const u32 HOST_SETTINGS_PREVIEW_COUNT = 27;
 
 enum DenyType {
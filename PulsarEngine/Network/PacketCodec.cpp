@@ -0,0 +1,331 @@
+#include <Network/PacketCodec.hpp>
+#ifdef PACKET_CODEC_HOST
+#include <string.h>
+#else
+#include <include/c_string.h>
+#endif
+#ifdef PACKET_CODEC_SELFTEST
+#include <kamek.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <Network/PacketExpansion.hpp>
+#endif
+
+namespace Pulsar {
+namespace Network {
+
+static const u32 RH1PulsarSectionSize = 7;  // pulsarTrackId through nextTrack
+static const u32 RH1KOSectionSize = 4;
+static const u32 RH1LapKoHeaderSize = 4;  // seq, round, active count, elim count; elims follow with a length byte
+static const u32 SELECTCoreSize = 11;
+static const u32 SELECTKOSectionSize = 6;
+static const u32 SELECTBlockingHeaderSize = 3;  // count, array index and grouped flag, copied as bytes
+static_assert(PulRH1SizeBase - sizeof(RKNet::RACEHEADER1Packet) == RH1PulsarSectionSize + RH1KOSectionSize, "RH1 base sections");
+static_assert(PulRH1LapKoSize == RH1LapKoHeaderSize + 12, "RH1 LapKO section");
+static_assert(PulSELECTWireSizeMax == sizeof(RKNet::SELECTPacket) + 1 + SELECTCoreSize + 1 + SELECTKOSectionSize + (SELECTBlockingHeaderSize + 1 + 2 * MAX_TRACK_BLOCKING) + 4, "SELECT sections");
+
+// Values BeforeRH1Send writes for disabled modes, these are what an omitted section decodes to
+static void SetRH1Defaults(PulRH1 &packet) {
+    memset(&packet.pulsarTrackId, 0, RH1PulsarSectionSize + RH1KOSectionSize + RH1LapKoHeaderSize);
+    memset(packet.lapKoElims, 0xFF, sizeof(packet.lapKoElims));
+    memset(&packet.battleRoyaleLossSeq, 0, PulRH1BattleRoyaleSize);
+    packet.battleRoyaleLossPlayerId = 0xFF;
+    packet.battleRoyaleBalloonCounts = 0xFF;
+}
+
+static void SetSELECTDefaults(PulSELECT &packet) {
+    packet.allowChangeComboStatus = 0;
+    memset(&packet.koPerRace, 0, SELECTKOSectionSize);
+    packet.blockedTrackCount = 0;
+    packet.curBlockingArrayIdx = 0;
+    packet.lastGroupedTrackPlayed = false;
+    for (u32 i = 0; i < MAX_TRACK_BLOCKING; ++i) packet.blockedTracks[i] = 0xFFFF;
+}
+
+static bool IsRawRH1Size(u32 size) {
+    return size == sizeof(RKNet::RACEHEADER1Packet) || size == PulRH1SizeBase || size == PulRH1SizeLapKo || size == PulRH1SizeFull;
+}
+
+static bool IsSame(const void *a, const void *b, u32 size) {
+    return memcmp(a, b, size) == 0;
+}
+
+static u8 *Put(u8 *dest, const void *src, u32 size) {
+    memcpy(dest, src, size);
+    return dest + size;
+}
+
+static bool Take(const u8 *&src, const u8 *end, void *dest, u32 size) {
+    if (static_cast<u32>(end - src) < size) return false;
+    memcpy(dest, src, size);
+    src += size;
+    return true;
+}
+
+u32 EncodePulRH1(const PulRH1 &packet, u32 size, u8 *dest) {
+    const u32 vanillaSize = sizeof(RKNet::RACEHEADER1Packet);
+    u8 *cur = Put(dest, &packet, vanillaSize);
+    if (size <= vanillaSize) return vanillaSize;
+
+    const u32 tier = size <= PulRH1SizeBase ? 0 : (size <= PulRH1SizeLapKo ? 1 : 2);
+    PulRH1 defaults;
+    SetRH1Defaults(defaults);
+
+    u8 *mask = cur++;
+    *mask = static_cast<u8>(tier << PULRH1_TIER_SHIFT);
+    if (!IsSame(&packet.pulsarTrackId, &defaults.pulsarTrackId, RH1PulsarSectionSize)) {
+        *mask |= PULRH1_SECTION_PULSAR;
+        cur = Put(cur, &packet.pulsarTrackId, RH1PulsarSectionSize);
+    }
+    if (!IsSame(&packet.timeInDanger, &defaults.timeInDanger, RH1KOSectionSize)) {
+        *mask |= PULRH1_SECTION_KO;
+        cur = Put(cur, &packet.timeInDanger, RH1KOSectionSize);
+    }
+    if (tier >= 1 && !IsSame(&packet.lapKoSeq, &defaults.lapKoSeq, PulRH1LapKoSize)) {
+        *mask |= PULRH1_SECTION_LAPKO;
+        cur = Put(cur, &packet.lapKoSeq, RH1LapKoHeaderSize);
+        u8 elimCount = 12;
+        while (elimCount > 0 && packet.lapKoElims[elimCount - 1] == 0xFF) --elimCount;
+        *cur++ = elimCount;
+        cur = Put(cur, packet.lapKoElims, elimCount);
+    }
+    if (tier >= 2 && !IsSame(&packet.battleRoyaleLossSeq, &defaults.battleRoyaleLossSeq, PulRH1BattleRoyaleSize)) {
+        *mask |= PULRH1_SECTION_BATTLEROYALE;
+        cur = Put(cur, &packet.battleRoyaleLossSeq, PulRH1BattleRoyaleSize);
+    }
+    if (IsRawRH1Size(static_cast<u32>(cur - dest))) {
+        *mask |= PULRH1_WIRE_PAD;
+        *cur++ = 0;
+    }
+    return static_cast<u32>(cur - dest);
+}
+
+bool DecodePulRH1(const u8 *src, u32 wireSize, PulRH1 &packet, u32 &size) {
+    const u32 vanillaSize = sizeof(RKNet::RACEHEADER1Packet);
+    if (wireSize < vanillaSize) return false;
+    SetRH1Defaults(packet);
+    size = wireSize;
+    if (IsRawRH1Size(wireSize)) {
+        memcpy(&packet, src, wireSize);
+        return true;
+    }
+    memcpy(&packet, src, vanillaSize);
+
+    const u8 *cur = src + vanillaSize;
+    const u8 *end = src + wireSize;
+    const u8 mask = *cur++;
+    const u32 tier = mask >> PULRH1_TIER_SHIFT;
+    if (tier > 2 || (mask & ~(PULRH1_SECTION_MASK | PULRH1_WIRE_PAD | (3 << PULRH1_TIER_SHIFT))) != 0) return false;
+    if ((mask & PULRH1_SECTION_LAPKO) != 0 && tier < 1) return false;
+    if ((mask & PULRH1_SECTION_BATTLEROYALE) != 0 && tier < 2) return false;
+    size = tier == 0 ? PulRH1SizeBase : (tier == 1 ? PulRH1SizeLapKo : PulRH1SizeFull);
+
+    if ((mask & PULRH1_SECTION_PULSAR) != 0 && !Take(cur, end, &packet.pulsarTrackId, RH1PulsarSectionSize)) return false;
+    if ((mask & PULRH1_SECTION_KO) != 0 && !Take(cur, end, &packet.timeInDanger, RH1KOSectionSize)) return false;
+    if ((mask & PULRH1_SECTION_LAPKO) != 0) {
+        u8 elimCount;
+        if (!Take(cur, end, &packet.lapKoSeq, RH1LapKoHeaderSize) || !Take(cur, end, &elimCount, 1)) return false;
+        if (elimCount > 12 || !Take(cur, end, packet.lapKoElims, elimCount)) return false;
+    }
+    if ((mask & PULRH1_SECTION_BATTLEROYALE) != 0 && !Take(cur, end, &packet.battleRoyaleLossSeq, PulRH1BattleRoyaleSize)) return false;
+    u8 pad;
+    if ((mask & PULRH1_WIRE_PAD) != 0 && !Take(cur, end, &pad, 1)) return false;
+    return cur == end;
+}
+
+u32 EncodePulSELECT(const PulSELECT &packet, u32 size, u8 *dest) {
+    const u32 vanillaSize = sizeof(RKNet::SELECTPacket);
+    u8 *cur = Put(dest, &packet, vanillaSize);
+    if (size <= vanillaSize) return vanillaSize;
+
+    PulSELECT defaults;
+    SetSELECTDefaults(defaults);
+
+    u8 *mask = cur++;
+    *mask = 0;
+    cur = Put(cur, &packet.pulVote, sizeof(packet.pulVote));
+    cur = Put(cur, &packet.pulWinningTrack, sizeof(packet.pulWinningTrack));
+    *cur++ = packet.variantIdx;
+    cur = Put(cur, packet.decimalVR, sizeof(packet.decimalVR));
+    cur = Put(cur, packet.voteVariantIdx, sizeof(packet.voteVariantIdx));
+    cur = Put(cur, &packet.characterTables, sizeof(packet.characterTables));
+
+    if (packet.allowChangeComboStatus != defaults.allowChangeComboStatus) {
+        *mask |= PULSELECT_SECTION_OTT;
+        *cur++ = packet.allowChangeComboStatus;
+    }
+    if (!IsSame(&packet.koPerRace, &defaults.koPerRace, SELECTKOSectionSize)) {
+        *mask |= PULSELECT_SECTION_KO;
+        cur = Put(cur, &packet.koPerRace, SELECTKOSectionSize);
+    }
+    if (!IsSame(&packet.blockedTrackCount, &defaults.blockedTrackCount, SELECTBlockingHeaderSize)
+        || !IsSame(packet.blockedTracks, defaults.blockedTracks, sizeof(packet.blockedTracks))) {
+        *mask |= PULSELECT_SECTION_BLOCKING;
+        cur = Put(cur, &packet.blockedTrackCount, SELECTBlockingHeaderSize);
+        u8 trackCount = MAX_TRACK_BLOCKING;
+        while (trackCount > 0 && packet.blockedTracks[trackCount - 1] == 0xFFFF) --trackCount;
+        *cur++ = trackCount;
+        cur = Put(cur, packet.blockedTracks, trackCount * sizeof(u16));
+    }
+    cur = Put(cur, &packet.acVerifyTag, sizeof(packet.acVerifyTag));
+    if (static_cast<u32>(cur - dest) == sizeof(PulSELECT)) {
+        *mask |= PULSELECT_WIRE_PAD;
+        *cur++ = 0;
+    }
+    return static_cast<u32>(cur - dest);
+}
+
+bool DecodePulSELECT(const u8 *src, u32 wireSize, PulSELECT &packet, u32 &size) {
+    const u32 vanillaSize = sizeof(RKNet::SELECTPacket);
+    if (wireSize < vanillaSize) return false;
+    memcpy(&packet, src, vanillaSize);
+    size = wireSize;
+    if (wireSize == vanillaSize) return true;
+    if (wireSize == sizeof(PulSELECT)) {
+        memcpy(&packet, src, wireSize);
+        return true;
+    }
+
+    const u8 *cur = src + vanillaSize;
+    const u8 *end = src + wireSize;
+    const u8 mask = *cur++;
+    if ((mask & ~(PULSELECT_SECTION_MASK | PULSELECT_WIRE_PAD)) != 0) return false;
+    SetSELECTDefaults(packet);
+    size = sizeof(PulSELECT);
+
+    if (!Take(cur, end, &packet.pulVote, sizeof(packet.pulVote)) || !Take(cur, end, &packet.pulWinningTrack, sizeof(packet.pulWinningTrack))
+        || !Take(cur, end, &packet.variantIdx, 1) || !Take(cur, end, packet.decimalVR, sizeof(packet.decimalVR))
+        || !Take(cur, end, packet.voteVariantIdx, sizeof(packet.voteVariantIdx))
+        || !Take(cur, end, &packet.characterTables, sizeof(packet.characterTables)))
+        return false;
+    if ((mask & PULSELECT_SECTION_OTT) != 0 && !Take(cur, end, &packet.allowChangeComboStatus, 1)) return false;
+    if ((mask & PULSELECT_SECTION_KO) != 0 && !Take(cur, end, &packet.koPerRace, SELECTKOSectionSize)) return false;
+    if ((mask & PULSELECT_SECTION_BLOCKING) != 0) {
+        u8 trackCount;
+        if (!Take(cur, end, &packet.blockedTrackCount, SELECTBlockingHeaderSize) || !Take(cur, end, &trackCount, 1)) return false;
+        if (trackCount > MAX_TRACK_BLOCKING || !Take(cur, end, packet.blockedTracks, trackCount * sizeof(u16))) return false;
+    }
+    if (!Take(cur, end, &packet.acVerifyTag, sizeof(packet.acVerifyTag))) return false;
+    u8 pad;
+    if ((mask & PULSELECT_WIRE_PAD) != 0 && !Take(cur, end, &pad, 1)) return false;
+    return cur == end;
+}
+
+#ifdef PACKET_CODEC_SELFTEST
+static u32 sSelfTestFailures;
+
+static void CheckRH1(const char *name, const PulRH1 &packet, u32 size) {
+    u8 wire[PulRH1WireSizeMax];
+    const u32 wireSize = EncodePulRH1(packet, size, wire);
+    PulRH1 decoded;
+    u32 decodedSize;
+    const bool ok = wireSize <= PulRH1WireSizeMax && DecodePulRH1(wire, wireSize, decoded, decodedSize) && decodedSize == size
+                    && memcmp(&decoded, &packet, size) == 0;
+    if (!ok) ++sSelfTestFailures;
+    OS::Report("RH1 %-14s %3u -> %3u bytes%s\n", name, size, wireSize, ok ? "" : " MISMATCH");
+}
+
+static void CheckSELECT(const char *name, const PulSELECT &packet) {
+    u8 wire[PulSELECTWireSizeMax];
+    const u32 wireSize = EncodePulSELECT(packet, sizeof(PulSELECT), wire);
+    PulSELECT decoded;
+    u32 decodedSize;
+    const bool ok = wireSize <= PulSELECTWireSizeMax && DecodePulSELECT(wire, wireSize, decoded, decodedSize)
+                    && decodedSize == sizeof(PulSELECT) && memcmp(&decoded, &packet, sizeof(PulSELECT)) == 0;
+    if (!ok) ++sSelfTestFailures;
+    OS::Report("SELECT %-11s %3u -> %3u bytes%s\n", name, sizeof(PulSELECT), wireSize, ok ? "" : " MISMATCH");
+}
+
+static void FillVanilla(void *packet, u32 size, u8 seed) {
+    u8 *bytes = reinterpret_cast<u8 *>(packet);
+    for (u32 i = 0; i < size; ++i) bytes[i] = static_cast<u8>(seed + i * 7);
+}
+
+bool RunPacketCodecSelfTest() {
+    sSelfTestFailures = 0;
+
+    PulRH1 rh1;
+    FillVanilla(&rh1, sizeof(RKNet::RACEHEADER1Packet), 0x11);
+    SetRH1Defaults(rh1);
+    CheckRH1("vanilla", rh1, sizeof(RKNet::RACEHEADER1Packet));
+    CheckRH1("idle", rh1, PulRH1SizeBase);
+    rh1.pulsarTrackId = 0x105;
+    rh1.variantIdx = 2;
+    CheckRH1("vs ct", rh1, PulRH1SizeBase);
+    rh1.chooseNextStatus = 1;
+    rh1.hasTrack = true;
+    rh1.nextTrack = 0x142;
+    CheckRH1("vs ct haw", rh1, PulRH1SizeBase);
+    rh1.timeInDanger = 380;
+    rh1.almostKOdCounter = 3;
+    rh1.finalPercentageSum = 170;
+    CheckRH1("ko", rh1, PulRH1SizeBase);
+    rh1.timeInDanger = 0;
+    rh1.almostKOdCounter = 0;
+    rh1.finalPercentageSum = 0;
+    CheckRH1("lapko idle", rh1, PulRH1SizeLapKo);
+    rh1.lapKoSeq = 4;
+    rh1.lapKoRoundIndex = 2;
+    rh1.lapKoActiveCount = 9;
+    rh1.lapKoElimCount = 2;
+    rh1.lapKoElims[0] = 5;
+    rh1.lapKoElims[1] = 7;
+    CheckRH1("lapko event", rh1, PulRH1SizeLapKo);
+    CheckRH1("royale idle", rh1, PulRH1SizeFull);
+    rh1.battleRoyaleLossSeq = 3;
+    rh1.battleRoyaleLossPlayerId = 0x10 + 2 * 12 + 4;
+    rh1.battleRoyaleBalloonCounts = 0x23;
+    rh1.battleRoyaleFinishMask = 1;
+    rh1.battleRoyaleFinishMinutes[0] = 2;
+    rh1.battleRoyaleFinishSeconds[0] = 41;
+    rh1.battleRoyaleFinishMilliseconds[0] = 517;
+    CheckRH1("royale finish", rh1, PulRH1SizeFull);
+
+    PulSELECT select;
+    FillVanilla(&select, sizeof(RKNet::SELECTPacket), 0x37);
+    SetSELECTDefaults(select);
+    select.pulVote = 0x120;
+    select.pulWinningTrack = 0x120;
+    select.variantIdx = 1;
+    select.decimalVR[0] = 42;
+    select.decimalVR[1] = 0;
+    select.voteVariantIdx[0] = 1;
+    select.voteVariantIdx[1] = 0;
+    select.characterTables = 0x3F;
+    select.acVerifyTag = 0xA5C3E1F0;
+    CheckSELECT("vs ct", select);
+    select.allowChangeComboStatus = SELECT_COMBO_ENABLED;
+    CheckSELECT("ott", select);
+    select.allowChangeComboStatus = 0;
+    select.koPerRace = 2;
+    select.racesPerKO = 1;
+    select.alwaysFinal = true;
+    select.elimThresholdPlayers = 4;
+    select.elimChangeCount = 1;
+    CheckSELECT("ko", select);
+    memset(&select.koPerRace, 0, SELECTKOSectionSize);
+    select.blockedTrackCount = 4;
+    select.curBlockingArrayIdx = 3;
+    select.lastGroupedTrackPlayed = true;
+    select.blockedTracks[0] = 0x101;
+    select.blockedTracks[1] = 0x13A;
+    select.blockedTracks[2] = 0x110;
+    CheckSELECT("regional", select);
+    for (u32 i = 0; i < MAX_TRACK_BLOCKING; ++i) select.blockedTracks[i] = static_cast<u16>(0x100 + i);
+    select.blockedTrackCount = MAX_TRACK_BLOCKING;
+    CheckSELECT("blocking full", select);
+
+    u32 size;
+    const u8 truncated[sizeof(RKNet::SELECTPacket) + 2] = {0};
+    if (DecodePulSELECT(truncated, sizeof(truncated), select, size)) ++sSelfTestFailures;
+    OS::Report("packet codec self test: %u failure(s)\n", sSelfTestFailures);
+    return sSelfTestFailures == 0;
+}
+
+static void RunPacketCodecSelfTestAtBoot() {
+    RunPacketCodecSelfTest();
+}
+static BootHook PacketCodecSelfTest(RunPacketCodecSelfTestAtBoot, 0);
+#endif
+
+}  // namespace Network
+}  // namespace Pulsar
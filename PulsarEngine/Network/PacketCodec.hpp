@@ -0,0 +1,29 @@
+#ifndef _PUL_PACKET_CODEC_
+#define _PUL_PACKET_CODEC_
+
+#include <Network/PacketLayout.hpp>
+
+namespace Pulsar {
+namespace Network {
+
+// Wire encoding of the Pulsar parts of RH1 and SELECT. The vanilla prefix is sent untouched, followed by a presence
+// byte and only the sections that differ from the values a sender writes when the matching feature is off.
+// Decoding restores those defaults, so every reader keeps working on the in-memory structs and size checks.
+// Encoded sizes never match a raw struct size, raw packets from and for peers without the codec decode as themselves.
+
+// size is the in-memory size the packet would have been sent with; returns the wire size written to dest
+u32 EncodePulRH1(const PulRH1 &packet, u32 size, u8 *dest);
+// Returns false on malformed input; size receives the in-memory size to expose to readers
+bool DecodePulRH1(const u8 *src, u32 wireSize, PulRH1 &packet, u32 &size);
+u32 EncodePulSELECT(const PulSELECT &packet, u32 size, u8 *dest);
+bool DecodePulSELECT(const u8 *src, u32 wireSize, PulSELECT &packet, u32 &size);
+
+#ifdef PACKET_CODEC_SELFTEST
+// Round-trips representative packets of every mode, reports mismatches and the per mode byte counts
+bool RunPacketCodecSelfTest();
+#endif
+
+}  // namespace Network
+}  // namespace Pulsar
+
+#endif
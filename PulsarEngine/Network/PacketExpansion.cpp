@@ -1,8 +1,14 @@
 #include <Network/PacketExpansion.hpp>
+#include <Network/PacketCodec.hpp>
+#include <include/c_string.h>
 
 namespace Pulsar {
 namespace Network {
 
+static u32 sCodecAids;  // bit per aid
+static PulRH1 sSendRH1[2][12];  // indexed like splitToSendRACEPackets
+static u8 sSendRH1Sizes[2][12];
+
 void *CreateSendAndRecvBuffers() {
     register RKNet::PacketHolder<void> *holder;
     register CustomRKNetController *controller;
@@ -19,9 +25,10 @@ kmCall(0x806570b4, CreateSendAndRecvBuffers);
 
 // Buffer size must be the FULL size to accommodate any packet (including LapKO in friend rooms)
 // The actual transmitted packet size is controlled dynamically in BeforeRH1Send based on context
-kmWrite8(0x8089a19b, PulRH1SizeFull);
+// RH1 and SELECT hold their wire encoding when sent, which can be a few bytes larger than the structs
+kmWrite8(0x8089a19b, PulRH1WireSizeMax);
 kmWrite8(0x8089a19f, sizeof(PulRH2));
-kmWrite8(0x8089a1a3, sizeof(PulSELECT));
+kmWrite8(0x8089a1a3, PulSELECTWireSizeMax);
 kmWrite8(0x8089a1a7, 2 * sizeof(PulRACEDATA));
 kmWrite8(0x8089a1ab, sizeof(PulUSER));
 kmWrite8(0x8089a1af, 2 * sizeof(PulITEM));
@@ -31,6 +38,7 @@ void SetProperRecvBuffers(u8 aid, void *usualBuffer, u32 usualSize) {
     register CustomRKNetController *controller;
     asm(mr controller, r31;);
     memset(controller->fullPulRecvPackets[aid], 0, totalRACESize);
+    SetCodecPeer(aid, false);
     DWC::SetRecvBuffer(aid, controller->fullPulRecvPackets[aid], totalRACESize);
 }
 kmWrite32(0x80658c78, 0x60000000);  // prevent usual memset
@@ -39,9 +47,37 @@ kmCall(0x80658c90, SetProperRecvBuffers);
 void ProperRecvBuffersClear() {
     const CustomRKNetController *controller = reinterpret_cast<CustomRKNetController *>(RKNet::Controller::sInstance);
     for (int aid = 0; aid < 12; ++aid) memset(controller->fullPulRecvPackets[aid], 0, totalRACESize);
+    sCodecAids = 0;
+    memset(sSendRH1Sizes, 0, sizeof(sSendRH1Sizes));
 }
 kmCall(0x8065607c, ProperRecvBuffersClear);
 
+// RH1 is expanded in place so ProcessRACEPacket hands the in-memory PulRH1 to every reader
+// SELECT can't be done here as ROOM shares its section, it's expanded in AfterSELECTReception instead
+static bool ExpandRH1(RKNet::RACEPacketHeader &packet, u32 &size) {
+    u8 *sizes = &packet.sizes[0];
+    const u32 wireSize = sizes[1];
+    if (wireSize <= sizeof(RKNet::RACEHEADER1Packet)) return true;
+    const u32 offset = sizes[0];
+    if (offset + wireSize > size) return false;
+
+    u8 *section = reinterpret_cast<u8 *>(&packet) + offset;
+    PulRH1 rh1;
+    u32 rh1Size;
+    if (!DecodePulRH1(section, wireSize, rh1, rh1Size)) return false;
+    if (rh1Size == wireSize) return true;  // raw struct
+    const u32 expandedSize = size - wireSize + rh1Size;
+    if (expandedSize > totalRACESize) return false;
+
+    memmove(section + rh1Size, section + wireSize, size - offset - wireSize);
+    memcpy(section, &rh1, rh1Size);
+    sizes[1] = static_cast<u8>(rh1Size);
+    size = expandedSize;
+    packet.crc32 = 0;
+    packet.crc32 = OS::CalcCRC32(&packet, size);
+    return true;
+}
+
 void CheckPacket(CustomRKNetController *controller, RKNet::RACEPacketHeader &packet, u32 size, u32 sizeUnused, u32 aid) {
     using namespace RKNet;
 
@@ -50,7 +86,7 @@ void CheckPacket(CustomRKNetController *controller, RKNet::RACEPacketHeader &pac
     const u32 calcCRC = OS::CalcCRC32(&packet, size);
     packet.crc32 = recvCRC;
     bool disconnect = false;
-    if (recvCRC != calcCRC)
+    if (recvCRC != calcCRC || !ExpandRH1(packet, size))
         disconnect = true;
     else {
         u32 *lastUsedBufferAid = &controller->lastReceivedBufferUsed[aid][0];
@@ -117,5 +153,71 @@ u8 GetLastRecvSECTIONSize(u8 aid, u8 sectionIdx) {
     return header->sizes[sectionIdx];
 }
 
+void SetCodecPeer(u8 aid, bool hasCodec) {
+    if (aid >= 12) return;
+    if (hasCodec)
+        sCodecAids |= 1 << aid;
+    else
+        sCodecAids &= ~(1 << aid);
+}
+
+bool IsCodecPeer(u8 aid) {
+    return aid < 12 && (sCodecAids >> aid & 1) != 0;
+}
+
+template <class T>
+static bool FindSendHolder(const RKNet::PacketHolder<T> &holder, u32 &bufferIdx, u8 &aid) {
+    const RKNet::Controller *controller = RKNet::Controller::sInstance;
+    if (controller == nullptr) return false;
+    for (u32 i = 0; i < 2; ++i) {
+        for (u8 cur = 0; cur < 12; ++cur) {
+            const RKNet::SplitRACEPointers *split = controller->splitToSendRACEPackets[i][cur];
+            if (split != nullptr && split->GetPacketHolder<T>() == &holder) {
+                bufferIdx = i;
+                aid = cur;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WriteSendPulSELECT(RKNet::PacketHolder<PulSELECT> &holder, const PulSELECT &packet, u32 size) {
+    u32 bufferIdx;
+    u8 aid;
+    if (size > sizeof(RKNet::SELECTPacket) && FindSendHolder(holder, bufferIdx, aid) && IsCodecPeer(aid))
+        holder.packetSize = EncodePulSELECT(packet, size, reinterpret_cast<u8 *>(holder.packet));
+    else
+        holder.Copy(&packet, size);
+}
+
+void ReadSendPulRH1(const RKNet::PacketHolder<PulRH1> &holder, PulRH1 &packet, u32 &size) {
+    u32 bufferIdx;
+    u8 aid;
+    if (FindSendHolder(holder, bufferIdx, aid) && sSendRH1Sizes[bufferIdx][aid] != 0) {
+        packet = sSendRH1[bufferIdx][aid];
+        size = sSendRH1Sizes[bufferIdx][aid];
+        return;
+    }
+    memcpy(&packet, holder.packet, sizeof(PulRH1));  // holders without a copy are never encoded
+    size = holder.packetSize;
+}
+
+void WriteSendPulRH1(RKNet::PacketHolder<PulRH1> &holder, const PulRH1 &packet, u32 size) {
+    u32 bufferIdx;
+    u8 aid;
+    const bool found = FindSendHolder(holder, bufferIdx, aid);
+    if (found) {
+        sSendRH1[bufferIdx][aid] = packet;
+        sSendRH1Sizes[bufferIdx][aid] = static_cast<u8>(size);
+    }
+    if (size > sizeof(RKNet::RACEHEADER1Packet) && found && IsCodecPeer(aid)) {
+        holder.packetSize = EncodePulRH1(packet, size, reinterpret_cast<u8 *>(holder.packet));
+    } else {
+        memcpy(holder.packet, &packet, sizeof(PulRH1));
+        holder.packetSize = size;
+    }
+}
+
 }  // namespace Network
 }  // namespace Pulsar
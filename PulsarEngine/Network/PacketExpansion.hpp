@@ -2,15 +2,14 @@
 #define _PUL_NETWORK_EXPANSION_
 
 #include <MarioKartWii/RKNet/RKNetController.hpp>
-#include <MarioKartWii/RKNet/SELECT.hpp>
 #include <MarioKartWii/RKNet/EVENT.hpp>
 #include <MarioKartWii/RKNet/ROOM.hpp>
 #include <MarioKartWii/RKNet/ITEM.hpp>
 #include <MarioKartWii/RKNet/RACEDATA.hpp>
-#include <MarioKartWii/RKNet/RH1.hpp>
 #include <MarioKartWii/RKNet/RH2.hpp>
 #include <MarioKartWii/RKNet/USER.hpp>
 #include <Network/Network.hpp>
+#include <Network/PacketLayout.hpp>
 
 namespace Pulsar {
 namespace Network {
@@ -26,49 +25,6 @@ struct PulPlayerData {  // SELECT struct
 };
 static_assert(sizeof(PulPlayerData) == 0x8, "PulPlayerData size");
 
-struct PulRH1 : public RKNet::RACEHEADER1Packet {
-    // Pulsar data (always sent)
-    u16 pulsarTrackId;  // current
-    u8 variantIdx;
-
-    // HAW Vote (always sent)
-    u8 chooseNextStatus;
-    bool hasTrack;
-    u16 nextTrack;  // PulsarId
-
-    // These fields are only populated/read when their respective game modes are enabled
-    // They are always present in the struct for memory layout, but zeroed when not in use
-
-    // KOStats - only used when PULSAR_MODE_KO is enabled
-    u16 timeInDanger;
-    u8 almostKOdCounter;
-    u8 finalPercentageSum;  // to be divided by racecount at the end of the GP
-
-    // LapKO - only used when PULSAR_MODE_LAPKO is enabled AND in friend rooms
-    u8 lapKoSeq;
-    u8 lapKoRoundIndex;
-    u8 lapKoActiveCount;
-    u8 lapKoElimCount;
-    u8 lapKoElims[12];
-
-    // Battle Royale - only used when PULSAR_MODE_BATTLEROYALE is enabled AND in friend rooms
-    // Must stay at the END so we can conditionally expand packet size
-    u8 battleRoyaleLossSeq;
-    u8 battleRoyaleLossPlayerId;  // 0..11 loss, 0x10 + losing * 12 + gaining means move
-    u8 battleRoyaleBalloonCounts;  // low/high nibbles are local player balloon counts, up to two players per aid
-    u8 battleRoyaleFinishMask;  // bits are local players with a synced finish time
-    u16 battleRoyaleFinishMinutes[2];
-    u8 battleRoyaleFinishSeconds[2];
-    u16 battleRoyaleFinishMilliseconds[2];
-};
-
-// Size constants for conditional packet expansion
-static const u32 PulRH1BattleRoyaleSize = 14;
-static const u32 PulRH1LapKoSize = 16;
-static const u32 PulRH1SizeBase = sizeof(PulRH1) - PulRH1LapKoSize - PulRH1BattleRoyaleSize;
-static const u32 PulRH1SizeLapKo = PulRH1SizeBase + PulRH1LapKoSize;
-static const u32 PulRH1SizeFull = sizeof(PulRH1);
-
 struct PulRH2 : public RKNet::RACEHEADER2Packet {};
 struct PulROOM : public RKNet::ROOMPacket {
     // Generic ROOM settings
@@ -102,36 +58,6 @@ enum SELECTComboStatus {
 
 };
 
-struct PulSELECT : public RKNet::SELECTPacket {
-    u16 pulVote;  // 0x38 no need for 2, they're guaranteed to be the same
-    u16 pulWinningTrack;  // 0x3a
-    u8 variantIdx;  // 0x3c
-
-    // OTT Settings
-    u8 allowChangeComboStatus;
-
-    // KOSettings
-    u8 koPerRace;
-    u8 racesPerKO;
-    bool alwaysFinal;
-    bool singleRace1v1Final;
-    u8 elimThresholdPlayers;
-    u8 elimChangeCount;
-
-    u8 decimalVR[2];
-
-    u8 voteVariantIdx[2];
-
-    // Track blocking sync for regional rooms (late joiner support)
-    u8 blockedTrackCount;  // Number of valid entries in blockedTracks
-    u8 curBlockingArrayIdx;  // Current write index in circular buffer
-    bool lastGroupedTrackPlayed;  // Whether most recent track was a grouped track
-    u16 characterTables;  // six bits per local hud slot, up to two local slots
-    u16 blockedTracks[12];  // PulsarId array (up to MAX_TRACK_BLOCKING tracks)
-
-    // Anti-cheat verification tag - proves sender has correct encryption key
-    u32 acVerifyTag;  // Must be last encrypted field for alignment
-};
 
 struct PulRACEDATA : public RKNet::RACEDATAPacket {};
 struct PulUSER : public RKNet::USERPacket {};
@@ -139,7 +65,7 @@ struct PulITEM : public RKNet::ITEMPacket {};
 struct PulEVENT : public RKNet::EVENTPacket {};  // NOT RECOMMENDED as this has variable length
 #pragma pack(pop)
 
-static const u32 totalRACESize = sizeof(RKNet::RACEPacketHeader) + sizeof(PulRH1) + sizeof(PulRH2) + sizeof(PulSELECT) + 2 * sizeof(PulRACEDATA) + sizeof(PulUSER) + 2 * sizeof(PulITEM) + sizeof(PulEVENT);
+static const u32 totalRACESize = sizeof(RKNet::RACEPacketHeader) + PulRH1WireSizeMax + sizeof(PulRH2) + PulSELECTWireSizeMax + 2 * sizeof(PulRACEDATA) + sizeof(PulUSER) + 2 * sizeof(PulITEM) + sizeof(PulEVENT);
 
 class CustomRKNetController {  // Exists to make received packets a pointer array so that the size can be variable
 public:
@@ -229,6 +155,15 @@ public:
 
 u8 GetLastRecvSECTIONSize(u8 aid, u8 sectionIdx);
 
+// Only aids whose SELECT carried PulSELECTCodecFlag are sent the wire encoding, everyone else gets the raw structs
+void SetCodecPeer(u8 aid, bool hasCodec);
+bool IsCodecPeer(u8 aid);
+void WriteSendPulSELECT(RKNet::PacketHolder<PulSELECT> &holder, const PulSELECT &packet, u32 size);
+
+// Outgoing RH1s are kept unencoded per send holder; code that patches one after its export goes through these
+void ReadSendPulRH1(const RKNet::PacketHolder<PulRH1> &holder, PulRH1 &packet, u32 &size);
+void WriteSendPulRH1(RKNet::PacketHolder<PulRH1> &holder, const PulRH1 &packet, u32 size);
+
 }  // namespace Network
 }  // namespace Pulsar
 
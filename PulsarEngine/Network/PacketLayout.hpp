@@ -0,0 +1,122 @@
+#ifndef _PUL_PACKET_LAYOUT_
+#define _PUL_PACKET_LAYOUT_
+
+#include <MarioKartWii/RKNet/RH1.hpp>
+#include <MarioKartWii/RKNet/SELECT.hpp>
+
+// Expanded RH1 and SELECT layouts. Only the vanilla packet structs are pulled in, so PacketCodec.cpp also builds
+// natively with -DPACKET_CODEC_HOST, see scripts/build_packet_codec_host.sh.
+
+namespace Pulsar {
+namespace Network {
+
+static const u32 MAX_TRACK_BLOCKING = 12;  // Maximum number of blocked tracks synced via packets
+
+#pragma pack(push, 1)
+struct PulRH1 : public RKNet::RACEHEADER1Packet {
+    // Pulsar data (always sent)
+    u16 pulsarTrackId;  // current
+    u8 variantIdx;
+
+    // HAW Vote (always sent)
+    u8 chooseNextStatus;
+    bool hasTrack;
+    u16 nextTrack;  // PulsarId
+
+    // These fields are only populated/read when their respective game modes are enabled
+    // They are always present in the struct for memory layout, but zeroed when not in use
+
+    // KOStats - only used when PULSAR_MODE_KO is enabled
+    u16 timeInDanger;
+    u8 almostKOdCounter;
+    u8 finalPercentageSum;  // to be divided by racecount at the end of the GP
+
+    // LapKO - only used when PULSAR_MODE_LAPKO is enabled AND in friend rooms
+    u8 lapKoSeq;
+    u8 lapKoRoundIndex;
+    u8 lapKoActiveCount;
+    u8 lapKoElimCount;
+    u8 lapKoElims[12];
+
+    // Battle Royale - only used when PULSAR_MODE_BATTLEROYALE is enabled AND in friend rooms
+    // Must stay at the END so we can conditionally expand packet size
+    u8 battleRoyaleLossSeq;
+    u8 battleRoyaleLossPlayerId;  // 0..11 loss, 0x10 + losing * 12 + gaining means move
+    u8 battleRoyaleBalloonCounts;  // low/high nibbles are local player balloon counts, up to two players per aid
+    u8 battleRoyaleFinishMask;  // bits are local players with a synced finish time
+    u16 battleRoyaleFinishMinutes[2];
+    u8 battleRoyaleFinishSeconds[2];
+    u16 battleRoyaleFinishMilliseconds[2];
+};
+
+// Size constants for conditional packet expansion
+static const u32 PulRH1BattleRoyaleSize = 14;
+static const u32 PulRH1LapKoSize = 16;
+static const u32 PulRH1SizeBase = sizeof(PulRH1) - PulRH1LapKoSize - PulRH1BattleRoyaleSize;
+static const u32 PulRH1SizeLapKo = PulRH1SizeBase + PulRH1LapKoSize;
+static const u32 PulRH1SizeFull = sizeof(PulRH1);
+
+// On the wire, Pulsar RH1 and SELECT sections are a presence byte followed by the non-default parts only (see PacketCodec)
+// Peers without the codec get the raw structs, so an encoded packet is padded whenever its size matches a raw one
+enum PulRH1WireSection {
+    PULRH1_SECTION_PULSAR = 1 << 0,  // track, variant and HAW vote
+    PULRH1_SECTION_KO = 1 << 1,
+    PULRH1_SECTION_LAPKO = 1 << 2,
+    PULRH1_SECTION_BATTLEROYALE = 1 << 3,
+    PULRH1_SECTION_MASK = 0xF,
+    PULRH1_WIRE_PAD = 1 << 4,  // one trailing pad byte
+    PULRH1_TIER_SHIFT = 6  // top two bits hold the in-memory size the sender used: base, LapKO or full
+};
+static const u32 PulRH1WireSizeMax = sizeof(RKNet::RACEHEADER1Packet) + 1 + 7 + 4 + (4 + 1 + 12) + PulRH1BattleRoyaleSize;
+
+struct PulSELECT : public RKNet::SELECTPacket {
+    u16 pulVote;  // 0x38 no need for 2, they're guaranteed to be the same
+    u16 pulWinningTrack;  // 0x3a
+    u8 variantIdx;  // 0x3c
+
+    // OTT Settings
+    u8 allowChangeComboStatus;
+
+    // KOSettings
+    u8 koPerRace;
+    u8 racesPerKO;
+    bool alwaysFinal;
+    bool singleRace1v1Final;
+    u8 elimThresholdPlayers;
+    u8 elimChangeCount;
+
+    u8 decimalVR[2];
+
+    u8 voteVariantIdx[2];
+
+    // Track blocking sync for regional rooms (late joiner support)
+    u8 blockedTrackCount;  // Number of valid entries in blockedTracks
+    u8 curBlockingArrayIdx;  // Current write index in circular buffer
+    bool lastGroupedTrackPlayed;  // Whether most recent track was a grouped track
+    u16 characterTables;  // six bits per local hud slot, up to two local slots
+    u16 blockedTracks[12];  // PulsarId array (up to MAX_TRACK_BLOCKING tracks)
+
+    // Anti-cheat verification tag - proves sender has correct encryption key
+    u32 acVerifyTag;  // Must be last encrypted field for alignment
+};
+
+enum PulSELECTWireSection {
+    PULSELECT_SECTION_OTT = 1 << 0,
+    PULSELECT_SECTION_KO = 1 << 1,
+    PULSELECT_SECTION_BLOCKING = 1 << 2,
+    PULSELECT_SECTION_MASK = 0x7,
+    PULSELECT_WIRE_PAD = 1 << 7  // one trailing pad byte
+};
+static const u32 PulSELECTWireSizeMax = sizeof(RKNet::SELECTPacket) + 1 + 11 + 1 + 6 + (3 + 1 + 2 * MAX_TRACK_BLOCKING) + 4;
+
+// Senders that decode the wire encoding set this in the characterTables of every SELECT, older builds mask it out
+static const u16 PulSELECTCodecFlag = 0x8000;
+#pragma pack(pop)
+
+static_assert(PulRH1WireSizeMax >= sizeof(PulRH1) && PulRH1WireSizeMax <= 0xFF, "RH1 wire size");
+static_assert(PulSELECTWireSizeMax >= sizeof(PulSELECT) && PulSELECTWireSizeMax <= 0xFF, "SELECT wire size");
+
+}  // namespace Network
+}  // namespace Pulsar
+
+#endif
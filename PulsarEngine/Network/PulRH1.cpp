@@ -64,6 +64,9 @@ void BeforeRH1Send(RKNet::PacketHolder<PulRH1> &packetHolder, PulRH1 *packet, u3
         packetHolder.packet->battleRoyaleFinishMilliseconds[0] = 0;
         packetHolder.packet->battleRoyaleFinishMilliseconds[1] = 0;
     }
+
+    const PulRH1 expanded = *packetHolder.packet;
+    WriteSendPulRH1(packetHolder, expanded, packetHolder.packetSize);
 }
 kmCall(0x80655458, BeforeRH1Send);
 kmCall(0x806550e4, BeforeRH1Send);
@@ -7,6 +7,7 @@
 #include <Network/GPReport.hpp>
 #include <Network/Network.hpp>
 #include <Network/PacketExpansion.hpp>
+#include <Network/PacketCodec.hpp>
 #include <Network/PulSELECT.hpp>
 #include <Network/Rating/PlayerRating.hpp>
 #include <CustomCharacters/CustomCharacters.hpp>
@@ -84,9 +85,8 @@ void BeforeSELECTSend(RKNet::PacketHolder<PulSELECT> *packetHolder, PulSELECT *s
         src->playersData[1].courseVote = vanillaVote;
     } else
         len = sizeof(PulSELECT);
-    packetHolder->Copy(src, len);
-
-    packetHolder->packet->characterTables = CustomCharacters::GetLocalOnlineCharacterTables();
+    src->characterTables = CustomCharacters::GetLocalOnlineCharacterTables() | PulSELECTCodecFlag;
+    WriteSendPulSELECT(*packetHolder, *src, len);
 }
 kmCall(0x80661040, BeforeSELECTSend);
 
@@ -98,7 +98,19 @@ static void AfterSELECTReception(PulSELECT *unused, PulSELECT *src, u32 len) {
     register RKNet::PacketHolder<PulSELECT> *holder;
     asm(mr holder, r27);
 
-    const u16 characterTables = (holder != nullptr && holder->packetSize == sizeof(PulSELECT)) ? src->characterTables : 0;
+    // The holder keeps the wire encoding, the expanded packet is worked on locally
+    u32 packetSize = holder != nullptr ? holder->packetSize : 0;
+    PulSELECT expanded;
+    if (packetSize > sizeof(RKNet::SELECTPacket)) {
+        const bool isRaw = packetSize == sizeof(PulSELECT);
+        if (!DecodePulSELECT(reinterpret_cast<const u8 *>(src), packetSize, expanded, packetSize))
+            packetSize = sizeof(RKNet::SELECTPacket);  // malformed Pulsar part, keep the vanilla fields only
+        else
+            SetCodecPeer(aid, !isRaw || (expanded.characterTables & PulSELECTCodecFlag) != 0);
+        src = &expanded;
+    }
+
+    const u16 characterTables = packetSize == sizeof(PulSELECT) ? src->characterTables & ~PulSELECTCodecFlag : 0;
     CustomCharacters::UpdateOnlineCharacterTablesFromAid(aid, src->playerIdToAid, characterTables);
 
     for (int i = 0; i < 2; ++i) {
@@ -106,9 +118,9 @@ static void AfterSELECTReception(PulSELECT *unused, PulSELECT *src, u32 len) {
     }
 
     PulSELECT &dest = handler->receivedPackets[aid];
-    if (holder != nullptr && holder->packetSize == sizeof(RKNet::SELECTPacket)) {
+    if (packetSize == sizeof(RKNet::SELECTPacket)) {
         const u16 pulWinning = CupsConfig::ConvertTrack_RealIdToPulsarId(static_cast<CourseId>(src->winningCourse));
-        src->pulWinningTrack = pulWinning;  // this is safe because src is a ptr to the buffer of holder which is always big enough
+        src->pulWinningTrack = pulWinning;  // this is safe because src is either the holder buffer, which is always big enough, or expanded
         const u16 pulVote = CupsConfig::ConvertTrack_RealIdToPulsarId(static_cast<CourseId>(src->playersData[0].courseVote));
         src->pulVote = pulVote;
         src->voteVariantIdx[0] = 0;
@@ -149,7 +161,7 @@ static void AfterSELECTReception(PulSELECT *unused, PulSELECT *src, u32 len) {
     }
 
     System *system = System::sInstance;
-    if (system != nullptr && holder != nullptr && holder->packetSize == sizeof(PulSELECT)) {
+    if (system != nullptr && packetSize == sizeof(PulSELECT)) {
         Network::Mgr &netMgr = system->netMgr;
         const u32 localBlockingCount = system->GetInfo().GetTrackBlocking();
 
@@ -286,6 +298,30 @@ void StoreBlockedTrack(System &system, PulsarId trackId) {
     system.netMgr.lastGroupedTrackPlayed = IsGroupedTrack(trackId);
 }
 
+// The winner is final as soon as the host decides it (or a non-host validates the host's pick), which is several seconds
+// before the voting page calls SetCorrectTrack. Starting ArchiveMgr's async course load there lets the roulette hide
+// the SZS read/decode; SetCorrectTrack then only hands the already requested archive over.
+static PulsarId preloadedTrack = PULSARID_NONE;
+static u8 preloadedVariant = 0;
+
+static void ResetTrackPreload() {
+    preloadedTrack = PULSARID_NONE;
+    preloadedVariant = 0;
+}
+
+static void PreloadWinningTrack(PulsarId winningTrack, u8 variantIdx) {
+    CupsConfig *cupsConfig = CupsConfig::sInstance;
+    ArchiveMgr *archiveMgr = ArchiveMgr::sInstance;
+    if (cupsConfig == nullptr || archiveMgr == nullptr || !cupsConfig->IsValidTrack(winningTrack)) return;
+    if (preloadedTrack != PULSARID_NONE) return;  // the async loader only holds one course, never re-request mid-load
+
+    cupsConfig->SetWinning(winningTrack, variantIdx);
+    archiveMgr->RequestLoadCourseAsync(static_cast<CourseId>(winningTrack));
+    preloadedTrack = winningTrack;
+    preloadedVariant = variantIdx;
+    OS::Report("[Pulsar] Preloading voted track %d (variant %d)\n", winningTrack, variantIdx);
+}
+
 void ExpSELECTHandler::DecideTrack(ExpSELECTHandler &self) {
     Random random;
     System *system = System::sInstance;
@@ -377,6 +413,10 @@ void ExpSELECTHandler::DecideTrack(ExpSELECTHandler &self) {
             "wl:mkw_select_course", static_cast<u32>(vote));
         ReportU32("wl:mkw_select_cc", static_cast<u32>(GetEngineClass(self)));
     }
+    if (sub.localAid == hostAid) {
+        const PulsarId winningTrack = static_cast<PulsarId>(self.toSendPacket.pulWinningTrack);
+        PreloadWinningTrack(winningTrack, self.toSendPacket.variantIdx);
+    }
 }
 kmCall(0x80661490, ExpSELECTHandler::DecideTrack);
 
@@ -419,8 +459,15 @@ static void SetCorrectTrack(ArchiveMgr *root, PulsarId winningCourse) {
         }
     }
 
+    const bool hasPreload = preloadedTrack != PULSARID_NONE;
+    const bool isPreloaded = preloadedTrack == winningCourse && preloadedVariant == select->variantIdx;
+    ResetTrackPreload();
     cupsConfig->SetWinning(winningCourse, select->variantIdx);
-    root->RequestLoadCourseAsync(static_cast<CourseId>(winningCourse));
+    if (!isPreloaded) {
+        // The loader only holds one course: let a mismatched preload finish before requesting the real winner
+        if (hasPreload) root->WaitForLoad();
+        root->RequestLoadCourseAsync(static_cast<CourseId>(winningCourse));
+    }
 }
 kmCall(0x80644414, SetCorrectTrack);
 
@@ -510,6 +557,7 @@ void InitPatch() {
     select->toSendPacket.pulVote = 0x43;
     select->toSendPacket.pulWinningTrack = 0xff;
     select->toSendPacket.acVerifyTag = 0;
+    ResetTrackPreload();
     const Settings::Mgr &settings = Settings::Mgr::Get();
     bool allowChangeCombo;
     const RKNet::Controller *controller = RKNet::Controller::sInstance;
@@ -678,6 +726,7 @@ void ProcessNewPacketVoting() {
                             send.winningVoterAid = winningAid;
                             send.pulWinningTrack = winningTrack;
                             memcpy(send.playerIdToAid, curRecv.playerIdToAid, sizeof(send.playerIdToAid));
+                            PreloadWinningTrack(static_cast<PulsarId>(winningTrack), curRecv.variantIdx);
                         }
                     }
                 }
@@ -11,8 +11,6 @@
 #include <MarioKartWii/GlobalFunctions.hpp>
 #include <MarioKartWii/System/Rating.hpp>
 #include <Network/Rating/PlayerRating.hpp>
-#include <core/rvl/DWC/NHTTP.hpp>
-#include <core/rvl/NHTTP/NHTTP.hpp>
 #include <MarioKartWii/RKNet/USER.hpp>
 #include <Settings/Settings.hpp>
 #include <Settings/SettingsParam.hpp>
@@ -28,14 +26,24 @@ struct BadgeRequestCtx {
     u32 pid;
 };
 
+// Special badge icons (bit per icon) of one license's PID, picked out of the downloaded badge list
+struct LicenseBadgeEntry {
+    u32 pid;
+    u32 mask;
+};
+
+// The badge list holds every PID at once, so one download answers for all four licenses on the console. Only their
+// PIDs are looked up while parsing, so the size of the list never decides whose badges are kept.
+static const u32 kBadgeLicenseCount = 4;
+
 static BadgeRequestCtx s_badgeRequestCtx;
-static void *s_badgeRequestWorkBuf = nullptr;
+static Network::HttpRequestId s_badgeRequestId = 0;
 static u32 s_badgeRequestGeneration = 0;
 static u32 s_badgePid = 0;
 static u32 s_badgeMask = 0;
-static bool s_badgeRequestActive = false;
-static bool s_badgeRefreshPending = false;
-static u32 s_pendingBadgePid = 0;
+static LicenseBadgeEntry s_licenseBadges[kBadgeLicenseCount];
+static bool s_hasBadgeList = false;
+static u64 s_badgeListTime = 0;
 static const u32 MIN_VS_MATCHES = 100;
 
 static s32 BadgeTypeToIcon(u32 badgeType) {
@@ -64,60 +72,75 @@ static s32 BadgeTypeToIcon(u32 badgeType) {
     }
 }
 
-static u32 ParseBadgeJson(const char *body, int bodyLen, u32 pid) {
-    if (body == nullptr || bodyLen <= 0 || pid == 0) return 0;
-
-    const char *p = body;
-    const char *end = body + bodyLen;
-    while (p < end) {
-        if (*p != '"') {
-            ++p;
-            continue;
+// Reads {"<pid>": [badge types...], ...} and fills in the masks of the PIDs already present in entries
+class BadgeListHandler : public Network::Json::Handler {
+public:
+    BadgeListHandler(LicenseBadgeEntry *entries, u32 count) : entries(entries), count(count), pid(0), mask(0) {}
+
+    bool OnKey(const Network::Json::StringRef &key, u32 depth) override {
+        this->pid = 0;
+        if (depth != 1 || key.hasEscapes || key.length == 0) return true;
+        u32 value = 0;
+        for (u32 i = 0; i < key.length; ++i) {
+            const char c = key.data[i];
+            if (c < '0' || c > '9') return true;
+            const u32 digit = static_cast<u32>(c - '0');
+            if (value > (0xffffffffu - digit) / 10) return true;
+            value = value * 10 + digit;
         }
+        this->pid = value;
+        return true;
+    }
 
-        ++p;
-        u32 key = 0;
-        bool hasKeyDigits = false;
-        bool validKey = true;
-        while (p < end && *p != '"') {
-            if (*p >= '0' && *p <= '9') {
-                const u32 digit = static_cast<u32>(*p - '0');
-                if (key > (0xffffffffu - digit) / 10) validKey = false;
-                key = key * 10 + digit;
-                hasKeyDigits = true;
-            } else {
-                validKey = false;
-            }
-            ++p;
-        }
-        if (p >= end) break;
-        ++p;
-        p = Network::Json::SkipWhitespace(p, end);
-        if (p >= end || *p != ':') continue;
-        ++p;
-        p = Network::Json::SkipWhitespace(p, end);
-        if (!validKey || !hasKeyDigits || key != pid || p >= end || *p != '[') continue;
-
-        ++p;
-        u32 badgeMask = 0;
-        while (p < end && *p != ']') {
-            p = Network::Json::SkipWhitespace(p, end);
-            if (p < end && *p == ',') {
-                ++p;
-                continue;
-            }
-
-            u32 badgeType = 0;
-            if (!Network::Json::ParseU32(p, end, badgeType)) break;
-            const s32 icon = BadgeTypeToIcon(badgeType);
-            if (icon >= SPECIAL_BADGE_FIRST && icon <= SPECIAL_BADGE_LAST) badgeMask |= 1u << icon;
-
-            p = Network::Json::SkipWhitespace(p, end);
-            if (p < end && *p == ',') ++p;
+    bool OnArrayBegin(u32 /*depth*/) override {
+        this->mask = 0;
+        return true;
+    }
+
+    bool OnNumber(const Network::Json::NumberRef &value, u32 depth) override {
+        u32 badgeType = 0;
+        if (depth != 2 || !value.ToU32(badgeType)) return true;
+        const s32 icon = BadgeTypeToIcon(badgeType);
+        if (icon >= SPECIAL_BADGE_FIRST && icon <= SPECIAL_BADGE_LAST) this->mask |= 1u << icon;
+        return true;
+    }
+
+    bool OnArrayEnd(u32 depth) override {
+        if (depth != 1 || this->pid == 0) return true;
+        for (u32 i = 0; i < this->count; ++i) {
+            if (this->entries[i].pid == this->pid) this->entries[i].mask = this->mask;
         }
-        return p < end && *p == ']' ? badgeMask : 0;
+        return true;
+    }
+
+private:
+    LicenseBadgeEntry *entries;
+    u32 count;
+    u32 pid;  // 0 while the current key is not a PID
+    u32 mask;
+};
+
+// One pass over the whole list. A truncated or malformed body fails as a whole and leaves entries untouched.
+static bool ParseLicenseBadges(const char *body, u32 bodyLen, LicenseBadgeEntry *entries, u32 count) {
+    if (body == nullptr || bodyLen == 0 || count > kBadgeLicenseCount) return false;
+
+    LicenseBadgeEntry parsed[kBadgeLicenseCount];
+    for (u32 i = 0; i < count; ++i) {
+        parsed[i].pid = entries[i].pid;
+        parsed[i].mask = 0;
     }
-    return 0;
+    BadgeListHandler handler(parsed, count);
+    if (Network::Json::Parse(body, bodyLen, handler) != Network::Json::PARSE_OK) return false;
+    memcpy(entries, parsed, count * sizeof(LicenseBadgeEntry));
+    return true;
+}
+
+static const LicenseBadgeEntry *FindLicenseBadge(u32 pid) {
+    if (!s_hasBadgeList || pid == 0) return nullptr;
+    for (u32 i = 0; i < kBadgeLicenseCount; ++i) {
+        if (s_licenseBadges[i].pid == pid) return &s_licenseBadges[i];
+    }
+    return nullptr;
 }
 
 static float ComputeVsScoreFromLicense(const RKSYS::LicenseMgr &license) {
@@ -456,6 +479,14 @@ int FormatRankDetailsMessage(wchar_t *dst, size_t dstLen) {
         vrClamped, winPct, times1st, distTravelled, distInFirst, score, scoreNeededForNextRank, nextRankLabel);
 }
 
+static u32 GetLicensePID(u32 licenseId) {
+    RKSYS::Mgr *rksysMgr = RKSYS::Mgr::sInstance;
+    if (rksysMgr == nullptr || licenseId >= kBadgeLicenseCount) return 0;
+    const RKSYS::LicenseMgr &license = rksysMgr->licenses[licenseId];
+    if (license.dwcAccUserData.gsProfileId <= 0) return 0;
+    return static_cast<u32>(license.dwcAccUserData.gsProfileId);
+}
+
 static u32 GetCurrentLicensePID() {
     RKSYS::Mgr *rksysMgr = RKSYS::Mgr::sInstance;
     if (rksysMgr == nullptr || rksysMgr->curLicenseId < 0 || rksysMgr->curLicenseId >= 4) return 0;
@@ -500,100 +531,81 @@ static s32 GetFetchedBadgeForPID(u32 pid) {
     return IsSpecialBadgeAvailable(selectedBadge) ? selectedBadge : -1;
 }
 
-static void OnBadgeResponse(s32 result, void *response, void *userdata) {
-    Network::FinishNHTTPRequest();
-    BadgeRequestCtx *ctx = reinterpret_cast<BadgeRequestCtx *>(userdata);
-    if (ctx == nullptr || ctx->generation != s_badgeRequestGeneration || response == nullptr) {
-        if (response != nullptr) NHTTPDestroyResponse(response);
-        s_badgeRequestActive = false;
-        s_badgeMask = 0;
-        return;
-    }
+// Special badge icons (bit per icon) of a license PID in the last badge list, 0 if unknown
+static u32 GetBadgeMaskForPID(u32 pid) {
+    const LicenseBadgeEntry *entry = FindLicenseBadge(pid);
+    return entry != nullptr ? entry->mask : 0;
+}
 
-    if (result == 0) {
-        char *body = nullptr;
-        const int bodyLen = NHTTP::GetBodyAll(reinterpret_cast<NHTTP::Res *>(response), &body);
-        s_badgeMask = ParseBadgeJson(body, bodyLen, ctx->pid);
-        if (Settings::Mgr::IsCreated()) {
-            Settings::Mgr &settings = Settings::Mgr::Get();
-            const u8 selectedBadge = settings.GetRankingBadge();
-            if (selectedBadge != NORMAL_RANKING_BADGE && !IsSpecialBadgeAvailable(selectedBadge)) {
-                settings.SetRankingBadge(NORMAL_RANKING_BADGE);
-            }
-        }
-    } else {
-        s_badgeMask = 0;
+static void ValidateSelectedBadge() {
+    if (!Settings::Mgr::IsCreated()) return;
+    Settings::Mgr &settings = Settings::Mgr::Get();
+    const u8 selectedBadge = settings.GetRankingBadge();
+    if (selectedBadge != NORMAL_RANKING_BADGE && !IsSpecialBadgeAvailable(selectedBadge)) {
+        settings.SetRankingBadge(NORMAL_RANKING_BADGE);
     }
-
-    NHTTPDestroyResponse(response);
-    s_badgeRequestActive = false;
 }
 
-static void StartBadgeRequest(u32 pid) {
-    if (pid == 0 || s_badgeRequestActive) return;
-
-    if (!Network::PrepareNHTTPRequest()) return;
-
-    if (s_badgeRequestWorkBuf == nullptr) {
-        s_badgeRequestWorkBuf = Network::NHTTPAlloc(BADGE_REQUEST_WORK_BUF_SIZE, 0x20);
-        if (s_badgeRequestWorkBuf == nullptr) return;
+static void OnBadgeResponse(s32 result, const char *body, u32 bodyLen, void *userdata) {
+    BadgeRequestCtx *ctx = reinterpret_cast<BadgeRequestCtx *>(userdata);
+    if (ctx == nullptr || ctx->generation != s_badgeRequestGeneration) return;
+    if (result != 0 || body == nullptr) return;  // keep the last list, if any
+
+    // Licenses can be created or changed between downloads, so the PIDs to look up are taken fresh every time.
+    LicenseBadgeEntry entries[kBadgeLicenseCount];
+    for (u32 i = 0; i < kBadgeLicenseCount; ++i) {
+        entries[i].pid = GetLicensePID(i);
+        entries[i].mask = 0;
     }
-    memset(s_badgeRequestWorkBuf, 0, BADGE_REQUEST_WORK_BUF_SIZE);
-
-    s_badgeRequestCtx.generation = s_badgeRequestGeneration;
-    s_badgeRequestCtx.pid = pid;
-
-    void *request = NHTTPCreateRequest(BADGE_URL, 0, s_badgeRequestWorkBuf, BADGE_REQUEST_WORK_BUF_SIZE,
-                                       reinterpret_cast<void *>(&OnBadgeResponse),
-                                       reinterpret_cast<void *>(&s_badgeRequestCtx));
-    if (request == nullptr) return;
-
-    const s32 sendRet = NHTTPSendRequestAsync(request);
-    if (sendRet >= 0) {
-        Network::MarkNHTTPRequestActive();
-        s_badgeRequestActive = true;
+    if (!ParseLicenseBadges(body, bodyLen, entries, kBadgeLicenseCount)) return;
+
+    const bool isFirstList = !s_hasBadgeList;
+    memcpy(s_licenseBadges, entries, sizeof(s_licenseBadges));
+    s_hasBadgeList = true;
+    s_badgeListTime = OS::GetTime();
+
+    // Only the selected license's badges are applied, and only when they changed.
+    const u32 mask = GetBadgeMaskForPID(ctx->pid);
+    if (isFirstList || mask != s_badgeMask) {
+        s_badgeMask = mask;
+        ValidateSelectedBadge();
     }
 }
 
+// Switching licenses is answered from the last list; it is only downloaded again once it is stale or the PID is new
 static void StartBadgeRefresh(u32 pid) {
-    s_badgeRefreshPending = false;
-    s_pendingBadgePid = 0;
-
-    if (pid == 0) {
-        s_badgePid = 0;
-        s_badgeMask = 0;
+    s_badgePid = pid;
+    s_badgeMask = GetBadgeMaskForPID(pid);
+    if (pid == 0) return;
+    const bool isKnownPid = FindLicenseBadge(pid) != nullptr;
+    if (isKnownPid) ValidateSelectedBadge();
+    if (isKnownPid && OS::TicksToSeconds(OS::GetTime() - s_badgeListTime) < BADGE_CACHE_MAX_AGE_SEC) return;
+    if (Network::IsHttpRequestPending(s_badgeRequestId)) {
+        s_badgeRequestCtx.pid = pid;
         return;
     }
 
     ++s_badgeRequestGeneration;
-    s_badgePid = pid;
-    s_badgeMask = 0;
-    StartBadgeRequest(s_badgePid);
+    s_badgeRequestCtx.generation = s_badgeRequestGeneration;
+    s_badgeRequestCtx.pid = pid;
+
+    Network::HttpRequestParams params;
+    params.url = BADGE_URL;
+    params.priority = Network::HTTP_PRIORITY_NORMAL;
+    params.bufferSize = BADGE_REQUEST_WORK_BUF_SIZE;
+    // Freshness is tracked by the license entries themselves, so the response bypasses the HTTP cache
+    params.cacheMaxAgeSec = 0;
+    params.callback = &OnBadgeResponse;
+    params.userdata = &s_badgeRequestCtx;
+    s_badgeRequestId = Network::QueueHttpRequest(params);
 }
 
 static void BeginBadgeDownloads() {
     const u32 pid = GetCurrentLicensePID();
     if (pid == 0) return;
-
-    if (s_badgeRequestActive) {
-        s_badgeRefreshPending = true;
-        s_pendingBadgePid = pid;
-        return;
-    }
-
     StartBadgeRefresh(pid);
 }
 
-static void ProcessPendingBadgeRequests() {
-    if (s_badgeRequestActive) return;
-
-    if (s_badgeRefreshPending) {
-        StartBadgeRefresh(s_pendingBadgePid);
-    }
-}
-
-static FrameLoadHook BadgeRequestFrameHook(ProcessPendingBadgeRequests);
-
 asmFunc AsmHook_WFCMainOnActivateBadgeRefresh() {
     ASM(
         nofralloc;
@@ -10,6 +10,7 @@ namespace Ranking {
 
 static const char *BADGE_URL = "http://rwfc.net/api/badges/all";
 static const u32 BADGE_REQUEST_WORK_BUF_SIZE = 0x4000;
+static const u32 BADGE_CACHE_MAX_AGE_SEC = 600;  // age of the parsed badge list before it is downloaded again
 static const u8 NORMAL_RANKING_BADGE = 0;
 static const u8 SPECIAL_BADGE_FIRST = 10;
 static const u8 SPECIAL_BADGE_LAST = 17;
@@ -1,18 +1,14 @@
 #include <RetroRewind.hpp>
 #include <Gamemodes/Battle/BattleElimination.hpp>
-#include <core/RK/RKSystem.hpp>
-#include <core/egg/mem/Heap.hpp>
 #include <core/System/SystemManager.hpp>
-#include <core/rvl/DWC/NHTTP.hpp>
-#include <core/rvl/NHTTP/NHTTP.hpp>
 #include <MarioKartWii/RKNet/RKNetController.hpp>
+#include <Network/Json.hpp>
 #include <Network/NHTTPHelper.hpp>
 #include <Network/Rating/PlayerRating.hpp>
 #include <Network/WiiLink.hpp>
 #include <Network/ServerDateTime.hpp>
 #include <PulsarSystem.hpp>
 #include <Gamemodes/ItemRain/ItemRain.hpp>
-#include <include/c_string.h>
 
 namespace Pulsar {
 namespace PointRating {
@@ -23,54 +19,34 @@ static const char *MULTIPLIER_URL = "http://rwfc.net/api/game/multiplierBeta.txt
 static const char *MULTIPLIER_URL = "http://rwfc.net/api/game/multiplier.txt";
 #endif
 static const u32 MULTIPLIER_REQUEST_WORK_BUF_SIZE = 0x1000;
+static const u32 MULTIPLIER_CACHE_MAX_AGE_SEC = 600;  // reconnecting within this reuses the last value
 
-static void *s_multiplierRequestWorkBuf = nullptr;
 static bool s_multiplierRequestActive = false;
 static bool s_multiplierRequestDone = false;
 static bool s_wasConnectedToWfc = false;
 static bool s_remoteMultiplierValid = false;
 static float s_remoteMultiplier = 1.0f;
 
-static const char *SkipWhitespace(const char *p) {
-    while (p != nullptr && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
-    return p;
-}
-
-static bool ParseRemoteMultiplier(const char *body, int bodyLen, float &out) {
-    if (body == nullptr || bodyLen <= 0) return false;
-
-    const int maxLen = bodyLen < 31 ? bodyLen : 31;
-    char text[32];
-    memcpy(text, body, maxLen);
-    text[maxLen] = '\0';
-
-    const char *start = SkipWhitespace(text);
-    const char *p = start;
-    if (*p == '+') ++p;
+// multiplier.txt holds a bare number, which is a complete JSON document on its own
+class MultiplierResponseHandler : public Network::Json::Handler {
+public:
+    MultiplierResponseHandler() : hasValue(false), value(0.0f) {}
 
-    bool hasDigit = false;
-    float value = 0.0f;
-    while (*p >= '0' && *p <= '9') {
-        hasDigit = true;
-        value = value * 10.0f + (float)(*p - '0');
-        ++p;
+    bool OnNumber(const Network::Json::NumberRef &number, u32 depth) override {
+        this->hasValue = depth == 0 && !number.isNegative && number.ToFloat(this->value);
+        return true;
     }
-    if (*p == '.') {
-        ++p;
-        float scale = 0.1f;
-        while (*p >= '0' && *p <= '9') {
-            hasDigit = true;
-            value += (float)(*p - '0') * scale;
-            scale *= 0.1f;
-            ++p;
-        }
-    }
-    if (!hasDigit) return false;
 
-    p = SkipWhitespace(p);
-    if (*p != '\0') return false;
+    bool hasValue;
+    float value;
+};
 
-    out = value;
+static bool ParseRemoteMultiplier(const char *body, u32 bodyLen, float &out) {
+    if (body == nullptr || bodyLen == 0) return false;
+
+    MultiplierResponseHandler handler;
+    if (Network::Json::Parse(body, bodyLen, handler) != Network::Json::PARSE_OK || !handler.hasValue) return false;
+    out = handler.value;
     return true;
 }
 
@@ -79,52 +55,29 @@ static bool CanStartMultiplierDownload() {
     return controller != nullptr && controller->GetConnectionState() == RKNet::CONNECTIONSTATE_IDLE;
 }
 
-static void OnMultiplierDownloaded(s32 result, void *response, void * /*userdata*/) {
-    Network::FinishNHTTPRequest();
+static void OnMultiplierDownloaded(s32 result, const char *body, u32 bodyLen, void * /*userdata*/) {
     s_multiplierRequestActive = false;
     s_multiplierRequestDone = true;
 
-    if (response == nullptr) return;
-
-    if (result == 0) {
-        char *body = nullptr;
-        const int bodyLen = NHTTP::GetBodyAll(reinterpret_cast<NHTTP::Res *>(response), &body);
-        float multiplier = 1.0f;
-        if (ParseRemoteMultiplier(body, bodyLen, multiplier)) {
-            s_remoteMultiplier = multiplier;
-            s_remoteMultiplierValid = true;
-        }
+    float multiplier = 1.0f;
+    if (result == 0 && ParseRemoteMultiplier(body, bodyLen, multiplier)) {
+        s_remoteMultiplier = multiplier;
+        s_remoteMultiplierValid = true;
     }
-
-    NHTTPDestroyResponse(response);
 }
 
 static void TryStartMultiplierDownload() {
     if (s_multiplierRequestActive || s_multiplierRequestDone || !CanStartMultiplierDownload()) return;
 
-    if (!Network::PrepareNHTTPRequest()) return;
-
-    if (s_multiplierRequestWorkBuf == nullptr) {
-        s_multiplierRequestWorkBuf = Network::NHTTPAlloc(MULTIPLIER_REQUEST_WORK_BUF_SIZE, 0x20);
-        if (s_multiplierRequestWorkBuf == nullptr) return;
-    }
-    memset(s_multiplierRequestWorkBuf, 0, MULTIPLIER_REQUEST_WORK_BUF_SIZE);
-
-    void *request = NHTTPCreateRequest(MULTIPLIER_URL, 0, s_multiplierRequestWorkBuf, MULTIPLIER_REQUEST_WORK_BUF_SIZE,
-                                       reinterpret_cast<void *>(&OnMultiplierDownloaded),
-                                       nullptr);
-    if (request == nullptr) {
-        s_multiplierRequestDone = true;
-        return;
-    }
-
-    const s32 sendRet = NHTTPSendRequestAsync(request);
-    if (sendRet < 0) {
-        s_multiplierRequestDone = true;
-        return;
-    }
-    Network::MarkNHTTPRequestActive();
-    s_multiplierRequestActive = true;
+    Network::HttpRequestParams params;
+    params.url = MULTIPLIER_URL;
+    params.priority = Network::HTTP_PRIORITY_BACKGROUND;
+    params.bufferSize = MULTIPLIER_REQUEST_WORK_BUF_SIZE;
+    params.cacheMaxAgeSec = MULTIPLIER_CACHE_MAX_AGE_SEC;
+    params.callback = &OnMultiplierDownloaded;
+    params.userdata = nullptr;
+    // A full queue just means trying again next frame
+    if (Network::QueueHttpRequest(params) != 0) s_multiplierRequestActive = true;
 }
 
 static void UpdateMultiplierDownloadForWfcConnection() {
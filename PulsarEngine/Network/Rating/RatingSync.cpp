@@ -1,12 +1,8 @@
 #include <kamek.hpp>
 #include <core/egg/System.hpp>
 #include <include/c_stdio.h>
-#include <include/c_stdlib.h>
-#include <include/c_string.h>
 #include <MarioKartWii/RKSYS/RKSYSMgr.hpp>
 #include <core/RK/RKSystem.hpp>
-#include <core/rvl/DWC/NHTTP.hpp>
-#include <core/rvl/NHTTP/NHTTP.hpp>
 #include <Network/GPReport.hpp>
 #include <Network/Json.hpp>
 #include <Network/NHTTPHelper.hpp>
@@ -23,7 +19,7 @@ static const u32 s_nhttpWorkBufSize = 0x1000;
 static u32 s_requestGeneration = 0;
 static float s_requestStartVr = 0.0f;
 static float s_requestStartBr = 0.0f;
-static void *s_requestWorkBuf = nullptr;
+static Network::HttpRequestId s_requestId = 0;
 static char s_requestUrl[160];
 static s32 s_pendingInitialReportProfileId = 0;
 static u32 s_pendingInitialReportLicenseId = 0;
@@ -47,34 +43,68 @@ static int ClampRatingForSync(float rating) {
     return scaled;
 }
 
-static bool ParseJsonScaledValue(const char *json, const char *key, int &out) {
-    if (json == nullptr || key == nullptr) return false;
-
-    const char *pos = strstr(json, key);
-    if (pos == nullptr) return false;
-
-    const char *colon = strchr(pos, ':');
-    if (colon == nullptr) return false;
+// Reads "found", "vr" and "br" from the top-level object of the ratings response in one pass
+class RatingsResponseHandler : public Network::Json::Handler {
+public:
+    RatingsResponseHandler() : found(false), hasVr(false), hasBr(false), vrScaled(0), brScaled(0), field(FIELD_NONE) {}
+
+    bool OnKey(const Network::Json::StringRef &key, u32 depth) override {
+        this->field = FIELD_NONE;
+        if (depth != 1) return true;
+        if (key.Equals("found")) this->field = FIELD_FOUND;
+        else if (key.Equals("vr")) this->field = FIELD_VR;
+        else if (key.Equals("br")) this->field = FIELD_BR;
+        return true;
+    }
 
-    char *end = nullptr;
-    long value = strtol(Network::Json::SkipWhitespace(colon + 1), &end, 10);
-    if (end == nullptr || end == colon + 1) return false;
-    out = (int)value;
-    return true;
-}
+    bool OnNumber(const Network::Json::NumberRef &value, u32 /*depth*/) override {
+        s32 scaled = 0;
+        const bool isInt = value.ToS32(scaled);
+        if (this->field == FIELD_FOUND) {
+            this->found = isInt && scaled == 1;
+        } else if (this->field == FIELD_VR) {
+            this->hasVr = isInt;
+            this->vrScaled = scaled;
+        } else if (this->field == FIELD_BR) {
+            this->hasBr = isInt;
+            this->brScaled = scaled;
+        }
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-static bool ParseJsonFoundFlag(const char *json) {
-    if (json == nullptr) return false;
+    bool OnBool(bool value, u32 /*depth*/) override {
+        if (this->field == FIELD_FOUND) this->found = value;
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-    const char *pos = strstr(json, "\"found\"");
-    if (pos == nullptr) return false;
+    bool OnObjectBegin(u32 /*depth*/) override {
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-    const char *colon = strchr(pos, ':');
-    if (colon == nullptr) return false;
+    bool OnArrayBegin(u32 /*depth*/) override {
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-    colon = Network::Json::SkipWhitespace(colon + 1);
-    return colon != nullptr && *colon == '1';
-}
+    bool found;
+    bool hasVr;
+    bool hasBr;
+    s32 vrScaled;
+    s32 brScaled;
+
+private:
+    enum Field {
+        FIELD_NONE,
+        FIELD_FOUND,
+        FIELD_VR,
+        FIELD_BR
+    };
+
+    Field field;
+};
 
 void SetSyncReportingSuppressed(bool suppress) {
     s_syncReportingSuppressed = suppress;
@@ -108,50 +138,24 @@ static bool IsRequestStillRelevant(const RequestCtx &ctx) {
     return true;
 }
 
-static void OnRatingsDownloaded(s32 result, void *response, void *userdata) {
-    Network::FinishNHTTPRequest();
+static void OnRatingsDownloaded(s32 result, const char *body, u32 bodyLen, void *userdata) {
     RequestCtx *ctx = reinterpret_cast<RequestCtx *>(userdata);
-    if (ctx == nullptr || response == nullptr) return;
-
-    if (ctx->generation != s_requestGeneration) {
-        NHTTPDestroyResponse(response);
-        return;
-    }
-
-    if (result != 0) {
-        NHTTPDestroyResponse(response);
-        return;
-    }
-
-    char *body = nullptr;
-    const int bodyLen = NHTTP::GetBodyAll(reinterpret_cast<NHTTP::Res *>(response), &body);
-    if (body == nullptr || bodyLen <= 0) {
-        NHTTPDestroyResponse(response);
-        return;
-    }
-
-    const int maxLen = bodyLen < 255 ? bodyLen : 255;
-    char json[256];
-    memcpy(json, body, maxLen);
-    json[maxLen] = '\0';
-
-    NHTTPDestroyResponse(response);
+    if (ctx == nullptr || ctx->generation != s_requestGeneration) return;
+    if (result != 0 || body == nullptr) return;
 
     if (!IsRequestStillRelevant(*ctx)) return;
 
-    if (!ParseJsonFoundFlag(json)) {
+    RatingsResponseHandler response;
+    if (Network::Json::Parse(body, bodyLen, response) != Network::Json::PARSE_OK) return;
+    if (!response.found) {
         ReportCurrentRatings(ctx->licenseId);
         return;
     }
-
-    int vrScaled = 0;
-    int brScaled = 0;
-    if (!ParseJsonScaledValue(json, "\"vr\"", vrScaled)) return;
-    if (!ParseJsonScaledValue(json, "\"br\"", brScaled)) return;
+    if (!response.hasVr || !response.hasBr) return;
 
     SetSyncReportingSuppressed(true);
-    SaveProfileVR(ctx->profileId, (float)vrScaled / 100.0f);
-    SaveProfileBR(ctx->profileId, (float)brScaled / 100.0f);
+    SaveProfileVR(ctx->profileId, (float)response.vrScaled / 100.0f);
+    SaveProfileBR(ctx->profileId, (float)response.brScaled / 100.0f);
     SetSyncReportingSuppressed(false);
 }
 
@@ -162,13 +166,8 @@ void BeginLoginRatingDownload(s32 profileId, u32 licenseId) {
     if (rksys == nullptr || licenseId >= 4) return;
     BindLicenseProfileId(licenseId, profileId);
 
-    if (!Network::PrepareNHTTPRequest()) return;
-
-    if (s_requestWorkBuf == nullptr) {
-        s_requestWorkBuf = Network::NHTTPAlloc(s_nhttpWorkBufSize, 0x20);
-        if (s_requestWorkBuf == nullptr) return;
-    }
-    memset(s_requestWorkBuf, 0, s_nhttpWorkBufSize);
+    Network::CancelHttpRequest(s_requestId);
+    s_requestId = 0;
 
     ++s_requestGeneration;
     s_requestStartVr = GetUserVR(licenseId);
@@ -183,17 +182,14 @@ void BeginLoginRatingDownload(s32 profileId, u32 licenseId) {
         return;
     }
 
-    void *request = NHTTPCreateRequest(s_requestUrl, 0, s_requestWorkBuf, s_nhttpWorkBufSize,
-                                       reinterpret_cast<void *>(&OnRatingsDownloaded),
-                                       reinterpret_cast<void *>(&s_requestCtx));
-    if (request == nullptr) return;
-
-    const s32 sendRet = NHTTPSendRequestAsync(request);
-    if (sendRet < 0) {
-        ++s_requestGeneration;
-        return;
-    }
-    Network::MarkNHTTPRequestActive();
+    Network::HttpRequestParams params;
+    params.url = s_requestUrl;
+    params.priority = Network::HTTP_PRIORITY_NORMAL;
+    params.bufferSize = s_nhttpWorkBufSize;
+    params.cacheMaxAgeSec = 0;
+    params.callback = &OnRatingsDownloaded;
+    params.userdata = &s_requestCtx;
+    s_requestId = Network::QueueHttpRequest(params);
 }
 
 static bool CanStartLoginRatingDownload() {
@@ -20,6 +20,7 @@
 #include <Dolphin/DolphinIOS.hpp>
 #include <Network/PacketExpansion.hpp>
 #include <hooks.hpp>
+#include <include/c_stdlib.h>
 
 namespace Pulsar {
 
@@ -105,7 +106,9 @@ BootHook CreateSystem(System::CreateSystem, 0);
 System::System() : heap(RKSystem::mInstance.EGGSystem), taskThread(EGG::TaskThread::Create(8, 0, 0x4000, this->heap)),
                    // Modes
                    koMgr(nullptr),
-                   lapKoMgr(nullptr) {
+                   lapKoMgr(nullptr),
+                   bmgIndex(nullptr),
+                   bmgIndexCount(0) {
 }
 
 static void PatchBMGOffsets(BMGHolder &holder, u32 cupOffset, u32 trackOffset) {
@@ -214,10 +217,104 @@ void System::Init(const ConfigFile &confRT, const ConfigFile &confCT, const Conf
 
     PatchBMGOffsets(this->customBmgsCT, rtCups.ctsCupCount, rtTrackCount);
     PatchBMGOffsets(this->customBmgsBT, rtCups.ctsCupCount + ctCups.ctsCupCount, rtTrackCount + ctTrackCount);
+    this->BuildBMGIndex(bmgHeap);
 
     this->AfterInit();
 }
 
+static int CompareBMGIndexEntries(const void *a, const void *b) {
+    const System::BMGIndexEntry &left = *static_cast<const System::BMGIndexEntry *>(a);
+    const System::BMGIndexEntry &right = *static_cast<const System::BMGIndexEntry *>(b);
+    if (left.bmgId != right.bmgId) return left.bmgId < right.bmgId ? -1 : 1;
+    if (left.holderIdx != right.holderIdx) return left.holderIdx - right.holderIdx;
+    return left.msgIdx - right.msgIdx;
+}
+
+// Must run after PatchBMGOffsets, the index holds the final ids.
+void System::BuildBMGIndex(EGG::Heap *heap) {
+    u32 total = 0;
+    for (u8 holderIdx = 0; holderIdx < 3; ++holderIdx) {
+        const BMGMessageIds *msgIds = this->GetIndexedBMG(holderIdx)->messageIds;
+        if (msgIds != nullptr) total += msgIds->msgCount;
+    }
+    if (total == 0) return;
+    BMGIndexEntry *index = EGG::Heap::alloc<BMGIndexEntry>(sizeof(BMGIndexEntry) * total, 0x4, heap);
+    if (index == nullptr) return;
+
+    u32 count = 0;
+    for (u8 holderIdx = 0; holderIdx < 3; ++holderIdx) {
+        const BMGHolder &holder = *this->GetIndexedBMG(holderIdx);
+        if (holder.bmgFile == nullptr || holder.messageIds == nullptr) continue;
+        const BMGMessageIds &msgIds = *holder.messageIds;
+        for (u16 msgIdx = 0; msgIdx < msgIds.msgCount; ++msgIdx) {
+            BMGIndexEntry &entry = index[count++];
+            entry.bmgId = msgIds.messageIds[msgIdx];
+            entry.msgIdx = msgIdx;
+            entry.holderIdx = holderIdx;
+            entry.padding = 0;
+        }
+    }
+    qsort(index, count, sizeof(BMGIndexEntry), CompareBMGIndexEntries);
+
+    // An id present in several BMGs keeps the RT > CT > BT priority of the per-holder lookups, which sorts first.
+    u32 uniqueCount = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (uniqueCount != 0 && index[uniqueCount - 1].bmgId == index[i].bmgId) continue;
+        index[uniqueCount++] = index[i];
+    }
+    this->bmgIndex = index;
+    this->bmgIndexCount = uniqueCount;
+}
+
+const BMGHolder *System::GetIndexedBMG(u8 holderIdx) const {
+    if (holderIdx == 1) return &this->customBmgsCT;
+    if (holderIdx == 2) return &this->customBmgsBT;
+    return &this->customBmgs;
+}
+
+// MID1 ids are sorted; used directly when the index could not be allocated.
+static int FindMsgIdxInHolder(const BMGHolder &bmg, u32 id) {
+    if (bmg.bmgFile == nullptr || bmg.messageIds == nullptr) return -1;
+    const BMGMessageIds &msgIds = *bmg.messageIds;
+    u32 low = 0;
+    u32 high = msgIds.msgCount;
+    while (low < high) {
+        const u32 mid = (low + high) >> 1;
+        if (msgIds.messageIds[mid] < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low == msgIds.msgCount || msgIds.messageIds[low] != id) return -1;
+    return low;
+}
+
+int System::GetCustomMsgIdx(s32 bmgId, const BMGHolder *&holder) const {
+    const u32 id = static_cast<u32>(bmgId);
+    if (this->bmgIndex == nullptr) {
+        for (u8 holderIdx = 0; holderIdx < 3; ++holderIdx) {
+            const int msgIdx = FindMsgIdxInHolder(*this->GetIndexedBMG(holderIdx), id);
+            if (msgIdx >= 0) {
+                holder = this->GetIndexedBMG(holderIdx);
+                return msgIdx;
+            }
+        }
+        return -1;
+    }
+    u32 low = 0;
+    u32 high = this->bmgIndexCount;
+    while (low < high) {
+        const u32 mid = (low + high) >> 1;
+        if (this->bmgIndex[mid].bmgId < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low == this->bmgIndexCount || this->bmgIndex[low].bmgId != id) return -1;
+    holder = this->GetIndexedBMG(this->bmgIndex[low].holderIdx);
+    return this->bmgIndex[low].msgIdx;
+}
+
 // IO
 #pragma suppress_warnings on
 void System::InitIO(IOType type) const {
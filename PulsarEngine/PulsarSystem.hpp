@@ -129,6 +129,15 @@ public:
     const BMGHolder &GetBMG() const { return customBmgs; }
     const BMGHolder &GetBMGCT() const { return customBmgsCT; }
     const BMGHolder &GetBMGBT() const { return customBmgsBT; }
+    // Looks bmgId up in the RT, CT and BT BMGs at once; holder is set to whichever one owns the message.
+    int GetCustomMsgIdx(s32 bmgId, const BMGHolder *&holder) const;
+
+    struct BMGIndexEntry {
+        u32 bmgId;
+        u16 msgIdx;
+        u8 holderIdx;  // 0 RT, 1 CT, 2 BT
+        u8 padding;
+    };
 
     // VARIABLES
     EGG::ExpHeap *const heap;  // 0x4
@@ -166,6 +175,10 @@ private:
     BMGHeader *rawBmgCT;
     BMGHolder customBmgsBT;
     BMGHeader *rawBmgBT;
+    void BuildBMGIndex(EGG::Heap *heap);
+    const BMGHolder *GetIndexedBMG(u8 holderIdx) const;
+    BMGIndexEntry *bmgIndex;  // sorted by bmgId, one entry per id; null if it could not be allocated
+    u32 bmgIndexCount;
 
 public:
     // string pool
@@ -1,5 +1,8 @@
 #include <kamek.hpp>
 #include <runtimeWrite.hpp>
+#include <include/c_string.h>
+#include <core/egg/mem/Heap.hpp>
+#include <core/rvl/OS/OS.hpp>
 #include <MarioKartWii/Archive/ArchiveMgr.hpp>
 #include <MarioKartWii/3D/Camera/CameraMgr.hpp>
 #include <MarioKartWii/CourseMgr.hpp>
@@ -14,11 +17,14 @@
 #include <MarioKartWii/Objects/KCL/ObjectKCLManager.hpp>
 #include <MarioKartWii/Race/RaceData.hpp>
 #include <MarioKartWii/Race/RaceInfo/RaceInfo.hpp>
+#include <MarioKartWii/Scene/GameScene.hpp>
 #include <Race/ConditionalTrackState.hpp>
 
 namespace Pulsar {
 namespace Race {
 
+// Build with -DCONDITIONAL_OBJECTS_BENCHMARK to report the per-frame cost of conditional object queries every 600 frames.
+
 struct ObjectConditionalView {
     u8 padding[0xa0];
     const void *gobjLink;
@@ -89,12 +95,58 @@ struct BoxColUnitView {
     void *userData;
 };
 
+// Row layout of ConditionalTables::rows: one per player, then rows shared by every frame view.
+enum ConditionalRow {
+    CONDITIONAL_ROW_ALWAYS = 12,
+    CONDITIONAL_ROW_VISIBLE = 13,
+    CONDITIONAL_ROW_COLLISION = 14,
+    CONDITIONAL_ROW_COUNT = 15
+};
+
+struct CompiledConditional {
+    u8 mode;  // ConditionalConfig::Mode
+    u8 rangeMask;  // lap or checkpoint range indices that are active, with the inversion folded in
+    bool invert;  // lap progress ranges only
+    u8 padding;
+    u16 progressStart;
+    u16 progressEnd;
+};
+
+// Conditions are compiled once per course into per-holder lap/checkpoint masks. Once per race frame, every player's
+// lap, checkpoint range and lap progress resolve them into a bit row over the GOBJ holders, so each object's
+// visibility and collision queries are bit tests. Holders without a condition keep their bit set in every row.
+struct ConditionalTables {
+    const KMP::Manager *kmp;
+    bool isCompiled;
+    bool hasFrame;
+    u8 trackLapCount;
+    u8 localScreenCount;
+    u16 holderCount;
+    u16 wordCount;
+    u16 ckptCount;
+    u16 conditionalCount;
+    u16 *conditionalHolders;
+    CompiledConditional *compiled;  // parallel to conditionalHolders
+    u32 *conditionalBits;
+    u32 *rows;  // CONDITIONAL_ROW_COUNT rows of wordCount words
+    const Raceinfo *frameRaceInfo;
+    u32 frameStamp;
+    u8 screenRows[4];
+};
+
+static ConditionalTables sTables;
 static const void *sCachedCourseArchive = nullptr;
 static s8 sConditionalTrackFileState = CONDITIONAL_TRACK_FILE_UNKNOWN;
 
+static void ResetConditionalTables() {
+    // The arrays live on the course structs heap, which the game frees with the scene.
+    memset(&sTables, 0, sizeof(ConditionalTables));
+}
+
 void ResetConditionalObjectsTrackState() {
     sCachedCourseArchive = nullptr;
     sConditionalTrackFileState = CONDITIONAL_TRACK_FILE_UNKNOWN;
+    ResetConditionalTables();
 }
 
 void PushConditionalCollisionPlayerContext(u8 playerId) {
@@ -151,6 +203,7 @@ static bool IsTrackConditionalObjectsEnabled() {
     if (courseArchive != sCachedCourseArchive) {
         sCachedCourseArchive = courseArchive;
         sConditionalTrackFileState = CONDITIONAL_TRACK_FILE_UNKNOWN;
+        ResetConditionalTables();
     }
 
     if (sConditionalTrackFileState == CONDITIONAL_TRACK_FILE_UNKNOWN) {
@@ -182,14 +235,10 @@ static bool TryGetTrackDefinedLapCount(u8 &lapCount) {
     return true;
 }
 
-static bool TryGetConditionalConfig(const Object &object, ConditionalConfig &config) {
+static bool TryGetConditionalConfig(const GOBJ &gobj, ConditionalConfig &config) {
     static const u16 LAP_PROGRESS_STEPS_PER_LAP = 100;
-    if (!IsTrackConditionalObjectsEnabled()) return false;
 
-    const GOBJ *gobj = GetObjectGobj(object);
-    if (gobj == nullptr) return false;
-
-    const u16 flags = gobj->presenceFlags;
+    const u16 flags = gobj.presenceFlags;
     const u8 mode = static_cast<u8>((flags >> 3) & 0x7);
     if (mode == 0 || mode > 6) return false;
 
@@ -204,8 +253,8 @@ static bool TryGetConditionalConfig(const Object &object, ConditionalConfig &con
         config.mode = ConditionalConfig::MODE_LAP_PROGRESS_RANGE;
 
         // For lap progression modes, GOBJ padding packs start/end lap percentage as [start, end] bytes.
-        config.startProgressPercent = static_cast<u8>((gobj->padding >> 8) & 0xFF);
-        config.endProgressPercent = static_cast<u8>(gobj->padding & 0xFF);
+        config.startProgressPercent = static_cast<u8>((gobj.padding >> 8) & 0xFF);
+        config.endProgressPercent = static_cast<u8>(gobj.padding & 0xFF);
         if (config.startProgressPercent > LAP_PROGRESS_STEPS_PER_LAP) config.startProgressPercent = LAP_PROGRESS_STEPS_PER_LAP;
         if (config.endProgressPercent > LAP_PROGRESS_STEPS_PER_LAP) config.endProgressPercent = LAP_PROGRESS_STEPS_PER_LAP;
     } else {
@@ -270,48 +319,127 @@ static u16 GetPlayerLapProgressRangeValue(const RaceinfoPlayer &player, u8 track
     return static_cast<u16>(lapProgress);
 }
 
-static bool IsPlayerInConditionalRange(const RaceinfoPlayer &player, const ConditionalConfig &config, u16 ckptCount, u8 trackLapCount) {
-    switch (config.mode) {
-        case ConditionalConfig::MODE_CHECKPOINT_RANGE: {
-            const u8 checkpointIdx = GetPlayerCheckpointRangeIdx(player, ckptCount);
-            return IsInWrappedRange(checkpointIdx, config.startIdx, config.endIdx);
+static u8 GetWrappedRangeMask(u8 start, u8 end) {
+    u8 mask = 0;
+    for (u8 idx = 0; idx < MAX_CONDITIONAL_LAP_INDEX_COUNT; ++idx) {
+        if (IsInWrappedRange(idx, start, end)) mask |= static_cast<u8>(1 << idx);
+    }
+    return mask;
+}
+
+static void CompileConditional(const ConditionalConfig &config, CompiledConditional &compiled) {
+    compiled.mode = static_cast<u8>(config.mode);
+    compiled.invert = false;
+    compiled.padding = 0;
+    compiled.progressStart = 0;
+    compiled.progressEnd = 0;
+    compiled.rangeMask = 0;
+
+    if (config.mode == ConditionalConfig::MODE_LAP_PROGRESS_RANGE) {
+        compiled.invert = config.invert;
+        compiled.progressStart = GetLapProgressValue(config.startIdx, config.startProgressPercent);
+        compiled.progressEnd = GetLapProgressValue(config.endIdx, config.endProgressPercent);
+        return;
+    }
+
+    const u8 mask = GetWrappedRangeMask(config.startIdx, config.endIdx);
+    compiled.rangeMask = config.invert ? static_cast<u8>(~mask) : mask;
+}
+
+static bool CompileConditionalTables(ConditionalTables &tables, const KMP::Manager &kmp) {
+    ResetConditionalTables();
+    tables.kmp = &kmp;
+
+    const GameScene *scene = GameScene::GetCurrent();
+    EGG::Heap *heap = scene != nullptr ? scene->structsHeaps.heaps[1] : nullptr;
+    if (heap == nullptr || kmp.gobjSection == nullptr || kmp.gobjSection->holdersArray == nullptr) return false;
+
+    const u16 holderCount = kmp.gobjSection->pointCount;
+    u16 conditionalCount = 0;
+    for (u16 i = 0; i < holderCount; ++i) {
+        const KMP::Holder<GOBJ> *holder = kmp.gobjSection->holdersArray[i];
+        ConditionalConfig config;
+        if (holder != nullptr && holder->raw != nullptr && TryGetConditionalConfig(*holder->raw, config)) ++conditionalCount;
+    }
+
+    tables.holderCount = holderCount;
+    tables.wordCount = static_cast<u16>((holderCount + 31) / 32);
+    TryGetTrackDefinedLapCount(tables.trackLapCount);
+    if (kmp.ckptSection != nullptr) tables.ckptCount = kmp.ckptSection->pointCount;
+
+    if (conditionalCount > 0) {
+        const u32 wordBytes = sizeof(u32) * tables.wordCount;
+        tables.conditionalHolders = EGG::Heap::alloc<u16>(sizeof(u16) * conditionalCount, 0x4, heap);
+        tables.compiled = EGG::Heap::alloc<CompiledConditional>(sizeof(CompiledConditional) * conditionalCount, 0x4, heap);
+        tables.conditionalBits = EGG::Heap::alloc<u32>(wordBytes, 0x4, heap);
+        tables.rows = EGG::Heap::alloc<u32>(wordBytes * CONDITIONAL_ROW_COUNT, 0x4, heap);
+        if (tables.conditionalHolders == nullptr || tables.compiled == nullptr || tables.conditionalBits == nullptr || tables.rows == nullptr) {
+            OS::Report("[Pulsar] Conditional objects: could not allocate tables for %u holders\n", holderCount);
+            ResetConditionalTables();
+            tables.kmp = &kmp;
+            return false;
         }
-        case ConditionalConfig::MODE_LAP_PROGRESS_RANGE: {
-            static const u16 LAP_PROGRESS_WRAP = 800;
+        memset(tables.conditionalBits, 0, wordBytes);
+        memset(tables.rows + CONDITIONAL_ROW_ALWAYS * tables.wordCount, 0xFF, wordBytes);
+
+        for (u16 i = 0; i < holderCount; ++i) {
+            const KMP::Holder<GOBJ> *holder = kmp.gobjSection->holdersArray[i];
+            ConditionalConfig config;
+            if (holder == nullptr || holder->raw == nullptr || !TryGetConditionalConfig(*holder->raw, config)) continue;
+
+            CompileConditional(config, tables.compiled[tables.conditionalCount]);
+            tables.conditionalHolders[tables.conditionalCount] = i;
+            tables.conditionalBits[i >> 5] |= 1u << (i & 31);
+            ++tables.conditionalCount;
+        }
+    }
+
+    tables.isCompiled = true;
+    return true;
+}
+
+static u32 *GetConditionalRow(ConditionalTables &tables, u32 rowIdx) {
+    return tables.rows + rowIdx * tables.wordCount;
+}
 
-            const u16 currentProgress = GetPlayerLapProgressRangeValue(player, trackLapCount);
-            const u16 startProgress = GetLapProgressValue(config.startIdx, config.startProgressPercent);
-            const u16 endProgress = GetLapProgressValue(config.endIdx, config.endProgressPercent);
-            return IsInWrappedRange(currentProgress, startProgress, endProgress, LAP_PROGRESS_WRAP);
+static bool IsCompiledConditionalActive(const ConditionalTables &tables, const CompiledConditional &compiled, u8 lapBit, u8 checkpointBit,
+                                        u16 progress) {
+    static const u16 LAP_PROGRESS_WRAP = 800;
+
+    switch (compiled.mode) {
+        case ConditionalConfig::MODE_CHECKPOINT_RANGE:
+            if (tables.ckptCount == 0) return true;
+            return (compiled.rangeMask & checkpointBit) != 0;
+        case ConditionalConfig::MODE_LAP_PROGRESS_RANGE: {
+            const bool inRange = IsInWrappedRange(progress, compiled.progressStart, compiled.progressEnd, LAP_PROGRESS_WRAP);
+            return compiled.invert ? !inRange : inRange;
         }
         default:
-            break;
+            return (compiled.rangeMask & lapBit) != 0;
     }
-
-    const u8 lapIdx = GetPlayerLapRangeIdx(player, trackLapCount);
-    return IsInWrappedRange(lapIdx, config.startIdx, config.endIdx);
 }
 
-static bool EvaluateConditionalForPlayer(const ConditionalConfig &config, u8 playerId) {
-    const Raceinfo *raceInfo = Raceinfo::sInstance;
-    if (raceInfo == nullptr) return true;
+static void BuildPlayerRow(ConditionalTables &tables, u32 *row, const RaceinfoPlayer *player) {
+    memset(row, 0xFF, sizeof(u32) * tables.wordCount);
+    if (player == nullptr) return;
 
-    if (playerId >= 12) return true;
-    const RaceinfoPlayer *player = raceInfo->players[playerId];
-    if (player == nullptr) return true;
-
-    u16 ckptCount = 0;
-    u8 trackLapCount = 0;
-    if (config.mode == ConditionalConfig::MODE_CHECKPOINT_RANGE) {
-        const KMP::Manager *kmp = KMP::Manager::sInstance;
-        if (kmp == nullptr || kmp->ckptSection == nullptr || kmp->ckptSection->pointCount == 0) return true;
-        ckptCount = kmp->ckptSection->pointCount;
-    } else {
-        TryGetTrackDefinedLapCount(trackLapCount);
+    const u8 lapBit = static_cast<u8>(1 << GetPlayerLapRangeIdx(*player, tables.trackLapCount));
+    const u8 checkpointBit = tables.ckptCount > 0 ? static_cast<u8>(1 << GetPlayerCheckpointRangeIdx(*player, tables.ckptCount)) : 0;
+    const u16 progress = GetPlayerLapProgressRangeValue(*player, tables.trackLapCount);
+
+    for (u16 i = 0; i < tables.conditionalCount; ++i) {
+        if (IsCompiledConditionalActive(tables, tables.compiled[i], lapBit, checkpointBit, progress)) continue;
+        const u16 holderIdx = tables.conditionalHolders[i];
+        row[holderIdx >> 5] &= ~(1u << (holderIdx & 31));
     }
+}
+
+static void OrConditionalRow(const ConditionalTables &tables, u32 *dest, const u32 *src) {
+    for (u16 i = 0; i < tables.wordCount; ++i) dest[i] |= src[i];
+}
 
-    const bool inRange = IsPlayerInConditionalRange(*player, config, ckptCount, trackLapCount);
-    return config.invert ? !inRange : inRange;
+static void CopyConditionalRow(const ConditionalTables &tables, u32 *dest, const u32 *src) {
+    memcpy(dest, src, sizeof(u32) * tables.wordCount);
 }
 
 static bool IsConditionalReplayPlayer(const RacedataScenario &scenario, const Raceinfo &raceInfo, u8 playerId) {
@@ -322,35 +450,41 @@ static bool IsConditionalReplayPlayer(const RacedataScenario &scenario, const Ra
     return raceInfo.players[playerId] != nullptr;
 }
 
-static bool EvaluateConditionalForAnyReplayPlayer(const ConditionalConfig &config, const RacedataScenario &scenario, const Raceinfo &raceInfo) {
-    bool hasReplayPlayer = false;
-    for (u8 playerId = 0; playerId < 12; ++playerId) {
-        if (!IsConditionalReplayPlayer(scenario, raceInfo, playerId)) continue;
-
-        hasReplayPlayer = true;
-        if (EvaluateConditionalForPlayer(config, playerId)) return true;
-    }
-    return !hasReplayPlayer;
+static u8 GetPlayerRowIdx(const RacedataScenario &scenario, u8 playerId) {
+    return playerId < scenario.playerCount ? playerId : static_cast<u8>(CONDITIONAL_ROW_ALWAYS);
 }
 
-static void EvaluateConditionalState(const Object &object, ConditionalState &state) {
-    InitConditionalState(state);
-
-    ConditionalConfig config;
-    if (!TryGetConditionalConfig(object, config)) return;
-    state.isConditional = true;
+// Views resolve which rows drive visibility and collision this frame, mirroring the per-mode rules below.
+static void BuildConditionalFrame(ConditionalTables &tables, const Racedata *raceData, const Raceinfo *raceInfo) {
+    u32 *visibleRow = GetConditionalRow(tables, CONDITIONAL_ROW_VISIBLE);
+    u32 *collisionRow = GetConditionalRow(tables, CONDITIONAL_ROW_COLLISION);
+    const u32 *alwaysRow = GetConditionalRow(tables, CONDITIONAL_ROW_ALWAYS);
 
-    const Racedata *raceData = Racedata::sInstance;
-    const Raceinfo *raceInfo = Raceinfo::sInstance;
-    if (raceData == nullptr || raceInfo == nullptr) return;
+    tables.localScreenCount = 1;
+    for (u8 i = 0; i < 4; ++i) tables.screenRows[i] = CONDITIONAL_ROW_VISIBLE;
+    if (raceData == nullptr || raceInfo == nullptr || raceInfo->players == nullptr) {
+        CopyConditionalRow(tables, visibleRow, alwaysRow);
+        CopyConditionalRow(tables, collisionRow, alwaysRow);
+        return;
+    }
 
     const RacedataScenario &scenario = raceData->racesScenario;
-    const GameMode mode = scenario.settings.gamemode;
-    const bool isTTMode = (mode == MODE_TIME_TRIAL || mode == MODE_GHOST_RACE);
+    for (u8 playerId = 0; playerId < 12; ++playerId) {
+        const RaceinfoPlayer *player = playerId < scenario.playerCount ? raceInfo->players[playerId] : nullptr;
+        BuildPlayerRow(tables, GetConditionalRow(tables, playerId), player);
+    }
 
-    if (isTTMode) {
+    const GameMode mode = scenario.settings.gamemode;
+    if (mode == MODE_TIME_TRIAL || mode == MODE_GHOST_RACE) {
         // Keep collision/update active whenever any replay-relevant player can interact with this object.
-        state.isCollisionActive = EvaluateConditionalForAnyReplayPlayer(config, scenario, *raceInfo);
+        bool hasReplayPlayer = false;
+        memset(collisionRow, 0, sizeof(u32) * tables.wordCount);
+        for (u8 playerId = 0; playerId < 12; ++playerId) {
+            if (!IsConditionalReplayPlayer(scenario, *raceInfo, playerId)) continue;
+            hasReplayPlayer = true;
+            OrConditionalRow(tables, collisionRow, GetConditionalRow(tables, GetPlayerRowIdx(scenario, playerId)));
+        }
+        if (!hasReplayPlayer) CopyConditionalRow(tables, collisionRow, alwaysRow);
 
         u8 watchedPlayerId = 0xFF;
         const RaceCameraMgr *cameraMgr = RaceCameraMgr::sInstance;
@@ -364,33 +498,94 @@ static void EvaluateConditionalState(const Object &object, ConditionalState &sta
             if (IsConditionalReplayPlayer(scenario, *raceInfo, hudPlayerId)) watchedPlayerId = hudPlayerId;
         }
 
-        if (watchedPlayerId != 0xFF) {
-            state.isActive = EvaluateConditionalForPlayer(config, watchedPlayerId);
-        } else {
-            state.isActive = state.isCollisionActive;
-        }
-
-        state.localScreenCount = 1;
-        FillScreenState(state.screenIsActive, state.isActive);
+        const u32 *watchedRow = watchedPlayerId != 0xFF ? GetConditionalRow(tables, GetPlayerRowIdx(scenario, watchedPlayerId)) : collisionRow;
+        CopyConditionalRow(tables, visibleRow, watchedRow);
         return;
     }
 
     const u8 localScreenCount = (scenario.localPlayerCount > 4) ? 4 : scenario.localPlayerCount;
-    if (localScreenCount == 0) return;
+    if (localScreenCount == 0) {
+        CopyConditionalRow(tables, visibleRow, alwaysRow);
+        CopyConditionalRow(tables, collisionRow, alwaysRow);
+        return;
+    }
 
-    state.localScreenCount = localScreenCount;
-    FillScreenState(state.screenIsActive, true);
-    state.isActive = false;
-    state.isCollisionActive = false;
+    tables.localScreenCount = localScreenCount;
+    memset(visibleRow, 0, sizeof(u32) * tables.wordCount);
     for (u8 i = 0; i < localScreenCount; ++i) {
-        const u8 playerId = scenario.settings.hudPlayerIds[i];
-        const bool playerActive = EvaluateConditionalForPlayer(config, playerId);
-        state.screenIsActive[i] = playerActive;
-        if (playerActive) {
-            state.isActive = true;
-            state.isCollisionActive = true;
+        const u8 hudPlayerId = scenario.settings.hudPlayerIds[i];
+        tables.screenRows[i] = hudPlayerId < 12 ? GetPlayerRowIdx(scenario, hudPlayerId) : static_cast<u8>(CONDITIONAL_ROW_ALWAYS);
+        OrConditionalRow(tables, visibleRow, GetConditionalRow(tables, tables.screenRows[i]));
+    }
+    CopyConditionalRow(tables, collisionRow, visibleRow);
+}
+
+static ConditionalTables *GetConditionalFrameTables() {
+    if (!IsTrackConditionalObjectsEnabled()) return nullptr;
+
+    const KMP::Manager *kmp = KMP::Manager::sInstance;
+    if (kmp == nullptr) return nullptr;
+
+    ConditionalTables &tables = sTables;
+    if (tables.kmp != kmp) CompileConditionalTables(tables, *kmp);
+    if (!tables.isCompiled || tables.conditionalCount == 0) return nullptr;
+
+    const Raceinfo *raceInfo = Raceinfo::sInstance;
+    const u32 frameStamp = raceInfo != nullptr ? raceInfo->raceFrames : 0;
+    if (!tables.hasFrame || tables.frameRaceInfo != raceInfo || tables.frameStamp != frameStamp) {
+        BuildConditionalFrame(tables, Racedata::sInstance, raceInfo);
+        tables.hasFrame = true;
+        tables.frameRaceInfo = raceInfo;
+        tables.frameStamp = frameStamp;
+    }
+    return &tables;
+}
+
+static bool TryGetConditionalHolderIdx(const ConditionalTables &tables, const Object &object, u16 &holderIdx) {
+    const GOBJ *gobj = GetObjectGobj(object);
+    if (gobj == nullptr) return false;
+
+    const KMP::Holder<GOBJ> *const *holders = tables.kmp->gobjSection->holdersArray;
+    if (object.holderIdx < tables.holderCount) {
+        const KMP::Holder<GOBJ> *holder = holders[object.holderIdx];
+        if (holder != nullptr && holder->raw == gobj) {
+            holderIdx = static_cast<u16>(object.holderIdx);
+            return true;
+        }
+    }
+
+    // Only conditional holders matter here, so the fallback never scans the whole GOBJ section.
+    for (u16 i = 0; i < tables.conditionalCount; ++i) {
+        const u16 candidate = tables.conditionalHolders[i];
+        if (holders[candidate] != nullptr && holders[candidate]->raw == gobj) {
+            holderIdx = candidate;
+            return true;
         }
     }
+    return false;
+}
+
+static bool TestConditionalRow(const ConditionalTables &tables, u32 rowIdx, u16 holderIdx) {
+    return (tables.rows[rowIdx * tables.wordCount + (holderIdx >> 5)] & (1u << (holderIdx & 31))) != 0;
+}
+
+static void EvaluateConditionalStateIndexed(const Object &object, ConditionalState &state) {
+    InitConditionalState(state);
+
+    ConditionalTables *tables = GetConditionalFrameTables();
+    if (tables == nullptr) return;
+
+    u16 holderIdx;
+    if (!TryGetConditionalHolderIdx(*tables, object, holderIdx)) return;
+    if ((tables->conditionalBits[holderIdx >> 5] & (1u << (holderIdx & 31))) == 0) return;
+    state.isConditional = true;
+
+    state.isActive = TestConditionalRow(*tables, CONDITIONAL_ROW_VISIBLE, holderIdx);
+    state.isCollisionActive = TestConditionalRow(*tables, CONDITIONAL_ROW_COLLISION, holderIdx);
+    state.localScreenCount = tables->localScreenCount;
+    for (u8 i = 0; i < state.localScreenCount; ++i) {
+        state.screenIsActive[i] = TestConditionalRow(*tables, tables->screenRows[i], holderIdx);
+    }
 }
 
 static void ApplyModelDirectorScreenVisibility(ModelDirector *director, const ConditionalState &state) {
@@ -462,11 +657,69 @@ static void ApplyKCLConditionalState(Object &object, const ConditionalState &sta
     }
 }
 
+static bool IsObjectActiveForPlayerIndexed(const Object &object, u8 playerId) {
+    if (playerId >= 12) return true;
+
+    const ConditionalTables *tables = GetConditionalFrameTables();
+    if (tables == nullptr) return true;
+
+    u16 holderIdx;
+    if (!TryGetConditionalHolderIdx(*tables, object, holderIdx)) return true;
+    const Racedata *raceData = Racedata::sInstance;
+    if (raceData == nullptr || playerId >= raceData->racesScenario.playerCount) return true;
+    return TestConditionalRow(*tables, playerId, holderIdx);
+}
+
+#ifdef CONDITIONAL_OBJECTS_BENCHMARK
+struct ConditionalObjectsBench {
+    u32 frames;
+    u32 stateQueries;
+    u32 playerQueries;
+    u32 frameTicks;
+    u32 peakFrameTicks;
+    u64 totalTicks;
+};
+static ConditionalObjectsBench sConditionalObjectsBench;
+
+static void EvaluateConditionalState(const Object &object, ConditionalState &state) {
+    const u32 start = OS::GetTick();
+    EvaluateConditionalStateIndexed(object, state);
+    sConditionalObjectsBench.frameTicks += OS::GetTick() - start;
+    ++sConditionalObjectsBench.stateQueries;
+}
+
+static bool IsObjectActiveForPlayer(const Object &object, u8 playerId) {
+    const u32 start = OS::GetTick();
+    const bool isActive = IsObjectActiveForPlayerIndexed(object, playerId);
+    sConditionalObjectsBench.frameTicks += OS::GetTick() - start;
+    ++sConditionalObjectsBench.playerQueries;
+    return isActive;
+}
+
+// Run a stress track with many conditional GOBJs and 12 players; the per-frame cost covers table refreshes and queries.
+static void ReportConditionalObjectsBench() {
+    ConditionalObjectsBench &bench = sConditionalObjectsBench;
+    bench.totalTicks += bench.frameTicks;
+    if (bench.frameTicks > bench.peakFrameTicks) bench.peakFrameTicks = bench.frameTicks;
+    bench.frameTicks = 0;
+    if (++bench.frames < 600) return;
+    if (bench.stateQueries != 0 || bench.playerQueries != 0) {
+        OS::Report("[Pulsar] Conditional objects: %u holders, %u state + %u player queries over %u frames, avg %uus/frame, peak %uus\n",
+                   sTables.conditionalCount, bench.stateQueries, bench.playerQueries, bench.frames,
+                   OS::TicksToMicroseconds(bench.totalTicks) / bench.frames, OS::TicksToMicroseconds(bench.peakFrameTicks));
+    }
+    bench = ConditionalObjectsBench();
+}
+static RaceFrameHook ConditionalObjectsBenchHook(ReportConditionalObjectsBench);
+#else
+static void EvaluateConditionalState(const Object &object, ConditionalState &state) {
+    EvaluateConditionalStateIndexed(object, state);
+}
+
 static bool IsObjectActiveForPlayer(const Object &object, u8 playerId) {
-    ConditionalConfig config;
-    if (!TryGetConditionalConfig(object, config)) return true;
-    return EvaluateConditionalForPlayer(config, playerId);
+    return IsObjectActiveForPlayerIndexed(object, playerId);
 }
+#endif
 
 static ObjectCollision *CallOriginalGetCollision(void *object) {
     typedef ObjectCollision *(*GetCollisionFn)(void *);
@@ -1,4 +1,7 @@
 #include <kamek.hpp>
+#include <include/c_string.h>
+#include <core/egg/mem/Heap.hpp>
+#include <core/rvl/OS/OS.hpp>
 #include <MarioKartWii/AI/CPUDriving.hpp>
 #include <MarioKartWii/Archive/ArchiveMgr.hpp>
 #include <MarioKartWii/Item/ItemPlayer.hpp>
@@ -7,6 +10,7 @@
 #include <MarioKartWii/KMP/ITPH.hpp>
 #include <MarioKartWii/KMP/KMPManager.hpp>
 #include <MarioKartWii/Race/RaceInfo/RaceInfo.hpp>
+#include <MarioKartWii/Scene/GameScene.hpp>
 #include <Race/ConditionalTrackState.hpp>
 
 namespace Pulsar {
@@ -16,10 +20,14 @@ namespace Race {
 Route group condition encoding (ENPH/ITPH unknown_0xE):
 - bits 1-8: lap mask (bit1 = lap 1 ... bit8 = lap 8)
 - bit 9: invert mask (0 = disable on set bits, 1 = disable on clear bits)
+
+The rules are decoded once per course into per-lap link masks sized from the ENPT/ITPT sections: entry
+[lap * pointCount + point] has one bit per raw link slot that stays routable on that lap. Routing only tests bits.
 */
 
 static const u8 MAX_CONDITIONAL_LAP_INDEX_COUNT = 8;
-static const u16 INVALID_GROUP_ID = 0xFFFF;
+static const u8 MAX_ROUTE_LINK_SLOTS = 15;
+static const u16 ROUTE_LINK_FALLBACK = 0x8000;  // every link was filtered, keep the raw links
 static const char *CONDITIONAL_ROUTE_GROUPS_ENABLE_FILE = "enable.rgrp";
 
 enum ConditionalRouteTrackFileState {
@@ -28,22 +36,23 @@ enum ConditionalRouteTrackFileState {
     CONDITIONAL_ROUTE_TRACK_FILE_PRESENT = 1
 };
 
+struct RouteLinkTable {
+    u16 pointCount;
+    u16 *nextMasks;
+    u16 *prevMasks;
+};
+
 static const void *sCachedCourseArchive = nullptr;
 static s8 sConditionalRouteTrackFileState = CONDITIONAL_ROUTE_TRACK_FILE_UNKNOWN;
 static const KMP::Manager *sCachedKmpMgr = nullptr;
-static u16 sEnemyGroupByPoint[256];
-static u16 sItemGroupByPoint[256];
-static u16 sEnemyGroupRules[256];
-static u16 sItemGroupRules[256];
+static RouteLinkTable sEnemyLinks;
+static RouteLinkTable sItemLinks;
 static u8 sRoutePlayerId = 0xFF;
 
 static void ResetRouteGroupCache() {
-    for (u16 i = 0; i < 256; ++i) {
-        sEnemyGroupByPoint[i] = INVALID_GROUP_ID;
-        sItemGroupByPoint[i] = INVALID_GROUP_ID;
-        sEnemyGroupRules[i] = 0;
-        sItemGroupRules[i] = 0;
-    }
+    // The masks live on the course structs heap, which the game frees with the scene.
+    memset(&sEnemyLinks, 0, sizeof(RouteLinkTable));
+    memset(&sItemLinks, 0, sizeof(RouteLinkTable));
     sCachedKmpMgr = nullptr;
 }
 
@@ -126,72 +135,127 @@ static u8 SetRoutePlayerId(u8 playerId) {
     return previousPlayerId;
 }
 
-static void BuildRouteGroupCache(const KMP::Manager &kmpMgr) {
-    ResetRouteGroupCache();
-    sCachedKmpMgr = &kmpMgr;
-
-    const KMP::Section<ENPH> *enphSection = kmpMgr.enphSection;
-    if (enphSection != nullptr) {
-        const u16 enphCount = enphSection->pointCount;
-        for (u16 groupId = 0; groupId < enphCount && groupId < 256; ++groupId) {
-            const KMP::Holder<ENPH> *groupHolder = kmpMgr.GetHolder<ENPH>(groupId);
-            if (groupHolder == nullptr || groupHolder->raw == nullptr) continue;
+static bool IsLapDisabledByRule(u16 rule, u8 lapIdx) {
+    const u16 lapMask = static_cast<u16>(rule & 0x1FE);
+    if (lapMask == 0 || lapIdx >= MAX_CONDITIONAL_LAP_INDEX_COUNT) return false;
 
-            const ENPH &group = *groupHolder->raw;
-            sEnemyGroupRules[groupId] = group.unknown_0xE;
+    const bool invert = (rule & 0x200) != 0;
+    const bool lapBitSet = (lapMask & (1 << (lapIdx + 1))) != 0;
+    return invert ? !lapBitSet : lapBitSet;
+}
 
-            const u16 start = group.start;
-            const u16 end = static_cast<u16>(start + group.length);
-            for (u16 pointId = start; pointId < end && pointId < 256; ++pointId) {
-                sEnemyGroupByPoint[pointId] = groupId;
-            }
+// Later groups win when ranges overlap, like the old per-point group ids did.
+template <class Group>
+static void FillPointRules(const KMP::Manager &kmpMgr, const KMP::Section<Group> *groupSection, u16 *ruleByPoint, u16 pointCount) {
+    memset(ruleByPoint, 0, sizeof(u16) * pointCount);
+    if (groupSection == nullptr) return;
+
+    const u16 groupCount = groupSection->pointCount;
+    for (u16 groupId = 0; groupId < groupCount; ++groupId) {
+        const KMP::Holder<Group> *groupHolder = kmpMgr.GetHolder<Group>(groupId);
+        if (groupHolder == nullptr || groupHolder->raw == nullptr) continue;
+
+        const Group &group = *groupHolder->raw;
+        const u16 start = group.start;
+        const u16 end = static_cast<u16>(start + group.length);
+        for (u16 pointId = start; pointId < end && pointId < pointCount; ++pointId) {
+            ruleByPoint[pointId] = group.unknown_0xE;
         }
     }
+}
 
-    const KMP::Section<ITPH> *itphSection = kmpMgr.itphSection;
-    if (itphSection != nullptr) {
-        const u16 itphCount = itphSection->pointCount;
-        for (u16 groupId = 0; groupId < itphCount && groupId < 256; ++groupId) {
-            const KMP::Holder<ITPH> *groupHolder = kmpMgr.GetHolder<ITPH>(groupId);
-            if (groupHolder == nullptr || groupHolder->raw == nullptr) continue;
+static u16 BuildLinkMask(const u8 *links, u8 rawCount, const u16 *ruleByPoint, u16 pointCount, u8 lapIdx) {
+    if (links == nullptr || rawCount == 0) return 0;
+    if (rawCount > MAX_ROUTE_LINK_SLOTS) rawCount = MAX_ROUTE_LINK_SLOTS;
 
-            const ITPH &group = *groupHolder->raw;
-            sItemGroupRules[groupId] = group.unknown_0xE;
+    u16 mask = 0;
+    for (u8 i = 0; i < rawCount; ++i) {
+        const u8 link = links[i];
+        const u16 rule = link < pointCount ? ruleByPoint[link] : 0;
+        if (!IsLapDisabledByRule(rule, lapIdx)) mask |= static_cast<u16>(1 << i);
+    }
 
-            const u16 start = group.start;
-            const u16 end = static_cast<u16>(start + group.length);
-            for (u16 pointId = start; pointId < end && pointId < 256; ++pointId) {
-                sItemGroupByPoint[pointId] = groupId;
-            }
+    // Keep vanilla behavior stable: never let filtering remove every branch if raw links exist.
+    return mask != 0 ? mask : ROUTE_LINK_FALLBACK;
+}
+
+static bool AllocRouteLinkTable(RouteLinkTable &table, u16 pointCount, EGG::Heap *heap) {
+    table.pointCount = pointCount;
+    if (pointCount == 0) return true;
+
+    const u32 maskBytes = sizeof(u16) * MAX_CONDITIONAL_LAP_INDEX_COUNT * pointCount;
+    table.nextMasks = EGG::Heap::alloc<u16>(maskBytes, 0x4, heap);
+    table.prevMasks = EGG::Heap::alloc<u16>(maskBytes, 0x4, heap);
+    return table.nextMasks != nullptr && table.prevMasks != nullptr;
+}
+
+static bool BuildEnemyLinkTable(const KMP::Manager &kmpMgr, EGG::Heap *heap, u16 *ruleByPoint) {
+    const u16 pointCount = kmpMgr.enptSection != nullptr ? kmpMgr.enptSection->pointCount : 0;
+    if (!AllocRouteLinkTable(sEnemyLinks, pointCount, heap)) return false;
+    FillPointRules(kmpMgr, kmpMgr.enphSection, ruleByPoint, pointCount);
+
+    for (u16 pointId = 0; pointId < pointCount; ++pointId) {
+        const KMP::Holder<ENPT> *holder = kmpMgr.GetHolder<ENPT>(pointId);
+        for (u8 lapIdx = 0; lapIdx < MAX_CONDITIONAL_LAP_INDEX_COUNT; ++lapIdx) {
+            const u32 entry = lapIdx * pointCount + pointId;
+            sEnemyLinks.nextMasks[entry] = holder != nullptr ? BuildLinkMask(holder->nextLinks, holder->nextCount, ruleByPoint, pointCount, lapIdx) : 0;
+            sEnemyLinks.prevMasks[entry] = holder != nullptr ? BuildLinkMask(holder->prevLinks, holder->prevCount, ruleByPoint, pointCount, lapIdx) : 0;
         }
     }
+    return true;
 }
 
-static void EnsureRouteGroupCache(const KMP::Manager *kmpMgr) {
-    if (kmpMgr == nullptr) return;
-    if (sCachedKmpMgr == kmpMgr) return;
-    BuildRouteGroupCache(*kmpMgr);
+static bool BuildItemLinkTable(const KMP::Manager &kmpMgr, EGG::Heap *heap, u16 *ruleByPoint) {
+    const u16 pointCount = kmpMgr.itptSection != nullptr ? kmpMgr.itptSection->pointCount : 0;
+    if (!AllocRouteLinkTable(sItemLinks, pointCount, heap)) return false;
+    FillPointRules(kmpMgr, kmpMgr.itphSection, ruleByPoint, pointCount);
+
+    for (u16 pointId = 0; pointId < pointCount; ++pointId) {
+        const KMP::Holder<ITPT> *holder = kmpMgr.GetHolder<ITPT>(pointId);
+        for (u8 lapIdx = 0; lapIdx < MAX_CONDITIONAL_LAP_INDEX_COUNT; ++lapIdx) {
+            const u32 entry = lapIdx * pointCount + pointId;
+            if (holder == nullptr) {
+                sItemLinks.nextMasks[entry] = 0;
+                sItemLinks.prevMasks[entry] = 0;
+                continue;
+            }
+            const u8 nextCount = holder->nextCount > 6 ? 6 : holder->nextCount;
+            const u8 prevCount = holder->prevCount > 6 ? 6 : holder->prevCount;
+            sItemLinks.nextMasks[entry] = BuildLinkMask(holder->nextLinks, nextCount, ruleByPoint, pointCount, lapIdx);
+            sItemLinks.prevMasks[entry] = BuildLinkMask(holder->prevLinks, prevCount, ruleByPoint, pointCount, lapIdx);
+        }
+    }
+    return true;
 }
 
-static bool IsLapDisabledByRule(u16 rule, u8 lapIdx) {
-    const u16 lapMask = static_cast<u16>(rule & 0x1FE);
-    if (lapMask == 0 || lapIdx >= MAX_CONDITIONAL_LAP_INDEX_COUNT) return false;
+static void BuildRouteGroupCache(const KMP::Manager &kmpMgr) {
+    ResetRouteGroupCache();
+    sCachedKmpMgr = &kmpMgr;
 
-    const bool invert = (rule & 0x200) != 0;
-    const bool lapBitSet = (lapMask & (1 << (lapIdx + 1))) != 0;
-    return invert ? !lapBitSet : lapBitSet;
-}
+    const GameScene *scene = GameScene::GetCurrent();
+    EGG::Heap *heap = scene != nullptr ? scene->structsHeaps.heaps[1] : nullptr;
+    if (heap == nullptr) return;
+
+    const u16 enptCount = kmpMgr.enptSection != nullptr ? kmpMgr.enptSection->pointCount : 0;
+    const u16 itptCount = kmpMgr.itptSection != nullptr ? kmpMgr.itptSection->pointCount : 0;
+    const u16 maxPointCount = enptCount > itptCount ? enptCount : itptCount;
+    u16 *ruleByPoint = maxPointCount > 0 ? EGG::Heap::alloc<u16>(sizeof(u16) * maxPointCount, 0x4, heap) : nullptr;
 
-static bool IsEnemyPointDisabled(u8 enptId, u8 lapIdx) {
-    const u16 groupId = sEnemyGroupByPoint[enptId];
-    if (groupId == INVALID_GROUP_ID) return false;
-    return IsLapDisabledByRule(sEnemyGroupRules[groupId], lapIdx);
+    bool built = maxPointCount == 0 || ruleByPoint != nullptr;
+    if (built) built = BuildEnemyLinkTable(kmpMgr, heap, ruleByPoint) && BuildItemLinkTable(kmpMgr, heap, ruleByPoint);
+    if (ruleByPoint != nullptr) EGG::Heap::free(ruleByPoint, heap);
+
+    if (!built) {
+        OS::Report("[Pulsar] Route groups: could not allocate link masks for %u ENPT / %u ITPT points\n", enptCount, itptCount);
+        ResetRouteGroupCache();
+        sCachedKmpMgr = &kmpMgr;
+    }
 }
 
-static bool IsItemPointDisabled(u8 itptId, u8 lapIdx) {
-    const u16 groupId = sItemGroupByPoint[itptId];
-    if (groupId == INVALID_GROUP_ID) return false;
-    return IsLapDisabledByRule(sItemGroupRules[groupId], lapIdx);
+static void EnsureRouteGroupCache(const KMP::Manager *kmpMgr) {
+    if (kmpMgr == nullptr) return;
+    if (sCachedKmpMgr == kmpMgr) return;
+    BuildRouteGroupCache(*kmpMgr);
 }
 
 static bool ShouldFilterRouteGroups(const KMP::Manager *kmpMgr, u8 &lapIdx) {
@@ -202,6 +266,31 @@ static bool ShouldFilterRouteGroups(const KMP::Manager *kmpMgr, u8 &lapIdx) {
     return true;
 }
 
+static bool TryGetRouteLinkMask(const RouteLinkTable &table, const KMP::Manager *kmpMgr, u8 pointId, bool useNextLinks, u16 &mask) {
+    u8 lapIdx = 0;
+    if (!ShouldFilterRouteGroups(kmpMgr, lapIdx)) return false;
+    if (pointId >= table.pointCount || table.nextMasks == nullptr) return false;
+
+    const u32 entry = lapIdx * table.pointCount + pointId;
+    mask = useNextLinks ? table.nextMasks[entry] : table.prevMasks[entry];
+    return mask != 0;
+}
+
+static u8 CountLinkMaskBits(u16 mask) {
+    u8 count = 0;
+    for (; mask != 0; mask &= static_cast<u16>(mask - 1)) ++count;
+    return count;
+}
+
+static s8 FindLinkMaskSlot(u16 mask, u8 linkIdx) {
+    for (u8 slot = 0; slot < MAX_ROUTE_LINK_SLOTS; ++slot) {
+        if ((mask & (1 << slot)) == 0) continue;
+        if (linkIdx == 0) return static_cast<s8>(slot);
+        --linkIdx;
+    }
+    return -1;
+}
+
 static s8 GetENPTCount(const KMP::Manager *kmpMgr, const u8 &curENPT, bool useNextLinks) {
     if (kmpMgr == nullptr) return 0;
 
@@ -212,19 +301,9 @@ static s8 GetENPTCount(const KMP::Manager *kmpMgr, const u8 &curENPT, bool useNe
     const u8 *rawLinks = useNextLinks ? enptHolder->nextLinks : enptHolder->prevLinks;
     if (rawLinks == nullptr) return 0;
 
-    u8 lapIdx = 0;
-    if (!ShouldFilterRouteGroups(kmpMgr, lapIdx)) return rawCount;
-
-    s8 filteredCount = 0;
-    for (u8 i = 0; i < rawCount; ++i) {
-        const u8 link = rawLinks[i];
-        if (IsEnemyPointDisabled(link, lapIdx)) continue;
-        ++filteredCount;
-    }
-
-    // Keep vanilla behavior stable: never let filtering remove every branch if raw links exist.
-    if (filteredCount == 0 && rawCount > 0) return rawCount;
-    return filteredCount;
+    u16 mask;
+    if (!TryGetRouteLinkMask(sEnemyLinks, kmpMgr, curENPT, useNextLinks, mask) || (mask & ROUTE_LINK_FALLBACK) != 0) return rawCount;
+    return static_cast<s8>(CountLinkMaskBits(mask));
 }
 
 static s8 GetENPTLink(const KMP::Manager *kmpMgr, const u8 &curENPT, u8 linkIdx, bool useNextLinks) {
@@ -237,19 +316,14 @@ static s8 GetENPTLink(const KMP::Manager *kmpMgr, const u8 &curENPT, u8 linkIdx,
     const u8 *rawLinks = useNextLinks ? enptHolder->nextLinks : enptHolder->prevLinks;
     if (rawLinks == nullptr) return -1;
 
-    u8 lapIdx = 0;
-    if (!ShouldFilterRouteGroups(kmpMgr, lapIdx)) {
+    u16 mask;
+    if (!TryGetRouteLinkMask(sEnemyLinks, kmpMgr, curENPT, useNextLinks, mask)) {
         if (linkIdx >= rawCount) return -1;
         return static_cast<s8>(rawLinks[linkIdx]);
     }
 
-    u8 filteredIdx = 0;
-    for (u8 i = 0; i < rawCount; ++i) {
-        const u8 link = rawLinks[i];
-        if (IsEnemyPointDisabled(link, lapIdx)) continue;
-        if (filteredIdx == linkIdx) return static_cast<s8>(link);
-        ++filteredIdx;
-    }
+    const s8 slot = FindLinkMaskSlot(mask, linkIdx);
+    if (slot >= 0) return static_cast<s8>(rawLinks[slot]);
 
     // Keep at least one fallback route if filtering removed all candidates.
     if (rawCount > 0) {
@@ -268,19 +342,9 @@ static u8 GetITPTCount(const KMP::Manager *kmpMgr, const u8 &itpt, bool useNextL
     u8 rawCount = useNextLinks ? itptHolder->nextCount : itptHolder->prevCount;
     if (rawCount > 6) rawCount = 6;
 
-    u8 lapIdx = 0;
-    if (!ShouldFilterRouteGroups(kmpMgr, lapIdx)) return rawCount;
-
-    u8 filteredCount = 0;
-    for (u8 i = 0; i < rawCount; ++i) {
-        const u8 link = useNextLinks ? itptHolder->nextLinks[i] : itptHolder->prevLinks[i];
-        if (IsItemPointDisabled(link, lapIdx)) continue;
-        ++filteredCount;
-    }
-
-    // Keep vanilla behavior stable: never let filtering remove every branch if raw links exist.
-    if (filteredCount == 0 && rawCount > 0) return rawCount;
-    return filteredCount;
+    u16 mask;
+    if (!TryGetRouteLinkMask(sItemLinks, kmpMgr, itpt, useNextLinks, mask) || (mask & ROUTE_LINK_FALLBACK) != 0) return rawCount;
+    return CountLinkMaskBits(mask);
 }
 
 static u8 GetITPTLink(const KMP::Manager *kmpMgr, const u8 &curITPT, u8 linkIdx, bool useNextLinks) {
@@ -291,25 +355,21 @@ static u8 GetITPTLink(const KMP::Manager *kmpMgr, const u8 &curITPT, u8 linkIdx,
 
     u8 rawCount = useNextLinks ? itptHolder->nextCount : itptHolder->prevCount;
     if (rawCount > 6) rawCount = 6;
+    const u8 *rawLinks = useNextLinks ? itptHolder->nextLinks : itptHolder->prevLinks;
 
-    u8 lapIdx = 0;
-    if (!ShouldFilterRouteGroups(kmpMgr, lapIdx)) {
+    u16 mask;
+    if (!TryGetRouteLinkMask(sItemLinks, kmpMgr, curITPT, useNextLinks, mask)) {
         if (linkIdx >= rawCount) return 0xFF;
-        return useNextLinks ? itptHolder->nextLinks[linkIdx] : itptHolder->prevLinks[linkIdx];
+        return rawLinks[linkIdx];
     }
 
-    u8 filteredIdx = 0;
-    for (u8 i = 0; i < rawCount; ++i) {
-        const u8 link = useNextLinks ? itptHolder->nextLinks[i] : itptHolder->prevLinks[i];
-        if (IsItemPointDisabled(link, lapIdx)) continue;
-        if (filteredIdx == linkIdx) return link;
-        ++filteredIdx;
-    }
+    const s8 slot = FindLinkMaskSlot(mask, linkIdx);
+    if (slot >= 0) return rawLinks[slot];
 
     // Keep at least one fallback route if filtering removed all candidates.
     if (rawCount > 0) {
         const u8 fallbackIdx = (linkIdx < rawCount) ? linkIdx : 0;
-        return useNextLinks ? itptHolder->nextLinks[fallbackIdx] : itptHolder->prevLinks[fallbackIdx];
+        return rawLinks[fallbackIdx];
     }
     return 0xFF;
 }
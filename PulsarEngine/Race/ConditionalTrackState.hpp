@@ -6,6 +6,9 @@ namespace Race {
 
 void ResetConditionalObjectsTrackState();
 void ResetConditionalRouteGroupsState();
+void ResetObjectResourceVariantsState();
+// Indexes the "<name>_<n>" object resources of the freshly loaded course archive
+void IndexObjectResourceVariants();
 
 }  // namespace Race
 }  // namespace Pulsar
@@ -1,11 +1,17 @@
 #include <kamek.hpp>
 #include <include/c_stdio.h>
+#include <include/c_string.h>
+#include <core/egg/mem/Heap.hpp>
+#include <core/rvl/OS/OS.hpp>
+#include <core/rvl/arc/arc.hpp>
 #include <MarioKartWii/3D/Model/ModelDirector.hpp>
 #include <MarioKartWii/Archive/ArchiveMgr.hpp>
 #include <MarioKartWii/KMP/GOBJ.hpp>
 #include <MarioKartWii/KMP/KMPManager.hpp>
 #include <MarioKartWii/System/Random.hpp>
 #include <MarioKartWii/Objects/Object.hpp>
+#include <MarioKartWii/Scene/GameScene.hpp>
+#include <Race/ConditionalTrackState.hpp>
 
 namespace Pulsar {
 namespace Race {
@@ -15,6 +21,10 @@ static const u32 GET_SUBFILE_NAME_VTABLE_OFFSET = 0x38;
 static const u32 VARIANT_NAME_BUFFER_COUNT = 4;
 static const u32 VARIANT_NAME_BUFFER_SIZE = 0x40;
 static const char *FALLBACK_EMPTY_RESOURCE_NAME = "-";
+static const u16 VARIANT_COUNTED_OBJECT_ID_LIMIT = 0x400;
+static const u32 VARIANT_MIN_INDEX_CAPACITY = 0x10;
+static const u32 U8_MAGIC = 0x55aa382d;
+static const u32 VARIANT_NAME_POOL_CHUNK_SIZE = 0x800;
 
 enum VariantNameType {
     VARIANT_NAME_BRRES,
@@ -23,11 +33,46 @@ enum VariantNameType {
 
 typedef const char *(*ObjectNameGetter)(Object *);
 
+struct CourseArchiveNode {
+    u32 typeName;  // directory flag in the top byte, string table offset below
+    u32 dataOffset;  // parent for directories
+    u32 dataSize;  // one past the last child for directories
+};
+
 struct ObjectGobjView {
     u8 padding[0xa0];
     const void *gobjLink;
 };
 
+// Every "<stem>_<n>.brres" and "<stem>_<n>.kcl" the course archive ships, indexed once per course by (stem, n, type).
+// Names live in a pool on the course structs heap, so the pointer handed back to the game stays valid until the scene
+// frees the heap.
+struct VariantResource {
+    u32 stemHash;
+    u16 variantIndex;
+    u8 type;
+    bool isUsed;
+    u16 stemLength;
+    const char *name;  // "<stem>_<n>", without the extension
+};
+
+struct VariantResolutionTable {
+    const void *courseArchive;
+    EGG::Heap *heap;
+    const KMP::Manager *kmp;
+    u16 *variantIndexByHolder;
+    u16 holderCount;
+    VariantResource *resources;
+    u32 capacity;  // power of two
+    u32 count;
+    char *poolCursor;
+    u32 poolRemaining;
+    u32 lookups;
+    u32 variantHits;
+};
+
+static VariantResolutionTable sResolutionTable;
+
 static char sVariantNameBuffers[VARIANT_NAME_BUFFER_COUNT][VARIANT_NAME_BUFFER_SIZE];
 static u32 sNextVariantNameBufferIdx = 0;
 
@@ -76,6 +121,19 @@ static bool TryGetObjectHolderIndex(const Object &object, u16 &holderIdx) {
     return false;
 }
 
+static u32 CountPreviousVariants(const KMP::Manager &kmp, u16 holderIdx, u16 objectId) {
+    u32 variantIndex = 0;
+    for (u16 i = 0; i < holderIdx; ++i) {
+        const KMP::Holder<GOBJ> *previousHolder = kmp.gobjSection->holdersArray[i];
+        if (previousHolder != nullptr && previousHolder->raw != nullptr && previousHolder->raw->objID == objectId) {
+            ++variantIndex;
+        }
+    }
+    return variantIndex;
+}
+
+static bool BuildVariantIndexByHolder(VariantResolutionTable &table, const KMP::Manager &kmp);
+
 static u32 GetObjectVariantIndex(const Object &object) {
     const KMP::Manager *kmp = KMP::Manager::sInstance;
     if (kmp == nullptr || kmp->gobjSection == nullptr || kmp->gobjSection->holdersArray == nullptr) return 0;
@@ -83,19 +141,21 @@ static u32 GetObjectVariantIndex(const Object &object) {
     u16 holderIdx = 0;
     if (!TryGetObjectHolderIndex(object, holderIdx)) return 0;
 
+    // The KMP is only parsed after LoadLEXAndKMP, so the per-holder indices are built on the first lookup
+    VariantResolutionTable &table = sResolutionTable;
+    if (table.kmp != kmp && table.heap != nullptr) {
+        table.kmp = kmp;
+        table.variantIndexByHolder = nullptr;
+        table.holderCount = 0;
+        BuildVariantIndexByHolder(table, *kmp);
+    }
+    if (table.variantIndexByHolder != nullptr && holderIdx < table.holderCount) {
+        return table.variantIndexByHolder[holderIdx];
+    }
+
     const KMP::Holder<GOBJ> *holder = kmp->gobjSection->holdersArray[holderIdx];
     if (holder == nullptr || holder->raw == nullptr) return 0;
-
-    const u16 objectId = holder->raw->objID;
-    u32 variantIndex = 0;
-
-    for (u16 i = 0; i < holderIdx; ++i) {
-        const KMP::Holder<GOBJ> *previousHolder = kmp->gobjSection->holdersArray[i];
-        if (previousHolder != nullptr && previousHolder->raw != nullptr && previousHolder->raw->objID == objectId) {
-            ++variantIndex;
-        }
-    }
-    return variantIndex;
+    return CountPreviousVariants(*kmp, holderIdx, holder->raw->objID);
 }
 
 static bool DoesVariantResourceExist(const char *variantName, VariantNameType type) {
@@ -112,38 +172,264 @@ static bool DoesVariantResourceExist(const char *variantName, VariantNameType ty
     return ArchiveMgr::sInstance->GetFile(ARCHIVE_HOLDER_COURSE, fileName, nullptr) != nullptr;
 }
 
-static bool IsDigit(char value) {
-    return value >= '0' && value <= '9';
+void ResetObjectResourceVariantsState() {
+    VariantResolutionTable &table = sResolutionTable;
+    if (table.lookups > 0) {
+        OS::Report("[Pulsar] Object variants: %u resources indexed, %u/%u lookups resolved to a variant\n", table.count,
+                   table.variantHits, table.lookups);
+    }
+    // The arrays live on the previous scene's structs heap, which the game frees with the scene.
+    memset(&table, 0, sizeof(VariantResolutionTable));
 }
 
-static const char *GetVariantNameIfAvailable(Object *object, const char *baseName, VariantNameType type) {
-    if (baseName == nullptr) return FALLBACK_EMPTY_RESOURCE_NAME;
-    if (object == nullptr) return baseName;
-    if (baseName[0] == '\0') return baseName;
-    if (baseName[0] == '-' && baseName[1] == '\0') return baseName;
+static char ToLowerAscii(char c) {
+    if (c >= 'A' && c <= 'Z') return static_cast<char>(c - 'A' + 'a');
+    return c;
+}
 
-    const u32 variantIndex = GetObjectVariantIndex(*object);
+// ARC lookups ignore case, so the index matches stems and extensions the same way.
+static bool EqualsIgnoreCase(const char *str, const char *expected, u32 length) {
+    for (u32 i = 0; i < length; ++i) {
+        if (ToLowerAscii(str[i]) != ToLowerAscii(expected[i])) return false;
+    }
+    return true;
+}
+
+static bool EqualsIgnoreCase(const char *str, const char *expected) {
+    const u32 length = static_cast<u32>(strlen(expected));
+    return strlen(str) == length && EqualsIgnoreCase(str, expected, length);
+}
 
+static u32 HashVariantStem(const char *stem, u32 stemLength) {
+    u32 hash = 0x811C9DC5;
+    for (u32 i = 0; i < stemLength; ++i) {
+        hash ^= static_cast<u8>(ToLowerAscii(stem[i]));
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static const char *CopyToVariantNamePool(VariantResolutionTable &table, const char *name, u32 length) {
+    const u32 size = length + 1;
+    if (size > table.poolRemaining) {
+        if (size > VARIANT_NAME_POOL_CHUNK_SIZE) return nullptr;
+        char *chunk = EGG::Heap::alloc<char>(VARIANT_NAME_POOL_CHUNK_SIZE, 0x4, table.heap);
+        if (chunk == nullptr) return nullptr;
+        table.poolCursor = chunk;
+        table.poolRemaining = VARIANT_NAME_POOL_CHUNK_SIZE;
+    }
+
+    char *copy = table.poolCursor;
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+    table.poolCursor += size;
+    table.poolRemaining -= size;
+    return copy;
+}
+
+// Variant indices for every GOBJ are computed in one pass instead of rescanning the earlier holders per object.
+static bool BuildVariantIndexByHolder(VariantResolutionTable &table, const KMP::Manager &kmp) {
+    const u16 holderCount = kmp.gobjSection->pointCount;
+    if (holderCount == 0) return true;
+
+    u16 *variantIndexByHolder = EGG::Heap::alloc<u16>(sizeof(u16) * holderCount, 0x4, table.heap);
+    u16 *countByObjectId = EGG::Heap::alloc<u16>(sizeof(u16) * VARIANT_COUNTED_OBJECT_ID_LIMIT, 0x4, table.heap);
+    if (variantIndexByHolder == nullptr || countByObjectId == nullptr) return false;
+    memset(countByObjectId, 0, sizeof(u16) * VARIANT_COUNTED_OBJECT_ID_LIMIT);
+
+    for (u16 i = 0; i < holderCount; ++i) {
+        const KMP::Holder<GOBJ> *holder = kmp.gobjSection->holdersArray[i];
+        if (holder == nullptr || holder->raw == nullptr) {
+            variantIndexByHolder[i] = 0;
+            continue;
+        }
+
+        const u16 objectId = holder->raw->objID;
+        if (objectId < VARIANT_COUNTED_OBJECT_ID_LIMIT) {
+            variantIndexByHolder[i] = countByObjectId[objectId]++;
+        } else {
+            variantIndexByHolder[i] = static_cast<u16>(CountPreviousVariants(kmp, i, objectId));
+        }
+    }
+    EGG::Heap::free(countByObjectId, table.heap);
+
+    table.variantIndexByHolder = variantIndexByHolder;
+    table.holderCount = holderCount;
+    return true;
+}
+
+static bool IsDigit(char value) {
+    return value >= '0' && value <= '9';
+}
+
+// Length of baseName without a trailing "_<number>", which the variant index replaces
+static u32 GetVariantStemLength(const char *baseName) {
     const u32 nameLen = static_cast<u32>(strlen(baseName));
     u32 digitStart = nameLen;
     while (digitStart > 0 && IsDigit(baseName[digitStart - 1])) --digitStart;
-    const bool hasNumericSuffix = (digitStart > 1 && digitStart < nameLen && baseName[digitStart - 1] == '_');
+    if (digitStart > 1 && digitStart < nameLen && baseName[digitStart - 1] == '_') return digitStart - 1;
+    return nameLen;
+}
 
-    char *variantName = GetNextVariantNameBuffer();
-    int writeCount = 0;
+// Accepts "<stem>_<n>.brres" and "<stem>_<n>.kcl" with n spelled the way the uncached path prints it.
+static bool ParseVariantFileName(const char *fileName, u32 &stemLength, u32 &nameLength, u32 &variantIndex, VariantNameType &type) {
+    const char *extension = strrchr(fileName, '.');
+    if (extension == nullptr) return false;
+    if (EqualsIgnoreCase(extension, ".brres")) type = VARIANT_NAME_BRRES;
+    else if (EqualsIgnoreCase(extension, ".kcl")) type = VARIANT_NAME_KCL;
+    else return false;
+
+    nameLength = static_cast<u32>(extension - fileName);
+    if (nameLength >= VARIANT_NAME_BUFFER_SIZE) return false;
+    u32 digitStart = nameLength;
+    while (digitStart > 0 && IsDigit(fileName[digitStart - 1])) --digitStart;
+    const u32 digitCount = nameLength - digitStart;
+    if (digitCount == 0 || digitCount > 5 || digitStart < 2 || fileName[digitStart - 1] != '_') return false;
+    if (digitCount > 1 && fileName[digitStart] == '0') return false;
+
+    variantIndex = 0;
+    for (u32 i = digitStart; i < nameLength; ++i) variantIndex = variantIndex * 10 + (fileName[i] - '0');
+    stemLength = digitStart - 1;
+    return variantIndex <= 0xFFFF;
+}
+
+static VariantResource *FindVariantResource(VariantResolutionTable &table, const char *stem, u32 stemLength, u32 stemHash,
+                                            u32 variantIndex, VariantNameType type) {
+    const u32 mask = table.capacity - 1;
+    u32 slot = (stemHash ^ (variantIndex * 0x9E3779B1) ^ static_cast<u32>(type)) & mask;
+    for (u32 probe = 0; probe < table.capacity; ++probe) {
+        VariantResource &resource = table.resources[slot];
+        if (!resource.isUsed) return &resource;
+        if (resource.stemHash == stemHash && resource.variantIndex == variantIndex && resource.type == type &&
+            resource.stemLength == stemLength && EqualsIgnoreCase(resource.name, stem, stemLength)) {
+            return &resource;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
 
-    if (hasNumericSuffix) {
-        const u32 stemLen = digitStart - 1;  // trim trailing "_<number>"
-        if (stemLen > 0) {
-            writeCount = snprintf(variantName, VARIANT_NAME_BUFFER_SIZE, "%.*s_%u", stemLen, baseName, variantIndex);
+// Walks the files directly under the archive root and its "." directory, the only ones GetFile finds by bare name.
+// Counts the variant files, and also indexes them once the table exists.
+static u32 IndexCourseArchiveVariants(VariantResolutionTable &table, const void *archive) {
+    const ARC::Header *header = static_cast<const ARC::Header *>(archive);
+    if (header->Magic != U8_MAGIC || header->combinedNodeSize < sizeof(CourseArchiveNode)) return 0;
+    const CourseArchiveNode *nodes =
+        reinterpret_cast<const CourseArchiveNode *>(static_cast<const u8 *>(archive) + header->nodeOffset);
+    const u32 nodeCount = nodes[0].dataSize;
+    if (nodeCount == 0 || nodeCount > header->combinedNodeSize / sizeof(CourseArchiveNode)) return 0;
+    const char *stringTable = reinterpret_cast<const char *>(nodes + nodeCount);
+    const u32 stringTableSize = header->combinedNodeSize - nodeCount * sizeof(CourseArchiveNode);
+    if (stringTableSize == 0 || stringTable[stringTableSize - 1] != '\0') return 0;
+
+    u32 matches = 0;
+    u32 nestedEnd = 0;  // nodes below this index sit in a subdirectory
+    for (u32 i = 1; i < nodeCount; ++i) {
+        const CourseArchiveNode &node = nodes[i];
+        const u32 nameOffset = node.typeName & 0x00FFFFFF;
+        if (nameOffset >= stringTableSize) return matches;
+        const char *name = stringTable + nameOffset;
+        if ((node.typeName >> 24) != 0) {
+            const bool isRootDot = node.dataOffset == 0 && strcmp(name, ".") == 0;
+            if (!isRootDot && node.dataSize > nestedEnd) nestedEnd = node.dataSize;
+            continue;
         }
-    } else {
-        writeCount = snprintf(variantName, VARIANT_NAME_BUFFER_SIZE, "%s_%u", baseName, variantIndex);
+        if (i < nestedEnd) continue;
+
+        u32 stemLength;
+        u32 nameLength;
+        u32 variantIndex;
+        VariantNameType type;
+        if (!ParseVariantFileName(name, stemLength, nameLength, variantIndex, type)) continue;
+        ++matches;
+        if (table.resources == nullptr) continue;
+
+        const u32 stemHash = HashVariantStem(name, stemLength);
+        VariantResource *resource = FindVariantResource(table, name, stemLength, stemHash, variantIndex, type);
+        if (resource == nullptr || resource->isUsed) continue;
+        const char *pooledName = CopyToVariantNamePool(table, name, nameLength);
+        if (pooledName == nullptr) continue;
+        resource->stemHash = stemHash;
+        resource->variantIndex = static_cast<u16>(variantIndex);
+        resource->type = static_cast<u8>(type);
+        resource->isUsed = true;
+        resource->stemLength = static_cast<u16>(stemLength);
+        resource->name = pooledName;
+        ++table.count;
+    }
+    return matches;
+}
+
+void IndexObjectResourceVariants() {
+    VariantResolutionTable &table = sResolutionTable;
+    const ArchiveMgr *archiveMgr = ArchiveMgr::sInstance;
+    const GameScene *scene = GameScene::GetCurrent();
+    if (archiveMgr == nullptr || scene == nullptr || scene->structsHeaps.heaps[1] == nullptr) return;
+    const void *courseArchive = archiveMgr->GetArchive(ARCHIVE_HOLDER_COURSE, 0);
+    if (courseArchive == nullptr) return;
+    table.heap = scene->structsHeaps.heaps[1];
+
+    const int archiveCount = archiveMgr->GetArchiveCount(ARCHIVE_HOLDER_COURSE);
+    u32 variantFiles = 0;
+    for (int i = 0; i < archiveCount; ++i) {
+        const void *archive = archiveMgr->GetArchive(ARCHIVE_HOLDER_COURSE, i);
+        if (archive != nullptr) variantFiles += IndexCourseArchiveVariants(table, archive);
     }
 
-    if (writeCount <= 0 || writeCount >= static_cast<int>(VARIANT_NAME_BUFFER_SIZE)) return baseName;
+    if (variantFiles != 0) {
+        u32 capacity = VARIANT_MIN_INDEX_CAPACITY;
+        while (capacity < variantFiles * 2) capacity <<= 1;
+        VariantResource *resources = EGG::Heap::alloc<VariantResource>(sizeof(VariantResource) * capacity, 0x4, table.heap);
+        if (resources == nullptr) return;
+        memset(resources, 0, sizeof(VariantResource) * capacity);
+        table.resources = resources;
+        table.capacity = capacity;
+        for (int i = 0; i < archiveCount; ++i) {
+            const void *archive = archiveMgr->GetArchive(ARCHIVE_HOLDER_COURSE, i);
+            if (archive != nullptr) IndexCourseArchiveVariants(table, archive);
+        }
+    }
+    table.courseArchive = courseArchive;
+}
+
+static VariantResolutionTable *GetIndexedVariantTable() {
+    const ArchiveMgr *archiveMgr = ArchiveMgr::sInstance;
+    VariantResolutionTable &table = sResolutionTable;
+    if (archiveMgr == nullptr || table.courseArchive == nullptr) return nullptr;
+    if (archiveMgr->GetArchive(ARCHIVE_HOLDER_COURSE, 0) != table.courseArchive) return nullptr;
+    return &table;
+}
+
+static const char *BuildVariantName(const char *baseName, u32 variantIndex, VariantNameType type) {
+    char *variantName = GetNextVariantNameBuffer();
+    const int writeCount = snprintf(variantName, VARIANT_NAME_BUFFER_SIZE, "%.*s_%u", GetVariantStemLength(baseName), baseName, variantIndex);
+    if (writeCount <= 0 || writeCount >= static_cast<int>(VARIANT_NAME_BUFFER_SIZE)) return nullptr;
     if (DoesVariantResourceExist(variantName, type)) return variantName;
-    return baseName;
+    return nullptr;
+}
+
+static const char *GetVariantNameIfAvailable(Object *object, const char *baseName, VariantNameType type) {
+    if (baseName == nullptr) return FALLBACK_EMPTY_RESOURCE_NAME;
+    if (object == nullptr) return baseName;
+    if (baseName[0] == '\0') return baseName;
+    if (baseName[0] == '-' && baseName[1] == '\0') return baseName;
+
+    const u32 variantIndex = GetObjectVariantIndex(*object);
+    VariantResolutionTable *table = GetIndexedVariantTable();
+    if (table == nullptr) {
+        // Course archive was not indexed (out of structs heap), look the name up in the archive instead
+        const char *variantName = BuildVariantName(baseName, variantIndex, type);
+        return variantName != nullptr ? variantName : baseName;
+    }
+
+    ++table->lookups;
+    if (table->count == 0) return baseName;
+    const u32 stemLength = GetVariantStemLength(baseName);
+    const VariantResource *resource =
+        FindVariantResource(*table, baseName, stemLength, HashVariantStem(baseName, stemLength), variantIndex, type);
+    if (resource == nullptr || !resource->isUsed) return baseName;
+    ++table->variantHits;
+    return resource->name;
 }
 
 static const char *GetVariantBRRESName(Object *object) {
@@ -4,6 +4,7 @@
 #include <MarioKartWii/Race/RaceInfo/RaceInfo.hpp>
 #include <MarioKartWii/RKNet/RKNetController.hpp>
 #include <MarioKartWii/System/ElineManager.hpp>
+#include <Debug/FrameRecorder.hpp>
 
 namespace Security {
 
@@ -45,7 +46,9 @@ void EveryFrame(ElineMgr *_this) {
 
     u32 expectedNumberOfRaceFrames = (u32)((currentTime - raceStartTime) / SystemManager::sInstance->frameDuration);
     if (Raceinfo::sInstance->timerMgr->raceFrameCounter < expectedNumberOfRaceFrames) {
-        OS::Report("Detected frame lag, applied a %d frame correction\n", expectedNumberOfRaceFrames - Raceinfo::sInstance->timerMgr->raceFrameCounter);
+        const u32 correction = expectedNumberOfRaceFrames - Raceinfo::sInstance->timerMgr->raceFrameCounter;
+        OS::Report("Detected frame lag, applied a %d frame correction\n", correction);
+        Pulsar::Debug::RecordLagCorrection(correction);
         Raceinfo::sInstance->timerMgr->raceFrameCounter = expectedNumberOfRaceFrames;
     }
 }
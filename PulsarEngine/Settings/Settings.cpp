@@ -14,6 +14,8 @@ Mgr *Mgr::sInstance = nullptr;
 
 static const char trophyFolderName[] = "Trophies";
 static const char trophyFileName[] = "Trophy.pul";
+static const char trophyStoreFileName[] = "Trophies.pul";
+static const u16 emptyTrophySlot = 0xFFFF;
 static const char migratedLegacySuffix[] = ".migrated";
 
 void Mgr::SaveTask(void *data) {
@@ -40,17 +42,7 @@ void Mgr::Save() {
 
 void Mgr::SaveTrophies() {
     if (this->trophyEntries == nullptr) return;
-    for (u32 i = 0; i < this->trophyEntryCount; ++i) {
-        TrophyEntry &trophy = this->trophyEntries[i];
-        bool hasAnyTrophy = false;
-        for (int mode = 0; mode < 4; ++mode) {
-            if (trophy.hasTrophy[mode]) {
-                hasAnyTrophy = true;
-                break;
-            }
-        }
-        if (hasAnyTrophy) this->WriteTrophyFile(trophy);
-    }
+    this->WriteTrophyStore();
 }
 
 void Mgr::Init(const u16 *totalTrophyCount, const char *settingsPath, const char *trophiesPath) {
@@ -115,8 +107,14 @@ void Mgr::Init(const u16 *totalTrophyCount, const char *settingsPath, const char
     }
 
     this->InitTrophyEntries(totalTrophyCount);
-    this->LoadTrophiesFromFiles();
-    this->MigrateLegacyTrophies();
+    bool trophyStoreDirty = false;
+    if (!this->LoadTrophyStore()) {
+        // First boot with the packed store: pull in the old per-track files once, the store replaces them from now on.
+        this->LoadTrophiesFromFiles();
+        trophyStoreDirty = true;
+    }
+    if (this->MigrateLegacyTrophies()) trophyStoreDirty = true;
+    if (trophyStoreDirty) this->WriteTrophyStore();
 
     if (io->OpenFile(this->filePath, FILE_MODE_WRITE) || io->CreateAndOpen(this->filePath, FILE_MODE_WRITE)) {
         io->Overwrite(this->rawBin->header.fileSize, this->rawBin);
@@ -138,70 +136,163 @@ void Mgr::GetTrophyFilePath(char *dest, u32 crc32, u8 variantIdx) const {
     snprintf(dest, IOS::ipcMaxPath, "%s/%s", folder, trophyFileName);
 }
 
-bool Mgr::EnsureTrophyFoldersExist(u32 crc32, u8 variantIdx) const {
+bool Mgr::ReadTrophyFile(TrophyEntry &trophy) const {
+    char path[IOS::ipcMaxPath];
+    this->GetTrophyFilePath(path, trophy.crc32, trophy.variantIdx);
+
     IO *io = IO::sInstance;
-    char rootFolder[IOS::ipcMaxPath];
-    snprintf(rootFolder, IOS::ipcMaxPath, "%s/%s", System::sInstance->GetModFolder(), trophyFolderName);
-    if (!io->FolderExists(rootFolder) && !io->CreateFolder(rootFolder)) return false;
+    if (!io->OpenFile(path, FILE_MODE_READ)) return false;
 
-    char baseFolder[IOS::ipcMaxPath];
-    this->GetTrophyFolder(baseFolder, crc32, 0);
-    if (!io->FolderExists(baseFolder) && !io->CreateFolder(baseFolder)) return false;
+    alignas(0x20) TrophyFile file;
+    bool ret = io->Read(sizeof(TrophyFile), &file) == sizeof(TrophyFile) &&
+               file.header.magic == TrophyFile::magic &&
+               file.header.version == TrophyFile::version &&
+               file.crc32 == trophy.crc32 &&
+               file.variantIdx == trophy.variantIdx;
+    io->Close();
 
-    if (variantIdx != 0) {
-        char variantFolder[IOS::ipcMaxPath];
-        this->GetTrophyFolder(variantFolder, crc32, variantIdx);
-        if (!io->FolderExists(variantFolder) && !io->CreateFolder(variantFolder)) return false;
+    if (!ret) return false;
+    for (int mode = 0; mode < 4; ++mode) {
+        trophy.hasTrophy[mode] = file.hasTrophy[mode] != 0;
     }
     return true;
 }
 
-bool Mgr::WriteTrophyFile(const TrophyEntry &trophy) const {
-    if (!this->EnsureTrophyFoldersExist(trophy.crc32, trophy.variantIdx)) return false;
+void Mgr::GetTrophyStorePath(char *dest) const {
+    snprintf(dest, IOS::ipcMaxPath, "%s/%s", System::sInstance->GetModFolder(), trophyStoreFileName);
+}
 
-    alignas(0x20) TrophyFile file;
-    file.header.magic = TrophyFile::magic;
-    file.header.version = TrophyFile::version;
-    file.header.size = sizeof(TrophyFile);
-    file.crc32 = trophy.crc32;
-    file.variantIdx = trophy.variantIdx;
-    memset(file.hasTrophy, 0, sizeof(file.hasTrophy));
-    memset(file.reserved, 0, sizeof(file.reserved));
+void Mgr::SetTrophyMask(TrophyEntry &trophy, u8 trophyMask) {
     for (int mode = 0; mode < 4; ++mode) {
-        file.hasTrophy[mode] = trophy.hasTrophy[mode] ? 1 : 0;
+        if ((trophyMask & (1 << mode)) != 0 && !trophy.hasTrophy[mode]) {
+            trophy.hasTrophy[mode] = true;
+            ++this->trophyCount[mode];
+        }
     }
+}
 
+bool Mgr::LoadTrophyStore() {
     char path[IOS::ipcMaxPath];
-    this->GetTrophyFilePath(path, trophy.crc32, trophy.variantIdx);
+    this->GetTrophyStorePath(path);
+
     IO *io = IO::sInstance;
-    bool ret = io->OpenFile(path, FILE_MODE_WRITE);
-    if (!ret) ret = io->CreateAndOpen(path, FILE_MODE_WRITE);
-    if (!ret) return false;
-    io->Overwrite(sizeof(TrophyFile), &file);
+    if (!io->OpenFile(path, FILE_MODE_READ)) return false;
+
+    const s32 fileSize = io->GetFileSize();
+    const u32 headerSize = sizeof(TrophyStore) - sizeof(TrophyStoreEntry);
+    if (fileSize < static_cast<s32>(headerSize)) {
+        io->Close();
+        return false;
+    }
+    TrophyStore *store = io->Alloc<TrophyStore>(fileSize);
+    if (store == nullptr) {
+        io->Close();
+        return false;
+    }
+    bool ret = io->Read(fileSize, store) == fileSize &&
+               store->header.magic == TrophyStore::magic &&
+               store->header.version == TrophyStore::version &&
+               store->header.size >= headerSize &&
+               store->header.size <= static_cast<u32>(fileSize) &&
+               store->entryCount <= (store->header.size - headerSize) / sizeof(TrophyStoreEntry);
     io->Close();
+    if (!ret) {
+        delete store;
+        return false;
+    }
+
+    u32 unknownCount = 0;
+    for (u32 i = 0; i < store->entryCount; ++i) {
+        const TrophyStoreEntry &src = store->entries[i];
+        TrophyEntry *dest = this->FindTrackTrophy(src.crc32, src.variantIdx);
+        if (dest != nullptr)
+            this->SetTrophyMask(*dest, src.trophyMask);
+        else if (src.trophyMask != 0)
+            ++unknownCount;
+    }
+
+    if (unknownCount > 0) {
+        this->unknownTrophies = new (System::sInstance->heap) TrophyStoreEntry[unknownCount];
+        for (u32 i = 0; i < store->entryCount; ++i) {
+            const TrophyStoreEntry &src = store->entries[i];
+            if (src.trophyMask == 0 || this->FindTrackTrophy(src.crc32, src.variantIdx) != nullptr) continue;
+            this->unknownTrophies[this->unknownTrophyCount++] = src;
+        }
+    }
+    delete store;
     return true;
 }
 
-bool Mgr::ReadTrophyFile(TrophyEntry &trophy) const {
-    char path[IOS::ipcMaxPath];
-    this->GetTrophyFilePath(path, trophy.crc32, trophy.variantIdx);
+bool Mgr::WriteTrophyStore() const {
+    u32 entryCount = this->unknownTrophyCount;
+    for (u32 i = 0; i < this->trophyEntryCount; ++i) {
+        const TrophyEntry &trophy = this->trophyEntries[i];
+        if (trophy.hasTrophy[0] || trophy.hasTrophy[1] || trophy.hasTrophy[2] || trophy.hasTrophy[3]) ++entryCount;
+    }
 
+    const u32 size = sizeof(TrophyStore) - sizeof(TrophyStoreEntry) + sizeof(TrophyStoreEntry) * entryCount;
     IO *io = IO::sInstance;
-    if (!io->OpenFile(path, FILE_MODE_READ)) return false;
+    TrophyStore *store = io->Alloc<TrophyStore>(size);
+    if (store == nullptr) return false;
+    memset(store, 0, size);
+    store->header.magic = TrophyStore::magic;
+    store->header.version = TrophyStore::version;
+    store->header.size = size;
+    store->entryCount = entryCount;
+
+    u32 storeIdx = 0;
+    for (u32 i = 0; i < this->trophyEntryCount; ++i) {
+        const TrophyEntry &trophy = this->trophyEntries[i];
+        u8 trophyMask = 0;
+        for (int mode = 0; mode < 4; ++mode) {
+            if (trophy.hasTrophy[mode]) trophyMask |= 1 << mode;
+        }
+        if (trophyMask == 0) continue;
+        TrophyStoreEntry &dest = store->entries[storeIdx++];
+        dest.crc32 = trophy.crc32;
+        dest.variantIdx = trophy.variantIdx;
+        dest.trophyMask = trophyMask;
+    }
+    for (u32 i = 0; i < this->unknownTrophyCount; ++i) store->entries[storeIdx++] = this->unknownTrophies[i];
 
-    alignas(0x20) TrophyFile file;
-    bool ret = io->Read(sizeof(TrophyFile), &file) == sizeof(TrophyFile) &&
-               file.header.magic == TrophyFile::magic &&
-               file.header.version == TrophyFile::version &&
-               file.crc32 == trophy.crc32 &&
-               file.variantIdx == trophy.variantIdx;
-    io->Close();
+    char path[IOS::ipcMaxPath];
+    this->GetTrophyStorePath(path);
+    bool ret = io->OpenFile(path, FILE_MODE_WRITE);
+    if (!ret) ret = io->CreateAndOpen(path, FILE_MODE_WRITE);
+    if (ret) {
+        io->Overwrite(size, store);
+        io->Close();
+    }
+    delete store;
+    return ret;
+}
 
-    if (!ret) return false;
-    for (int mode = 0; mode < 4; ++mode) {
-        trophy.hasTrophy[mode] = file.hasTrophy[mode] != 0;
+static u32 HashTrophyKey(u32 crc32, u8 variantIdx) {
+    u32 hash = crc32 ^ (static_cast<u32>(variantIdx) * 0x9E3779B1);
+    return hash ^ (hash >> 16);
+}
+
+void Mgr::BuildTrophyHashTable() {
+    u32 capacity = 16;
+    while (capacity < this->trophyEntryCount * 2) capacity <<= 1;
+    this->trophyHashMask = capacity - 1;
+    this->trophyHashTable = new (System::sInstance->heap) u16[capacity];
+    memset(this->trophyHashTable, 0xFF, sizeof(u16) * capacity);
+
+    for (u32 i = 0; i < this->trophyEntryCount; ++i) {
+        const TrophyEntry &trophy = this->trophyEntries[i];
+        u32 slot = HashTrophyKey(trophy.crc32, trophy.variantIdx) & this->trophyHashMask;
+        bool isDuplicate = false;
+        while (this->trophyHashTable[slot] != emptyTrophySlot) {
+            const TrophyEntry &cur = this->trophyEntries[this->trophyHashTable[slot]];
+            if (cur.crc32 == trophy.crc32 && cur.variantIdx == trophy.variantIdx) {
+                isDuplicate = true;  // the first entry wins, as it did with the old linear scan
+                break;
+            }
+            slot = (slot + 1) & this->trophyHashMask;
+        }
+        if (!isDuplicate) this->trophyHashTable[slot] = static_cast<u16>(i);
     }
-    return true;
 }
 
 void Mgr::InitTrophyEntries(const u16 *totalTrophyCount) {
@@ -246,6 +337,7 @@ void Mgr::InitTrophyEntries(const u16 *totalTrophyCount) {
             ++entryIdx;
         }
     }
+    this->BuildTrophyHashTable();
 }
 
 void Mgr::LoadTrophiesFromFiles() {
@@ -293,18 +385,20 @@ bool Mgr::LoadLegacyTrophies(TrophiesHolder *&holder) const {
     return true;
 }
 
-void Mgr::MigrateLegacyTrophies() {
+bool Mgr::MigrateLegacyTrophies() {
     char migratedPath[IOS::ipcMaxPath];
     snprintf(migratedPath, IOS::ipcMaxPath, "%s%s", this->trophiesFilePath, migratedLegacySuffix);
 
     IO *io = IO::sInstance;
     if (io->OpenFile(migratedPath, FILE_MODE_READ)) {
         io->Close();
-        return;
+        return false;
     }
 
     TrophiesHolder *legacy = nullptr;
-    if (!this->LoadLegacyTrophies(legacy) || legacy == nullptr) return;
+    if (!this->LoadLegacyTrophies(legacy) || legacy == nullptr) return false;
+
+    bool changed = false;
 
     const u32 legacyEntryCount = (legacy->header.size - sizeof(TrophiesHolder)) / sizeof(TrackTrophy) + 1;
     for (u32 i = 0; i < legacyEntryCount; ++i) {
@@ -312,7 +406,6 @@ void Mgr::MigrateLegacyTrophies() {
         TrophyEntry *dest = this->FindTrackTrophy(src.crc32, 0);
         if (dest == nullptr) continue;
 
-        bool changed = false;
         for (int mode = 0; mode < 4; ++mode) {
             if (src.hastrophy[mode] && !dest->hasTrophy[mode]) {
                 dest->hasTrophy[mode] = true;
@@ -320,9 +413,6 @@ void Mgr::MigrateLegacyTrophies() {
                 changed = true;
             }
         }
-        if (changed) {
-            this->WriteTrophyFile(*dest);
-        }
     }
 
     delete legacy;
@@ -334,20 +424,20 @@ void Mgr::MigrateLegacyTrophies() {
             io->Close();
         }
     }
+    return changed;
 }
 
 TrophyEntry *Mgr::FindTrackTrophy(u32 crc32, u8 variantIdx) {
-    for (u32 i = 0; i < this->trophyEntryCount; ++i) {
-        TrophyEntry &trophy = this->trophyEntries[i];
-        if (trophy.crc32 == crc32 && trophy.variantIdx == variantIdx) return &trophy;
-    }
-    return nullptr;
+    return const_cast<TrophyEntry *>(static_cast<const Mgr *>(this)->FindTrackTrophy(crc32, variantIdx));
 }
 
 const TrophyEntry *Mgr::FindTrackTrophy(u32 crc32, u8 variantIdx) const {
-    for (u32 i = 0; i < this->trophyEntryCount; ++i) {
-        const TrophyEntry &trophy = this->trophyEntries[i];
+    if (this->trophyHashTable == nullptr) return nullptr;
+    u32 slot = HashTrophyKey(crc32, variantIdx) & this->trophyHashMask;
+    while (this->trophyHashTable[slot] != emptyTrophySlot) {
+        const TrophyEntry &trophy = this->trophyEntries[this->trophyHashTable[slot]];
         if (trophy.crc32 == crc32 && trophy.variantIdx == variantIdx) return &trophy;
+        slot = (slot + 1) & this->trophyHashMask;
     }
     return nullptr;
 }
@@ -35,6 +35,24 @@ struct TrophyFile {
     u8 reserved[3];
 };
 
+struct TrophyStoreEntry {
+    u32 crc32;
+    u8 variantIdx;
+    u8 trophyMask;  // bit n set -> hasTrophy[n]
+    u8 reserved[2];
+};
+
+// Every earned trophy in one file, so boot is a single read and a new trophy a single write.
+// Replaces the per-track TrophyFile layout, which is only read once to migrate into it.
+struct TrophyStore {
+    static const u32 magic = 'TRPS';
+    static const u32 version = 1;
+
+    Pulsar::SectionHeader header;
+    u32 entryCount;
+    TrophyStoreEntry entries[1];
+};
+
 class Hook : public DoFuncsHook {
     static DoFuncsHook *settingsHooks;
 
@@ -56,14 +74,17 @@ private:
     TrophyEntry *FindTrackTrophy(u32 crc32, u8 variantIdx);
     const TrophyEntry *FindTrackTrophy(u32 crc32, u8 variantIdx) const;
     void InitTrophyEntries(const u16 *totalTrophyCount);
+    void BuildTrophyHashTable();
+    bool LoadTrophyStore();
+    bool WriteTrophyStore() const;
+    void GetTrophyStorePath(char *dest) const;
+    void SetTrophyMask(TrophyEntry &trophy, u8 trophyMask);
     void LoadTrophiesFromFiles();
-    void MigrateLegacyTrophies();
+    bool MigrateLegacyTrophies();
     bool LoadLegacyTrophies(TrophiesHolder *&holder) const;
-    bool WriteTrophyFile(const TrophyEntry &trophy) const;
     bool ReadTrophyFile(TrophyEntry &trophy) const;
     void GetTrophyFolder(char *dest, u32 crc32, u8 variantIdx) const;
     void GetTrophyFilePath(char *dest, u32 crc32, u8 variantIdx) const;
-    bool EnsureTrophyFoldersExist(u32 crc32, u8 variantIdx) const;
     void AdjustSections();
     void AdjustSectionsSizes();
     void Update() {
@@ -79,7 +100,8 @@ private:
     void SetLastSelectedCup(PulsarCupId id) { this->rawBin->GetSection<MiscParams>().lastSelectedCup = id; }
 
 public:
-    Mgr() : rawBin(nullptr), trophyEntries(nullptr), trophyEntryCount(0) {
+    Mgr() : rawBin(nullptr), trophyEntries(nullptr), trophyEntryCount(0), trophyHashTable(nullptr), trophyHashMask(0),
+            unknownTrophies(nullptr), unknownTrophyCount(0) {
         for (int i = 0; i < 4; ++i) this->trophyCount[i] = 0;
     }
     static Mgr &Get() { return *sInstance; }
@@ -127,6 +149,10 @@ private:
     u16 trophyCount[4];
     TrophyEntry *trophyEntries;
     u32 trophyEntryCount;
+    u16 *trophyHashTable;  // open addressing on crc32 + variantIdx, holds indices into trophyEntries
+    u32 trophyHashMask;
+    TrophyStoreEntry *unknownTrophies;  // stored trophies for tracks missing from this pack, written back untouched
+    u32 unknownTrophyCount;
     friend class System;
     friend class UI::SettingsPanel;
     // Two ghosts functions which save the settings
@@ -114,6 +114,9 @@ CupsConfig::CupsConfig(const CupsHolder &rawCups) : regsMode(rawCups.regsMode),
                                                     isAlphabeticalLayout(false),
                                                     lastVariantIdxByTrack(nullptr) {
     memset(this->vsTrackVariantIdx, 0, sizeof(this->vsTrackVariantIdx));
+    memset(this->fileNamePools, 0, sizeof(this->fileNamePools));
+    memset(this->fileNamePoolSizes, 0, sizeof(this->fileNamePoolSizes));
+    this->fileNamePoolCount = 0;
     lastVariantIdxByTrack = new u8[0x2000];
     memset(lastVariantIdxByTrack, 0, 0x2000);
     totalVariantCount = rawCups.totalVariantCount;
@@ -221,6 +224,9 @@ CupsConfig::CupsConfig(const CupsHolder &rtCups, const CupsHolder &ctCups, const
       ctOnlyCupCount(ctCups.ctsCupCount),
       battleCupCount(btCups.ctsCupCount) {
     memset(this->vsTrackVariantIdx, 0, sizeof(this->vsTrackVariantIdx));
+    memset(this->fileNamePools, 0, sizeof(this->fileNamePools));
+    memset(this->fileNamePoolSizes, 0, sizeof(this->fileNamePoolSizes));
+    this->fileNamePoolCount = 0;
     lastVariantIdxByTrack = new u8[0x2000];
     memset(lastVariantIdxByTrack, 0, 0x2000);
     if (regsMode != 1) {
@@ -377,6 +383,18 @@ void CupsConfig::GetTrackGhostFolder(char *dest, PulsarId pulsarId, u8 variantId
 
 void CupsConfig::LoadFileNames(const char *buffer, u32 length, u32 trackIdxOffset, u32 sourceTrackCount) {
     if (buffer == nullptr || length == 0 || this->GetCtsTrackCount() == 0) return;
+    if (length >= sizeof(FileNamesHolder)) {
+        const FileNamesHolder &holder = *reinterpret_cast<const FileNamesHolder *>(buffer);
+        if (holder.header.magic == FileNamesHolder::magic &&
+            LoadPackedFileNames(holder, length, trackIdxOffset, sourceTrackCount)) {
+            return;
+        }
+        // A broken or unknown packed section is skipped so the text block behind it still gets a chance.
+        if (holder.header.magic == FileNamesHolder::magic && holder.header.size < length) {
+            buffer += holder.header.size;
+            length -= holder.header.size;
+        }
+    }
     char *temp = new char[length + 1];
     memcpy(temp, buffer, length);
     temp[length] = '\0';
@@ -418,54 +436,95 @@ void CupsConfig::LoadFileNames(const char *buffer, u32 length, u32 trackIdxOffse
         if (pipe == nullptr) continue;
         *pipe = '\0';
         TrimLine(valueStr);
-        const u32 rawTrackIdx = key & 0x0FFF;
-        if (sourceTrackCount != 0 && rawTrackIdx >= sourceTrackCount) continue;
-        const u32 variantIdx = key >> 12;
-        u32 trackIdx = rawTrackIdx + trackIdxOffset;
-        if (trackIdx >= static_cast<u32>(this->GetCtsTrackCount())) {
-            if (sourceTrackCount == 0 && rawTrackIdx < static_cast<u32>(this->GetCtsTrackCount()))
-                trackIdx = rawTrackIdx;
-            else
-                continue;
-        }
-        this->RegisterFileName(trackIdx, variantIdx, valueStr);
+        u32 trackIdx = 0;
+        if (!this->ResolveFileNameKey(key, trackIdxOffset, sourceTrackCount, trackIdx)) continue;
+        this->RegisterFileName(trackIdx, key >> 12, valueStr);
     }
     delete[] temp;
 }
 
-void CupsConfig::RegisterFileName(u32 trackIdx, u32 variantIdx, const char *name) {
-    if (trackIdx >= static_cast<u32>(this->GetCtsTrackCount()) || name == nullptr || *name == '\0') return;
-    char *stored = DuplicateFileName(name);
-    if (stored == nullptr) return;
-    if (variantIdx == 0) {
-        if (trackFileNames[trackIdx] != nullptr) delete[] trackFileNames[trackIdx];
-        trackFileNames[trackIdx] = stored;
-        return;
+// The pool is copied once per config (the ConfigFile itself is freed after boot) and names point straight into it.
+bool CupsConfig::LoadPackedFileNames(const FileNamesHolder &holder, u32 length, u32 trackIdxOffset,
+                                     u32 sourceTrackCount) {
+    if (holder.header.version != FileNamesHolder::curVersion || holder.header.size > length) return false;
+    if (this->fileNamePoolCount >= sizeof(this->fileNamePools) / sizeof(this->fileNamePools[0])) return false;
+    const u32 entriesOffset = offsetof(FileNamesHolder, entries);
+    const u32 entryCount = holder.entryCount;
+    const u32 poolSize = holder.poolSize;
+    if (entryCount > (holder.header.size - entriesOffset) / sizeof(FileNameEntry)) return false;
+    const u32 poolOffset = entriesOffset + entryCount * sizeof(FileNameEntry);
+    if (poolSize == 0 || poolSize > holder.header.size - poolOffset) return false;
+    const char *srcPool = reinterpret_cast<const char *>(&holder) + poolOffset;
+    if (srcPool[poolSize - 1] != '\0') return false;
+
+    char *pool = new char[poolSize];
+    memcpy(pool, srcPool, poolSize);
+    this->fileNamePools[this->fileNamePoolCount] = pool;
+    this->fileNamePoolSizes[this->fileNamePoolCount] = poolSize;
+    ++this->fileNamePoolCount;
+
+    for (u32 i = 0; i < entryCount; ++i) {
+        const FileNameEntry &entry = holder.entries[i];
+        if (entry.nameOffset >= poolSize) continue;
+        char *name = pool + entry.nameOffset;
+        if (*name == '\0') continue;
+        // Same limit DuplicateFileName applies to text names; the pool is our copy, so cut in place.
+        if (strlen(name) > trackMaxFileName) name[trackMaxFileName] = '\0';
+        u32 trackIdx = 0;
+        if (!this->ResolveFileNameKey(entry.key, trackIdxOffset, sourceTrackCount, trackIdx)) continue;
+        char **slot = this->GetFileNameSlot(trackIdx, entry.key >> 12);
+        if (slot == nullptr) continue;
+        this->ReleaseFileName(*slot);
+        *slot = name;
     }
-    if (variantIdx - 1 >= this->mainTracks[trackIdx].variantCount || this->variantFileNames == nullptr) {
-        delete[] stored;
-        return;
-    }
-    const u32 base = this->variantsOffs[trackIdx] / sizeof(Variant);
-    const u32 variantArrayIdx = base + (variantIdx - 1);
-    if (variantArrayIdx >= this->totalVariantCount) {
-        delete[] stored;
-        return;
+    return true;
+}
+
+bool CupsConfig::ResolveFileNameKey(u32 key, u32 trackIdxOffset, u32 sourceTrackCount, u32 &trackIdx) const {
+    const u32 rawTrackIdx = key & 0x0FFF;
+    if (sourceTrackCount != 0 && rawTrackIdx >= sourceTrackCount) return false;
+    trackIdx = rawTrackIdx + trackIdxOffset;
+    if (trackIdx < static_cast<u32>(this->GetCtsTrackCount())) return true;
+    if (sourceTrackCount == 0 && rawTrackIdx < static_cast<u32>(this->GetCtsTrackCount())) {
+        trackIdx = rawTrackIdx;
+        return true;
     }
-    if (variantFileNames[variantArrayIdx] != nullptr) delete[] variantFileNames[variantArrayIdx];
-    variantFileNames[variantArrayIdx] = stored;
+    return false;
 }
 
-const char *CupsConfig::GetFileName(PulsarId id, u8 variantIdx) const {
-    if (IsReg(id)) return nullptr;
-    const u32 trackIdx = ConvertTrack_PulsarIdToRealId(id);
+char **CupsConfig::GetFileNameSlot(u32 trackIdx, u32 variantIdx) const {
     if (trackIdx >= static_cast<u32>(this->GetCtsTrackCount())) return nullptr;
-    if (variantIdx == 0) return trackFileNames[trackIdx];
+    if (variantIdx == 0) return &trackFileNames[trackIdx];
     if (variantIdx - 1 >= this->mainTracks[trackIdx].variantCount || this->variantFileNames == nullptr) return nullptr;
     const u32 base = this->variantsOffs[trackIdx] / sizeof(Variant);
     const u32 variantArrayIdx = base + (variantIdx - 1);
     if (variantArrayIdx >= this->totalVariantCount) return nullptr;
-    return variantFileNames[variantArrayIdx];
+    return &variantFileNames[variantArrayIdx];
+}
+
+void CupsConfig::ReleaseFileName(char *name) const {
+    if (name == nullptr) return;
+    for (u32 i = 0; i < this->fileNamePoolCount; ++i) {
+        const char *pool = this->fileNamePools[i];
+        if (name >= pool && name < pool + this->fileNamePoolSizes[i]) return;
+    }
+    delete[] name;
+}
+
+void CupsConfig::RegisterFileName(u32 trackIdx, u32 variantIdx, const char *name) {
+    if (name == nullptr || *name == '\0') return;
+    char **slot = this->GetFileNameSlot(trackIdx, variantIdx);
+    if (slot == nullptr) return;
+    char *stored = DuplicateFileName(name);
+    if (stored == nullptr) return;
+    this->ReleaseFileName(*slot);
+    *slot = stored;
+}
+
+const char *CupsConfig::GetFileName(PulsarId id, u8 variantIdx) const {
+    if (IsReg(id)) return nullptr;
+    char **slot = this->GetFileNameSlot(ConvertTrack_PulsarIdToRealId(id), variantIdx);
+    return slot != nullptr ? *slot : nullptr;
 }
 
 u32 CupsConfig::RandomizeVariant(PulsarId id) const {
@@ -35,6 +35,7 @@ public:
     static void SetLayout();
     void GetExpertPath(char *dest, PulsarId id, TTMode mode, u8 variantIdx) const;
     void LoadFileNames(const char *buffer, u32 length, u32 trackIdxOffset = 0, u32 sourceTrackCount = 0);
+    bool LoadPackedFileNames(const FileNamesHolder &holder, u32 length, u32 trackIdxOffset, u32 sourceTrackCount);
 
     // Ghosts
     int GetCRC32(PulsarId id) const;
@@ -148,7 +149,15 @@ public:
     u32 *variantNameBmgIds;
     u32 totalVariantCount;
 
+    // Packed FNAM pools, one per config; names pointing in here are not owned individually.
+    char *fileNamePools[3];
+    u32 fileNamePoolSizes[3];
+    u32 fileNamePoolCount;
+
     void RegisterFileName(u32 trackIdx, u32 variantIdx, const char *name);
+    bool ResolveFileNameKey(u32 key, u32 trackIdxOffset, u32 sourceTrackCount, u32 &trackIdx) const;
+    char **GetFileNameSlot(u32 trackIdx, u32 variantIdx) const;
+    void ReleaseFileName(char *name) const;
 
     u8 vsTrackVariantIdx[32];
     u8 *lastVariantIdxByTrack;
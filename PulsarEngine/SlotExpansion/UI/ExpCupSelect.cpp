@@ -4,11 +4,18 @@
 #include <SlotExpansion/UI/ExpCupSelect.hpp>
 #include <UI/UI.hpp>
 #include <Settings/Settings.hpp>
+#include <PulsarSystem.hpp>
+#include <include/c_string.h>
 
 namespace Pulsar {
 namespace UI {
 
+static void ResetCupIconCache();
+
 ExpCupSelect::ExpCupSelect() {
+    // Cached TPLs point into the previous section's layouts. Resetting here, when the page is built, runs before InitSelf
+    // and any prefetch, so nothing resolved for this page is ever dropped.
+    ResetCupIconCache();
     internControlCount += 1;
     onRightArrowSelectHandler.subject = this;
     onRightArrowSelectHandler.ptmf = &ExpCupSelect::OnRightArrowSelect;
@@ -85,6 +92,11 @@ void ExpCupSelect::OnArrowSelect(s32 direction) {
         buttons[i]->buttonId = nextId;
         this->UpdateCupData(nextId, *buttons[i]);
     }
+    // Resolve the page past the new one now so the next presses only swap cached TPLs
+    if (direction > 0)
+        PrefetchCupIcons(cupsConfig->GetNextCupId(static_cast<PulsarCupId>(buttons[7]->buttonId), 1), 8, *buttons[7]);
+    else
+        PrefetchCupIcons(cupsConfig->GetNextCupId(static_cast<PulsarCupId>(buttons[0]->buttonId), -8), 8, *buttons[0]);
 }
 
 void ExpCupSelect::OnStartPress(u32 hudSlotId) {
@@ -154,32 +166,89 @@ kmWrite32(0x808404f8, 0x60000000);
 // brlyt TPL stuff
 const char *regCupNames[8] = {"kinoko", "koura", "flower", "banana", "star", "konoha", "oukan", "thunder"};
 
+// Resolved icon TPLs, 0-7 are the regular cups and icon_%03d.tpl follows; entries are only valid for the section that
+// built the page. Misses are not cached, the next lookup tries the archive again.
+struct CupIconCacheEntry {
+    TPLPalettePtr tpl;
+};
+static CupIconCacheEntry *cupIcons = nullptr;
+static u32 cupIconCount = 0;
+
+static const u32 kNoCupIconKey = 0xFFFFFFFF;
+
+static void ResetCupIconCache() {
+    if (cupIcons != nullptr) memset(cupIcons, 0, sizeof(CupIconCacheEntry) * cupIconCount);
+}
+
+// kNoCupIconKey when no custom cup icon is defined; those cups are resolved by name, uncached.
+static u32 GetCupIconKey(PulsarCupId pulsarCupId) {
+    const u32 realCupId = CupsConfig::ConvertCup_PulsarIdToRealId(pulsarCupId);
+    if (CupsConfig::IsRegCup(pulsarCupId)) return realCupId;
+    const u32 iconCount = CupsConfig::sInstance->definedCTsCupCount;
+    if (iconCount == 0) return kNoCupIconKey;
+    return 8 + realCupId % iconCount;
+}
+
+static TPLPalettePtr GetCupIcon(u32 key, LayoutUIControl &control) {
+    if (cupIcons == nullptr) {
+        cupIconCount = 8 + CupsConfig::sInstance->definedCTsCupCount;
+        cupIcons = new (System::sInstance->heap) CupIconCacheEntry[cupIconCount];
+        ResetCupIconCache();
+    }
+    if (key >= cupIconCount) return nullptr;
+    CupIconCacheEntry &entry = cupIcons[key];
+    if (entry.tpl == nullptr) {
+        char tplName[0x20];
+        if (key < 8)
+            snprintf(tplName, 0x20, "tt_cup_icon_%s_00.tpl", &Pages::CupSelect::cupTPLs[key][8]);
+        else
+            snprintf(tplName, 0x20, "icon_%03d.tpl", key - 8);
+        entry.tpl = GetTPLResource(control, tplName);
+    }
+    return entry.tpl;
+}
+
+void ExpCupSelect::PrefetchCupIcons(PulsarCupId firstId, u32 count, LayoutUIControl &control) {
+    const CupsConfig *cupsConfig = CupsConfig::sInstance;
+    PulsarCupId id = firstId;
+    for (u32 i = 0; i < count; ++i) {
+        const u32 key = GetCupIconKey(id);
+        if (key != kNoCupIconKey) GetCupIcon(key, control);
+        id = cupsConfig->GetNextCupId(id, 1);
+    }
+}
+
 void ExpCupSelect::UpdateCupData(PulsarCupId pulsarCupId, LayoutUIControl &control) {
     u32 bmgId;
-    char tplName[0x20];
     Text::Info info;
     u32 realCupId = CupsConfig::ConvertCup_PulsarIdToRealId(pulsarCupId);
+    const u32 iconKey = GetCupIconKey(pulsarCupId);
     if (CupsConfig::IsRegCup(pulsarCupId)) {
-        snprintf(tplName, 0x20, "tt_cup_icon_%s_00.tpl", &cupTPLs[realCupId][8]);
         bmgId = BMG_REGCUPS;
     } else {
-        u32 tplId = realCupId;
         u16 iconCount = static_cast<u16>(CupsConfig::sInstance->definedCTsCupCount);
         if (realCupId > iconCount - 1) {
             wchar_t cupName[0x20];
             swprintf(cupName, 0x20, L"Cup %d", realCupId);
             info.strings[0] = cupName;
-            tplId = tplId % iconCount;
             realCupId = 0;
             bmgId = BMG_TEXT;
         } else
             bmgId = BMG_CUPS;
-        snprintf(tplName, 0x20, "icon_%03d.tpl", tplId);
     }
     control.SetMessage(bmgId + realCupId, &info);
-    ChangeImage(control, "icon", tplName);
-    ChangeImage(control, "icon_light_01", tplName);
-    ChangeImage(control, "icon_light_02", tplName);
+    if (iconKey == kNoCupIconKey) {
+        char tplName[0x20];
+        snprintf(tplName, 0x20, "icon_%03d.tpl", CupsConfig::ConvertCup_PulsarIdToRealId(pulsarCupId));
+        ChangeImage(control, "icon", tplName);
+        ChangeImage(control, "icon_light_01", tplName);
+        ChangeImage(control, "icon_light_02", tplName);
+        return;
+    }
+    const TPLPalettePtr icon = GetCupIcon(iconKey, control);
+    ChangeImage(control, "icon", icon);
+    ChangeImage(control, "icon_light_01", icon);
+    ChangeImage(control, "icon_light_02", icon);
 }
 
 }  // namespace UI
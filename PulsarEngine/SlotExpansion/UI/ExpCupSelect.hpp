@@ -11,6 +11,7 @@ class ExpCupSelect : public Pages::CupSelect {
 public:
     ExpCupSelect();
     static void UpdateCupData(PulsarCupId id, LayoutUIControl &control);
+    static void PrefetchCupIcons(PulsarCupId firstId, u32 count, LayoutUIControl &control);
     void OnActivate() override;
     void AfterControlUpdate() override;
     UIControl *CreateControl(u32 controlId) override;
@@ -429,6 +429,8 @@ static void ExtCupSelectCupInitSelf(CtrlMenuCupSelectCup *cups) {
         buttons[i]->SetPlayerBitfield(SectionMgr::sInstance->curSection->Get<Pages::CupSelect>()->GetPlayerBitfield());
     }
     buttons[cupsConfig->lastSelectedCupButtonIdx]->SelectInitial(0);
+    // Resolve the icons of the neighbouring pages on section load so the first arrow presses hit the cache
+    ExpCupSelect::PrefetchCupIcons(cupsConfig->GetNextCupId(static_cast<PulsarCupId>(buttons[0]->buttonId), -8), 24, *buttons[0]);
 };
 kmWritePointer(0x808d324c, ExtCupSelectCupInitSelf);  // 807e5894
 
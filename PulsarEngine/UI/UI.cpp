@@ -35,6 +35,7 @@
 #include <UI/SelectStage/VariantSelect.hpp>
 #include <UI/TransmissionSelect/TransmissionSelect.hpp>
 #include <UI/VRLeaderboard/VRLeaderboard.hpp>
+#include <core/rvl/OS/OS.hpp>
 
 namespace Pulsar {
 namespace UI {
@@ -321,7 +322,7 @@ void ExpSection::SetNextPage(u32 id, u32 animDirection) {
 kmCall(0x8062314c, ExpSection::SetNextPage);
 
 // Various Util funcs
-void ChangeImage(LayoutUIControl &control, const char *paneName, const char *tplName) {
+TPLPalettePtr GetTPLResource(LayoutUIControl &control, const char *tplName) {
     TPLPalettePtr tplRes = static_cast<TPLPalettePtr>(control.layout.resources->multiArcResourceAccessor.GetResource(lyt::res::RESOURCETYPE_TEXTURE, tplName));
     if (tplRes == nullptr) {
         Section *section = SectionMgr::sInstance->curSection;
@@ -333,32 +334,44 @@ void ChangeImage(LayoutUIControl &control, const char *paneName, const char *tpl
             }
         }
     }
+    return tplRes;
+}
+
+void ChangeImage(LayoutUIControl &control, const char *paneName, TPLPalettePtr tplRes) {
     if (tplRes != nullptr) {
         lyt::Pane *pane = control.layout.GetPaneByName(paneName);
         if (pane) pane->GetMaterial()->GetTexMapAry()->ReplaceImage(tplRes);
     }
+}
+
+void ChangeImage(LayoutUIControl &control, const char *paneName, const char *tplName) {
+    ChangeImage(control, paneName, GetTPLResource(control, tplName));
 };
 
 // Implements the use of Pulsar's BMGHolder when needed
+// Build with -DBMG_LOOKUP_BENCHMARK to time the indexed lookup against the old linear scan every 600 frames.
 enum BMGType {
     BMG_NORMAL,
     CUSTOM_BMG,
 };
 BMGType isCustom;
 
+// MID1 ids are sorted, which the old linear scan relied on as well to stop early.
 static int GetMsgIdxByBmgId(const BMGHolder &bmg, s32 bmgId) {
     if (bmg.bmgFile == nullptr || bmg.messageIds == nullptr) return -1;
     const BMGMessageIds &msgIds = *bmg.messageIds;
-    int ret = -1;
-    for (int i = 0; i < msgIds.msgCount; ++i) {
-        int curBmgId = msgIds.messageIds[i];
-        if (curBmgId == bmgId) {
-            ret = i;
-            break;
-        } else if (curBmgId > bmgId)
-            break;
+    const u32 id = static_cast<u32>(bmgId);
+    u32 low = 0;
+    u32 high = msgIds.msgCount;
+    while (low < high) {
+        const u32 mid = (low + high) >> 1;
+        if (msgIds.messageIds[mid] < id)
+            low = mid + 1;
+        else
+            high = mid;
     }
-    return ret;
+    if (low == msgIds.msgCount || msgIds.messageIds[low] != id) return -1;
+    return low;
 }
 
 static const BMGHolder *matchedCustomBmg = nullptr;
@@ -384,23 +397,12 @@ static const BMGHolder *GetCharaNameBmg() {
     return &charaNameBmg;
 }
 
-static int GetMsgIdxById(const BMGHolder &normalHolder, s32 bmgId) {
-    int ret = GetMsgIdxByBmgId(System::sInstance->GetBMG(), bmgId);
+static int GetMsgIdxByIdIndexed(const BMGHolder &normalHolder, s32 bmgId) {
+    const BMGHolder *customHolder = nullptr;
+    int ret = System::sInstance->GetCustomMsgIdx(bmgId, customHolder);
     if (ret >= 0) {
         isCustom = CUSTOM_BMG;
-        matchedCustomBmg = &System::sInstance->GetBMG();
-        return ret;
-    }
-    ret = GetMsgIdxByBmgId(System::sInstance->GetBMGCT(), bmgId);
-    if (ret >= 0) {
-        isCustom = CUSTOM_BMG;
-        matchedCustomBmg = &System::sInstance->GetBMGCT();
-        return ret;
-    }
-    ret = GetMsgIdxByBmgId(System::sInstance->GetBMGBT(), bmgId);
-    if (ret >= 0) {
-        isCustom = CUSTOM_BMG;
-        matchedCustomBmg = &System::sInstance->GetBMGBT();
+        matchedCustomBmg = customHolder;
         return ret;
     }
     const BMGHolder *charaNameBmg = GetCharaNameBmg();
@@ -417,6 +419,83 @@ static int GetMsgIdxById(const BMGHolder &normalHolder, s32 bmgId) {
     ret = GetMsgIdxByBmgId(normalHolder, bmgId);
     return ret;
 }
+
+#ifdef BMG_LOOKUP_BENCHMARK
+// The pre-index lookup: an early-exit linear scan of each BMG in priority order.
+static int GetMsgIdxByBmgIdLinear(const BMGHolder &bmg, s32 bmgId, u32 &compares) {
+    if (bmg.bmgFile == nullptr || bmg.messageIds == nullptr) return -1;
+    const BMGMessageIds &msgIds = *bmg.messageIds;
+    for (int i = 0; i < msgIds.msgCount; ++i) {
+        ++compares;
+        const int curBmgId = msgIds.messageIds[i];
+        if (curBmgId == bmgId) return i;
+        if (curBmgId > bmgId) break;
+    }
+    return -1;
+}
+
+static int GetMsgIdxByIdLinear(const BMGHolder &normalHolder, s32 bmgId, const BMGHolder *&matched, u32 &compares) {
+    const System *system = System::sInstance;
+    const BMGHolder *holders[5] = {&system->GetBMG(), &system->GetBMGCT(), &system->GetBMGBT(), GetCharaNameBmg(), &normalHolder};
+    for (int i = 0; i < 5; ++i) {
+        if (holders[i] == nullptr) continue;
+        const int ret = GetMsgIdxByBmgIdLinear(*holders[i], bmgId, compares);
+        if (ret >= 0) {
+            matched = i == 4 ? nullptr : holders[i];
+            return ret;
+        }
+    }
+    matched = nullptr;
+    return -1;
+}
+
+struct BMGLookupBench {
+    u32 frames;
+    u32 lookups;
+    u32 maxLookupsPerFrame;
+    u32 frameLookups;
+    u64 indexedTicks;
+    u64 linearTicks;
+    u32 linearCompares;
+    u32 mismatches;
+};
+static BMGLookupBench bmgLookupBench;
+
+// Every lookup runs both paths so the two timings cover exactly the same ids; results must agree.
+static int GetMsgIdxById(const BMGHolder &normalHolder, s32 bmgId) {
+    BMGLookupBench &bench = bmgLookupBench;
+    const BMGHolder *linearMatch = nullptr;
+    const u64 linearStart = OS::GetTime();
+    const int linearRet = GetMsgIdxByIdLinear(normalHolder, bmgId, linearMatch, bench.linearCompares);
+    const u64 indexedStart = OS::GetTime();
+    const int ret = GetMsgIdxByIdIndexed(normalHolder, bmgId);
+    const u64 indexedEnd = OS::GetTime();
+    bench.linearTicks += indexedStart - linearStart;
+    bench.indexedTicks += indexedEnd - indexedStart;
+    ++bench.lookups;
+    ++bench.frameLookups;
+    if (ret != linearRet || (ret >= 0 && matchedCustomBmg != linearMatch)) ++bench.mismatches;
+    return ret;
+}
+
+static void ReportBMGLookupBench() {
+    BMGLookupBench &bench = bmgLookupBench;
+    if (bench.frameLookups > bench.maxLookupsPerFrame) bench.maxLookupsPerFrame = bench.frameLookups;
+    bench.frameLookups = 0;
+    if (++bench.frames < 600) return;
+    if (bench.lookups != 0) {
+        OS::Report("[Pulsar] BMG lookups: %u over %u frames (peak %u/frame), indexed %uus, linear %uus (%u compares), %u mismatches\n",
+                   bench.lookups, bench.frames, bench.maxLookupsPerFrame, OS::TicksToMicroseconds(bench.indexedTicks),
+                   OS::TicksToMicroseconds(bench.linearTicks), bench.linearCompares, bench.mismatches);
+    }
+    bench = BMGLookupBench();
+}
+static FrameLoadHook BMGLookupBenchHook(ReportBMGLookupBench);
+#else
+static int GetMsgIdxById(const BMGHolder &normalHolder, s32 bmgId) {
+    return GetMsgIdxByIdIndexed(normalHolder, bmgId);
+}
+#endif
 kmBranch(0x805f8c88, GetMsgIdxById);
 
 wchar_t *GetMsgByMsgIdx(const BMGHolder &bmg, s32 msgIdx) {
@@ -2,12 +2,15 @@
 #define _PULUI_
 #include <MarioKartWii/UI/Section/SectionMgr.hpp>
 #include <MarioKartWii/UI/Ctrl/UIControl.hpp>
+#include <core/rvl/tpl.hpp>
 #include <Settings/SettingsParam.hpp>
 
 namespace Pulsar {
 namespace UI {
 
 void ChangeImage(LayoutUIControl &control, const char *paneName, const char *tplName);
+void ChangeImage(LayoutUIControl &control, const char *paneName, TPLPalettePtr tplRes);
+TPLPalettePtr GetTPLResource(LayoutUIControl &control, const char *tplName);  // searches the control's archives, then the section's
 const wchar_t *GetCustomMsg(s32 bmgId);
 void UnbindRLMC(lyt::Material *mat);
 void ResetMatColor(lyt::Pane *pane, u32 color);
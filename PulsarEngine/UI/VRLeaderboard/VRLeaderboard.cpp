@@ -14,8 +14,6 @@
 #include <core/RK/RKSystem.hpp>
 #include <core/egg/mem/Heap.hpp>
 #include <core/rvl/DWC/DWCAccount.hpp>
-#include <core/rvl/NHTTP/NHTTP.hpp>
-#include <core/rvl/DWC/NHTTP.hpp>
 #include <core/rvl/OS/OS.hpp>
 #include <core/nw4r/lyt/TextBox.hpp>
 #include <include/c_stdio.h>
@@ -26,13 +24,6 @@
 
 kmWrite32(0x800c9980, 0x4800000c);  // b 0x800c998c
 
-static void NHTTPConfigureHttpsForRequest(void *request) {
-    if (request == nullptr) return;
-    typedef s32 (*Fn)(void *, ...);
-    (reinterpret_cast<Fn>(&NHTTPSetRootCADefault))(request);
-    (reinterpret_cast<Fn>(&NHTTPSetVerifyOption))(request, 1);
-}
-
 namespace Pulsar {
 namespace UI {
 
@@ -97,7 +88,6 @@ static wchar_t s_rowTextDash[] = L"----";
 static wchar_t s_rowLabelVR[] = L"VR";
 static wchar_t s_rowBlank[] = L"";
 static u64 s_requestStartTime = 0;
-static bool s_nhttpStarted = false;
 static const u32 s_nhttpWorkBufSize = 0x20000;
 static u32 s_requestGeneration = 0;
 static u64 s_currentUserFriendCode = 0;
@@ -106,16 +96,17 @@ static u32 s_loadedAPIPage = 0;
 static s32 s_loadedEntryCount = 0;
 
 static const u32 s_requestTimeoutMs = 45000;
+static const u32 s_cacheMaxAgeSec = 60;  // reopening the page or paging back within a minute needs no download
 
 struct NHTTPRequestCtx {
     u32 generation;
     u32 apiPage;
 };
 
-// This page only issues a new request after the prior one has completed, so a single
-// persistent request context/work buffer avoids lifetime bugs without affecting boot.
+// This page only issues a new request after the prior one has completed or was cancelled, so a single
+// persistent request context is enough.
 static NHTTPRequestCtx s_requestCtx;
-static void *s_requestWorkBuf = nullptr;
+static Network::HttpRequestId s_requestId = 0;
 static char s_requestUrl[256];
 
 static u32 GetAPIPageForInGamePage(u32 inGamePage) {
@@ -158,68 +149,6 @@ static void ClearLeaderboardRow(LayoutUIControl &row, wchar_t *nameText) {
     SetPaneVisibleIfPresent(row, "chara_icon_sha", false);
 }
 
-static unsigned char ParseJsonEscape(const char *&p) {
-    const unsigned char esc = static_cast<unsigned char>(*p++);
-    if (esc == '\0') return '?';
-    switch (esc) {
-        case '"':
-        case '\\':
-        case '/':
-            return esc;
-        case 'b':
-            return '\b';
-        case 'f':
-            return '\f';
-        case 'n':
-            return '\n';
-        case 'r':
-            return '\r';
-        case 't':
-            return '\t';
-        case 'u':
-            for (int i = 0; i < 4 && *p != '\0'; ++i) ++p;
-            return '?';
-        default:
-            return '?';
-    }
-}
-
-static const char *ParseJsonStringIntoWide(const char *p, wchar_t *out, size_t outLen) {
-    if (out == nullptr || outLen == 0) return nullptr;
-    out[0] = L'\0';
-    p = Network::Json::SkipWhitespace(p);
-    if (p == nullptr || *p != '"') return nullptr;
-    ++p;
-
-    size_t o = 0;
-    while (*p != '\0' && *p != '"') {
-        unsigned char c = static_cast<unsigned char>(*p++);
-        if (c == '\\') c = ParseJsonEscape(p);
-        if (o + 1 < outLen) out[o++] = (c < 0x80) ? static_cast<wchar_t>(c) : L'?';
-    }
-    if (*p == '"') ++p;
-    out[o] = L'\0';
-    return p;
-}
-
-static const char *ParseJsonStringIntoAscii(const char *p, char *out, size_t outLen) {
-    if (out == nullptr || outLen == 0) return nullptr;
-    out[0] = '\0';
-    p = Network::Json::SkipWhitespace(p);
-    if (p == nullptr || *p != '"') return nullptr;
-    ++p;
-
-    size_t o = 0;
-    while (*p != '\0' && *p != '"') {
-        unsigned char c = static_cast<unsigned char>(*p++);
-        if (c == '\\') c = ParseJsonEscape(p);
-        if (o + 1 < outLen) out[o++] = static_cast<char>(c);
-    }
-    if (*p == '"') ++p;
-    out[o] = '\0';
-    return p;
-}
-
 static int Base64CharValue(char c) {
     if (c >= 'A' && c <= 'Z') return c - 'A';
     if (c >= 'a' && c <= 'z') return c - 'a' + 26;
@@ -230,14 +159,14 @@ static int Base64CharValue(char c) {
     return -1;
 }
 
-static int DecodeBase64(const char *in, u8 *out, int outCap) {
+static int DecodeBase64(const char *in, u32 inLen, u8 *out, int outCap) {
     if (in == nullptr || out == nullptr || outCap <= 0) return 0;
 
     int outLen = 0;
     int buf[4];
     int bufCount = 0;
 
-    for (const char *p = in; *p != '\0'; ++p) {
+    for (const char *p = in; p < in + inLen; ++p) {
         const char c = *p;
         if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
 
@@ -285,49 +214,6 @@ static void ExtractMiiNameFromStoreData(const RFL::StoreData *storeData, wchar_t
     outName[o] = L'\0';
 }
 
-static const char *FindStrInRange(const char *start, const char *end, const char *needle) {
-    if (start == nullptr || end == nullptr || needle == nullptr) return nullptr;
-    const size_t needleLen = strlen(needle);
-    if (needleLen == 0) return start;
-    for (const char *p = start; p + needleLen <= end; ++p) {
-        if (strncmp(p, needle, needleLen) == 0) return p;
-    }
-    return nullptr;
-}
-
-static const char *FindMatchingObjectEnd(const char *objStart) {
-    if (objStart == nullptr || *objStart != '{') return nullptr;
-    int depth = 0;
-    bool inString = false;
-    bool escape = false;
-    for (const char *p = objStart; *p != '\0'; ++p) {
-        const char c = *p;
-        if (inString) {
-            if (escape) {
-                escape = false;
-                continue;
-            }
-            if (c == '\\') {
-                escape = true;
-                continue;
-            }
-            if (c == '"') inString = false;
-            continue;
-        }
-        if (c == '"') {
-            inString = true;
-            continue;
-        }
-        if (c == '{') {
-            ++depth;
-        } else if (c == '}') {
-            --depth;
-            if (depth == 0) return p;
-        }
-    }
-    return nullptr;
-}
-
 static bool IsFriendCodeInLicenseFriends(u64 friendCode) {
     if (friendCode == 0) return false;
     RKSYS::Mgr *rksysMgr = RKSYS::Mgr::sInstance;
@@ -414,7 +300,6 @@ void VRLeaderboardPage::OnActivate() {
     this->curPage = 0;
     s_hasApplied = false;
     s_fetchState = FETCH_IDLE;
-    s_nhttpStarted = false;
     s_loadedAPIPage = 0;
     s_loadedEntryCount = 0;
     ResetRowsToLoading();
@@ -435,6 +320,8 @@ void VRLeaderboardPage::OnActivate() {
 }
 
 void VRLeaderboardPage::OnDeactivate() {
+    Network::CancelHttpRequest(s_requestId);
+    s_requestId = 0;
     ++s_requestGeneration;
     s_fetchState = FETCH_IDLE;
     s_hasApplied = false;
@@ -457,6 +344,8 @@ void VRLeaderboardPage::OnUpdate() {
         const u64 now = OS::GetTime();
         const u32 elapsedMs = OS::TicksToMilliseconds(now - s_requestStartTime);
         if (elapsedMs > s_requestTimeoutMs) {
+            Network::CancelHttpRequest(s_requestId);
+            s_requestId = 0;
             s_fetchState = FETCH_ERROR;
             s_hasApplied = false;
         }
@@ -655,94 +544,35 @@ void VRLeaderboardPage::StartFetch(VRLeaderboardPage *page) {
 
     memset(s_entries, 0, sizeof(Entry) * kMaxEntries);
 
-    if (!Network::PreparePersistentNHTTPRequest(s_nhttpStarted)) {
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-
     NHTTPRequestCtx *ctx = &s_requestCtx;
     ctx->generation = s_requestGeneration;
     ctx->apiPage = apiPage;
-    if (s_requestWorkBuf == nullptr) {
-        s_requestWorkBuf = Network::NHTTPAlloc(s_nhttpWorkBufSize, 0x20);
-        if (s_requestWorkBuf == nullptr) {
-            s_fetchState = FETCH_ERROR;
-            return;
-        }
-    }
-    memset(s_requestWorkBuf, 0, s_nhttpWorkBufSize);
 
     snprintf(s_requestUrl, sizeof(s_requestUrl), "http://rwfc.net/api/leaderboard/in-game?page=%u", apiPage);
 
-    void *request = NHTTPCreateRequest(s_requestUrl, 0, s_requestWorkBuf, s_nhttpWorkBufSize,
-                                       reinterpret_cast<void *>(&VRLeaderboardPage::OnLeaderboardReceived),
-                                       ctx);
-    if (request == nullptr) {
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-
-    if (strncmp(s_requestUrl, "https://", 8) == 0) {
-        NHTTPConfigureHttpsForRequest(request);
-    }
-    const s32 sendRet = NHTTPSendRequestAsync(request);
-    if (sendRet < 0) {
-        s_nhttpStarted = false;
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-    Network::MarkNHTTPRequestActive();
+    Network::HttpRequestParams params;
+    params.url = s_requestUrl;
+    params.priority = Network::HTTP_PRIORITY_INTERACTIVE;
+    params.bufferSize = s_nhttpWorkBufSize;
+    params.cacheMaxAgeSec = s_cacheMaxAgeSec;
+    params.callback = &VRLeaderboardPage::OnLeaderboardReceived;
+    params.userdata = ctx;
+    s_requestId = Network::QueueHttpRequest(params);
+    if (s_requestId == 0) s_fetchState = FETCH_ERROR;
 }
 
-void VRLeaderboardPage::OnLeaderboardReceived(s32 result, void *response, void *userdata) {
-    Network::FinishNHTTPRequest();
+void VRLeaderboardPage::OnLeaderboardReceived(s32 result, const char *body, u32 bodyLen, void *userdata) {
     NHTTPRequestCtx *ctx = reinterpret_cast<NHTTPRequestCtx *>(userdata);
+    if (ctx == nullptr || ctx->generation != s_requestGeneration) return;
 
-    if (ctx == nullptr || ctx->generation != s_requestGeneration) {
-        if (response != nullptr) NHTTPDestroyResponse(response);
-        return;
-    }
-
-    if (response == nullptr) {
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-    if (s_entries == nullptr) {
-        NHTTPDestroyResponse(response);
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-
-    if (result != 0) {
-        NHTTPDestroyResponse(response);
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-
-    char *body = nullptr;
-    int bodyLen = NHTTP::GetBodyAll(reinterpret_cast<NHTTP::Res *>(response), &body);
-    if (body == nullptr || bodyLen <= 0) {
-        NHTTPDestroyResponse(response);
+    if (s_entries == nullptr || result != 0 || body == nullptr) {
         s_fetchState = FETCH_ERROR;
         return;
     }
 
-    const u32 responseBufSize = static_cast<u32>(bodyLen) + 1;
-    char *responseBuf = reinterpret_cast<char *>(Network::NHTTPAlloc(responseBufSize, 4));
-    if (responseBuf == nullptr) {
-        NHTTPDestroyResponse(response);
-        s_fetchState = FETCH_ERROR;
-        return;
-    }
-
-    memcpy(responseBuf, body, bodyLen);
-    responseBuf[bodyLen] = '\0';
-
-    NHTTPDestroyResponse(response);
     s_loadedAPIPage = ctx->apiPage;
 
-    const int parsed = ParseResponse(responseBuf, s_entries, kMaxEntries);
-    Network::NHTTPFree(responseBuf);
+    const int parsed = ParseResponse(body, bodyLen, s_entries, kMaxEntries);
     if (parsed <= 0) {
         s_fetchState = FETCH_ERROR;
         s_loadedEntryCount = 0;
@@ -756,99 +586,149 @@ void VRLeaderboardPage::OnLeaderboardReceived(s32 result, void *response, void *
     s_hasApplied = false;
 }
 
-int VRLeaderboardPage::ParseResponse(const char *json, Entry *outEntries, int maxEntries) {
-    if (json == nullptr || outEntries == nullptr || maxEntries <= 0) return 0;
-
-    const char *p = strchr(json, '[');
-    if (p == nullptr) return 0;
+// Fills one Entry per object of the first array in the response; the fields of an object may come in any order
+class VRLeaderboardPage::ResponseHandler : public Network::Json::Handler {
+public:
+    ResponseHandler(Entry *entries, int maxEntries)
+        : entries(entries), maxEntries(maxEntries), count(0), listDepth(0), hasList(false), nameFromMii(false),
+          field(FIELD_NONE) {}
 
-    ++p;
+    int GetCount() const { return this->count; }
 
-    int count = 0;
-
-    while (*p != '\0' && count < maxEntries) {
-        while (*p != '\0' && *p != '{' && *p != ']') ++p;
-        if (*p == ']' || *p == '\0') break;
-
-        const char *objStart = p;
-        const char *objEnd = FindMatchingObjectEnd(objStart);
-        if (objEnd == nullptr) break;
-
-        outEntries[count].name[0] = L'\0';
-        outEntries[count].vr = 0;
-        outEntries[count].rank = 0;
-        outEntries[count].friendCode = 0;
-        memset(&outEntries[count].miiData, 0, sizeof(outEntries[count].miiData));
-
-        const char *miiKey = FindStrInRange(objStart, objEnd, "\"miiData\"");
-        const char *nameKey = FindStrInRange(objStart, objEnd, "\"name\"");
-        const char *vrKey = FindStrInRange(objStart, objEnd, "\"vr\"");
-        const char *rankKey = FindStrInRange(objStart, objEnd, "\"rank\"");
-        const char *friendCodeKey = FindStrInRange(objStart, objEnd, "\"friendCode\"");
-        if (friendCodeKey == nullptr) {
-            friendCodeKey = FindStrInRange(objStart, objEnd, "\"friend_code\"");
+    bool OnArrayBegin(u32 depth) override {
+        this->field = FIELD_NONE;
+        if (!this->hasList) {
+            this->hasList = true;
+            this->listDepth = depth + 1;
         }
-
-        if (miiKey != nullptr) {
-            const char *colon = FindStrInRange(miiKey, objEnd, ":");
-            if (colon != nullptr) {
-                char miiB64[192];
-                (void)ParseJsonStringIntoAscii(colon + 1, miiB64, sizeof(miiB64));
-                DecodeBase64(miiB64, reinterpret_cast<u8 *>(&outEntries[count].miiData), sizeof(outEntries[count].miiData));
-                ExtractMiiNameFromStoreData(&outEntries[count].miiData, outEntries[count].name,
-                                            sizeof(outEntries[count].name) / sizeof(outEntries[count].name[0]));
+        return true;
+    }
+
+    // Anything after the list is of no interest
+    bool OnArrayEnd(u32 depth) override { return depth + 1 != this->listDepth; }
+
+    bool OnObjectBegin(u32 depth) override {
+        this->field = FIELD_NONE;
+        if (!this->IsEntryDepth(depth)) return true;
+        Entry &entry = this->entries[this->count];
+        entry.name[0] = L'\0';
+        entry.vr = 0;
+        entry.rank = 0;
+        entry.friendCode = 0;
+        memset(&entry.miiData, 0, sizeof(entry.miiData));
+        this->nameFromMii = false;
+        return true;
+    }
+
+    bool OnObjectEnd(u32 depth) override {
+        if (!this->IsEntryDepth(depth)) return true;
+        if (this->entries[this->count].name[0] != L'\0') ++this->count;
+        return this->count < this->maxEntries;
+    }
+
+    bool OnKey(const Network::Json::StringRef &key, u32 depth) override {
+        this->field = FIELD_NONE;
+        if (!this->IsEntryDepth(depth - 1)) return true;
+        if (key.Equals("miiData")) this->field = FIELD_MII_DATA;
+        else if (key.Equals("name")) this->field = FIELD_NAME;
+        else if (key.Equals("vr")) this->field = FIELD_VR;
+        else if (key.Equals("rank")) this->field = FIELD_RANK;
+        else if (key.Equals("friendCode") || key.Equals("friend_code")) this->field = FIELD_FRIEND_CODE;
+        return true;
+    }
+
+    bool OnString(const Network::Json::StringRef &value, u32 /*depth*/) override {
+        Entry &entry = this->entries[this->count];
+        const size_t nameLen = sizeof(entry.name) / sizeof(entry.name[0]);
+        switch (this->field) {
+            case FIELD_MII_DATA:
+                this->ReadMiiData(value, entry);
+                break;
+            case FIELD_NAME:
+                if (!this->nameFromMii) value.CopyWide(entry.name, nameLen);
+                break;
+            case FIELD_FRIEND_CODE: {
+                // Friend codes sent as strings may be grouped, only the digits count
+                u64 friendCode = 0;
+                for (u32 i = 0; i < value.length; ++i) {
+                    const char c = value.data[i];
+                    if (c >= '0' && c <= '9') friendCode = friendCode * 10 + static_cast<u64>(c - '0');
+                }
+                entry.friendCode = friendCode;
+                break;
             }
+            default:
+                break;
         }
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-        if (outEntries[count].name[0] == L'\0' && nameKey != nullptr) {
-            const char *colon = FindStrInRange(nameKey, objEnd, ":");
-            if (colon != nullptr) {
-                (void)ParseJsonStringIntoWide(colon + 1, outEntries[count].name,
-                                              sizeof(outEntries[count].name) / sizeof(outEntries[count].name[0]));
-            }
-        }
+    bool OnNumber(const Network::Json::NumberRef &value, u32 /*depth*/) override {
+        Entry &entry = this->entries[this->count];
+        if (this->field == FIELD_VR) value.ToU32(entry.vr);
+        else if (this->field == FIELD_RANK) value.ToU32(entry.rank);
+        else if (this->field == FIELD_FRIEND_CODE) value.ToU64(entry.friendCode);
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-        if (vrKey != nullptr) {
-            const char *colon = FindStrInRange(vrKey, objEnd, ":");
-            if (colon != nullptr) {
-                Network::Json::ParseU32(colon + 1, outEntries[count].vr);
-            }
-        }
+    bool OnBool(bool /*value*/, u32 /*depth*/) override {
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-        if (rankKey != nullptr) {
-            const char *colon = FindStrInRange(rankKey, objEnd, ":");
-            if (colon != nullptr) {
-                Network::Json::ParseU32(colon + 1, outEntries[count].rank);
-            }
-        }
+    bool OnNull(u32 /*depth*/) override {
+        this->field = FIELD_NONE;
+        return true;
+    }
 
-        if (friendCodeKey != nullptr) {
-            const char *colon = FindStrInRange(friendCodeKey, objEnd, ":");
-            if (colon != nullptr) {
-                colon = Network::Json::SkipWhitespace(colon + 1);
-                if (colon != nullptr && *colon == '"') {
-                    char fcStr[32];
-                    ParseJsonStringIntoAscii(colon, fcStr, sizeof(fcStr));
-                    u64 friendCodeValue = 0;
-                    for (const char *fc = fcStr; *fc != '\0'; ++fc) {
-                        if (*fc >= '0' && *fc <= '9') {
-                            friendCodeValue = friendCodeValue * 10 + static_cast<u64>(*fc - '0');
-                        }
-                    }
-                    outEntries[count].friendCode = friendCodeValue;
-                } else {
-                    Network::Json::ParseU64(colon, outEntries[count].friendCode);
-                }
-            }
-        }
+private:
+    enum Field {
+        FIELD_NONE,
+        FIELD_MII_DATA,
+        FIELD_NAME,
+        FIELD_VR,
+        FIELD_RANK,
+        FIELD_FRIEND_CODE
+    };
+
+    bool IsEntryDepth(u32 depth) const { return this->hasList && depth == this->listDepth; }
 
-        if (outEntries[count].name[0] != L'\0') {
-            ++count;
+    // The Mii's own name wins over the "name" field, whichever comes first
+    void ReadMiiData(const Network::Json::StringRef &value, Entry &entry) {
+        u8 *miiData = reinterpret_cast<u8 *>(&entry.miiData);
+        if (!value.hasEscapes) {
+            DecodeBase64(value.data, value.length, miiData, sizeof(entry.miiData));
+        } else {
+            char miiB64[192];
+            const u32 miiB64Len = value.CopyAscii(miiB64, sizeof(miiB64));
+            DecodeBase64(miiB64, miiB64Len, miiData, sizeof(entry.miiData));
         }
 
-        p = objEnd + 1;
+        wchar_t miiName[11];
+        ExtractMiiNameFromStoreData(&entry.miiData, miiName, sizeof(miiName) / sizeof(miiName[0]));
+        if (miiName[0] == L'\0') return;
+        memcpy(entry.name, miiName, sizeof(miiName));
+        this->nameFromMii = true;
     }
-    return count;
+
+    Entry *entries;
+    int maxEntries;
+    int count;
+    u32 listDepth;
+    bool hasList;
+    bool nameFromMii;
+    Field field;
+};
+
+int VRLeaderboardPage::ParseResponse(const char *json, u32 jsonLen, Entry *outEntries, int maxEntries) {
+    if (json == nullptr || outEntries == nullptr || maxEntries <= 0) return 0;
+
+    // A malformed tail only costs the entries past it
+    ResponseHandler handler(outEntries, maxEntries);
+    Network::Json::Parse(json, jsonLen, handler);
+    return handler.GetCount();
 }
 
 void VRLeaderboardPage::OverrideOwnMiiData(Entry *entries, int entryCount, u64 ownFriendCode) {
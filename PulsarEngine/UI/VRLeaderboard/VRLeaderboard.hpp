@@ -52,10 +52,11 @@ private:
         RFL::StoreData miiData;
         u64 friendCode;
     };
+    class ResponseHandler;
 
-    static void OnLeaderboardReceived(s32 result, void *response, void *userdata);
+    static void OnLeaderboardReceived(s32 result, const char *body, u32 bodyLen, void *userdata);
     static void StartFetch(VRLeaderboardPage *page);
-    static int ParseResponse(const char *json, Entry *outEntries, int maxEntries);
+    static int ParseResponse(const char *json, u32 jsonLen, Entry *outEntries, int maxEntries);
     static void OverrideOwnMiiData(Entry *entries, int entryCount, u64 ownFriendCode);
 
     static FetchState s_fetchState;
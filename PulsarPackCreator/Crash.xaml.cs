@@ -102,7 +102,29 @@ namespace Pulsar_Pack_Creator
             bool hasPatchFiles = rawFile.extra.looseOverrideFileCount > 0;
             string myStuff = GetMyStuffState(rawFile.extra.version, rawFile.extra.myStuffState);
 
-            return $"\n\nSection: {section}\nPage: {page}\nLast Track SZS: {lastTrackSzs}\nContexts: {contexts}\nCustom Character Enabled: {customCharacterEnabled}\nMy Stuff: {myStuff}\nPatches Enabled: {looseOverridesEnabled}\nPatches Folder Has Files: {hasPatchFiles} ({rawFile.extra.looseOverrideFileCount})\n\n";
+            return $"\n\nSection: {section}\nPage: {page}\nLast Track SZS: {lastTrackSzs}\nContexts: {contexts}\nCustom Character Enabled: {customCharacterEnabled}\nMy Stuff: {myStuff}\nPatches Enabled: {looseOverridesEnabled}\nPatches Folder Has Files: {hasPatchFiles} ({rawFile.extra.looseOverrideFileCount})\n{BuildFrameTimes(rawFile.extra)}\n";
+        }
+
+        private static string BuildFrameTimes(PulsarGame.CrashExtra extra)
+        {
+            if (extra.version < 4 || extra.frameCount == 0) return "";
+            string recent = "";
+            for (int i = 0; i < extra.recentFrameTotalUs.Length; i++)
+            {
+                if (extra.recentFrameTotalUs[i] == 0) continue;
+                recent += $" {extra.recentFrameCpuUs[i] / 1000.0:F1}/{extra.recentFrameTotalUs[i] / 1000.0:F1}";
+            }
+            return $"Frames: {extra.frameCount}\n" +
+                $"CPU p50/p95/p99: {FormatMs(extra.frameCpuUs)}\n" +
+                $"Wait p50/p95/p99: {FormatMs(extra.frameWaitUs)}\n" +
+                $"Frame p50/p95/p99: {FormatMs(extra.frameTotalUs)} (max {extra.frameMaxTotalUs / 1000.0:F1}ms)\n" +
+                $"Lag Corrections: {extra.lagCorrections} ({extra.lagFramesCorrected} frames)\n" +
+                $"Last Frames (CPU/Frame ms):{recent}\n";
+        }
+
+        private static string FormatMs(uint[] us)
+        {
+            return $"{us[0] / 1000.0:F1}/{us[1] / 1000.0:F1}/{us[2] / 1000.0:F1}ms";
         }
 
         private static string GetMyStuffState(uint version, uint myStuffState)
@@ -432,6 +432,24 @@ public class PulsarGame
         public uint myStuffState;
         [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 64)]
         public string lastTrackSzs;
+        [Endian(Endianness.BigEndian)]
+        public uint frameCount;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 3), Endian(Endianness.BigEndian)]
+        public uint[] frameCpuUs;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 3), Endian(Endianness.BigEndian)]
+        public uint[] frameWaitUs;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 3), Endian(Endianness.BigEndian)]
+        public uint[] frameTotalUs;
+        [Endian(Endianness.BigEndian)]
+        public uint frameMaxTotalUs;
+        [Endian(Endianness.BigEndian)]
+        public uint lagCorrections;
+        [Endian(Endianness.BigEndian)]
+        public uint lagFramesCorrected;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32), Endian(Endianness.BigEndian)]
+        public ushort[] recentFrameCpuUs;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32), Endian(Endianness.BigEndian)]
+        public ushort[] recentFrameTotalUs;
     }
 
     [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi, Pack = 1)]
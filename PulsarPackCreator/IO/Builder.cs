@@ -6,6 +6,7 @@ using System.Drawing;
 using System.IO;
 using System.Linq;
 using System.Runtime.InteropServices;
+using System.Text;
 using static Pulsar_Pack_Creator.MainWindow;
 
 namespace Pulsar_Pack_Creator.IO {
@@ -55,6 +56,8 @@ namespace Pulsar_Pack_Creator.IO {
         PulsarGame.CupsHolderV3 cupsSection = new PulsarGame.CupsHolderV3(cupsMagic, CUPSVERSION);
         List<PulsarGame.TrackV3> mainTracksList = new List<PulsarGame.TrackV3>();
         List<PulsarGame.Variant> variantTracksList = new List<PulsarGame.Variant>();
+        // Same (variantIdx << 12) + idx keys as the FILE text, packed into the FNAM section the game reads directly.
+        SortedDictionary<uint, string> packedFileNames = new SortedDictionary<uint, string>();
         // List<(string, int)> stringPool = new List<(string, int)>();
 
         public Result Build() {
@@ -100,6 +103,7 @@ namespace Pulsar_Pack_Creator.IO {
                     {
                         bmgSW.WriteLine(bmgSW.NewLine);
                         fileSW.WriteLine("FILE");
+                        packedFileNames.Clear();
 
                         Result infoRet = WriteInfo();
                         if (infoRet != Result.Success)
@@ -221,6 +225,7 @@ namespace Pulsar_Pack_Creator.IO {
                         }
                     }
                     bin.Write(bmgReader.ReadBytes((int)bmgReader.BaseStream.Length));
+                    bin.Write(BuildFileNamesSection());
                     bin.Write(fileSectStream.ToArray());
 
                 }  // using memorystream
@@ -479,9 +484,45 @@ namespace Pulsar_Pack_Creator.IO {
 
             fileSW.WriteLine($"{(variantIdx << 12) + idx:X}={variant.fileName}|" +
                              $"{expertFileNames[0]}|{expertFileNames[1]}|{expertFileNames[2]}|{expertFileNames[3]}");
+            packedFileNames[(variantIdx << 12) + idx] = variant.fileName;
             return Result.Success;
         }
 
+        // FNAM: SectionHeader, entry count, pool size, {key, name offset} entries, then a NUL-terminated string pool.
+        private byte[] BuildFileNamesSection() {
+            using MemoryStream pool = new MemoryStream();
+            Dictionary<string, uint> pooledNames = new Dictionary<string, uint>();
+            List<(uint, uint)> entries = new List<(uint, uint)>();
+            foreach (KeyValuePair<uint, string> fileName in packedFileNames) {
+                if (string.IsNullOrEmpty(fileName.Value))
+                    continue;
+                if (!pooledNames.TryGetValue(fileName.Value, out uint nameOffset)) {
+                    nameOffset = (uint)pool.Length;
+                    pool.Write(Encoding.UTF8.GetBytes(fileName.Value));
+                    pool.WriteByte(0);
+                    pooledNames.Add(fileName.Value, nameOffset);
+                }
+                entries.Add((fileName.Key, nameOffset));
+            }
+            while (pool.Length % 4 != 0)
+                pool.WriteByte(0);
+
+            using MemoryStream section = new MemoryStream();
+            using (BigEndianWriter sectionWriter = new BigEndianWriter(section)) {
+                sectionWriter.Write(fileNamesMagic);
+                sectionWriter.Write(FILENAMESVERSION);
+                sectionWriter.Write((uint)(0x14 + entries.Count * 8 + pool.Length));
+                sectionWriter.Write((uint)entries.Count);
+                sectionWriter.Write((uint)pool.Length);
+                foreach ((uint key, uint nameOffset) in entries) {
+                    sectionWriter.Write(key);
+                    sectionWriter.Write(nameOffset);
+                }
+                sectionWriter.Write(pool.ToArray());
+            }
+            return section.ToArray();
+        }
+
         private void WriteBMG(uint bmgId, string content) {
             generatedBMGIds.Add(bmgId);
             bmgSW.WriteLine($"  {bmgId:X}    = {content}");
@@ -56,6 +56,7 @@ namespace Pulsar_Pack_Creator.IO
         protected const int cupsMagic = 0x43555053;
         protected const int textMagic = 0x54455854;
         protected const int fileMagic = 0x46494C45;
+        protected const int fileNamesMagic = 0x464E414D;
         protected const ulong bmgMagic = 0x4D455347626D6731;
 
         protected static string wiimmFolderPath = "";
@@ -65,6 +66,7 @@ namespace Pulsar_Pack_Creator.IO
         protected static readonly uint INFOVERSION = 1;
         protected static readonly uint CUPSVERSION = 3;
         protected static readonly uint TEXTVERSION = 1;
+        protected static readonly uint FILENAMESVERSION = 1;
 
         public string error;
         public static CancellationTokenSource cancelToken = new CancellationTokenSource();
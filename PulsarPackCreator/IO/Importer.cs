@@ -224,6 +224,14 @@ namespace Pulsar_Pack_Creator.IO
             using (BigEndianReader bin = new BigEndianReader(new MemoryStream(raw)))
             {
                 uint magic = bin.ReadUInt32();
+                if (magic == fileNamesMagic)
+                {
+                    // Packed FNAM section (game-side lookup only); the text FILE block right after it is what gets imported.
+                    bin.ReadUInt32(); // version
+                    uint size = bin.ReadUInt32();
+                    bin.BaseStream.Position = size;
+                    magic = bin.ReadUInt32();
+                }
                 if (magic != fileMagic) return Result.BadFile;
                 bin.BaseStream.Position -= 4;
                 using (BigEndianWriter file = new BigEndianWriter(File.Create("temp/files.txt")))
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+# Builds the host JSON tokenizer harness (scripts/json_host) into build/host with the system compiler.
+#   scripts/build_json_host.sh            optimised build for "bench"
+#   scripts/build_json_host.sh --asan     address and undefined behaviour sanitizers, for "check" and "fuzz"
+#   scripts/build_json_host.sh --fuzz     libFuzzer target, needs clang; run build/host/json_fuzz scripts/json_host/corpus
+
+set -euo pipefail
+
+SCRIPT_DIR=$(cd -- "$(dirname -- "${BASH_SOURCE[0]}")" &>/dev/null && pwd)
+BASE_DIR="$SCRIPT_DIR/.."
+
+cd "$BASE_DIR"
+
+OUT_DIR=build/host
+SRCS=(scripts/json_host/json_host.cpp PulsarEngine/Network/Json.cpp)
+FLAGS=(-std=c++11 -Wall -Wextra -Wno-unknown-pragmas -IKamekInclude -IPulsarEngine)
+
+mkdir -p "$OUT_DIR"
+
+case "${1:-}" in
+    --asan)
+        "${CXX:-g++}" "${FLAGS[@]}" -O1 -g -fno-omit-frame-pointer -fsanitize=address,undefined -o "$OUT_DIR/json_host" "${SRCS[@]}"
+        ;;
+    --fuzz)
+        "${CXX:-clang++}" "${FLAGS[@]}" -O1 -g -fsanitize=fuzzer,address,undefined -DJSON_HOST_LIBFUZZER -o "$OUT_DIR/json_fuzz" "${SRCS[@]}"
+        ;;
+    "")
+        "${CXX:-g++}" "${FLAGS[@]}" -O2 -o "$OUT_DIR/json_host" "${SRCS[@]}"
+        ;;
+    *)
+        echo "usage: $0 [--asan | --fuzz]"
+        exit 2
+        ;;
+esac
@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Builds the host loose override patcher harness (scripts/loose_override_host) into build/host with the system compiler.
+#   scripts/build_loose_override_host.sh            optimised build for "bench"
+#   scripts/build_loose_override_host.sh --asan     address and undefined behaviour sanitizers, for "check" and "fuzz"
+#   scripts/build_loose_override_host.sh --fuzz     libFuzzer target, needs clang; run build/host/loose_override_fuzz
+# The corpus in scripts/loose_override_host/corpus is regenerated with scripts/loose_override_host/make_corpus.py.
+
+set -euo pipefail
+
+SCRIPT_DIR=$(cd -- "$(dirname -- "${BASH_SOURCE[0]}")" &>/dev/null && pwd)
+BASE_DIR="$SCRIPT_DIR/.."
+
+cd "$BASE_DIR"
+
+OUT_DIR=build/host
+SRCS=(scripts/loose_override_host/loose_override_host.cpp PulsarEngine/IO/LooseArchivePatch.cpp)
+FLAGS=(-std=c++11 -Wall -Wextra -Wno-unknown-pragmas -IKamekInclude -IPulsarEngine -DLOOSE_OVERRIDE_HOST)
+
+mkdir -p "$OUT_DIR"
+
+case "${1:-}" in
+    --asan)
+        "${CXX:-g++}" "${FLAGS[@]}" -O1 -g -fno-omit-frame-pointer -fsanitize=address,undefined -o "$OUT_DIR/loose_override_host" "${SRCS[@]}"
+        ;;
+    --fuzz)
+        "${CXX:-clang++}" "${FLAGS[@]}" -O1 -g -fsanitize=fuzzer,address,undefined -DLOOSE_OVERRIDE_HOST_LIBFUZZER -o "$OUT_DIR/loose_override_fuzz" "${SRCS[@]}"
+        ;;
+    "")
+        "${CXX:-g++}" "${FLAGS[@]}" -O2 -o "$OUT_DIR/loose_override_host" "${SRCS[@]}"
+        ;;
+    *)
+        echo "usage: $0 [--asan | --fuzz]"
+        exit 2
+        ;;
+esac
@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Builds the host RH1 and SELECT wire codec harness (scripts/packet_codec_host) into build/host with the system compiler.
+#   scripts/build_packet_codec_host.sh            optimised build
+#   scripts/build_packet_codec_host.sh --asan     address and undefined behaviour sanitizers, for "check" and "fuzz"
+#   scripts/build_packet_codec_host.sh --fuzz     libFuzzer target, needs clang; run build/host/packet_codec_fuzz
+# scripts/packet_codec_host/shim stands in for kamek.hpp, the codec itself only needs the vanilla packet structs.
+
+set -euo pipefail
+
+SCRIPT_DIR=$(cd -- "$(dirname -- "${BASH_SOURCE[0]}")" &>/dev/null && pwd)
+BASE_DIR="$SCRIPT_DIR/.."
+
+cd "$BASE_DIR"
+
+OUT_DIR=build/host
+SRCS=(scripts/packet_codec_host/packet_codec_host.cpp PulsarEngine/Network/PacketCodec.cpp)
+FLAGS=(-std=c++11 -Wall -Wextra -Wno-unknown-pragmas -Iscripts/packet_codec_host/shim -IKamekInclude -IGameSource -IPulsarEngine -DPACKET_CODEC_HOST)
+
+mkdir -p "$OUT_DIR"
+
+case "${1:-}" in
+    --asan)
+        "${CXX:-g++}" "${FLAGS[@]}" -O1 -g -fno-omit-frame-pointer -fsanitize=address,undefined -o "$OUT_DIR/packet_codec_host" "${SRCS[@]}"
+        ;;
+    --fuzz)
+        "${CXX:-clang++}" "${FLAGS[@]}" -O1 -g -fsanitize=fuzzer,address,undefined -DPACKET_CODEC_HOST_LIBFUZZER -o "$OUT_DIR/packet_codec_fuzz" "${SRCS[@]}"
+        ;;
+    "")
+        "${CXX:-g++}" "${FLAGS[@]}" -O2 -o "$OUT_DIR/packet_codec_host" "${SRCS[@]}"
+        ;;
+    *)
+        echo "usage: $0 [--asan | --fuzz]"
+        exit 2
+        ;;
+esac
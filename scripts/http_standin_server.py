@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Serve canned responses to a build made with HTTP_STANDIN_HOST="<this host>:<port>".
+
+Every request path (query included) is looked up under --root, with '?' and '&' replaced by '_',
+e.g. /api/leaderboard/in-game?page=1 -> <root>/api/leaderboard/in-game_page=1.
+Unknown paths answer 404. --delay and --fail-every help exercise the request scheduler's queueing.
+Responses carry an ETag and, with --max-age, a Cache-Control header; a matching If-None-Match answers 304.
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    root: Path
+    delay: float
+    fail_every: int
+    max_age: int
+    served = 0
+
+    def do_GET(self) -> None:
+        StandInHandler.served += 1
+        if self.delay > 0:
+            time.sleep(self.delay)
+        if self.fail_every > 0 and StandInHandler.served % self.fail_every == 0:
+            self.send_error(503)
+            return
+
+        relative = self.path.lstrip("/").replace("?", "_").replace("&", "_")
+        target = (self.root / relative).resolve()
+        if self.root not in target.parents or not target.is_file():
+            self.send_error(404)
+            return
+
+        body = target.read_bytes()
+        etag = '"' + hashlib.sha1(body).hexdigest()[:16] + '"'
+        not_modified = self.headers.get("If-None-Match") == etag
+        self.send_response(304 if not_modified else 200)
+        self.send_header("ETag", etag)
+        if self.max_age > 0:
+            self.send_header("Cache-Control", f"max-age={self.max_age}")
+        self.send_header("Content-Length", "0" if not_modified else str(len(body)))
+        self.end_headers()
+        if not not_modified:
+            self.wfile.write(body)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--root", type=Path, required=True, help="directory holding the canned responses")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--delay", type=float, default=0.0, help="seconds to wait before answering")
+    parser.add_argument("--fail-every", type=int, default=0, help="answer every Nth request with 503")
+    parser.add_argument("--max-age", type=int, default=0, help="Cache-Control max-age to advertise, 0 for none")
+    args = parser.parse_args()
+
+    StandInHandler.root = args.root.resolve()
+    StandInHandler.delay = args.delay
+    StandInHandler.fail_every = args.fail_every
+    StandInHandler.max_age = args.max_age
+    server = ThreadingHTTPServer(("", args.port), StandInHandler)
+    print(f"Serving {StandInHandler.root} on port {args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
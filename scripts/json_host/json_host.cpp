@@ -0,0 +1,217 @@
+// Host build of the network JSON tokenizer, see scripts/build_json_host.sh.
+//   json_host check <files...>             parses every file; files named invalid_* must fail, all others must pass
+//   json_host fuzz <iterations> <files...>  parses random mutations and truncations of the files
+//   json_host bench <file> [iterations]     reports parse throughput
+// Every input is copied into a heap block of exactly its size, so an address sanitizer build catches any read past
+// the end. Built with -DJSON_HOST_LIBFUZZER, the file is a libFuzzer target instead.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include <string>
+
+#include <Network/Json.hpp>
+
+using namespace Pulsar::Network;
+
+namespace {
+
+// Pulls every token through the decoders the game code uses
+class ExerciseHandler : public Json::Handler {
+public:
+    ExerciseHandler() : tokens(0), checksum(0) {}
+
+    bool OnObjectBegin(u32 depth) override { return this->Count(depth); }
+    bool OnObjectEnd(u32 depth) override { return this->Count(depth); }
+    bool OnArrayBegin(u32 depth) override { return this->Count(depth); }
+    bool OnArrayEnd(u32 depth) override { return this->Count(depth); }
+    bool OnKey(const Json::StringRef &key, u32 depth) override {
+        this->checksum += key.Equals("name") ? 1 : 0;
+        return this->OnString(key, depth);
+    }
+    bool OnString(const Json::StringRef &value, u32 depth) override {
+        char ascii[32];
+        wchar_t wide[24];
+        this->checksum += value.CopyAscii(ascii, sizeof(ascii));
+        this->checksum += value.CopyWide(wide, sizeof(wide) / sizeof(wide[0]));
+        return this->Count(depth);
+    }
+    bool OnNumber(const Json::NumberRef &value, u32 depth) override {
+        u32 u = 0;
+        u64 u64Value = 0;
+        s32 s = 0;
+        float f = 0.0f;
+        if (value.ToU32(u)) this->checksum += u;
+        if (value.ToU64(u64Value)) this->checksum += static_cast<u32>(u64Value);
+        if (value.ToS32(s)) this->checksum += static_cast<u32>(s);
+        if (value.ToFloat(f)) this->checksum += static_cast<u32>(f > 0.0f && f < 1e9f ? f : 0.0f);
+        return this->Count(depth);
+    }
+    bool OnBool(bool value, u32 depth) override {
+        this->checksum += value ? 1 : 0;
+        return this->Count(depth);
+    }
+    bool OnNull(u32 depth) override { return this->Count(depth); }
+
+    u32 tokens;
+    u32 checksum;
+
+private:
+    bool Count(u32 depth) {
+        if (depth > Json::kMaxDepthLimit) abort();
+        ++this->tokens;
+        return true;
+    }
+};
+
+Json::ParseResult ParseExact(const char *data, size_t size, ExerciseHandler &handler) {
+    char *copy = static_cast<char *>(malloc(size == 0 ? 1 : size));
+    memcpy(copy, data, size);
+    const Json::ParseResult result = Json::Parse(size == 0 ? copy + 1 : copy, static_cast<u32>(size), handler);
+    free(copy);
+    return result;
+}
+
+const char *ResultName(Json::ParseResult result) {
+    switch (result) {
+        case Json::PARSE_OK:
+            return "ok";
+        case Json::PARSE_STOPPED:
+            return "stopped";
+        case Json::PARSE_ERROR_SYNTAX:
+            return "syntax error";
+        case Json::PARSE_ERROR_DEPTH:
+            return "too deep";
+        case Json::PARSE_ERROR_TRUNCATED:
+            return "truncated";
+    }
+    return "?";
+}
+
+}  // namespace
+
+#ifdef JSON_HOST_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const u8 *data, size_t size) {
+    ExerciseHandler handler;
+    ParseExact(reinterpret_cast<const char *>(data), size, handler);
+    return 0;
+}
+#else
+namespace {
+
+bool ReadFile(const char *path, std::string &out) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    char buffer[4096];
+    size_t read;
+    out.clear();
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) out.append(buffer, read);
+    fclose(file);
+    return true;
+}
+
+bool ExpectsFailure(const char *path) {
+    const char *name = strrchr(path, '/');
+    name = name == nullptr ? path : name + 1;
+    return strncmp(name, "invalid_", 8) == 0;
+}
+
+int Check(int count, char **paths) {
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        std::string body;
+        if (!ReadFile(paths[i], body)) return 1;
+        ExerciseHandler handler;
+        const Json::ParseResult result = ParseExact(body.data(), body.size(), handler);
+        const bool passed = (result == Json::PARSE_OK) != ExpectsFailure(paths[i]);
+        if (!passed) ++mismatches;
+        printf("%-4s %s: %s, %u tokens\n", passed ? "ok" : "FAIL", paths[i], ResultName(result), handler.tokens);
+
+        // Every prefix of a valid document must fail cleanly without reading past its end
+        for (size_t length = 0; length < body.size(); ++length) {
+            ExerciseHandler prefixHandler;
+            ParseExact(body.data(), length, prefixHandler);
+        }
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+u32 NextRandom(u32 &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+int Fuzz(u32 iterations, int count, char **paths) {
+    std::vector<std::string> corpus;
+    for (int i = 0; i < count; ++i) {
+        std::string body;
+        if (!ReadFile(paths[i], body)) return 1;
+        if (!body.empty()) corpus.push_back(body);
+    }
+    if (corpus.empty()) return 1;
+
+    static const char kInteresting[] = "{}[]\",:\\u0123456789-+.eEtruefalsn \x80\xc3\xe2";
+    u32 state = 0x2545f491;
+    u32 results[Json::PARSE_ERROR_TRUNCATED + 1] = {};
+    for (u32 i = 0; i < iterations; ++i) {
+        std::string input = corpus[NextRandom(state) % corpus.size()];
+        const u32 edits = 1 + NextRandom(state) % 8;
+        for (u32 e = 0; e < edits && !input.empty(); ++e) {
+            const size_t at = NextRandom(state) % input.size();
+            const char c = kInteresting[NextRandom(state) % (sizeof(kInteresting) - 1)];
+            switch (NextRandom(state) % 4) {
+                case 0:
+                    input[at] = c;
+                    break;
+                case 1:
+                    input.insert(input.begin() + at, c);
+                    break;
+                case 2:
+                    input.erase(at, 1 + NextRandom(state) % 4);
+                    break;
+                default:
+                    input.resize(at);
+                    break;
+            }
+        }
+        ExerciseHandler handler;
+        ++results[ParseExact(input.data(), input.size(), handler)];
+    }
+    printf("%u inputs:", iterations);
+    for (u32 r = 0; r <= Json::PARSE_ERROR_TRUNCATED; ++r) {
+        printf(" %s %u%s", ResultName(static_cast<Json::ParseResult>(r)), results[r], r < Json::PARSE_ERROR_TRUNCATED ? "," : "\n");
+    }
+    return 0;
+}
+
+int Bench(const char *path, u32 iterations) {
+    std::string body;
+    if (!ReadFile(path, body)) return 1;
+    ExerciseHandler handler;
+    const clock_t start = clock();
+    for (u32 i = 0; i < iterations; ++i) Json::Parse(body.data(), static_cast<u32>(body.size()), handler);
+    const double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    const double megabytes = static_cast<double>(body.size()) * iterations / (1024.0 * 1024.0);
+    printf("%s: %zu bytes x %u in %.3fs, %.1f MB/s, %.2f us per parse (checksum %u)\n", path, body.size(), iterations,
+           seconds, seconds > 0.0 ? megabytes / seconds : 0.0, seconds * 1e6 / iterations, handler.checksum);
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "check") == 0) return Check(argc - 2, argv + 2);
+    if (argc >= 4 && strcmp(argv[1], "fuzz") == 0) return Fuzz(static_cast<u32>(strtoul(argv[2], nullptr, 10)), argc - 3, argv + 3);
+    if (argc >= 3 && strcmp(argv[1], "bench") == 0) {
+        return Bench(argv[2], argc >= 4 ? static_cast<u32>(strtoul(argv[3], nullptr, 10)) : 10000);
+    }
+    fprintf(stderr, "usage: %s check <files...> | fuzz <iterations> <files...> | bench <file> [iterations]\n", argv[0]);
+    return 2;
+}
+#endif
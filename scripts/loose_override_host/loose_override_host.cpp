@@ -0,0 +1,981 @@
+// Host build of the loose override U8 patcher (PulsarEngine/IO/LooseArchivePatch.cpp), see
+// scripts/build_loose_override_host.sh.
+//   loose_override_host check <archives...>             applies synthetic override sets under several heap budgets
+//   loose_override_host fuzz <iterations> <archives...>  patches archives with randomly corrupted metadata
+//   loose_override_host bench <archive> [iterations]     reports time per call for in-place, repack and rebuild sets
+// Archives are SZS or plain U8 files; check expects files named invalid_* to be rejected untouched. Every heap block
+// has exactly the requested size, so an address sanitizer build catches writes past an allocation, and a block freed
+// on the wrong heap aborts. Set LOOSE_OVERRIDE_HOST_VERBOSE to see the patcher's reports. Built with
+// -DLOOSE_OVERRIDE_HOST_LIBFUZZER, the file is a libFuzzer target instead.
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <IO/LooseArchivePatch.hpp>
+
+using namespace Pulsar::IOOverrides;
+
+// Budgeted malloc heap standing in for EGG's; the patcher only ever sees the pointer
+namespace EGG {
+class Heap {
+public:
+    explicit Heap(u32 budget) : budget(budget), used(0) {}
+    ~Heap() {
+        for (std::map<void *, u32>::iterator it = this->blocks.begin(); it != this->blocks.end(); ++it) free(it->first);
+    }
+
+    u32 budget;
+    u32 used;
+    std::map<void *, u32> blocks;
+};
+}  // namespace EGG
+
+namespace {
+
+const u32 kYaz0Magic = 0x59617a30;
+
+// Entries outside the bucket under test sit around it and must never be read
+const u32 kDecoyEntries = 2;
+
+struct HostEntry {
+    std::string matchName;
+    std::vector<u8> payload;
+    bool failRead;
+};
+
+struct HostHeaps {
+    EGG::Heap *mem1;
+    EGG::Heap *mem2;
+    EGG::Heap *overrides;
+};
+
+// Emulates DecodeChunkedArchive leaving the payloads of overridden members zeroed
+struct SkippedPayloads {
+    const u8 *archive;
+    std::vector<u8> pristine;
+};
+
+HostHeaps sHeaps = {nullptr, nullptr, nullptr};
+std::vector<HostEntry> sEntries;
+u32 sRangeStart = 0;
+u32 sRangeEnd = 0;
+const u8 *sCompressed = nullptr;
+u32 sCompressedSize = 0;
+SkippedPayloads sSkipped = {nullptr, std::vector<u8>()};
+bool sVerbose = false;
+
+u32 ReadBE32(const u8 *p) {
+    return (static_cast<u32>(p[0]) << 24) | (static_cast<u32>(p[1]) << 16) | (static_cast<u32>(p[2]) << 8) | p[3];
+}
+
+void WriteBE32(u8 *p, u32 value) {
+    p[0] = static_cast<u8>(value >> 24);
+    p[1] = static_cast<u8>(value >> 16);
+    p[2] = static_cast<u8>(value >> 8);
+    p[3] = static_cast<u8>(value);
+}
+
+void SwapWords(u8 *p, u32 count) {
+    u32 *words = reinterpret_cast<u32 *>(p);
+    for (u32 i = 0; i < count; ++i) words[i] = ReadBE32(p + i * 4);
+}
+
+// The patcher reads the header and nodes natively, so they are swapped to host order the way the Wii sees them
+void SwapU8MetadataToHost(u8 *archive, u32 size) {
+    if (size < sizeof(U8Header)) return;
+    const u32 nodeOffset = ReadBE32(archive + 4);
+    SwapWords(archive, 4);
+    if ((nodeOffset & 3) != 0 || nodeOffset > size || size - nodeOffset < sizeof(U8Node)) return;
+    const u32 nodeCount = ReadBE32(archive + nodeOffset + 8);
+    if (nodeCount == 0 || nodeCount > (size - nodeOffset) / sizeof(U8Node)) {
+        SwapWords(archive + nodeOffset, 3);
+        return;
+    }
+    SwapWords(archive + nodeOffset, nodeCount * 3);
+}
+
+u32 GetYaz0DecodedSize(const u8 *data, u32 size) {
+    if (size < 0x10 || ReadBE32(data) != kYaz0Magic) return 0;
+    return ReadBE32(data + 4);
+}
+
+bool DecodeYaz0(const u8 *src, u32 srcSize, u8 *dest, u32 destSize) {
+    u32 in = 0x10;
+    u32 out = 0;
+    u32 groupHeader = 0;
+    u32 groupBits = 0;
+    while (out < destSize) {
+        if (groupBits == 0) {
+            if (in >= srcSize) return false;
+            groupHeader = src[in++];
+            groupBits = 8;
+        }
+        if ((groupHeader & 0x80) != 0) {
+            if (in >= srcSize) return false;
+            dest[out++] = src[in++];
+        } else {
+            if (in + 2 > srcSize) return false;
+            const u32 b1 = src[in++];
+            const u32 b2 = src[in++];
+            const u32 distance = ((b1 & 0x0F) << 8 | b2) + 1;
+            u32 length = b1 >> 4;
+            if (length == 0) {
+                if (in >= srcSize) return false;
+                length = src[in++] + 0x12;
+            } else {
+                length += 2;
+            }
+            if (distance > out || length > destSize - out) return false;
+            for (u32 i = 0; i < length; ++i, ++out) dest[out] = dest[out - distance];
+        }
+        groupHeader <<= 1;
+        --groupBits;
+    }
+    return true;
+}
+
+// Literal-only Yaz0, enough to hand plain U8 files to the patcher as their "source SZS"
+std::vector<u8> WrapYaz0(const std::vector<u8> &data) {
+    std::vector<u8> out(0x10, 0);
+    WriteBE32(&out[0], kYaz0Magic);
+    WriteBE32(&out[4], static_cast<u32>(data.size()));
+    for (size_t i = 0; i < data.size(); i += 8) {
+        out.push_back(0xFF);
+        for (size_t j = i; j < i + 8 && j < data.size(); ++j) out.push_back(data[j]);
+    }
+    return out;
+}
+
+u32 Align32(u32 value) {
+    return (value + 0x1F) & ~0x1Fu;
+}
+
+u32 NextRandom(u32 &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+}  // namespace
+
+namespace Pulsar {
+namespace IOOverrides {
+namespace PatchPlatform {
+
+EGG::Heap *GetRootHeapMEM1() {
+    return sHeaps.mem1;
+}
+
+EGG::Heap *GetRootHeapMEM2() {
+    return sHeaps.mem2;
+}
+
+EGG::Heap *GetOverridesHeap() {
+    return sHeaps.overrides;
+}
+
+void *Alloc(u32 size, s32 align, EGG::Heap *heap) {
+    if (heap == nullptr || size > heap->budget - heap->used) return nullptr;
+    size_t alignment = static_cast<size_t>(align < 0 ? -align : align);
+    if (alignment < sizeof(void *)) alignment = sizeof(void *);
+    void *block = nullptr;
+    if (posix_memalign(&block, alignment, size == 0 ? 1 : size) != 0) return nullptr;
+    // Like a debug heap, so reads of never-written bytes show up as content mismatches
+    memset(block, 0xCD, size);
+    heap->blocks[block] = size;
+    heap->used += size;
+    return block;
+}
+
+void Free(void *block, EGG::Heap *heap) {
+    if (block == nullptr) return;
+    std::map<void *, u32>::iterator it = heap == nullptr ? std::map<void *, u32>::iterator() : heap->blocks.find(block);
+    if (heap == nullptr || it == heap->blocks.end()) {
+        fprintf(stderr, "block %p freed on a heap that did not allocate it\n", block);
+        abort();
+    }
+    heap->used -= it->second;
+    heap->blocks.erase(it);
+    free(block);
+}
+
+u32 GetAllocatableSize(EGG::Heap *heap) {
+    return heap == nullptr ? 0 : heap->budget - heap->used;
+}
+
+void Report(const char *format, ...) {
+    if (!sVerbose) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+void FlushRange(void *, u32) {}
+
+void DecodeSourceArchive(const u8 *compressedData, u8 *dest) {
+    if (compressedData != sCompressed) {
+        fprintf(stderr, "asked to decode %p, the source archive is %p\n", compressedData, sCompressed);
+        abort();
+    }
+    const u32 size = GetYaz0DecodedSize(sCompressed, sCompressedSize);
+    DecodeYaz0(sCompressed, sCompressedSize, dest, size);
+    SwapU8MetadataToHost(dest, size);
+}
+
+// Plain case-insensitive walk, one U8 name per path component
+s32 FindU8Entry(const u8 *archiveBase, const char *path) {
+    const U8Header *header = reinterpret_cast<const U8Header *>(archiveBase);
+    const U8Node *nodes = reinterpret_cast<const U8Node *>(archiveBase + header->nodeOffset);
+    const u32 nodeCount = nodes[0].dataSize;
+    const char *names = reinterpret_cast<const char *>(nodes + nodeCount);
+
+    u32 dir = 0;
+    const char *component = path;
+    while (*component == '/') ++component;
+    while (*component != '\0') {
+        const char *end = strchr(component, '/');
+        const size_t length = end == nullptr ? strlen(component) : static_cast<size_t>(end - component);
+        u32 dirEnd = nodes[dir].dataSize > nodeCount ? nodeCount : nodes[dir].dataSize;
+        s32 found = -1;
+        for (u32 i = dir + 1; i < dirEnd;) {
+            const char *name = names + NodeNameOffset(nodes[i]);
+            if (strncasecmp(name, component, length) == 0 && name[length] == '\0') {
+                found = static_cast<s32>(i);
+                break;
+            }
+            i = NodeIsDir(nodes[i]) && nodes[i].dataSize > i ? nodes[i].dataSize : i + 1;
+        }
+        if (found < 0) return -1;
+        if (end == nullptr) return found;
+        if (!NodeIsDir(nodes[found])) return -1;
+        dir = static_cast<u32>(found);
+        component = end + 1;
+    }
+    return static_cast<s32>(dir);
+}
+
+void RestoreSkippedRange(u8 *archiveBase, u32 offset, u32 size) {
+    if (archiveBase != sSkipped.archive || offset > sSkipped.pristine.size() ||
+        size > sSkipped.pristine.size() - offset) {
+        return;
+    }
+    memcpy(archiveBase + offset, &sSkipped.pristine[offset], size);
+}
+
+bool GetMatchName(const TaggedOverrideEntry &entry, char *outName, u32 outNameSize) {
+    const std::string &name = sEntries[entry.sourcePathOffset].matchName;
+    if (name.size() + 1 > outNameSize) return false;
+    memcpy(outName, name.c_str(), name.size() + 1);
+    return true;
+}
+
+bool ReadOverride(const TaggedOverrideEntry &entry, void *dest) {
+    if (entry.sourcePathOffset < sRangeStart || entry.sourcePathOffset >= sRangeEnd) {
+        fprintf(stderr, "read entry %u outside the bucket [%u, %u)\n", entry.sourcePathOffset, sRangeStart, sRangeEnd);
+        abort();
+    }
+    const HostEntry &hostEntry = sEntries[entry.sourcePathOffset];
+    if (hostEntry.failRead) return false;
+    if (!hostEntry.payload.empty()) memcpy(dest, &hostEntry.payload[0], hostEntry.payload.size());
+    return true;
+}
+
+const char *GetSourcePath(const TaggedOverrideEntry &entry) {
+    return sEntries[entry.sourcePathOffset].matchName.c_str();
+}
+
+}  // namespace PatchPlatform
+}  // namespace IOOverrides
+}  // namespace Pulsar
+
+namespace {
+
+enum OverrideKind {
+    KIND_SAME_SIZE,
+    KIND_SHRINK,
+    KIND_GROW_IN_SLOT,
+    KIND_GROW,
+    KIND_DELETE,
+    KIND_ADD,
+    KIND_BASENAME,
+    KIND_MISSING,
+    KIND_READ_FAILURE,
+    KIND_COUNT
+};
+
+struct ArchiveFile {
+    std::string path;
+    std::string basename;
+    std::string parent;
+    u32 nodeIdx;
+    std::vector<u8> data;
+};
+
+struct Source {
+    std::string path;
+    std::vector<u8> compressed;
+    u32 decodedSize;
+};
+
+// Files of a host-order archive that passed IsValidU8Layout, with paths as FindU8Entry resolves them
+std::vector<ArchiveFile> ListFiles(const u8 *archive) {
+    const U8Header *header = reinterpret_cast<const U8Header *>(archive);
+    const U8Node *nodes = reinterpret_cast<const U8Node *>(archive + header->nodeOffset);
+    const u32 nodeCount = nodes[0].dataSize;
+    const char *names = reinterpret_cast<const char *>(nodes + nodeCount);
+
+    std::vector<ArchiveFile> files;
+    std::vector<std::pair<u32, std::string> > dirs(1, std::make_pair(nodeCount, std::string()));
+    for (u32 i = 1; i < nodeCount; ++i) {
+        while (dirs.size() > 1 && dirs.back().first <= i) dirs.pop_back();
+        const std::string &parent = dirs.back().second;
+        const char *name = names + NodeNameOffset(nodes[i]);
+        const std::string path = parent.empty() ? std::string(name) : parent + "/" + name;
+        if (NodeIsDir(nodes[i])) {
+            dirs.push_back(std::make_pair(nodes[i].dataSize, path));
+            continue;
+        }
+        ArchiveFile file;
+        file.path = path;
+        file.basename = name;
+        file.parent = parent;
+        file.nodeIdx = i;
+        file.data.assign(archive + nodes[i].dataOffset, archive + nodes[i].dataOffset + nodes[i].dataSize);
+        files.push_back(file);
+    }
+    return files;
+}
+
+bool ReadFile(const char *path, std::vector<u8> &out) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    u8 buffer[4096];
+    size_t read;
+    out.clear();
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) out.insert(out.end(), buffer, buffer + read);
+    fclose(file);
+    return true;
+}
+
+bool LoadSource(const char *path, Source &out) {
+    std::vector<u8> data;
+    if (!ReadFile(path, data)) return false;
+    out.path = path;
+    const u32 decodedSize = GetYaz0DecodedSize(data.empty() ? nullptr : &data[0], static_cast<u32>(data.size()));
+    if (decodedSize != 0) {
+        std::vector<u8> decoded(decodedSize);
+        if (!DecodeYaz0(&data[0], static_cast<u32>(data.size()), &decoded[0], decodedSize)) {
+            fprintf(stderr, "%s: truncated Yaz0 stream\n", path);
+            return false;
+        }
+        out.compressed = data;
+        out.decodedSize = decodedSize;
+        return true;
+    }
+    out.compressed = WrapYaz0(data);
+    out.decodedSize = static_cast<u32>(data.size());
+    return true;
+}
+
+std::vector<u8> DecodeSourceBE(const Source &source) {
+    std::vector<u8> decoded(source.decodedSize);
+    if (!decoded.empty()) {
+        DecodeYaz0(&source.compressed[0], static_cast<u32>(source.compressed.size()), &decoded[0],
+                   source.decodedSize);
+    }
+    return decoded;
+}
+
+bool ExpectsRejection(const std::string &path) {
+    const size_t slash = path.rfind('/');
+    return path.compare(slash == std::string::npos ? 0 : slash + 1, 8, "invalid_") == 0;
+}
+
+std::vector<u8> RandomPayload(u32 size, u32 &state) {
+    std::vector<u8> payload(size);
+    for (u32 i = 0; i < size; ++i) payload[i] = static_cast<u8>(NextRandom(state));
+    return payload;
+}
+
+// One override in the bucket under test and what it is expected to do
+struct PlannedOverride {
+    OverrideKind kind;
+    u32 entryIndex;
+    std::vector<u32> fileIndices;  // archive files it targets, several for a basename
+};
+
+struct OverrideSet {
+    std::vector<TaggedOverrideEntry> table;
+    std::vector<PlannedOverride> planned;
+    u32 expectedMissing;
+};
+
+u32 AddEntry(OverrideSet &set, const std::string &matchName, u16 flags, const std::vector<u8> &payload,
+             bool failRead) {
+    HostEntry hostEntry;
+    hostEntry.matchName = matchName;
+    hostEntry.payload = payload;
+    hostEntry.failRead = failRead;
+    sEntries.push_back(hostEntry);
+
+    TaggedOverrideEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.sourcePathOffset = static_cast<u32>(sEntries.size() - 1);
+    entry.sourceEntryNum = -1;
+    entry.size = static_cast<u32>(payload.size());
+    entry.flags = flags;
+    set.table.push_back(entry);
+    return entry.sourcePathOffset;
+}
+
+// Builds the bucket from the requested kinds, each targeting files no other override touches
+OverrideSet PlanOverrides(const std::vector<ArchiveFile> &files, const std::vector<OverrideKind> &kinds, u32 &state) {
+    sEntries.clear();
+    OverrideSet set;
+    set.expectedMissing = 0;
+    for (u32 i = 0; i < kDecoyEntries; ++i) AddEntry(set, "decoy", OVERRIDEENTRYFLAG_NONE, std::vector<u8>(4), false);
+    sRangeStart = static_cast<u32>(sEntries.size());
+
+    std::vector<bool> used(files.size(), false);
+    std::map<std::string, std::vector<u32> > byBasename;
+    for (u32 i = 0; i < files.size(); ++i) byBasename[files[i].basename].push_back(i);
+
+    for (size_t k = 0; k < kinds.size(); ++k) {
+        const OverrideKind kind = kinds[k];
+        PlannedOverride planned;
+        planned.kind = kind;
+
+        if (kind == KIND_MISSING) {
+            planned.entryIndex = AddEntry(set, "no_such_dir/missing.bin", OVERRIDEENTRYFLAG_HAS_SUBPATH,
+                                          RandomPayload(0x40, state), false);
+            ++set.expectedMissing;
+            set.planned.push_back(planned);
+            continue;
+        }
+        if (kind == KIND_BASENAME) {
+            // Prefer a name shared by several files so the fan-out is exercised
+            std::string name;
+            for (std::map<std::string, std::vector<u32> >::iterator it = byBasename.begin(); it != byBasename.end(); ++it) {
+                bool free = true;
+                for (size_t i = 0; i < it->second.size(); ++i) free = free && !used[it->second[i]];
+                if (free && (name.empty() || it->second.size() > byBasename[name].size())) name = it->first;
+            }
+            if (name.empty()) continue;
+            const std::vector<u32> &targets = byBasename[name];
+            for (size_t i = 0; i < targets.size(); ++i) used[targets[i]] = true;
+            planned.fileIndices = targets;
+            planned.entryIndex = AddEntry(set, name, OVERRIDEENTRYFLAG_NONE,
+                                          RandomPayload(1 + NextRandom(state) % 0x200, state), false);
+            set.planned.push_back(planned);
+            continue;
+        }
+
+        u32 target = static_cast<u32>(files.size());
+        for (u32 attempt = 0; attempt < files.size() * 2 && target == files.size(); ++attempt) {
+            const u32 candidate = NextRandom(state) % static_cast<u32>(files.size());
+            if (used[candidate] || byBasename[files[candidate].basename].size() > 1) continue;
+            const u32 size = static_cast<u32>(files[candidate].data.size());
+            if (kind == KIND_SHRINK && size < 2) continue;
+            if (kind == KIND_GROW_IN_SLOT && Align32(size) == size) continue;
+            target = candidate;
+        }
+        if (target == files.size()) continue;
+        const ArchiveFile &file = files[target];
+        const u32 size = static_cast<u32>(file.data.size());
+
+        if (kind == KIND_ADD) {
+            // New sibling of the chosen file
+            char name[64];
+            snprintf(name, sizeof(name), "added_%u.bin", static_cast<u32>(k));
+            const std::string path = file.parent.empty() ? std::string(name) : file.parent + "/" + name;
+            planned.entryIndex = AddEntry(set, path, OVERRIDEENTRYFLAG_HAS_SUBPATH,
+                                          RandomPayload(1 + NextRandom(state) % 0x300, state), false);
+            set.planned.push_back(planned);
+            continue;
+        }
+
+        used[target] = true;
+        planned.fileIndices.push_back(target);
+        u32 newSize = size;
+        u16 flags = OVERRIDEENTRYFLAG_HAS_SUBPATH;
+        if (kind == KIND_SHRINK) newSize = size / 2;
+        if (kind == KIND_GROW_IN_SLOT) newSize = Align32(size);
+        if (kind == KIND_GROW) newSize = Align32(size) + 0x40 + NextRandom(state) % 0x400;
+        if (kind == KIND_DELETE) {
+            newSize = 0;
+            flags |= OVERRIDEENTRYFLAG_IS_DELETE;
+        }
+        planned.entryIndex = AddEntry(set, file.path, flags, RandomPayload(newSize, state), kind == KIND_READ_FAILURE);
+        set.planned.push_back(planned);
+    }
+
+    sRangeEnd = static_cast<u32>(sEntries.size());
+    for (u32 i = 0; i < kDecoyEntries; ++i) AddEntry(set, "decoy", OVERRIDEENTRYFLAG_NONE, std::vector<u8>(4), false);
+    return set;
+}
+
+struct HeapBudget {
+    const char *name;
+    u32 mem1;
+    u32 mem2;
+    u32 overrides;
+    u32 sourceSlack;  // room left on the archive's own heap
+    bool exact;       // every override must land
+};
+
+const HeapBudget kHeapBudgets[] = {
+    {"roomy", 0x4000000, 0x4000000, 0x4000000, 0x4000000, true},
+    {"source heap only", 0, 0, 0, 0x4000000, false},
+    {"no temp heaps", 0, 0, 0, 0x2000, false},
+    {"starved", 0x800, 0x800, 0x800, 0x100, false},
+};
+
+struct PatchRun {
+    bool result;
+    u32 applied;
+    u32 patched;
+    u32 missing;
+    std::vector<u8> output;  // host order
+    bool leaked;
+};
+
+// Loads the source onto a fresh source heap, optionally zeroes overridden payloads like a chunked decode, patches it
+// and checks that everything but the archive went back to the heaps.
+PatchRun RunPatch(const Source &source, const OverrideSet &set, const HeapBudget &budget, bool skipOverridden) {
+    EGG::Heap mem1(budget.mem1);
+    EGG::Heap mem2(budget.mem2);
+    EGG::Heap overrides(budget.overrides);
+    EGG::Heap sourceHeap(source.decodedSize + budget.sourceSlack);
+    sHeaps.mem1 = budget.mem1 != 0 ? &mem1 : nullptr;
+    sHeaps.mem2 = budget.mem2 != 0 ? &mem2 : nullptr;
+    sHeaps.overrides = budget.overrides != 0 ? &overrides : nullptr;
+    sCompressed = &source.compressed[0];
+    sCompressedSize = static_cast<u32>(source.compressed.size());
+
+    u8 *archive = static_cast<u8 *>(PatchPlatform::Alloc(source.decodedSize, 0x20, &sourceHeap));
+    PatchPlatform::DecodeSourceArchive(sCompressed, archive);
+    u32 archiveSize = source.decodedSize;
+
+    sSkipped.archive = nullptr;
+    std::vector<u8> nodeFlags;
+    if (skipOverridden && IsValidU8Layout(archive, archiveSize)) {
+        const U8Header *header = reinterpret_cast<const U8Header *>(archive);
+        const U8Node *nodes = reinterpret_cast<const U8Node *>(archive + header->nodeOffset);
+        nodeFlags.assign(nodes[0].dataSize, 0);
+        MarkPatchedU8Nodes(&set.table[0], sRangeStart, sRangeEnd, archive, archiveSize, &nodeFlags[0],
+                           nodes[0].dataSize);
+        sSkipped.archive = archive;
+        sSkipped.pristine.assign(archive, archive + archiveSize);
+        for (u32 i = 0; i < nodeFlags.size(); ++i) {
+            if (nodeFlags[i] != 0) memset(archive + nodes[i].dataOffset, 0, nodes[i].dataSize);
+        }
+    }
+
+    PatchRun run;
+    EGG::Heap *archiveHeap = &sourceHeap;
+    run.result = PatchU8Archive("host", &set.table[0], sRangeStart, sRangeEnd, archive, archiveSize, &sourceHeap,
+                                archiveHeap, &run.applied, &run.patched, &run.missing, sCompressed);
+    if (!run.result && archive == sSkipped.archive) {
+        // FinishChunkedArchive decodes the skipped members back when nothing was patched
+        const U8Header *header = reinterpret_cast<const U8Header *>(archive);
+        const U8Node *nodes = reinterpret_cast<const U8Node *>(archive + header->nodeOffset);
+        for (u32 i = 0; i < nodeFlags.size(); ++i) {
+            if (nodeFlags[i] != 0) PatchPlatform::RestoreSkippedRange(archive, nodes[i].dataOffset, nodes[i].dataSize);
+        }
+    }
+    run.output.assign(archive, archive + archiveSize);
+    PatchPlatform::Free(archive, archiveHeap);
+    FreeLoosePatchScratch();
+    run.leaked = mem1.used != 0 || mem2.used != 0 || overrides.used != 0 || sourceHeap.used != 0;
+    sHeaps.mem1 = sHeaps.mem2 = sHeaps.overrides = nullptr;
+    sSkipped.archive = nullptr;
+    return run;
+}
+
+// Every file of the output must be its original, its override or an added file, and nothing may vanish that was not
+// deleted. With exact set, every override must have landed.
+bool VerifyOutput(const std::vector<ArchiveFile> &original, const OverrideSet &set, const PatchRun &run, bool exact,
+                  std::string &error) {
+    if (!IsValidU8Layout(&run.output[0], static_cast<u32>(run.output.size()))) {
+        error = "output is not a valid U8 archive";
+        return false;
+    }
+    const std::vector<ArchiveFile> files = ListFiles(&run.output[0]);
+    std::map<std::string, const ArchiveFile *> byPath;
+    for (size_t i = 0; i < files.size(); ++i) byPath[files[i].path] = &files[i];
+
+    std::vector<const PlannedOverride *> fileOverride(original.size(), nullptr);
+    for (size_t p = 0; p < set.planned.size(); ++p) {
+        for (size_t i = 0; i < set.planned[p].fileIndices.size(); ++i) {
+            fileOverride[set.planned[p].fileIndices[i]] = &set.planned[p];
+        }
+    }
+
+    u32 expectedApplied = 0;
+    for (size_t i = 0; i < original.size(); ++i) {
+        const PlannedOverride *planned = fileOverride[i];
+        std::map<std::string, const ArchiveFile *>::iterator it = byPath.find(original[i].path);
+        const bool present = it != byPath.end();
+        const bool isOriginal = present && it->second->data == original[i].data;
+        const bool isOverride =
+            present && planned != nullptr && it->second->data == sEntries[planned->entryIndex].payload;
+        const bool deletes = planned != nullptr && planned->kind == KIND_DELETE;
+        const bool landsExactly = planned != nullptr && planned->kind != KIND_READ_FAILURE;
+        if (present) byPath.erase(it);
+
+        if (!present && !deletes) {
+            error = original[i].path + " disappeared";
+            return false;
+        }
+        if (present && !isOriginal && !isOverride) {
+            error = original[i].path + " holds neither its original nor its override";
+            return false;
+        }
+        if (exact && landsExactly && (deletes ? present : !isOverride)) {
+            error = original[i].path + " was not overridden";
+            return false;
+        }
+        if (exact && !landsExactly && !isOriginal) {
+            error = original[i].path + " lost its original after a failed read";
+            return false;
+        }
+    }
+
+    for (size_t p = 0; p < set.planned.size(); ++p) {
+        const PlannedOverride &planned = set.planned[p];
+        if (planned.kind != KIND_MISSING && planned.kind != KIND_READ_FAILURE) ++expectedApplied;
+        if (planned.kind != KIND_ADD) continue;
+        const std::string &path = sEntries[planned.entryIndex].matchName;
+        std::map<std::string, const ArchiveFile *>::iterator it = byPath.find(path);
+        if (it == byPath.end()) {
+            if (exact) {
+                error = path + " was not added";
+                return false;
+            }
+            continue;
+        }
+        if (it->second->data != sEntries[planned.entryIndex].payload) {
+            error = path + " was added with the wrong contents";
+            return false;
+        }
+        byPath.erase(it);
+    }
+    if (!byPath.empty()) {
+        error = byPath.begin()->first + " appeared from nowhere";
+        return false;
+    }
+    if (exact && (run.applied != expectedApplied || run.missing != set.expectedMissing)) {
+        char counts[128];
+        snprintf(counts, sizeof(counts), "applied %u (expected %u), missing %u (expected %u)", run.applied,
+                 expectedApplied, run.missing, set.expectedMissing);
+        error = counts;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+#ifdef LOOSE_OVERRIDE_HOST_LIBFUZZER
+// Input: one byte choosing the heap budget and chunked emulation, one seed byte, then a plain U8 archive
+extern "C" int LLVMFuzzerTestOneInput(const u8 *data, size_t size) {
+    if (size < 2 + sizeof(U8Header)) return 0;
+    Source source;
+    source.compressed = WrapYaz0(std::vector<u8>(data + 2, data + size));
+    source.decodedSize = static_cast<u32>(size - 2);
+    u32 state = 0x9E3779B9u ^ data[1];
+
+    std::vector<u8> archive = DecodeSourceBE(source);
+    SwapU8MetadataToHost(&archive[0], source.decodedSize);
+    std::vector<ArchiveFile> files;
+    if (IsValidU8Layout(&archive[0], source.decodedSize)) files = ListFiles(&archive[0]);
+    std::vector<OverrideKind> kinds;
+    for (u32 i = 0; i < 6; ++i) kinds.push_back(static_cast<OverrideKind>(NextRandom(state) % KIND_COUNT));
+    if (files.empty()) kinds.assign(1, KIND_MISSING);
+
+    const OverrideSet set = PlanOverrides(files, kinds, state);
+    const HeapBudget &budget = kHeapBudgets[data[0] % (sizeof(kHeapBudgets) / sizeof(kHeapBudgets[0]))];
+    const PatchRun run = RunPatch(source, set, budget, (data[0] & 0x80) != 0);
+    if (run.leaked) abort();
+    return 0;
+}
+#else
+namespace {
+
+const OverrideKind kInPlaceKinds[] = {KIND_SAME_SIZE, KIND_SHRINK, KIND_GROW_IN_SLOT, KIND_SHRINK};
+const OverrideKind kRepackKinds[] = {KIND_GROW, KIND_SAME_SIZE, KIND_SHRINK, KIND_GROW};
+const OverrideKind kStructuralKinds[] = {KIND_DELETE, KIND_ADD, KIND_GROW, KIND_SHRINK};
+const OverrideKind kBasenameKinds[] = {KIND_BASENAME, KIND_SAME_SIZE, KIND_MISSING};
+const OverrideKind kFailureKinds[] = {KIND_READ_FAILURE, KIND_GROW, KIND_READ_FAILURE, KIND_SHRINK};
+const OverrideKind kMixedKinds[] = {KIND_GROW, KIND_DELETE, KIND_ADD, KIND_BASENAME, KIND_MISSING, KIND_SHRINK};
+// A failed read abandons the whole rebuild, so only consistency is checked
+const OverrideKind kStructuralFailureKinds[] = {KIND_DELETE, KIND_ADD, KIND_READ_FAILURE, KIND_GROW};
+
+struct OverrideScenario {
+    const char *name;
+    const OverrideKind *kinds;
+    u32 kindCount;
+    bool exact;  // every override lands when the heaps allow it
+};
+
+#define SCENARIO(name, kinds, exact) {name, kinds, sizeof(kinds) / sizeof(kinds[0]), exact}
+const OverrideScenario kScenarios[] = {
+    SCENARIO("in place", kInPlaceKinds, true),
+    SCENARIO("repack", kRepackKinds, true),
+    SCENARIO("structural", kStructuralKinds, true),
+    SCENARIO("basename", kBasenameKinds, true),
+    SCENARIO("read failures", kFailureKinds, true),
+    SCENARIO("mixed", kMixedKinds, true),
+    SCENARIO("structural read failure", kStructuralFailureKinds, false),
+};
+#undef SCENARIO
+
+std::vector<OverrideKind> ScenarioKinds(const OverrideScenario &scenario) {
+    return std::vector<OverrideKind>(scenario.kinds, scenario.kinds + scenario.kindCount);
+}
+
+bool CheckRejected(const Source &source) {
+    std::vector<ArchiveFile> files;
+    u32 state = 0x1234567;
+    const OverrideSet set = PlanOverrides(files, std::vector<OverrideKind>(1, KIND_MISSING), state);
+    std::vector<u8> expected = DecodeSourceBE(source);
+    SwapU8MetadataToHost(&expected[0], source.decodedSize);
+    const PatchRun run = RunPatch(source, set, kHeapBudgets[0], false);
+    const bool passed = !run.result && run.output == expected && !run.leaked;
+    printf("%-4s %s: %s\n", passed ? "ok" : "FAIL", source.path.c_str(), run.result ? "accepted" : "rejected");
+    return passed;
+}
+
+int Check(int count, char **paths) {
+    int failures = 0;
+    for (int p = 0; p < count; ++p) {
+        Source source;
+        if (!LoadSource(paths[p], source)) return 1;
+        if (ExpectsRejection(source.path)) {
+            if (!CheckRejected(source)) ++failures;
+            continue;
+        }
+
+        std::vector<u8> archive = DecodeSourceBE(source);
+        SwapU8MetadataToHost(&archive[0], source.decodedSize);
+        if (!IsValidU8Layout(&archive[0], source.decodedSize)) {
+            printf("FAIL %s: not a valid U8 archive\n", paths[p]);
+            ++failures;
+            continue;
+        }
+        const std::vector<ArchiveFile> files = ListFiles(&archive[0]);
+
+        u32 runs = 0;
+        u32 runFailures = 0;
+        u32 state = 0x2545f491;
+        for (u32 s = 0; s < sizeof(kScenarios) / sizeof(kScenarios[0]); ++s) {
+            const OverrideSet set = PlanOverrides(files, ScenarioKinds(kScenarios[s]), state);
+
+            // The pre-decode pass must flag exactly the members the patch replaces or deletes
+            std::vector<u8> nodeFlags(reinterpret_cast<const U8Node *>(&archive[0] +
+                                                                       reinterpret_cast<const U8Header *>(&archive[0])->nodeOffset)[0]
+                                          .dataSize,
+                                      0);
+            MarkPatchedU8Nodes(&set.table[0], sRangeStart, sRangeEnd, &archive[0], source.decodedSize, &nodeFlags[0],
+                               static_cast<u32>(nodeFlags.size()));
+            std::vector<u8> expectedFlags(nodeFlags.size(), 0);
+            for (size_t i = 0; i < set.planned.size(); ++i) {
+                for (size_t f = 0; f < set.planned[i].fileIndices.size(); ++f) {
+                    expectedFlags[files[set.planned[i].fileIndices[f]].nodeIdx] = 1;
+                }
+            }
+            if (nodeFlags != expectedFlags) {
+                printf("FAIL %s [%s]: MarkPatchedU8Nodes flagged the wrong members\n", paths[p], kScenarios[s].name);
+                ++runFailures;
+            }
+
+            for (u32 b = 0; b < sizeof(kHeapBudgets) / sizeof(kHeapBudgets[0]); ++b) {
+                for (u32 skip = 0; skip < 2; ++skip) {
+                    const PatchRun run = RunPatch(source, set, kHeapBudgets[b], skip != 0);
+                    std::string error;
+                    ++runs;
+                    if (run.leaked) {
+                        error = "heap blocks leaked";
+                    } else {
+                        VerifyOutput(files, set, run, kHeapBudgets[b].exact && kScenarios[s].exact, error);
+                    }
+                    if (error.empty()) continue;
+                    ++runFailures;
+                    printf("FAIL %s [%s, %s%s]: %s\n", paths[p], kScenarios[s].name, kHeapBudgets[b].name,
+                           skip != 0 ? ", chunked" : "", error.c_str());
+                }
+            }
+        }
+        if (runFailures > 0) ++failures;
+        printf("%-4s %s: %u files, %u patch runs\n", runFailures == 0 ? "ok" : "FAIL", paths[p],
+               static_cast<u32>(files.size()), runs);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Flips bits, copies words and truncates inside the header, nodes and names
+void MutateMetadata(std::vector<u8> &archive, u32 &state) {
+    u32 metaEnd = static_cast<u32>(archive.size());
+    if (archive.size() >= sizeof(U8Header)) {
+        const u64 end = static_cast<u64>(ReadBE32(&archive[4])) + ReadBE32(&archive[8]);
+        if (end < metaEnd) metaEnd = static_cast<u32>(end);
+    }
+    if (metaEnd == 0) return;
+    const u32 edits = 1 + NextRandom(state) % 6;
+    for (u32 e = 0; e < edits; ++e) {
+        const u32 at = NextRandom(state) % metaEnd;
+        switch (NextRandom(state) % 5) {
+            case 0:
+            case 1:
+                archive[at] ^= static_cast<u8>(1u << (NextRandom(state) % 8));
+                break;
+            case 2:
+                archive[at] = static_cast<u8>(NextRandom(state));
+                break;
+            case 3:
+                if (at + 4 <= metaEnd) WriteBE32(&archive[at & ~3u], NextRandom(state) % (metaEnd + 0x40));
+                break;
+            default:
+                if (NextRandom(state) % 8 == 0) archive.resize(at + sizeof(U8Header) > archive.size() ? archive.size() : at + sizeof(U8Header));
+                break;
+        }
+    }
+}
+
+int Fuzz(u32 iterations, int count, char **paths) {
+    std::vector<Source> corpus;
+    for (int i = 0; i < count; ++i) {
+        Source source;
+        if (!LoadSource(paths[i], source)) return 1;
+        if (!ExpectsRejection(source.path)) corpus.push_back(source);
+    }
+    if (corpus.empty()) return 1;
+
+    u32 state = 0x2545f491;
+    u32 accepted = 0;
+    u32 rejected = 0;
+    for (u32 i = 0; i < iterations; ++i) {
+        const Source &base = corpus[NextRandom(state) % corpus.size()];
+        std::vector<u8> archive = DecodeSourceBE(base);
+        std::vector<u8> hostArchive = archive;
+        SwapU8MetadataToHost(&hostArchive[0], base.decodedSize);
+        const std::vector<ArchiveFile> files = ListFiles(&hostArchive[0]);
+
+        // The override set is planned against the intact archive, so its paths and sizes still look plausible
+        std::vector<OverrideKind> kinds;
+        const u32 kindCount = 1 + NextRandom(state) % 6;
+        for (u32 k = 0; k < kindCount; ++k) kinds.push_back(static_cast<OverrideKind>(NextRandom(state) % KIND_COUNT));
+        const OverrideSet set = PlanOverrides(files, kinds, state);
+
+        MutateMetadata(archive, state);
+        Source mutated;
+        mutated.path = base.path;
+        mutated.compressed = WrapYaz0(archive);
+        mutated.decodedSize = static_cast<u32>(archive.size());
+        std::vector<u8> input = archive;
+        if (!input.empty()) SwapU8MetadataToHost(&input[0], mutated.decodedSize);
+        const bool inputValid = !input.empty() && IsValidU8Layout(&input[0], mutated.decodedSize);
+
+        const HeapBudget &budget = kHeapBudgets[NextRandom(state) % (sizeof(kHeapBudgets) / sizeof(kHeapBudgets[0]))];
+        const PatchRun run = RunPatch(mutated, set, budget, NextRandom(state) % 2 == 0);
+        const char *error = nullptr;
+        if (run.leaked) error = "heap blocks leaked";
+        if (!inputValid && (run.result || run.output != input)) error = "malformed archive was modified";
+        if (inputValid && !IsValidU8Layout(&run.output[0], static_cast<u32>(run.output.size()))) {
+            error = "output is not a valid U8 archive";
+        }
+        if (error != nullptr) {
+            printf("FAIL iteration %u (%s): %s\n", i, base.path.c_str(), error);
+            return 1;
+        }
+        if (run.result) {
+            ++accepted;
+        } else {
+            ++rejected;
+        }
+    }
+    printf("%u inputs: patched %u, left alone %u\n", iterations, accepted, rejected);
+    return 0;
+}
+
+int Bench(const char *path, u32 iterations) {
+    Source source;
+    if (!LoadSource(path, source)) return 1;
+    std::vector<u8> archive = DecodeSourceBE(source);
+    SwapU8MetadataToHost(&archive[0], source.decodedSize);
+    if (!IsValidU8Layout(&archive[0], source.decodedSize)) {
+        fprintf(stderr, "%s: not a valid U8 archive\n", path);
+        return 1;
+    }
+    const std::vector<ArchiveFile> files = ListFiles(&archive[0]);
+    printf("%s: %u bytes, %u files\n", path, source.decodedSize, static_cast<u32>(files.size()));
+
+    const u32 overrideCount = files.size() < 40 ? 4 : static_cast<u32>(files.size()) / 10;
+    const char *setNames[] = {"in place", "repack", "structural"};
+    const OverrideKind setKinds[][2] = {{KIND_SAME_SIZE, KIND_SHRINK}, {KIND_GROW, KIND_SAME_SIZE}, {KIND_DELETE, KIND_ADD}};
+    for (u32 s = 0; s < 3; ++s) {
+        std::vector<OverrideKind> kinds;
+        for (u32 i = 0; i < overrideCount; ++i) kinds.push_back(setKinds[s][i % 2]);
+        u32 state = 0x2545f491;
+        const OverrideSet set = PlanOverrides(files, kinds, state);
+
+        double seconds = 0.0;
+        u32 applied = 0;
+        LoosePatchStats stats = LoosePatchStats();
+        u32 scratch = 0;
+        for (u32 i = 0; i < iterations; ++i) {
+            EGG::Heap mem2(0x4000000);
+            EGG::Heap overrides(0x4000000);
+            EGG::Heap sourceHeap(source.decodedSize + 0x4000000);
+            sHeaps.mem2 = &mem2;
+            sHeaps.overrides = &overrides;
+            sCompressed = &source.compressed[0];
+            sCompressedSize = static_cast<u32>(source.compressed.size());
+            u8 *base = static_cast<u8 *>(PatchPlatform::Alloc(source.decodedSize, 0x20, &sourceHeap));
+            memcpy(base, &archive[0], source.decodedSize);
+            u32 size = source.decodedSize;
+            EGG::Heap *archiveHeap = &sourceHeap;
+            u32 patched = 0;
+            u32 missing = 0;
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            PatchU8Archive("bench", &set.table[0], sRangeStart, sRangeEnd, base, size, &sourceHeap, archiveHeap,
+                           &applied, &patched, &missing, sCompressed);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            stats = GetLastLoosePatchStats();
+            scratch = GetLoosePatchScratchFootprint();
+            PatchPlatform::Free(base, archiveHeap);
+            FreeLoosePatchScratch();
+            sHeaps.mem2 = sHeaps.overrides = nullptr;
+        }
+        printf("  %-10s %u overrides, %u applied: %.2f us per call, scratch 0x%X, temp 0x%X\n", setNames[s],
+               sRangeEnd - sRangeStart, applied, seconds * 1e6 / iterations, scratch, stats.tempBytes);
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    sVerbose = getenv("LOOSE_OVERRIDE_HOST_VERBOSE") != nullptr;
+    if (argc >= 3 && strcmp(argv[1], "check") == 0) return Check(argc - 2, argv + 2);
+    if (argc >= 4 && strcmp(argv[1], "fuzz") == 0) return Fuzz(static_cast<u32>(strtoul(argv[2], nullptr, 10)), argc - 3, argv + 3);
+    if (argc >= 3 && strcmp(argv[1], "bench") == 0) {
+        return Bench(argv[2], argc >= 4 ? static_cast<u32>(strtoul(argv[3], nullptr, 10)) : 200);
+    }
+    fprintf(stderr, "usage: %s check <archives...> | fuzz <iterations> <archives...> | bench <archive> [iterations]\n",
+            argv[0]);
+    return 2;
+}
+#endif
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Regenerate the synthetic U8 archives in scripts/loose_override_host/corpus.
+
+The archives mimic the layouts the loose override patcher meets in game: SZS files with a "." root directory, plain
+U8 files, names shared between directories, payloads with and without alignment slack, deep trees, and a few
+malformed archives (named invalid_*) that must be rejected untouched. Output is deterministic.
+"""
+
+from __future__ import annotations
+
+import random
+import struct
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pack_chunked_szs import U8_MAGIC, align, yaz0_encode  # noqa: E402
+
+CORPUS_DIR = Path(__file__).resolve().parent / "corpus"
+
+
+def payload(rng: random.Random, size: int) -> bytes:
+    # Runs of repeated bytes keep the Yaz0 encoder busy without making the corpus large
+    out = bytearray()
+    while len(out) < size:
+        out += bytes([rng.randrange(256)]) * rng.randrange(1, 9)
+    return bytes(out[:size])
+
+
+def build_u8(tree: dict, file_align: int = 0x20) -> bytes:
+    """tree maps names to bytes (files) or nested dicts (directories)."""
+    nodes: list[list[int]] = []
+    names = bytearray(b"\0")
+    files: list[tuple[int, bytes]] = []
+
+    def add_name(name: str) -> int:
+        offset = len(names)
+        names.extend(name.encode("ascii") + b"\0")
+        return offset
+
+    def add_dir(name_offset: int, parent: int, children: dict) -> None:
+        index = len(nodes)
+        nodes.append([0x01000000 | name_offset, parent, 0])
+        for name in sorted(children, key=lambda n: (isinstance(children[n], dict), n)):
+            child = children[name]
+            if isinstance(child, dict):
+                add_dir(add_name(name), index, child)
+            else:
+                files.append((len(nodes), child))
+                nodes.append([add_name(name), 0, len(child)])
+        nodes[index][2] = len(nodes)
+
+    add_dir(0, 0, tree)
+    meta_size = len(nodes) * 12 + len(names)
+    offset = align(0x20 + meta_size, 0x20)
+    data = bytearray()
+    for index, contents in files:
+        offset = align(offset, file_align)
+        nodes[index][1] = offset
+        data += bytes(offset - (align(0x20 + meta_size, 0x20) + len(data)))
+        data += contents
+        offset += len(contents)
+
+    out = bytearray(struct.pack(">IIII", U8_MAGIC, 0x20, meta_size, align(0x20 + meta_size, 0x20)) + bytes(16))
+    for node in nodes:
+        out += struct.pack(">III", *node)
+    out += names
+    out += bytes(align(len(out), 0x20) - len(out))
+    out += data
+    return bytes(out)
+
+
+def common_tree(rng: random.Random) -> dict:
+    return {
+        ".": {
+            "course_model.brres": payload(rng, 0x1234),
+            "course.kcl": payload(rng, 0x800),
+            "map_model.brres": payload(rng, 0x1),
+            "empty.bin": b"",
+            "posteffect": {
+                "posteffect.bfg": payload(rng, 0x60),
+                "posteffect.bblm": payload(rng, 0x41),
+            },
+            "effect": {
+                "one": {"common.breff": payload(rng, 0x100), "common.breft": payload(rng, 0x333)},
+                "two": {"common.breff": payload(rng, 0x77), "common.breft": payload(rng, 0x90)},
+            },
+        }
+    }
+
+
+def many_tree(rng: random.Random) -> dict:
+    tree: dict = {}
+    for d in range(12):
+        directory: dict = {}
+        for f in range(25):
+            # Every fifth name repeats across directories
+            name = f"shared_{f}.bin" if f % 5 == 0 else f"file_{d}_{f}.bin"
+            directory[name] = payload(rng, rng.randrange(1, 0x400))
+        tree[f"dir{d:02}"] = directory
+    return {".": tree}
+
+
+def deep_tree(rng: random.Random) -> dict:
+    tree: dict = {"leaf.bin": payload(rng, 0x45)}
+    for depth in range(8):
+        tree = {f"level{depth}": tree, f"file{depth}.bin": payload(rng, rng.randrange(0x10, 0x200))}
+    return tree
+
+
+def packed_tree(rng: random.Random) -> dict:
+    # Sizes without alignment slack, so any growth needs a repack
+    return {f"part{i}.bin": payload(rng, 0x20 * rng.randrange(1, 16)) for i in range(10)}
+
+
+def corrupt(archive: bytes, offset: int, value: int) -> bytes:
+    out = bytearray(archive)
+    struct.pack_into(">I", out, offset, value)
+    return bytes(out)
+
+
+def main() -> int:
+    rng = random.Random(0x5A5A)
+    CORPUS_DIR.mkdir(exist_ok=True)
+    common = build_u8(common_tree(rng))
+    node_count = struct.unpack_from(">I", common, 0x28)[0]
+    meta_size = struct.unpack_from(">I", common, 8)[0]
+    archives = {
+        "valid_common.szs": yaz0_encode(common),
+        "valid_many.szs": yaz0_encode(build_u8(many_tree(rng))),
+        "valid_deep.arc": build_u8(deep_tree(rng)),
+        "valid_packed.arc": build_u8(packed_tree(rng)),
+        "invalid_magic.arc": corrupt(common, 0, 0x55AA3820),
+        "invalid_node_count.arc": corrupt(common, 0x28, 0x10000),
+        "invalid_name_table.arc": corrupt(common, 0x20 + meta_size - 4, 0x41414141),
+        "invalid_child_range.arc": corrupt(common, 0x20 + 12 + 8, node_count + 1),
+    }
+    for name, data in archives.items():
+        (CORPUS_DIR / name).write_bytes(data)
+        print(f"{name}: {len(data)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
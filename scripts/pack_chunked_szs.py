@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""Repack an SZS (or plain U8) archive into Pulsar's chunked PCHK container.
+
+The container keeps the U8 header, nodes and names uncompressed and stores the file payloads as independently
+Yaz0-compressed chunks plus a node -> chunk table, so the game can skip decoding members that loose overrides
+replace. Layout (big endian), matching PulsarEngine/IO/ChunkedArchive.hpp:
+
+    0x00 'PCHK', u16 version, u16 chunk count, u32 expand size, u32 meta size,
+         u32 meta offset, u32 chunk table offset, u32 member table offset, u32 reserved
+    chunk table:  {u32 expand offset, u32 expand size, u32 data offset, u32 data size} per chunk
+    member table: {u16 first chunk, u16 chunk count} per U8 node
+"""
+
+from __future__ import annotations
+
+import argparse
+import struct
+import sys
+from dataclasses import dataclass
+from pathlib import Path
+
+
+CHUNKED_MAGIC = b"PCHK"
+CHUNKED_VERSION = 1
+CHUNKED_HEADER_SIZE = 0x20
+YAZ0_MAGIC = b"Yaz0"
+U8_MAGIC = 0x55AA382D
+DEFAULT_CHUNK_SIZE = 0x10000
+MAX_CHUNKS = 0xFFFF
+
+
+@dataclass(frozen=True)
+class U8File:
+    node_index: int
+    offset: int
+    size: int
+
+
+@dataclass(frozen=True)
+class Chunk:
+    expand_offset: int
+    expand_size: int
+
+
+def read_u32_be(data: bytes, offset: int) -> int:
+    return struct.unpack_from(">I", data, offset)[0]
+
+
+def align(value: int, alignment: int) -> int:
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def yaz0_decode(data: bytes) -> bytes:
+    if data[:4] != YAZ0_MAGIC:
+        raise ValueError("missing Yaz0 header")
+    expand_size = read_u32_be(data, 4)
+    out = bytearray()
+    src = 0x10
+    while len(out) < expand_size:
+        code = data[src]
+        src += 1
+        for _ in range(8):
+            if len(out) >= expand_size:
+                break
+            if code & 0x80:
+                out.append(data[src])
+                src += 1
+            else:
+                byte0, byte1 = data[src], data[src + 1]
+                src += 2
+                distance = ((byte0 & 0xF) << 8 | byte1) + 1
+                length = byte0 >> 4
+                if length == 0:
+                    length = data[src] + 0x12
+                    src += 1
+                else:
+                    length += 2
+                start = len(out) - distance
+                for i in range(length):
+                    out.append(out[start + i])
+            code <<= 1
+    return bytes(out[:expand_size])
+
+
+def yaz0_encode(data: bytes) -> bytes:
+    """Greedy Yaz0 encoder; the game's decoder only cares about validity, not optimal ratios."""
+    out = bytearray(YAZ0_MAGIC + struct.pack(">I", len(data)) + bytes(8))
+    recent: dict[bytes, list[int]] = {}
+    pos = 0
+    size = len(data)
+    while pos < size:
+        code_pos = len(out)
+        out.append(0)
+        code = 0
+        for bit in range(8):
+            if pos >= size:
+                break
+            best_len = 0
+            best_dist = 0
+            key = data[pos:pos + 3]
+            if len(key) == 3:
+                candidates = recent.get(key, [])
+                max_len = min(0x111, size - pos)
+                for candidate in reversed(candidates):
+                    distance = pos - candidate
+                    if distance > 0x1000:
+                        break
+                    length = 3
+                    while length < max_len and data[candidate + length] == data[pos + length]:
+                        length += 1
+                    if length > best_len:
+                        best_len = length
+                        best_dist = distance
+                        if length == max_len:
+                            break
+            step = best_len if best_len >= 3 else 1
+            for i in range(pos, min(pos + step, size - 2)):
+                bucket = recent.setdefault(data[i:i + 3], [])
+                bucket.append(i)
+                if len(bucket) > 32:
+                    del bucket[0]
+            if best_len >= 3:
+                distance = best_dist - 1
+                if best_len >= 0x12:
+                    out += bytes((distance >> 8, distance & 0xFF, best_len - 0x12))
+                else:
+                    out += bytes((((best_len - 2) << 4) | (distance >> 8), distance & 0xFF))
+            else:
+                code |= 0x80 >> bit
+                out.append(data[pos])
+            pos += step
+        out[code_pos] = code
+    return bytes(out)
+
+
+def parse_u8(archive: bytes) -> tuple[int, int, list[U8File]]:
+    if read_u32_be(archive, 0) != U8_MAGIC:
+        raise ValueError("not a U8 archive")
+    node_offset = read_u32_be(archive, 4)
+    meta_size = node_offset + read_u32_be(archive, 8)
+    node_count = read_u32_be(archive, node_offset + 8)
+    files: list[U8File] = []
+    for index in range(1, node_count):
+        type_name, offset, size = struct.unpack_from(">III", archive, node_offset + index * 12)
+        if type_name >> 24 == 0:
+            files.append(U8File(index, offset, size))
+    return meta_size, node_count, files
+
+
+def split_chunks(meta_size: int, expand_size: int, files: list[U8File], chunk_size: int) -> list[Chunk]:
+    """Cut only between members so each one maps to a contiguous run of chunks; big members get their own chunk."""
+    chunks: list[Chunk] = []
+    chunk_start = meta_size
+    covered_end = meta_size
+    for member in sorted(files, key=lambda f: f.offset):
+        if member.size == 0:
+            continue
+        member_end = member.offset + member.size
+        if member.offset >= covered_end and member.offset > chunk_start and member_end - chunk_start > chunk_size:
+            chunks.append(Chunk(chunk_start, member.offset - chunk_start))
+            chunk_start = member.offset
+        covered_end = max(covered_end, member_end)
+    if expand_size > chunk_start:
+        chunks.append(Chunk(chunk_start, expand_size - chunk_start))
+    if len(chunks) > MAX_CHUNKS:
+        raise ValueError(f"too many chunks ({len(chunks)}), raise --chunk-size")
+    return chunks
+
+
+def build_member_table(node_count: int, files: list[U8File], chunks: list[Chunk]) -> list[tuple[int, int]]:
+    members = [(0, 0)] * node_count
+    for member in files:
+        if member.size == 0:
+            continue
+        first = last = None
+        for index, chunk in enumerate(chunks):
+            chunk_end = chunk.expand_offset + chunk.expand_size
+            if first is None and chunk_end > member.offset:
+                first = index
+            if chunk.expand_offset < member.offset + member.size:
+                last = index
+        if first is None or last is None:
+            raise ValueError(f"node {member.node_index} lies outside the archive")
+        members[member.node_index] = (first, last - first + 1)
+    return members
+
+
+def pack(archive: bytes, chunk_size: int) -> tuple[bytes, int, int]:
+    meta_size, node_count, files = parse_u8(archive)
+    chunks = split_chunks(meta_size, len(archive), files, chunk_size)
+    members = build_member_table(node_count, files, chunks)
+
+    chunk_table_offset = CHUNKED_HEADER_SIZE
+    member_table_offset = chunk_table_offset + len(chunks) * 16
+    meta_offset = align(member_table_offset + node_count * 4, 0x20)
+    data_offset = align(meta_offset + meta_size, 0x20)
+
+    payload = bytearray()
+    chunk_table = bytearray()
+    compressed_chunks = 0
+    for chunk in chunks:
+        raw = archive[chunk.expand_offset:chunk.expand_offset + chunk.expand_size]
+        encoded = yaz0_encode(raw)
+        # Stored chunks are told apart by data size == expand size, so never keep a Yaz0 stream that is not smaller.
+        if len(encoded) < len(raw):
+            stored = encoded
+            compressed_chunks += 1
+        else:
+            stored = raw
+        offset = data_offset + len(payload)
+        chunk_table += struct.pack(">IIII", chunk.expand_offset, chunk.expand_size, offset, len(stored))
+        payload += stored
+        payload += bytes(align(len(payload), 0x20) - len(payload))
+
+    header = struct.pack(">4sHHIIIIII", CHUNKED_MAGIC, CHUNKED_VERSION, len(chunks), len(archive), meta_size,
+                         meta_offset, chunk_table_offset, member_table_offset, 0)
+    member_table = b"".join(struct.pack(">HH", first, count) for first, count in members)
+
+    out = bytearray(header + chunk_table + member_table)
+    out += bytes(meta_offset - len(out))
+    out += archive[:meta_size]
+    out += bytes(data_offset - len(out))
+    out += payload
+    return bytes(out), len(chunks), compressed_chunks
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="Input .szs (Yaz0) or uncompressed U8 archive.")
+    parser.add_argument("-o", "--output", help="Output path. Default: overwrite the input.")
+    parser.add_argument(
+        "--chunk-size",
+        type=lambda value: int(value, 0),
+        default=DEFAULT_CHUNK_SIZE,
+        help="Target decoded bytes per chunk. Default: 0x10000",
+    )
+    return parser.parse_args()
+
+
+def main() -> int:
+    args = parse_args()
+    input_path = Path(args.input)
+    try:
+        data = input_path.read_bytes()
+        archive = yaz0_decode(data) if data[:4] == YAZ0_MAGIC else data
+        packed, chunk_count, compressed_chunks = pack(archive, args.chunk_size)
+    except (OSError, ValueError, IndexError, struct.error) as exc:
+        print(f"error: {exc}", file=sys.stderr)
+        return 1
+
+    output_path = Path(args.output) if args.output else input_path
+    output_path.write_bytes(packed)
+    print(f"wrote {output_path}: {len(archive):#x} -> {len(packed):#x} bytes, "
+          f"{chunk_count} chunks ({compressed_chunks} compressed)")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
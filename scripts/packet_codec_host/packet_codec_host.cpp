@@ -0,0 +1,291 @@
+// Host build of the RH1 and SELECT wire codec, see scripts/build_packet_codec_host.sh.
+//   packet_codec_host check [iterations]  round-trips random packets of every size, then decodes every prefix of each
+//                                         encoding and a few corrupted copies of it
+//   packet_codec_host fuzz <iterations>   decodes random mutations of valid encodings and re-encodes what is accepted
+// Every input is copied into a heap block of exactly its size, so an address sanitizer build catches any read past
+// the end. Built with -DPACKET_CODEC_HOST_LIBFUZZER, the file is a libFuzzer target instead.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Network/PacketCodec.hpp>
+
+using namespace Pulsar::Network;
+
+namespace {
+
+const u32 kRH1Sizes[] = {sizeof(RKNet::RACEHEADER1Packet), PulRH1SizeBase, PulRH1SizeLapKo, PulRH1SizeFull};
+
+bool IsRawRH1Size(u32 size) {
+    for (u32 i = 0; i < sizeof(kRH1Sizes) / sizeof(kRH1Sizes[0]); ++i) {
+        if (size == kRH1Sizes[i]) return true;
+    }
+    return false;
+}
+
+bool IsRawSELECTSize(u32 size) {
+    return size == sizeof(RKNet::SELECTPacket) || size == sizeof(PulSELECT);
+}
+
+bool DecodeRH1Exact(const u8 *data, u32 size, PulRH1 &packet, u32 &packetSize) {
+    u8 *copy = static_cast<u8 *>(malloc(size == 0 ? 1 : size));
+    memcpy(copy, data, size);
+    const bool ok = DecodePulRH1(copy, size, packet, packetSize);
+    free(copy);
+    return ok;
+}
+
+bool DecodeSELECTExact(const u8 *data, u32 size, PulSELECT &packet, u32 &packetSize) {
+    u8 *copy = static_cast<u8 *>(malloc(size == 0 ? 1 : size));
+    memcpy(copy, data, size);
+    const bool ok = DecodePulSELECT(copy, size, packet, packetSize);
+    free(copy);
+    return ok;
+}
+
+// An accepted packet must have a raw size and survive another round trip unchanged
+bool ReencodesRH1(const PulRH1 &packet, u32 size) {
+    if (!IsRawRH1Size(size)) return false;
+    u8 wire[PulRH1WireSizeMax];
+    const u32 wireSize = EncodePulRH1(packet, size, wire);
+    PulRH1 decoded;
+    u32 decodedSize;
+    return wireSize <= PulRH1WireSizeMax && (wireSize == size || !IsRawRH1Size(wireSize))
+           && DecodeRH1Exact(wire, wireSize, decoded, decodedSize) && decodedSize == size && memcmp(&decoded, &packet, size) == 0;
+}
+
+bool ReencodesSELECT(const PulSELECT &packet, u32 size) {
+    if (!IsRawSELECTSize(size)) return false;
+    u8 wire[PulSELECTWireSizeMax];
+    const u32 wireSize = EncodePulSELECT(packet, size, wire);
+    PulSELECT decoded;
+    u32 decodedSize;
+    return wireSize <= PulSELECTWireSizeMax && (wireSize == size || !IsRawSELECTSize(wireSize))
+           && DecodeSELECTExact(wire, wireSize, decoded, decodedSize) && decodedSize == size && memcmp(&decoded, &packet, size) == 0;
+}
+
+}  // namespace
+
+#ifdef PACKET_CODEC_HOST_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const u8 *data, size_t size) {
+    if (size > 0x100) return 0;
+    PulRH1 rh1;
+    u32 rh1Size;
+    if (DecodeRH1Exact(data, static_cast<u32>(size), rh1, rh1Size) && !ReencodesRH1(rh1, rh1Size)) abort();
+    PulSELECT select;
+    u32 selectSize;
+    if (DecodeSELECTExact(data, static_cast<u32>(size), select, selectSize) && !ReencodesSELECT(select, selectSize)) abort();
+    return 0;
+}
+#else
+namespace {
+
+u32 NextRandom(u32 &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void FillRandom(u32 &state, void *dest, u32 size) {
+    u8 *bytes = static_cast<u8 *>(dest);
+    for (u32 i = 0; i < size; ++i) bytes[i] = static_cast<u8>(NextRandom(state));
+}
+
+// Each Pulsar section is left at the values senders write for a disabled mode half of the time
+void RandomRH1(u32 &state, PulRH1 &packet, u32 &size) {
+    FillRandom(state, &packet, sizeof(PulRH1));
+    packet.hasTrack = (NextRandom(state) & 1) != 0;
+    size = kRH1Sizes[NextRandom(state) % 4];
+    if (NextRandom(state) & 1) memset(&packet.pulsarTrackId, 0, 7);
+    if (NextRandom(state) & 1) memset(&packet.timeInDanger, 0, 4);
+    if (NextRandom(state) & 1) {
+        memset(&packet.lapKoSeq, 0, 4);
+        memset(packet.lapKoElims, 0xFF, sizeof(packet.lapKoElims));
+    } else {
+        for (u32 i = NextRandom(state) % 13; i < 12; ++i) packet.lapKoElims[i] = 0xFF;
+    }
+    if (NextRandom(state) & 1) {
+        memset(&packet.battleRoyaleLossSeq, 0, PulRH1BattleRoyaleSize);
+        packet.battleRoyaleLossPlayerId = 0xFF;
+        packet.battleRoyaleBalloonCounts = 0xFF;
+    }
+}
+
+void RandomSELECT(u32 &state, PulSELECT &packet, u32 &size) {
+    FillRandom(state, &packet, sizeof(PulSELECT));
+    packet.alwaysFinal = (NextRandom(state) & 1) != 0;
+    packet.singleRace1v1Final = (NextRandom(state) & 1) != 0;
+    packet.lastGroupedTrackPlayed = (NextRandom(state) & 1) != 0;
+    size = NextRandom(state) % 4 == 0 ? sizeof(RKNet::SELECTPacket) : sizeof(PulSELECT);
+    if (NextRandom(state) & 1) packet.allowChangeComboStatus = 0;
+    if (NextRandom(state) & 1) memset(&packet.koPerRace, 0, 6);
+    if (NextRandom(state) & 1) {
+        packet.blockedTrackCount = 0;
+        packet.curBlockingArrayIdx = 0;
+        packet.lastGroupedTrackPlayed = false;
+        for (u32 i = 0; i < MAX_TRACK_BLOCKING; ++i) packet.blockedTracks[i] = 0xFFFF;
+    } else {
+        for (u32 i = NextRandom(state) % (MAX_TRACK_BLOCKING + 1); i < MAX_TRACK_BLOCKING; ++i) packet.blockedTracks[i] = 0xFFFF;
+    }
+}
+
+void Corrupt(u32 &state, u8 *wire, u32 wireSize) {
+    const u32 edits = 1 + NextRandom(state) % 4;
+    for (u32 e = 0; e < edits; ++e) {
+        const u32 at = NextRandom(state) % wireSize;
+        if (NextRandom(state) & 1)
+            wire[at] ^= static_cast<u8>(1 << (NextRandom(state) % 8));
+        else
+            wire[at] = static_cast<u8>(NextRandom(state));
+    }
+}
+
+struct Stats {
+    Stats() : packets(0), rawBytes(0), wireBytes(0), failures(0) {}
+    u32 packets;
+    u32 rawBytes;
+    u32 wireBytes;
+    u32 failures;
+};
+
+void Report(const char *name, const Stats &stats) {
+    printf("%-6s %u packets, %u -> %u bytes, %u failure(s)\n", name, stats.packets, stats.rawBytes, stats.wireBytes, stats.failures);
+}
+
+void CheckRH1(u32 &state, Stats &stats) {
+    PulRH1 packet;
+    u32 size;
+    RandomRH1(state, packet, size);
+    u8 wire[PulRH1WireSizeMax];
+    const u32 wireSize = EncodePulRH1(packet, size, wire);
+    ++stats.packets;
+    stats.rawBytes += size;
+    stats.wireBytes += wireSize;
+
+    // Encodings never look like a raw struct, and raw structs from peers without the codec decode as themselves
+    bool ok = wireSize <= PulRH1WireSizeMax && (size == sizeof(RKNet::RACEHEADER1Packet) || !IsRawRH1Size(wireSize));
+    PulRH1 decoded;
+    u32 decodedSize;
+    ok = ok && DecodeRH1Exact(wire, wireSize, decoded, decodedSize) && decodedSize == size && memcmp(&decoded, &packet, size) == 0;
+    ok = ok && DecodeRH1Exact(reinterpret_cast<const u8 *>(&packet), size, decoded, decodedSize) && decodedSize == size
+         && memcmp(&decoded, &packet, size) == 0;
+
+    for (u32 length = 0; ok && length < wireSize; ++length) {
+        if (DecodeRH1Exact(wire, length, decoded, decodedSize) && decodedSize != length) ok = false;
+    }
+    for (u32 i = 0; ok && i < 8; ++i) {
+        u8 corrupt[PulRH1WireSizeMax];
+        memcpy(corrupt, wire, wireSize);
+        Corrupt(state, corrupt, wireSize);
+        if (DecodeRH1Exact(corrupt, wireSize, decoded, decodedSize) && !ReencodesRH1(decoded, decodedSize)) ok = false;
+    }
+    if (!ok) {
+        ++stats.failures;
+        fprintf(stderr, "RH1 mismatch: size %u, wire %u\n", size, wireSize);
+    }
+}
+
+void CheckSELECT(u32 &state, Stats &stats) {
+    PulSELECT packet;
+    u32 size;
+    RandomSELECT(state, packet, size);
+    u8 wire[PulSELECTWireSizeMax];
+    const u32 wireSize = EncodePulSELECT(packet, size, wire);
+    ++stats.packets;
+    stats.rawBytes += size;
+    stats.wireBytes += wireSize;
+
+    bool ok = wireSize <= PulSELECTWireSizeMax && (size == sizeof(RKNet::SELECTPacket) || !IsRawSELECTSize(wireSize));
+    PulSELECT decoded;
+    u32 decodedSize;
+    ok = ok && DecodeSELECTExact(wire, wireSize, decoded, decodedSize) && decodedSize == size && memcmp(&decoded, &packet, size) == 0;
+    ok = ok && DecodeSELECTExact(reinterpret_cast<const u8 *>(&packet), size, decoded, decodedSize) && decodedSize == size
+         && memcmp(&decoded, &packet, size) == 0;
+
+    for (u32 length = 0; ok && length < wireSize; ++length) {
+        if (DecodeSELECTExact(wire, length, decoded, decodedSize) && decodedSize != length) ok = false;
+    }
+    for (u32 i = 0; ok && i < 8; ++i) {
+        u8 corrupt[PulSELECTWireSizeMax];
+        memcpy(corrupt, wire, wireSize);
+        Corrupt(state, corrupt, wireSize);
+        if (DecodeSELECTExact(corrupt, wireSize, decoded, decodedSize) && !ReencodesSELECT(decoded, decodedSize)) ok = false;
+    }
+    if (!ok) {
+        ++stats.failures;
+        fprintf(stderr, "SELECT mismatch: size %u, wire %u\n", size, wireSize);
+    }
+}
+
+int Check(u32 iterations) {
+    u32 state = 0x6d2b79f5;
+    Stats rh1;
+    Stats select;
+    for (u32 i = 0; i < iterations; ++i) {
+        CheckRH1(state, rh1);
+        CheckSELECT(state, select);
+    }
+    Report("RH1", rh1);
+    Report("SELECT", select);
+    return rh1.failures == 0 && select.failures == 0 ? 0 : 1;
+}
+
+int Fuzz(u32 iterations) {
+    u32 state = 0x2545f491;
+    u32 accepted = 0;
+    u32 failures = 0;
+    for (u32 i = 0; i < iterations; ++i) {
+        u8 wire[0x100];
+        u32 wireSize;
+        const bool isRH1 = (NextRandom(state) & 1) != 0;
+        if (isRH1) {
+            PulRH1 packet;
+            u32 size;
+            RandomRH1(state, packet, size);
+            wireSize = EncodePulRH1(packet, size, wire);
+        } else {
+            PulSELECT packet;
+            u32 size;
+            RandomSELECT(state, packet, size);
+            wireSize = EncodePulSELECT(packet, size, wire);
+        }
+        switch (NextRandom(state) % 3) {
+            case 0:
+                Corrupt(state, wire, wireSize);
+                break;
+            case 1:
+                wireSize = NextRandom(state) % (wireSize + 1);
+                break;
+            default:
+                while (wireSize < sizeof(wire) && (NextRandom(state) & 3) != 0) wire[wireSize++] = static_cast<u8>(NextRandom(state));
+                break;
+        }
+
+        // Both decoders see every input, the section sizes of a RACE packet can be anything
+        PulRH1 rh1;
+        u32 rh1Size;
+        if (DecodeRH1Exact(wire, wireSize, rh1, rh1Size)) {
+            ++accepted;
+            if (!ReencodesRH1(rh1, rh1Size)) ++failures;
+        }
+        PulSELECT select;
+        u32 selectSize;
+        if (DecodeSELECTExact(wire, wireSize, select, selectSize)) {
+            ++accepted;
+            if (!ReencodesSELECT(select, selectSize)) ++failures;
+        }
+    }
+    printf("%u inputs: %u decodes accepted, %u failure(s)\n", iterations, accepted, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) return Check(argc >= 3 ? static_cast<u32>(strtoul(argv[2], nullptr, 10)) : 20000);
+    if (argc >= 3 && strcmp(argv[1], "fuzz") == 0) return Fuzz(static_cast<u32>(strtoul(argv[2], nullptr, 10)));
+    fprintf(stderr, "usage: %s check [iterations] | fuzz <iterations>\n", argv[0]);
+    return 2;
+}
+#endif
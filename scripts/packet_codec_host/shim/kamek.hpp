@@ -0,0 +1,9 @@
+// Stands in for KamekInclude/kamek.hpp in the host packet codec build; the vanilla packet headers only need the types.
+#ifndef __KAMEK_H
+#define __KAMEK_H
+#include <types.hpp>
+
+namespace OS {
+typedef s64 Time;
+}
+#endif